@@ -53,6 +53,7 @@ if ( CMOCKA_FOUND AND EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/test" )
 		include( CodeCoverage )
 	endif ( NOT CMAKE_CROSSCOMPILING )
 	set( INT_TESTS "" CACHE INTERNAL "list of integration tests" )
+	set( SYS_TESTS "" CACHE INTERNAL "list of system tests" )
 	include_directories( SYSTEM ${CMOCKA_INCLUDES} )
 	add_subdirectory( "test" )
 
@@ -86,6 +87,17 @@ if ( CMOCKA_FOUND AND EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/test" )
 			)
 		endforeach( INT_TEST )
 	endif( INT_TESTS )
+
+	# add system (performance) tests
+	if ( SYS_TESTS )
+		add_custom_target( "system-tests" )
+		foreach( SYS_TEST ${SYS_TESTS} )
+			add_custom_command( TARGET "system-tests"
+				COMMAND ${SYS_TEST} ${SYS_TEST_${SYS_TEST}_ARGS}
+				DEPENDS "${SYS_TEST}"
+			)
+		endforeach( SYS_TEST )
+	endif( SYS_TESTS )
 endif()
 
 # Adds a new integration test
@@ -172,6 +184,67 @@ macro( ADD_INTEGRATION_TESTS GROUP )
 	endforeach( TEST )
 endmacro( ADD_INTEGRATION_TESTS )
 
+# Adds a new system (performance) test
+# Parameters:
+# 	TEST_NAME - name of the test
+# 	DEFS ... - list of definitions
+# 	INCS ... - list of include directories
+# 	LIBS ... - list of libraries for linking
+# 	SRCS ... - list of source files
+function( ADD_SYSTEM_TEST TEST_NAME )
+	# Parse arguments passed to the function
+	cmake_parse_arguments( SYS_TEST "" "" "DEFS;INCS;LIBS;SRCS" ${ARGN} )
+	set( SYS_TEST_SRCS ${SYS_TEST_SRCS} ${SYS_TEST_UNPARSED_ARGUMENTS} )
+
+	# Add system tests
+	add_executable( "${TEST_NAME}" EXCLUDE_FROM_ALL ${SYS_TEST_SRCS} )
+	set( SYS_TESTS ${SYS_TESTS} "${TEST_NAME}" CACHE INTERNAL "list of system tests" )
+
+	# Add include directories
+	if ( SYS_TEST_INCS )
+		target_include_directories( "${TEST_NAME}" SYSTEM
+			PUBLIC ${SYS_TEST_INCS} )
+	endif( SYS_TEST_INCS )
+
+	# System tests are built with the other tests, but only run on request
+	add_dependencies( tests "${TEST_NAME}" )
+	target_link_libraries( "${TEST_NAME}" ${SYS_TEST_LIBS} )
+
+	# Add defintions, if required
+	if ( SYS_TEST_DEFS )
+		string( REGEX REPLACE "^-D" "" SYS_TEST_DEFS ${SYS_TEST_DEFS} )
+		get_target_property( COMPILE_DEFS "${TEST_NAME}"
+			COMPILE_DEFINITIONS )
+		set( COMPILE_DEFS ${COMPILE_DEFS} "${SYS_TEST_DEFS}" )
+		set_target_properties( "${TEST_NAME}"
+			PROPERTIES COMPILE_DEFINITIONS "${COMPILE_DEFS}" )
+	endif ( SYS_TEST_DEFS )
+endfunction( ADD_SYSTEM_TEST )
+
+# Adds multiple system (performance) tests
+# Parameters:
+# 	group - grouping name
+# 	... - name of variables holding test information, in the form:
+# 		TEST_${NAME}_DEFS - definitions to pass to each test
+# 		TEST_${NAME}_INCS - system include directories to compile with
+# 		TEST_${NAME}_LIBS - libraries to link the test executable with
+# 		TEST_${NAME}_SRCS - test source files
+macro( ADD_SYSTEM_TESTS GROUP )
+	foreach( TEST ${ARGN} )
+		string( TOUPPER "${TEST}" TEST_UPPER )
+		set( TEST_NAME "system-${TEST}" )
+		if ( NOT "x${GROUP}" STREQUAL "x" )
+			set( TEST_NAME "system-${GROUP}-${TEST}" )
+		endif ( NOT "x${GROUP}" STREQUAL "x" )
+		add_system_test( ${TEST_NAME}
+			DEFS ${TEST_${TEST_UPPER}_DEFS}
+			INCS ${TEST_${TEST_UPPER}_INCS}
+			LIBS ${TEST_${TEST_UPPER}_LIBS}
+			SRCS ${TEST_${TEST_UPPER}_SRCS}
+		)
+	endforeach( TEST )
+endmacro( ADD_SYSTEM_TESTS )
+
 # Create a new library for testing functionality
 # Parameters:
 # 	LIB_NAME        - name of the mocking library
@@ -16,6 +16,11 @@
  */
 
 #include "os.h"
+#if defined( _WIN32 )
+#	include "os_win_private.h"
+#else /* if defined( _WIN32 ) */
+#	include "os_posix_private.h"
+#endif /* else if defined( _WIN32 ) */
 
 #include <stdarg.h>
 
@@ -301,3 +306,4513 @@ int os_strncasecmp(
 	return result;
 }
 
+/* memory functions */
+/**
+ * @brief Size of a processor cache line, used to keep data written by
+ *        different CPUs apart
+ */
+#define OS_CACHE_LINE_SIZE             64u
+
+/**
+ * @brief Number of size classes kept in a thread's cache, from 16 bytes
+ *        doubling up to 512 bytes
+ */
+#define OS_ALLOCATOR_CLASSES           6u
+
+/**
+ * @brief Size of the smallest size class, as a power of 2
+ */
+#define OS_ALLOCATOR_CLASS_SHIFT       4u
+
+/**
+ * @brief Size class of a block that is not kept in a thread's cache
+ */
+#define OS_ALLOCATOR_CLASS_NONE        0xFFu
+
+/**
+ * @brief Maximum number of free blocks of each size class kept in a thread's
+ *        cache
+ */
+#define OS_ALLOCATOR_CACHE_MAX         64u
+
+/**
+ * @brief Size reserved before each block for its header, keeps the alignment
+ *        of the system allocator
+ */
+#define OS_ALLOCATOR_HEADER_SIZE       16u
+
+/**
+ * @brief Header stored before each block of the thread caching allocator
+ */
+struct os_allocator_header
+{
+	/** @brief Size of the block */
+	size_t size;
+	/** @brief Size class (OS_ALLOCATOR_CLASS_NONE = not cached) */
+	os_uint32_t size_class;
+	/** @brief Distance from the start of the system allocation */
+	os_uint32_t offset;
+};
+
+/**
+ * @brief Free blocks kept by a thread, for each size class
+ */
+struct os_allocator_cache
+{
+	/** @brief List of free blocks, linked through their first bytes */
+	void *blocks[OS_ALLOCATOR_CLASSES];
+	/** @brief Number of free blocks in each list */
+	os_uint32_t count[OS_ALLOCATOR_CLASSES];
+	/** @brief Whether the cache is emptied when the thread exits */
+	os_bool_t registered;
+};
+
+/** @brief Allocator set by os_allocator_set (NULL = system allocator) */
+static const os_allocator_t *OS_ALLOCATOR = NULL;
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/** @brief Allocator set by os_allocator_thread_set for the calling thread
+ *         (NULL = allocator set by os_allocator_set) */
+static OS_THREAD_LOCAL const os_allocator_t *OS_ALLOCATOR_LOCAL = NULL;
+/** @brief Free blocks kept by the calling thread */
+static OS_THREAD_LOCAL struct os_allocator_cache OS_ALLOCATOR_CACHE;
+/** @brief Key used to empty a thread's cache when it exits */
+static os_thread_local_key_t OS_ALLOCATOR_CACHE_KEY;
+/** @brief Creation of the key used to empty the thread caches */
+static os_thread_once_t OS_ALLOCATOR_CACHE_ONCE = OS_THREAD_ONCE_INIT;
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+/** @brief Allocator set by os_allocator_thread_set
+ *         (NULL = allocator set by os_allocator_set) */
+static const os_allocator_t *OS_ALLOCATOR_LOCAL = NULL;
+/** @brief Free blocks kept by the process */
+static struct os_allocator_cache OS_ALLOCATOR_CACHE;
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Allocates aligned memory from the thread caching allocator
+ *
+ * @param[in]      alignment           alignment, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_cache_aligned_alloc( size_t alignment,
+	size_t size, void *user_data );
+
+/**
+ * @brief Allocates a new block from the system allocator, with its header
+ *
+ * @param[in]      size                size of the block
+ * @param[in]      size_class          size class of the block
+ * @param[in]      alignment           alignment of the block, a power of 2
+ *                                     (0 = alignment of the system allocator)
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the block
+ */
+static void *os_allocator_cache_block(
+	size_t size,
+	os_uint32_t size_class,
+	size_t alignment );
+
+/**
+ * @brief Allocates zeroed memory from the thread caching allocator
+ *
+ * @param[in]      nmemb               number of elements
+ * @param[in]      size                size of each element in bytes
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_cache_calloc( size_t nmemb, size_t size,
+	void *user_data );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Returns the free blocks of a thread's cache to the system allocator
+ *
+ * @param[in,out]  cache               cache to empty
+ */
+static void OS_THREAD_LINK os_allocator_cache_flush( void *cache );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Frees memory to the thread caching allocator
+ *
+ * @param[in]      ptr                 memory to free
+ * @param[in]      user_data           not used
+ */
+static void os_allocator_cache_free( void *ptr, void *user_data );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Creates the key used to empty the thread caches
+ *
+ * @param[in]      arg                 not used
+ */
+static void os_allocator_cache_key_create( void *arg );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Allocates memory from the thread caching allocator
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_cache_malloc( size_t size, void *user_data );
+
+/**
+ * @brief Changes the size of memory from the thread caching allocator
+ *
+ * @param[in]      ptr                 previously allocated memory (optional)
+ * @param[in]      size                new size of the memory
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_cache_realloc( void *ptr, size_t size,
+	void *user_data );
+
+/**
+ * @brief Checks that an allocator provides all of its functions
+ *
+ * @param[in]      allocator           allocator to check
+ *
+ * @retval OS_FALSE                    a function is missing
+ * @retval OS_TRUE                     all functions are provided
+ */
+static os_bool_t os_allocator_complete( const os_allocator_t *allocator );
+
+/**
+ * @brief Default minimum size of each chunk of an arena
+ */
+#define OS_ARENA_CHUNK_SIZE            4096u
+
+/**
+ * @brief Alignment of the memory returned by os_arena_alloc, suitable for
+ *        any type
+ */
+#define OS_ARENA_ALIGNMENT             16u
+
+/**
+ * @brief Size reserved before each block allocated through an arena's
+ *        allocator, for its header
+ */
+#define OS_ARENA_HEADER_SIZE           OS_ARENA_ALIGNMENT
+
+/**
+ * @brief Chunk of memory owned by an arena, followed by its memory
+ */
+struct os_arena_chunk
+{
+	/** @brief Previous chunk of the arena */
+	struct os_arena_chunk *prev;
+	/** @brief End of the chunk */
+	char *end;
+};
+
+/**
+ * @brief Allocates aligned memory through an arena's allocator
+ *
+ * @param[in]      alignment           alignment, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ * @param[in,out]  user_data           arena to allocate from
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_arena_allocator_aligned_alloc( size_t alignment, size_t size,
+	void *user_data );
+
+/**
+ * @brief Allocates zeroed memory through an arena's allocator
+ *
+ * @param[in]      nmemb               number of elements
+ * @param[in]      size                size of each element in bytes
+ * @param[in,out]  user_data           arena to allocate from
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_arena_allocator_calloc( size_t nmemb, size_t size,
+	void *user_data );
+
+/**
+ * @brief Frees memory through an arena's allocator, giving it back only if
+ *        it is the arena's most recent allocation
+ *
+ * @param[in]      ptr                 memory to free
+ * @param[in,out]  user_data           arena the memory is from
+ */
+static void os_arena_allocator_free( void *ptr, void *user_data );
+
+/**
+ * @brief Allocates memory through an arena's allocator
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in,out]  user_data           arena to allocate from
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_arena_allocator_malloc( size_t size, void *user_data );
+
+/**
+ * @brief Changes the size of memory from an arena's allocator, in place if
+ *        it is the arena's most recent allocation
+ *
+ * @param[in]      ptr                 previously allocated memory (optional)
+ * @param[in]      size                new size of the memory
+ * @param[in,out]  user_data           arena the memory is from
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_arena_allocator_realloc( void *ptr, size_t size,
+	void *user_data );
+
+/**
+ * @brief Frees the most recent chunks of an arena, down to a given chunk
+ *
+ * @param[in,out]  arena               arena to free the chunks of
+ * @param[in]      chunk               chunk to keep (NULL = free all chunks)
+ */
+static void os_arena_release( os_arena_t *arena,
+	struct os_arena_chunk *chunk );
+
+/**
+ * @brief Default alignment of each object of a pool, suitable for any type
+ */
+#define OS_POOL_ALIGNMENT              16u
+
+/**
+ * @brief Number of objects moved at once between a thread's cache and the
+ *        objects shared by all threads
+ */
+#define OS_POOL_BATCH                  32u
+
+/**
+ * @brief Default number of objects carved from each block of a pool
+ */
+#define OS_POOL_BLOCK_OBJECTS          64u
+
+/**
+ * @brief Pattern written to objects when allocated, with OS_POOL_FLAG_POISON
+ */
+#define OS_POOL_POISON_ALLOC           0xCDu
+
+/**
+ * @brief Pattern written to objects when freed, with OS_POOL_FLAG_POISON
+ */
+#define OS_POOL_POISON_FREE            0xDDu
+
+/**
+ * @brief Free objects of a pool cached by a thread
+ */
+struct os_pool_cache
+{
+	/** @brief List of free objects, linked through their first bytes */
+	void *objects;
+	/** @brief Number of free objects in the list */
+	os_atomic_uint32_t count;
+	/** @brief Pool the objects belong to */
+	os_pool_t *pool;
+	/** @brief Next cache of the pool */
+	struct os_pool_cache *next;
+	/** @brief Previous cache of the pool */
+	struct os_pool_cache *prev;
+};
+
+/**
+ * @brief Returns the calling thread's cache of a pool, creating it if
+ *        required
+ *
+ * @param[in,out]  pool                pool to return the cache of
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   the calling thread's cache
+ */
+static struct os_pool_cache *os_pool_cache_get( os_pool_t *pool );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Returns the objects of a thread's cache to its pool and frees the
+ *        cache, when the thread exits
+ *
+ * @param[in,out]  cache               cache to release
+ */
+static void OS_THREAD_LINK os_pool_cache_release( void *cache );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Fills a thread's cache with the objects of a new block
+ *
+ * @param[in,out]  pool                pool to allocate the block for
+ * @param[in,out]  cache               cache to fill (empty)
+ *
+ * @retval OS_STATUS_NO_MEMORY         not enough memory available
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_pool_grow( os_pool_t *pool,
+	struct os_pool_cache *cache );
+
+/**
+ * @brief Records objects taken by a thread, updating the high watermark
+ *
+ * @param[in,out]  pool                pool the objects are from
+ * @param[in]      count               number of objects taken
+ */
+static void os_pool_held( os_pool_t *pool, os_uint32_t count );
+
+/**
+ * @brief Adds a list of objects to the objects shared by all threads
+ *
+ * @param[in,out]  pool                pool the objects belong to
+ * @param[in]      head                first object of the list
+ * @param[in]      tail                last object of the list
+ */
+static void os_pool_push( os_pool_t *pool, void *head, void *tail );
+
+/**
+ * @brief Fills a thread's cache from the objects shared by all threads, or
+ *        a new block if there are none
+ *
+ * @param[in,out]  pool                pool to refill the cache from
+ * @param[in,out]  cache               cache to fill (empty)
+ *
+ * @retval OS_STATUS_NO_MEMORY         not enough memory available
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_pool_refill( os_pool_t *pool,
+	struct os_pool_cache *cache );
+
+/**
+ * @brief Tag passed to os_memory_alloc to account the memory under the
+ *        calling thread's tag
+ */
+#define OS_MEMORY_TAG_CALLER           OS_MEMORY_TAG_MAX
+
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+/**
+ * @brief Size reserved before each allocation for its header, keeps the
+ *        alignment of the allocator
+ */
+#define OS_MEMORY_HEADER_SIZE          16u
+
+/**
+ * @brief Number of bytes a thread's count for a tag may change by before
+ *        it is added to the shared totals
+ */
+#define OS_MEMORY_FLUSH_BYTES          16384
+
+/**
+ * @brief Header stored before each accounted allocation
+ */
+struct os_memory_header
+{
+	/** @brief Size of the allocation */
+	size_t size;
+	/** @brief Tag the allocation is accounted under */
+	os_memory_tag_t tag;
+};
+
+/**
+ * @brief Memory counted by a thread, not yet added to the shared totals
+ */
+struct os_memory_counters
+{
+	/** @brief Change in the bytes allocated, for each tag */
+	os_atomic_uint64_t bytes[OS_MEMORY_TAG_MAX];
+	/** @brief Number of allocations made, for each tag */
+	os_atomic_uint64_t allocations[OS_MEMORY_TAG_MAX];
+	/** @brief Number of allocations freed, for each tag */
+	os_atomic_uint64_t frees[OS_MEMORY_TAG_MAX];
+	/** @brief Tag of the memory allocated by the thread */
+	os_memory_tag_t tag;
+	/** @brief Whether the counters are in the list of threads */
+	os_bool_t registered;
+	/** @brief Next thread's counters */
+	struct os_memory_counters *next;
+	/** @brief Previous thread's counters */
+	struct os_memory_counters *prev;
+};
+
+/**
+ * @brief Memory counted by all threads, added up from their counters
+ */
+struct os_memory_totals
+{
+	/** @brief Bytes allocated, for each tag then for all tags */
+	os_atomic_uint64_t bytes[OS_MEMORY_TAG_MAX + 1u];
+	/** @brief Highest bytes allocated, for each tag then for all tags */
+	os_atomic_uint64_t bytes_max[OS_MEMORY_TAG_MAX + 1u];
+	/** @brief Number of allocations made, for each tag */
+	os_atomic_uint64_t allocations[OS_MEMORY_TAG_MAX];
+	/** @brief Number of allocations freed, for each tag */
+	os_atomic_uint64_t frees[OS_MEMORY_TAG_MAX];
+};
+
+/** @brief Memory counted by all threads */
+static struct os_memory_totals OS_MEMORY_TOTALS;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/** @brief Memory counted by the calling thread */
+static OS_THREAD_LOCAL struct os_memory_counters OS_MEMORY_COUNTERS;
+/** @brief Key used to add a thread's counters to the totals when it exits */
+static os_thread_local_key_t OS_MEMORY_KEY;
+/** @brief Lock protecting the list of threads' counters */
+static os_thread_spinlock_t OS_MEMORY_LOCK;
+/** @brief Creation of the key used when threads exit */
+static os_thread_once_t OS_MEMORY_ONCE = OS_THREAD_ONCE_INIT;
+/** @brief Counters of the running threads */
+static struct os_memory_counters *OS_MEMORY_THREADS = NULL;
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+/** @brief Memory counted by the process */
+static struct os_memory_counters OS_MEMORY_COUNTERS;
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+#else /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+/**
+ * @brief Size reserved before each allocation for its header, none as
+ *        allocations are not accounted
+ */
+#define OS_MEMORY_HEADER_SIZE          0u
+#endif /* else if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+
+/**
+ * @brief Allocates memory from an allocator, accounted under a tag
+ *
+ * @param[in]      allocator           allocator to allocate from
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      tag                 tag to account the memory under
+ *                                     (OS_MEMORY_TAG_CALLER = caller's tag)
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_memory_alloc( const os_allocator_t *allocator, size_t size,
+	os_memory_tag_t tag );
+
+/**
+ * @brief Allocates aligned memory from an allocator, accounted under a tag
+ *
+ * The block allocated, including the header of the allocation, starts at
+ * the alignment requested.
+ *
+ * @param[in]      allocator           allocator to allocate from
+ * @param[in]      alignment           alignment of the block, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      tag                 tag to account the memory under
+ *                                     (OS_MEMORY_TAG_CALLER = caller's tag)
+ *
+ * @retval NULL    alignment not supported or not enough memory available
+ * @retval !NULL   a pointer to the allocated memory, after the header
+ */
+static void *os_memory_alloc_aligned( const os_allocator_t *allocator,
+	size_t alignment, size_t size, os_memory_tag_t tag );
+
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+/**
+ * @brief Adds a thread's counts for a tag to the shared totals
+ *
+ * @param[in,out]  counters            thread's counters
+ * @param[in]      tag                 tag to add the counts of
+ */
+static void os_memory_flush( struct os_memory_counters *counters,
+	os_memory_tag_t tag );
+#endif /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+
+/**
+ * @brief Frees memory allocated by os_memory_alloc
+ *
+ * @param[in]      allocator           allocator the memory is from
+ * @param[in]      ptr                 memory to free
+ */
+static void os_memory_free( const os_allocator_t *allocator, void *ptr );
+
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Creates the key used to add a thread's counters to the totals when
+ *        it exits
+ *
+ * @param[in]      arg                 not used
+ */
+static void os_memory_key_create( void *arg );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Raises a highest value, if a value is higher
+ *
+ * @param[in,out]  max                 highest value
+ * @param[in]      value               value to compare with (signed)
+ */
+static void os_memory_max( os_atomic_uint64_t *max, os_uint64_t value );
+
+/**
+ * @brief Counts a change in the memory allocated by the calling thread
+ *
+ * @param[in]      tag                 tag the memory is accounted under
+ * @param[in]      bytes               change in bytes (2's complement)
+ * @param[in]      allocations         number of allocations made
+ * @param[in]      frees               number of allocations freed
+ */
+static void os_memory_record( os_memory_tag_t tag, os_uint64_t bytes,
+	os_uint64_t allocations, os_uint64_t frees );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Adds a thread's counters to the totals, when the thread exits
+ *
+ * @param[in,out]  counters            thread's counters
+ */
+static void OS_THREAD_LINK os_memory_release( void *counters );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+#endif /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+
+/** @brief Allocator keeping per-thread caches of small blocks */
+static const os_allocator_t OS_ALLOCATOR_THREAD_CACHE = {
+	os_allocator_cache_malloc,
+	os_allocator_cache_calloc,
+	os_allocator_cache_realloc,
+	os_allocator_cache_free,
+	os_allocator_cache_aligned_alloc,
+	NULL
+};
+
+void *os_allocator_cache_aligned_alloc(
+	size_t alignment,
+	size_t size,
+	void *UNUSED(user_data) )
+{
+	void *result = NULL;
+	if ( alignment <= sizeof( void * ) )
+		result = os_allocator_cache_malloc( size, NULL );
+	else if ( ( alignment & ( alignment - 1u ) ) == 0u )
+		result = os_allocator_cache_block( size,
+			OS_ALLOCATOR_CLASS_NONE, alignment );
+	return result;
+}
+
+void *os_allocator_cache_block(
+	size_t size,
+	os_uint32_t size_class,
+	size_t alignment )
+{
+	void *result = NULL;
+	const os_allocator_t *const system = os_allocator_system();
+	size_t extra = OS_ALLOCATOR_HEADER_SIZE;
+
+	if ( alignment > 0u )
+		extra += alignment;
+	if ( size <= (size_t)-1 - extra )
+	{
+		char *const start = (char *)system->malloc_fn( size + extra,
+			system->user_data );
+		if ( start )
+		{
+			struct os_allocator_header *header;
+			size_t offset = OS_ALLOCATOR_HEADER_SIZE;
+
+			if ( alignment > 0u )
+				offset += ( alignment - ( (size_t)start +
+					OS_ALLOCATOR_HEADER_SIZE ) % alignment ) %
+					alignment;
+			result = start + offset;
+			header = (struct os_allocator_header *)(void *)
+				( start + offset - OS_ALLOCATOR_HEADER_SIZE );
+			header->size = size;
+			header->size_class = size_class;
+			header->offset = (os_uint32_t)offset;
+		}
+	}
+	return result;
+}
+
+void *os_allocator_cache_calloc(
+	size_t nmemb,
+	size_t size,
+	void *UNUSED(user_data) )
+{
+	void *result = NULL;
+	if ( size == 0u || nmemb <= (size_t)-1 / size )
+	{
+		result = os_allocator_cache_malloc( nmemb * size, NULL );
+		if ( result )
+			os_memzero( result, nmemb * size );
+	}
+	return result;
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_allocator_cache_flush(
+	void *cache )
+{
+	struct os_allocator_cache *const c =
+		(struct os_allocator_cache *)cache;
+	const os_allocator_t *const system = os_allocator_system();
+	unsigned int i;
+
+	for ( i = 0u; i < OS_ALLOCATOR_CLASSES; ++i )
+	{
+		while ( c->blocks[i] )
+		{
+			char *const block = (char *)c->blocks[i];
+			c->blocks[i] = *(void **)c->blocks[i];
+			system->free_fn( block - OS_ALLOCATOR_HEADER_SIZE,
+				system->user_data );
+		}
+		c->count[i] = 0u;
+	}
+	/* blocks freed later by the exiting thread register it again */
+	c->registered = OS_FALSE;
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+void os_allocator_cache_free(
+	void *ptr,
+	void *UNUSED(user_data) )
+{
+	const struct os_allocator_header *const header =
+		(const struct os_allocator_header *)(void *)
+		( (char *)ptr - OS_ALLOCATOR_HEADER_SIZE );
+	struct os_allocator_cache *const cache = &OS_ALLOCATOR_CACHE;
+	const os_uint32_t size_class = header->size_class;
+
+	if ( size_class < OS_ALLOCATOR_CLASSES &&
+		cache->count[size_class] < OS_ALLOCATOR_CACHE_MAX )
+	{
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		if ( cache->registered == OS_FALSE )
+		{
+			os_thread_once( &OS_ALLOCATOR_CACHE_ONCE,
+				os_allocator_cache_key_create, NULL );
+			if ( os_thread_local_key_set( &OS_ALLOCATOR_CACHE_KEY,
+				cache ) == OS_STATUS_SUCCESS )
+				cache->registered = OS_TRUE;
+		}
+		if ( cache->registered != OS_FALSE )
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		{
+			*(void **)ptr = cache->blocks[size_class];
+			cache->blocks[size_class] = ptr;
+			++cache->count[size_class];
+			ptr = NULL;
+		}
+	}
+	if ( ptr )
+	{
+		const os_allocator_t *const system = os_allocator_system();
+		system->free_fn( (char *)ptr - header->offset,
+			system->user_data );
+	}
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_allocator_cache_key_create(
+	void *UNUSED(arg) )
+{
+	os_thread_local_key_create( &OS_ALLOCATOR_CACHE_KEY,
+		os_allocator_cache_flush );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+void *os_allocator_cache_malloc(
+	size_t size,
+	void *UNUSED(user_data) )
+{
+	void *result = NULL;
+	os_uint32_t size_class = 0u;
+
+	while ( size_class < OS_ALLOCATOR_CLASSES &&
+		size > ( (size_t)1u << ( OS_ALLOCATOR_CLASS_SHIFT +
+			size_class ) ) )
+		++size_class;
+	if ( size_class < OS_ALLOCATOR_CLASSES )
+	{
+		struct os_allocator_cache *const cache = &OS_ALLOCATOR_CACHE;
+		result = cache->blocks[size_class];
+		if ( result )
+		{
+			cache->blocks[size_class] = *(void **)result;
+			--cache->count[size_class];
+		}
+		else
+			result = os_allocator_cache_block( (size_t)1u <<
+				( OS_ALLOCATOR_CLASS_SHIFT + size_class ),
+				size_class, 0u );
+	}
+	else
+		result = os_allocator_cache_block( size,
+			OS_ALLOCATOR_CLASS_NONE, 0u );
+	return result;
+}
+
+void *os_allocator_cache_realloc(
+	void *ptr,
+	size_t size,
+	void *UNUSED(user_data) )
+{
+	void *result = NULL;
+	if ( ptr == NULL )
+		result = os_allocator_cache_malloc( size, NULL );
+	else
+	{
+		struct os_allocator_header *const header =
+			(struct os_allocator_header *)(void *)
+			( (char *)ptr - OS_ALLOCATOR_HEADER_SIZE );
+		if ( size <= header->size )
+			result = ptr;
+		else
+		{
+			/* the contents are moved to a larger block */
+			result = os_allocator_cache_malloc( size, NULL );
+			if ( result )
+			{
+				os_memcpy( result, ptr, header->size );
+				os_allocator_cache_free( ptr, NULL );
+			}
+		}
+	}
+	return result;
+}
+
+os_bool_t os_allocator_complete(
+	const os_allocator_t *allocator )
+{
+	os_bool_t result = OS_FALSE;
+	if ( allocator->malloc_fn && allocator->calloc_fn &&
+		allocator->realloc_fn && allocator->free_fn &&
+		allocator->aligned_alloc_fn )
+		result = OS_TRUE;
+	return result;
+}
+
+const os_allocator_t *os_allocator_get( void )
+{
+	const os_allocator_t *result = OS_ALLOCATOR_LOCAL;
+	if ( result == NULL )
+		result = OS_ALLOCATOR;
+	if ( result == NULL )
+		result = os_allocator_system();
+	return result;
+}
+
+os_status_t os_allocator_set(
+	const os_allocator_t *allocator )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( allocator == NULL || os_allocator_complete( allocator ) )
+	{
+		OS_ALLOCATOR = allocator;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+const os_allocator_t *os_allocator_thread_cache( void )
+{
+	return &OS_ALLOCATOR_THREAD_CACHE;
+}
+
+os_status_t os_allocator_thread_set(
+	const os_allocator_t *allocator,
+	const os_allocator_t **previous )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( allocator == NULL || os_allocator_complete( allocator ) )
+	{
+		if ( previous )
+			*previous = OS_ALLOCATOR_LOCAL;
+		OS_ALLOCATOR_LOCAL = allocator;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void *os_arena_alloc(
+	os_arena_t *arena,
+	size_t size )
+{
+	return os_arena_alloc_aligned( arena, OS_ARENA_ALIGNMENT, size );
+}
+
+void *os_arena_alloc_aligned(
+	os_arena_t *arena,
+	size_t alignment,
+	size_t size )
+{
+	void *result = NULL;
+	if ( arena && alignment > 0u &&
+		( alignment & ( alignment - 1u ) ) == 0u )
+	{
+		size_t padding = 0u;
+		if ( arena->position )
+			padding = ( 0u - (size_t)arena->position ) &
+				( alignment - 1u );
+		if ( arena->position &&
+			padding <= (size_t)( arena->end - arena->position ) &&
+			size <= (size_t)( arena->end - arena->position ) -
+				padding )
+		{
+			result = arena->position + padding;
+			arena->position += padding + size;
+		}
+		else if ( size <= (size_t)-1 - alignment -
+			sizeof( struct os_arena_chunk ) )
+		{
+			/* the rest of the current chunk is left unused */
+			size_t chunk_size = sizeof( struct os_arena_chunk ) +
+				alignment - 1u + size;
+			struct os_arena_chunk *chunk;
+
+			if ( chunk_size < arena->chunk_size )
+				chunk_size = arena->chunk_size;
+			chunk = (struct os_arena_chunk *)os_memory_alloc(
+				arena->allocator, chunk_size,
+				OS_MEMORY_TAG_CALLER );
+			if ( chunk )
+			{
+				char *const start = (char *)( chunk + 1 );
+				chunk->prev = arena->chunk;
+				chunk->end = (char *)chunk + chunk_size;
+				padding = ( 0u - (size_t)start ) &
+					( alignment - 1u );
+				result = start + padding;
+				arena->chunk = chunk;
+				arena->position = start + padding + size;
+				arena->end = chunk->end;
+			}
+		}
+	}
+	return result;
+}
+
+os_status_t os_arena_allocator(
+	os_arena_t *arena,
+	os_allocator_t *allocator )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena && allocator )
+	{
+		allocator->malloc_fn = os_arena_allocator_malloc;
+		allocator->calloc_fn = os_arena_allocator_calloc;
+		allocator->realloc_fn = os_arena_allocator_realloc;
+		allocator->free_fn = os_arena_allocator_free;
+		allocator->aligned_alloc_fn = os_arena_allocator_aligned_alloc;
+		allocator->user_data = arena;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void *os_arena_allocator_aligned_alloc(
+	size_t alignment,
+	size_t size,
+	void *user_data )
+{
+	void *result = NULL;
+	if ( alignment < OS_ARENA_HEADER_SIZE )
+		alignment = OS_ARENA_HEADER_SIZE;
+	/* the header is stored just before the memory returned */
+	if ( size <= (size_t)-1 - alignment )
+	{
+		char *const start = (char *)os_arena_alloc_aligned(
+			(os_arena_t *)user_data, alignment, alignment + size );
+		if ( start )
+		{
+			result = start + alignment;
+			*(size_t *)(void *)( start + alignment -
+				OS_ARENA_HEADER_SIZE ) = size;
+		}
+	}
+	return result;
+}
+
+void *os_arena_allocator_calloc(
+	size_t nmemb,
+	size_t size,
+	void *user_data )
+{
+	void *result = NULL;
+	if ( size == 0u || nmemb <= (size_t)-1 / size )
+	{
+		result = os_arena_allocator_malloc( nmemb * size, user_data );
+		if ( result )
+			os_memzero( result, nmemb * size );
+	}
+	return result;
+}
+
+void os_arena_allocator_free(
+	void *ptr,
+	void *user_data )
+{
+	os_arena_t *const arena = (os_arena_t *)user_data;
+	char *const start = (char *)ptr;
+	const size_t size = *(size_t *)(void *)
+		( start - OS_ARENA_HEADER_SIZE );
+	if ( start + size == arena->position )
+		arena->position = start - OS_ARENA_HEADER_SIZE;
+}
+
+void *os_arena_allocator_malloc(
+	size_t size,
+	void *user_data )
+{
+	return os_arena_allocator_aligned_alloc( OS_ARENA_ALIGNMENT, size,
+		user_data );
+}
+
+void *os_arena_allocator_realloc(
+	void *ptr,
+	size_t size,
+	void *user_data )
+{
+	void *result = NULL;
+	if ( ptr == NULL )
+		result = os_arena_allocator_malloc( size, user_data );
+	else
+	{
+		os_arena_t *const arena = (os_arena_t *)user_data;
+		char *const start = (char *)ptr;
+		size_t *const old_size = (size_t *)(void *)
+			( start - OS_ARENA_HEADER_SIZE );
+		const os_bool_t last = ( start + *old_size == arena->position );
+
+		if ( size <= *old_size ||
+			( last && size <= (size_t)( arena->end - start ) ) )
+		{
+			/* most recent allocation grows or shrinks in place */
+			if ( last )
+				arena->position = start + size;
+			*old_size = size;
+			result = ptr;
+		}
+		else
+		{
+			result = os_arena_allocator_malloc( size, user_data );
+			if ( result )
+				os_memcpy( result, ptr, *old_size );
+		}
+	}
+	return result;
+}
+
+os_status_t os_arena_checkpoint(
+	const os_arena_t *arena,
+	os_arena_checkpoint_t *checkpoint )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena && checkpoint )
+	{
+		checkpoint->chunk = arena->chunk;
+		checkpoint->position = arena->position;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_arena_create(
+	os_arena_t *arena,
+	size_t chunk_size )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena )
+	{
+		if ( chunk_size == 0u )
+			chunk_size = OS_ARENA_CHUNK_SIZE;
+		os_memzero( arena, sizeof( os_arena_t ) );
+		arena->chunk_size = chunk_size;
+		arena->allocator = os_allocator_get();
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_arena_destroy(
+	os_arena_t *arena )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena )
+	{
+		os_arena_release( arena, NULL );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_arena_release(
+	os_arena_t *arena,
+	struct os_arena_chunk *chunk )
+{
+	while ( arena->chunk != chunk )
+	{
+		struct os_arena_chunk *const prev = arena->chunk->prev;
+		os_memory_free( arena->allocator, arena->chunk );
+		arena->chunk = prev;
+	}
+	arena->position = NULL;
+	arena->end = NULL;
+	if ( chunk )
+	{
+		arena->position = (char *)( chunk + 1 );
+		arena->end = chunk->end;
+	}
+}
+
+os_status_t os_arena_reset(
+	os_arena_t *arena )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena )
+	{
+		if ( arena->chunk && arena->chunk->prev )
+		{
+			/* replaced by a single chunk holding as much */
+			size_t size = 0u;
+			struct os_arena_chunk *chunk;
+			for ( chunk = arena->chunk; chunk; chunk = chunk->prev )
+				size += (size_t)( chunk->end - (char *)chunk );
+			os_arena_release( arena, NULL );
+			chunk = (struct os_arena_chunk *)os_memory_alloc(
+				arena->allocator, size, OS_MEMORY_TAG_CALLER );
+			if ( chunk )
+			{
+				chunk->prev = NULL;
+				chunk->end = (char *)chunk + size;
+				arena->chunk = chunk;
+			}
+		}
+		os_arena_release( arena, arena->chunk );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_arena_rewind(
+	os_arena_t *arena,
+	const os_arena_checkpoint_t *checkpoint )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( arena && checkpoint )
+	{
+		struct os_arena_chunk *chunk = arena->chunk;
+		while ( chunk && chunk != checkpoint->chunk )
+			chunk = chunk->prev;
+		if ( chunk == checkpoint->chunk )
+		{
+			os_arena_release( arena, chunk );
+			if ( chunk )
+				arena->position = checkpoint->position;
+			result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+void *os_calloc(
+	size_t nmemb,
+	size_t size )
+{
+	const os_allocator_t *const allocator = os_allocator_get();
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+	void *result = NULL;
+	if ( size == 0u ||
+		nmemb <= ( (size_t)-1 - OS_MEMORY_HEADER_SIZE ) / size )
+	{
+		struct os_memory_header *const header =
+			(struct os_memory_header *)allocator->calloc_fn( 1u,
+				nmemb * size + OS_MEMORY_HEADER_SIZE,
+				allocator->user_data );
+		if ( header )
+		{
+			header->size = nmemb * size;
+			header->tag = OS_MEMORY_COUNTERS.tag;
+			os_memory_record( header->tag, header->size, 1u, 0u );
+			result = (char *)header + OS_MEMORY_HEADER_SIZE;
+		}
+	}
+	return result;
+#else /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+	return allocator->calloc_fn( nmemb, size, allocator->user_data );
+#endif /* else if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+}
+
+void os_free(
+	void *ptr )
+{
+	if ( ptr )
+		os_memory_free( os_allocator_get(), ptr );
+}
+
+void os_free_aligned(
+	void *ptr )
+{
+	/* address of the memory allocated is kept just before it */
+	if ( ptr )
+		os_memory_free( os_allocator_get(), *( (void **)ptr - 1 ) );
+}
+
+void os_free_null(
+	void **ptr )
+{
+	if ( ptr && *ptr )
+	{
+		os_free( *ptr );
+		*ptr = NULL;
+	}
+}
+
+void *os_malloc(
+	size_t size )
+{
+	return os_memory_alloc( os_allocator_get(), size,
+		OS_MEMORY_TAG_CALLER );
+}
+
+void *os_malloc_aligned(
+	size_t alignment,
+	size_t size )
+{
+	void *result = NULL;
+	if ( alignment > 0u && ( alignment & ( alignment - 1u ) ) == 0u )
+	{
+		size_t offset;
+		/* the address to free is kept just before the memory, so the
+		 * block is aligned for it, and the memory follows at the first
+		 * aligned position after the header and that address */
+		if ( alignment < sizeof( void * ) )
+			alignment = sizeof( void * );
+		offset = ( OS_MEMORY_HEADER_SIZE + sizeof( void * ) +
+			alignment - 1u ) & ~( alignment - 1u );
+		if ( size <= (size_t)-1 - offset )
+		{
+			char *const start = (char *)os_memory_alloc_aligned(
+				os_allocator_get(), alignment,
+				size + offset - OS_MEMORY_HEADER_SIZE,
+				OS_MEMORY_TAG_CALLER );
+			if ( start )
+			{
+				result = start + offset - OS_MEMORY_HEADER_SIZE;
+				*( (void **)result - 1 ) = start;
+			}
+		}
+	}
+	return result;
+}
+
+void *os_malloc_tagged(
+	size_t size,
+	os_memory_tag_t tag )
+{
+	return os_memory_alloc( os_allocator_get(), size, tag );
+}
+
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+void *os_memory_alloc(
+	const os_allocator_t *allocator,
+	size_t size,
+	os_memory_tag_t tag )
+{
+	void *result = NULL;
+	if ( tag == OS_MEMORY_TAG_CALLER )
+		tag = OS_MEMORY_COUNTERS.tag;
+	if ( tag >= OS_MEMORY_TAG_MAX )
+		tag = OS_MEMORY_TAG_DEFAULT;
+	if ( size <= (size_t)-1 - OS_MEMORY_HEADER_SIZE )
+	{
+		struct os_memory_header *const header =
+			(struct os_memory_header *)allocator->malloc_fn(
+				size + OS_MEMORY_HEADER_SIZE,
+				allocator->user_data );
+		if ( header )
+		{
+			header->size = size;
+			header->tag = tag;
+			os_memory_record( tag, size, 1u, 0u );
+			result = (char *)header + OS_MEMORY_HEADER_SIZE;
+		}
+	}
+	return result;
+}
+
+void *os_memory_alloc_aligned(
+	const os_allocator_t *allocator,
+	size_t alignment,
+	size_t size,
+	os_memory_tag_t tag )
+{
+	void *result = NULL;
+	if ( tag == OS_MEMORY_TAG_CALLER )
+		tag = OS_MEMORY_COUNTERS.tag;
+	if ( tag >= OS_MEMORY_TAG_MAX )
+		tag = OS_MEMORY_TAG_DEFAULT;
+	if ( size <= (size_t)-1 - OS_MEMORY_HEADER_SIZE )
+	{
+		struct os_memory_header *const header =
+			(struct os_memory_header *)allocator->aligned_alloc_fn(
+				alignment, size + OS_MEMORY_HEADER_SIZE,
+				allocator->user_data );
+		if ( header )
+		{
+			header->size = size;
+			header->tag = tag;
+			os_memory_record( tag, size, 1u, 0u );
+			result = (char *)header + OS_MEMORY_HEADER_SIZE;
+		}
+	}
+	return result;
+}
+
+void os_memory_flush(
+	struct os_memory_counters *counters,
+	os_memory_tag_t tag )
+{
+	const os_uint64_t bytes = counters->bytes[tag];
+	const os_uint64_t allocations = counters->allocations[tag];
+	const os_uint64_t frees = counters->frees[tag];
+
+	os_atomic_store_u64( &counters->bytes[tag], 0u, OS_ATOMIC_RELAXED );
+	os_atomic_store_u64( &counters->allocations[tag], 0u,
+		OS_ATOMIC_RELAXED );
+	os_atomic_store_u64( &counters->frees[tag], 0u, OS_ATOMIC_RELAXED );
+	os_atomic_fetch_add_u64( &OS_MEMORY_TOTALS.allocations[tag],
+		allocations, OS_ATOMIC_RELAXED );
+	os_atomic_fetch_add_u64( &OS_MEMORY_TOTALS.frees[tag], frees,
+		OS_ATOMIC_RELAXED );
+	os_memory_max( &OS_MEMORY_TOTALS.bytes_max[tag],
+		os_atomic_fetch_add_u64( &OS_MEMORY_TOTALS.bytes[tag], bytes,
+			OS_ATOMIC_RELAXED ) + bytes );
+	os_memory_max( &OS_MEMORY_TOTALS.bytes_max[OS_MEMORY_TAG_MAX],
+		os_atomic_fetch_add_u64(
+			&OS_MEMORY_TOTALS.bytes[OS_MEMORY_TAG_MAX], bytes,
+			OS_ATOMIC_RELAXED ) + bytes );
+}
+
+void os_memory_free(
+	const os_allocator_t *allocator,
+	void *ptr )
+{
+	struct os_memory_header *const header = (struct os_memory_header *)
+		(void *)( (char *)ptr - OS_MEMORY_HEADER_SIZE );
+	os_memory_record( header->tag, (os_uint64_t)0u - header->size, 0u,
+		1u );
+	allocator->free_fn( header, allocator->user_data );
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_memory_key_create(
+	void *UNUSED(arg) )
+{
+	os_thread_local_key_create( &OS_MEMORY_KEY, os_memory_release );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+void os_memory_max(
+	os_atomic_uint64_t *max,
+	os_uint64_t value )
+{
+	os_uint64_t current = os_atomic_load_u64( max, OS_ATOMIC_RELAXED );
+	/* totals can briefly be negative, when memory is freed by another
+	 * thread than the one that allocated it */
+	while ( (os_int64_t)value > (os_int64_t)current &&
+		!os_atomic_cas_u64( max, &current, value, OS_ATOMIC_RELAXED ) ) {}
+}
+
+void os_memory_record(
+	os_memory_tag_t tag,
+	os_uint64_t bytes,
+	os_uint64_t allocations,
+	os_uint64_t frees )
+{
+	struct os_memory_counters *const counters = &OS_MEMORY_COUNTERS;
+	os_int64_t pending;
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	if ( counters->registered == OS_FALSE )
+	{
+		os_thread_once( &OS_MEMORY_ONCE, os_memory_key_create, NULL );
+		os_thread_spinlock_lock( &OS_MEMORY_LOCK );
+		counters->prev = NULL;
+		counters->next = OS_MEMORY_THREADS;
+		if ( OS_MEMORY_THREADS )
+			OS_MEMORY_THREADS->prev = counters;
+		OS_MEMORY_THREADS = counters;
+		counters->registered = OS_TRUE;
+		os_thread_spinlock_unlock( &OS_MEMORY_LOCK );
+		os_thread_local_key_set( &OS_MEMORY_KEY, counters );
+	}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+	/* only the owning thread writes, others read for a snapshot */
+	pending = (os_int64_t)( counters->bytes[tag] + bytes );
+	os_atomic_store_u64( &counters->bytes[tag], (os_uint64_t)pending,
+		OS_ATOMIC_RELAXED );
+	os_atomic_store_u64( &counters->allocations[tag],
+		counters->allocations[tag] + allocations, OS_ATOMIC_RELAXED );
+	os_atomic_store_u64( &counters->frees[tag],
+		counters->frees[tag] + frees, OS_ATOMIC_RELAXED );
+	if ( pending > OS_MEMORY_FLUSH_BYTES ||
+		pending < -OS_MEMORY_FLUSH_BYTES )
+		os_memory_flush( counters, tag );
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_memory_release(
+	void *counters )
+{
+	struct os_memory_counters *const c =
+		(struct os_memory_counters *)counters;
+	os_memory_tag_t tag;
+
+	for ( tag = 0u; tag < OS_MEMORY_TAG_MAX; ++tag )
+		os_memory_flush( c, tag );
+	os_thread_spinlock_lock( &OS_MEMORY_LOCK );
+	if ( c->prev )
+		c->prev->next = c->next;
+	else
+		OS_MEMORY_THREADS = c->next;
+	if ( c->next )
+		c->next->prev = c->prev;
+	/* memory freed later by the exiting thread registers it again */
+	c->registered = OS_FALSE;
+	os_thread_spinlock_unlock( &OS_MEMORY_LOCK );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+os_status_t os_memory_stats(
+	os_memory_stats_t *stats )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stats )
+	{
+		os_memory_tag_t tag;
+		os_memzero( stats, sizeof( os_memory_stats_t ) );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_spinlock_lock( &OS_MEMORY_LOCK );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		for ( tag = 0u; tag < OS_MEMORY_TAG_MAX; ++tag )
+		{
+			os_memory_tag_stats_t *const s = &stats->tags[tag];
+			const struct os_memory_counters *counters;
+			os_uint64_t bytes = os_atomic_load_u64(
+				&OS_MEMORY_TOTALS.bytes[tag], OS_ATOMIC_RELAXED );
+			os_uint64_t frees = os_atomic_load_u64(
+				&OS_MEMORY_TOTALS.frees[tag], OS_ATOMIC_RELAXED );
+
+			s->allocations = os_atomic_load_u64(
+				&OS_MEMORY_TOTALS.allocations[tag],
+				OS_ATOMIC_RELAXED );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			for ( counters = OS_MEMORY_THREADS; counters;
+				counters = counters->next )
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+			counters = &OS_MEMORY_COUNTERS;
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+			{
+				bytes += os_atomic_load_u64(
+					&counters->bytes[tag],
+					OS_ATOMIC_RELAXED );
+				s->allocations += os_atomic_load_u64(
+					&counters->allocations[tag],
+					OS_ATOMIC_RELAXED );
+				frees += os_atomic_load_u64(
+					&counters->frees[tag],
+					OS_ATOMIC_RELAXED );
+			}
+
+			/* counts of other threads may be changing */
+			if ( (os_int64_t)bytes > 0 )
+				s->bytes = bytes;
+			if ( s->allocations > frees )
+				s->count = s->allocations - frees;
+			os_memory_max( &OS_MEMORY_TOTALS.bytes_max[tag],
+				s->bytes );
+			s->bytes_max = os_atomic_load_u64(
+				&OS_MEMORY_TOTALS.bytes_max[tag],
+				OS_ATOMIC_RELAXED );
+
+			stats->total.bytes += s->bytes;
+			stats->total.count += s->count;
+			stats->total.allocations += s->allocations;
+		}
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_spinlock_unlock( &OS_MEMORY_LOCK );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		os_memory_max( &OS_MEMORY_TOTALS.bytes_max[OS_MEMORY_TAG_MAX],
+			stats->total.bytes );
+		stats->total.bytes_max = os_atomic_load_u64(
+			&OS_MEMORY_TOTALS.bytes_max[OS_MEMORY_TAG_MAX],
+			OS_ATOMIC_RELAXED );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_memory_tag_t os_memory_tag_set(
+	os_memory_tag_t tag )
+{
+	const os_memory_tag_t result = OS_MEMORY_COUNTERS.tag;
+	if ( tag < OS_MEMORY_TAG_MAX )
+		OS_MEMORY_COUNTERS.tag = tag;
+	return result;
+}
+#else /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+void *os_memory_alloc(
+	const os_allocator_t *allocator,
+	size_t size,
+	os_memory_tag_t UNUSED(tag) )
+{
+	return allocator->malloc_fn( size, allocator->user_data );
+}
+
+void *os_memory_alloc_aligned(
+	const os_allocator_t *allocator,
+	size_t alignment,
+	size_t size,
+	os_memory_tag_t UNUSED(tag) )
+{
+	return allocator->aligned_alloc_fn( alignment, size,
+		allocator->user_data );
+}
+
+void os_memory_free(
+	const os_allocator_t *allocator,
+	void *ptr )
+{
+	allocator->free_fn( ptr, allocator->user_data );
+}
+
+os_status_t os_memory_stats(
+	os_memory_stats_t *stats )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stats )
+		result = OS_STATUS_NOT_SUPPORTED;
+	return result;
+}
+
+os_memory_tag_t os_memory_tag_set(
+	os_memory_tag_t UNUSED(tag) )
+{
+	return OS_MEMORY_TAG_DEFAULT;
+}
+#endif /* else if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+
+void *os_pool_alloc(
+	os_pool_t *pool )
+{
+	void *result = NULL;
+	if ( pool )
+	{
+		struct os_pool_cache *const cache = os_pool_cache_get( pool );
+		if ( cache && ( cache->objects ||
+			os_pool_refill( pool, cache ) == OS_STATUS_SUCCESS ) )
+		{
+			result = cache->objects;
+			cache->objects = *(void **)result;
+			os_atomic_store_u32( &cache->count, cache->count - 1u,
+				OS_ATOMIC_RELAXED );
+			if ( pool->flags & OS_POOL_FLAG_POISON )
+			{
+				const unsigned char *p = (const unsigned char *)
+					result + sizeof( void * );
+				const unsigned char *const end =
+					(const unsigned char *)result +
+					pool->object_size;
+				while ( p < end && *p == OS_POOL_POISON_FREE )
+					++p;
+				if ( p < end )
+					os_atomic_fetch_add_u32(
+						&pool->poison_errors, 1u,
+						OS_ATOMIC_RELAXED );
+				os_memset( result, OS_POOL_POISON_ALLOC,
+					pool->object_size );
+			}
+		}
+	}
+	return result;
+}
+
+struct os_pool_cache *os_pool_cache_get(
+	os_pool_t *pool )
+{
+	struct os_pool_cache *result;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	result = (struct os_pool_cache *)os_thread_local_key_get(
+		&pool->key );
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	result = pool->caches;
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	if ( result == NULL )
+	{
+		result = (struct os_pool_cache *)os_memory_alloc(
+			pool->allocator, sizeof( struct os_pool_cache ),
+			OS_MEMORY_TAG_CALLER );
+		if ( result )
+		{
+			os_memzero( result, sizeof( struct os_pool_cache ) );
+			result->pool = pool;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			os_thread_mutex_lock( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+			result->next = pool->caches;
+			if ( pool->caches )
+				pool->caches->prev = result;
+			pool->caches = result;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			os_thread_mutex_unlock( &pool->lock );
+			if ( os_thread_local_key_set( &pool->key, result ) !=
+				OS_STATUS_SUCCESS )
+			{
+				os_pool_cache_release( result );
+				result = NULL;
+			}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		}
+	}
+	return result;
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_pool_cache_release(
+	void *cache )
+{
+	struct os_pool_cache *const c = (struct os_pool_cache *)cache;
+	os_pool_t *const pool = c->pool;
+
+	if ( c->objects )
+	{
+		void *tail = c->objects;
+		while ( *(void **)tail )
+			tail = *(void **)tail;
+		os_pool_push( pool, c->objects, tail );
+		os_atomic_fetch_add_u32( &pool->held,
+			(os_uint32_t)0u - c->count, OS_ATOMIC_RELAXED );
+	}
+
+	os_thread_mutex_lock( &pool->lock );
+	if ( c->prev )
+		c->prev->next = c->next;
+	else
+		pool->caches = c->next;
+	if ( c->next )
+		c->next->prev = c->prev;
+	os_thread_mutex_unlock( &pool->lock );
+	os_memory_free( pool->allocator, c );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+os_status_t os_pool_create(
+	os_pool_t *pool,
+	size_t object_size,
+	size_t block_objects,
+	unsigned int flags )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	size_t alignment = OS_POOL_ALIGNMENT;
+
+	if ( flags & OS_POOL_FLAG_CACHE_ALIGN )
+		alignment = OS_CACHE_LINE_SIZE;
+	if ( block_objects == 0u )
+		block_objects = OS_POOL_BLOCK_OBJECTS;
+	if ( object_size < sizeof( void * ) )
+		object_size = sizeof( void * );
+	if ( pool && object_size <= (size_t)-1 - alignment )
+	{
+		/* each object starts on the alignment */
+		object_size = ( object_size + alignment - 1u ) &
+			~(size_t)( alignment - 1u );
+		if ( block_objects <= ( (size_t)-1 - alignment -
+			sizeof( void * ) ) / object_size &&
+			block_objects <= (os_uint32_t)-1 )
+		{
+			os_memzero( pool, sizeof( os_pool_t ) );
+			pool->allocator = os_allocator_get();
+			pool->object_size = object_size;
+			pool->alignment = alignment;
+			pool->block_objects = block_objects;
+			pool->flags = flags;
+			result = OS_STATUS_SUCCESS;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			if ( os_thread_mutex_create( &pool->lock ) !=
+				OS_STATUS_SUCCESS )
+				result = OS_STATUS_FAILURE;
+			else if ( os_thread_local_key_create( &pool->key,
+				os_pool_cache_release ) != OS_STATUS_SUCCESS )
+			{
+				os_thread_mutex_destroy( &pool->lock );
+				result = OS_STATUS_FAILURE;
+			}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		}
+	}
+	return result;
+}
+
+os_status_t os_pool_destroy(
+	os_pool_t *pool )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( pool )
+	{
+		const os_allocator_t *const allocator = pool->allocator;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		/* caches of threads still running are freed below */
+		os_thread_local_key_destroy( &pool->key );
+		os_thread_mutex_destroy( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		while ( pool->caches )
+		{
+			struct os_pool_cache *const next = pool->caches->next;
+			os_memory_free( allocator, pool->caches );
+			pool->caches = next;
+		}
+		while ( pool->blocks )
+		{
+			void *const next = *(void **)pool->blocks;
+			os_memory_free( allocator, pool->blocks );
+			pool->blocks = next;
+		}
+		os_memzero( pool, sizeof( os_pool_t ) );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_pool_free(
+	os_pool_t *pool,
+	void *ptr )
+{
+	if ( pool && ptr )
+	{
+		struct os_pool_cache *const cache = os_pool_cache_get( pool );
+		if ( pool->flags & OS_POOL_FLAG_POISON )
+			os_memset( ptr, OS_POOL_POISON_FREE, pool->object_size );
+		if ( cache )
+		{
+			*(void **)ptr = cache->objects;
+			cache->objects = ptr;
+			os_atomic_store_u32( &cache->count, cache->count + 1u,
+				OS_ATOMIC_RELAXED );
+			if ( cache->count > 2u * OS_POOL_BATCH )
+			{
+				/* a batch is shared with the other threads */
+				void *const head = cache->objects;
+				void *tail = head;
+				unsigned int i;
+				for ( i = 1u; i < OS_POOL_BATCH; ++i )
+					tail = *(void **)tail;
+				cache->objects = *(void **)tail;
+				os_atomic_store_u32( &cache->count,
+					cache->count - OS_POOL_BATCH,
+					OS_ATOMIC_RELAXED );
+				os_pool_push( pool, head, tail );
+				os_atomic_fetch_add_u32( &pool->held,
+					(os_uint32_t)0u - OS_POOL_BATCH,
+					OS_ATOMIC_RELAXED );
+			}
+		}
+		else
+		{
+			os_pool_push( pool, ptr, ptr );
+			os_atomic_fetch_add_u32( &pool->held, (os_uint32_t)-1,
+				OS_ATOMIC_RELAXED );
+		}
+	}
+}
+
+os_status_t os_pool_grow(
+	os_pool_t *pool,
+	struct os_pool_cache *cache )
+{
+	os_status_t result = OS_STATUS_NO_MEMORY;
+	char *const block = (char *)os_memory_alloc( pool->allocator,
+		sizeof( void * ) + pool->alignment - 1u +
+		pool->object_size * pool->block_objects,
+		OS_MEMORY_TAG_CALLER );
+	if ( block )
+	{
+		/* objects follow the link to the next block, aligned */
+		char *object = block + sizeof( void * );
+		size_t i;
+
+		object += ( 0u - (size_t)object ) & ( pool->alignment - 1u );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_mutex_lock( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		*(void **)(void *)block = pool->blocks;
+		pool->blocks = block;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_mutex_unlock( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+		for ( i = pool->block_objects; i > 0u; --i )
+		{
+			char *const o = object + ( i - 1u ) * pool->object_size;
+			if ( pool->flags & OS_POOL_FLAG_POISON )
+				os_memset( o, OS_POOL_POISON_FREE,
+					pool->object_size );
+			*(void **)(void *)o = cache->objects;
+			cache->objects = o;
+		}
+		os_atomic_store_u32( &cache->count,
+			(os_uint32_t)pool->block_objects, OS_ATOMIC_RELAXED );
+		os_atomic_fetch_add_u32( &pool->block_count, 1u,
+			OS_ATOMIC_RELAXED );
+		os_pool_held( pool, (os_uint32_t)pool->block_objects );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_pool_held(
+	os_pool_t *pool,
+	os_uint32_t count )
+{
+	const os_uint32_t held = os_atomic_fetch_add_u32( &pool->held, count,
+		OS_ATOMIC_RELAXED ) + count;
+	os_uint32_t held_max = os_atomic_load_u32( &pool->held_max,
+		OS_ATOMIC_RELAXED );
+	while ( held > held_max && !os_atomic_cas_u32( &pool->held_max,
+		&held_max, held, OS_ATOMIC_RELAXED ) ) {}
+}
+
+void os_pool_push(
+	os_pool_t *pool,
+	void *head,
+	void *tail )
+{
+	void *old = os_atomic_load_ptr( &pool->free_list, OS_ATOMIC_RELAXED );
+	do
+	{
+		*(void **)tail = old;
+	} while ( !os_atomic_cas_ptr( &pool->free_list, &old, head,
+		OS_ATOMIC_RELEASE ) );
+}
+
+os_status_t os_pool_refill(
+	os_pool_t *pool,
+	struct os_pool_cache *cache )
+{
+	os_status_t result;
+	/* taking the whole list at once cannot suffer from ABA */
+	void *const head = os_atomic_exchange_ptr( &pool->free_list, NULL,
+		OS_ATOMIC_ACQUIRE );
+	if ( head )
+	{
+		void *last = head;
+		void *rest;
+		os_uint32_t count = 1u;
+
+		while ( count < OS_POOL_BATCH && *(void **)last )
+		{
+			last = *(void **)last;
+			++count;
+		}
+		rest = *(void **)last;
+		if ( rest )
+		{
+			/* objects beyond a batch are shared again */
+			void *expected = NULL;
+			*(void **)last = NULL;
+			if ( !os_atomic_cas_ptr( &pool->free_list, &expected,
+				rest, OS_ATOMIC_RELEASE ) )
+			{
+				void *tail = rest;
+				while ( *(void **)tail )
+					tail = *(void **)tail;
+				os_pool_push( pool, rest, tail );
+			}
+		}
+		cache->objects = head;
+		os_atomic_store_u32( &cache->count, count, OS_ATOMIC_RELAXED );
+		os_atomic_fetch_add_u32( &pool->refills, 1u, OS_ATOMIC_RELAXED );
+		os_pool_held( pool, count );
+		result = OS_STATUS_SUCCESS;
+	}
+	else
+		result = os_pool_grow( pool, cache );
+	return result;
+}
+
+os_status_t os_pool_stats(
+	os_pool_t *pool,
+	os_pool_stats_t *stats )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( pool && stats )
+	{
+		const struct os_pool_cache *cache;
+		os_uint32_t cached = 0u;
+		os_uint32_t held;
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_mutex_lock( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		for ( cache = pool->caches; cache; cache = cache->next )
+			cached += os_atomic_load_u32( &cache->count,
+				OS_ATOMIC_RELAXED );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		os_thread_mutex_unlock( &pool->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+		/* counts of other threads may be changing */
+		held = os_atomic_load_u32( &pool->held, OS_ATOMIC_RELAXED );
+		stats->in_use = held > cached ? held - cached : 0u;
+		stats->high_watermark = os_atomic_load_u32( &pool->held_max,
+			OS_ATOMIC_RELAXED );
+		stats->capacity = os_atomic_load_u32( &pool->block_count,
+			OS_ATOMIC_RELAXED ) * (os_uint32_t)pool->block_objects;
+		stats->refills = os_atomic_load_u32( &pool->refills,
+			OS_ATOMIC_RELAXED );
+		stats->poison_errors = os_atomic_load_u32(
+			&pool->poison_errors, OS_ATOMIC_RELAXED );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void *os_realloc(
+	void *ptr,
+	size_t size )
+{
+	const os_allocator_t *const allocator = os_allocator_get();
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+	void *result = NULL;
+	if ( ptr == NULL )
+		result = os_memory_alloc( allocator, size,
+			OS_MEMORY_TAG_CALLER );
+	else if ( size <= (size_t)-1 - OS_MEMORY_HEADER_SIZE )
+	{
+		struct os_memory_header *header = (struct os_memory_header *)
+			(void *)( (char *)ptr - OS_MEMORY_HEADER_SIZE );
+		const size_t old_size = header->size;
+		header = (struct os_memory_header *)allocator->realloc_fn(
+			header, size + OS_MEMORY_HEADER_SIZE,
+			allocator->user_data );
+		if ( header )
+		{
+			header->size = size;
+			os_memory_record( header->tag,
+				(os_uint64_t)size - old_size, 0u, 0u );
+			result = (char *)header + OS_MEMORY_HEADER_SIZE;
+		}
+	}
+	return result;
+#else /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+	return allocator->realloc_fn( ptr, size, allocator->user_data );
+#endif /* else if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+}
+
+
+/* thread support */
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Number of times a contended adaptive mutex is polled before the
+ *        calling thread goes to sleep
+ */
+#define OS_THREAD_ADAPTIVE_SPIN_COUNT  100u
+
+/**
+ * @brief Maximum number of pauses between polls of a contended spin lock
+ */
+#define OS_THREAD_SPIN_BACKOFF_MAX     64u
+
+/**
+ * @brief Number of polls at the maximum back off, before a contended spin
+ *        lock gives up the processor (the holder may not be running)
+ */
+#define OS_THREAD_SPIN_YIELD_COUNT     16u
+
+/** @brief One-time initialization is running */
+#define OS_THREAD_ONCE_RUNNING         1u
+/** @brief One-time initialization is running, with other threads waiting */
+#define OS_THREAD_ONCE_WAITING         2u
+/** @brief One-time initialization has completed */
+#define OS_THREAD_ONCE_DONE            3u
+
+/**
+ * @brief Reader counter of a big-reader lock
+ */
+struct os_thread_brlock_slot
+{
+	/** @brief Number of readers holding the lock through this counter */
+	os_atomic_uint32_t readers;
+	/** @brief Pads the counter to a full cache line */
+	char padding[OS_CACHE_LINE_SIZE - sizeof( os_atomic_uint32_t )];
+};
+
+/**
+ * @brief Reader counters of a read-copy-update pointer for a CPU
+ */
+struct os_rcu_slot
+{
+	/** @brief Number of readers, for each value of the lowest epoch bit */
+	os_atomic_uint32_t readers[2];
+	/** @brief Pads the counters to a full cache line */
+	char padding[OS_CACHE_LINE_SIZE - 2u * sizeof( os_atomic_uint32_t )];
+};
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+/** @brief Number of buckets in each lock statistics histogram */
+#define OS_LOCK_STATS_BUCKETS          32u
+/** @brief Maximum length of a lock name, including the null-terminator */
+#define OS_LOCK_STATS_NAME_MAX         32u
+
+/**
+ * @brief Contention statistics recorded for a lock
+ */
+struct os_lock_stats
+{
+	/** @brief Kind of lock ("mutex" or "rwlock") */
+	const char *kind;
+	/** @brief Name given at creation, empty for unnamed locks */
+	char name[OS_LOCK_STATS_NAME_MAX];
+	/** @brief Address of the lock, reported for unnamed locks */
+	const void *lock;
+	/** @brief Number of locks currently recording into the statistics */
+	unsigned int users;
+	/** @brief Number of times the lock was acquired */
+	os_atomic_uint64_t acquisitions;
+	/** @brief Total time spent waiting for the lock, in nanoseconds */
+	os_atomic_uint64_t wait_total;
+	/** @brief Total time the lock was held, in nanoseconds */
+	os_atomic_uint64_t hold_total;
+	/** @brief Histogram of the time spent by acquisitions that waited */
+	os_atomic_uint64_t wait[OS_LOCK_STATS_BUCKETS];
+	/** @brief Histogram of the time the lock was held */
+	os_atomic_uint64_t hold[OS_LOCK_STATS_BUCKETS];
+	/** @brief Next statistics in the list of all statistics */
+	struct os_lock_stats *next;
+};
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+/**
+ * @brief Work shared by the threads of a parallel operation
+ */
+struct os_parallel
+{
+	/** @brief User specific data */
+	void *arg;
+	/** @brief First index of the range */
+	size_t begin;
+	/** @brief Number of chunks in the range */
+	size_t chunk_count;
+	/** @brief Index after the last one of the range */
+	size_t end;
+	/** @brief Function called for each chunk, by @p os_parallel_for */
+	os_parallel_for_t fn;
+	/** @brief Number of indexes in each chunk */
+	size_t grain;
+	/** @brief Function called for each chunk, by @p os_parallel_reduce */
+	os_parallel_map_t map;
+	/** @brief Next chunk to hand out to a thread */
+	os_atomic_uint64_t next;
+};
+
+/**
+ * @brief Thread processing chunks of a parallel operation
+ */
+struct os_parallel_worker
+{
+	/** @brief Work shared by the threads */
+	struct os_parallel *parallel;
+	/** @brief Partial result accumulated by the thread */
+	void *partial;
+	/** @brief Thread of the pool (unused for the calling thread) */
+	os_thread_t thread;
+	/** @brief Set to give work to the thread of the pool, which waits on
+	 *         it between operations (unused for the calling thread) */
+	os_thread_event_t wake;
+};
+
+/**
+ * @brief Threads kept to process the chunks of parallel operations
+ */
+struct os_parallel_pool
+{
+	/** @brief Threads of the pool */
+	struct os_parallel_worker *workers;
+	/** @brief Number of threads started */
+	size_t worker_count;
+	/** @brief Whether an operation is using the pool */
+	os_atomic_uint32_t busy;
+	/** @brief Number of threads done with the current operation */
+	os_atomic_uint32_t done;
+	/** @brief Partial results of the threads for the current operation */
+	char *partials;
+	/** @brief Size of the memory held for partial results */
+	size_t partials_size;
+};
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+/** @brief Statistics of all locks created */
+static struct os_lock_stats *OS_LOCK_STATS_LIST = NULL;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+/** @brief Threads processing chunks of parallel operations */
+static struct os_parallel_pool OS_PARALLEL_POOL;
+/** @brief Ensures the threads of the pool are only started once */
+static os_thread_once_t OS_PARALLEL_POOL_ONCE = OS_THREAD_ONCE_INIT;
+
+/** @brief Identifier of the next thread to use a per-CPU counter */
+static os_atomic_uint32_t OS_THREAD_SLOT_NEXT_ID = 0u;
+/** @brief Identifier of the calling thread for per-CPU counters (0 = none) */
+static OS_THREAD_LOCAL os_uint32_t OS_THREAD_SLOT_ID = 0u;
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+/**
+ * @brief Returns the histogram bucket for a time
+ *
+ * @param[in]      ns                  time in nanoseconds
+ *
+ * @return the bucket, the base 2 logarithm of the time
+ */
+static unsigned int os_lock_stats_bucket(
+	os_uint64_t ns );
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+/**
+ * @brief Main method for the threads of the pool, processing chunks of
+ *        each parallel operation they are given
+ *
+ * @param[in]      arg                 thread (struct os_parallel_worker)
+ *
+ * @returns 0
+ */
+static OS_THREAD_DECL os_parallel_main(
+	void *arg );
+
+/**
+ * @brief Starts the threads of the pool, one less than the number of CPUs
+ *        available as the calling thread also processes chunks
+ *
+ * @param[in]      arg                 unused
+ */
+static void os_parallel_pool_start(
+	void *arg );
+
+/**
+ * @brief Processes the chunks of a parallel operation, on the calling
+ *        thread and as many other threads as there are CPUs available
+ *
+ * @param[in,out]  parallel            work to process
+ * @param[in]      combine             function combining partial results
+ *                                     (NULL = no results)
+ * @param[in,out]  total               total to combine into
+ * @param[in]      total_size          size of the total
+ *
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_parallel_run(
+	struct os_parallel *parallel,
+	os_parallel_combine_t combine,
+	void *total,
+	size_t total_size );
+
+/**
+ * @brief Processes chunks of a parallel operation until there are none
+ *        left
+ *
+ * @param[in,out]  worker              thread processing the chunks
+ */
+static void os_parallel_work(
+	struct os_parallel_worker *worker );
+
+/**
+ * @brief Waits until a reader counter drops to zero
+ *
+ * @param[in,out]  counter             reader counter to wait on
+ */
+static void os_rcu_wait_readers(
+	os_atomic_uint32_t *counter );
+
+/**
+ * @brief Removes a reader from a counter of a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ * @param[in,out]  slot                reader counter of the calling thread
+ */
+static void os_thread_brlock_slot_leave(
+	os_thread_brlock_t *lock,
+	struct os_thread_brlock_slot *slot );
+
+/**
+ * @brief Waits until there are no readers holding a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ */
+static void os_thread_brlock_wait_readers(
+	os_thread_brlock_t *lock );
+
+/**
+ * @brief Hints to the processor that the caller is in a spin-wait loop
+ */
+static void os_thread_cpu_relax( void );
+
+/**
+ * @brief Calculates the deadline for a wait, if one is required
+ *
+ * @param[in]      deadline            absolute deadline (optional)
+ * @param[in]      max_time_out        relative time out, used if no absolute
+ *                                     deadline is given (0 = indefinite)
+ * @param[out]     out                 storage for a calculated deadline
+ *
+ * @return a pointer to the deadline to use, NULL to wait indefinitely
+ */
+static const os_timestamp_t *os_thread_deadline(
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out,
+	os_timestamp_t *out );
+
+/**
+ * @brief Returns the index of the per-CPU counter for the calling thread
+ *
+ * Threads are assigned to counters in turn when they first use one, and
+ * keep their counter, so that a lock is released on the same counter even
+ * if the thread migrated to a different CPU while holding it.
+ *
+ * @param[in]      slot_count          number of counters (power of 2)
+ *
+ * @return the index of the counter for the calling thread
+ */
+static os_uint32_t os_thread_slot_index(
+	os_uint32_t slot_count );
+
+/**
+ * @brief Allocates zeroed per-CPU counters, aligned on a cache line
+ *
+ * @param[in]      slot_size           size of the counters for a CPU
+ *                                     (multiple of OS_CACHE_LINE_SIZE)
+ * @param[out]     slot_count          number of counters allocated (power
+ *                                     of 2, at least the number of CPUs)
+ * @param[out]     memory              memory to free, once the counters are
+ *                                     no longer used
+ *
+ * @retval NULL                        out of memory
+ * @retval !NULL                       pointer to the first counter
+ */
+static void *os_thread_slots_allocate(
+	size_t slot_size,
+	os_uint32_t *slot_count,
+	void **memory );
+
+/**
+ * @brief Consumes an event if it is set
+ *
+ * @param[in,out]  event               event to check
+ *
+ * @retval OS_FALSE                    event is not set
+ * @retval OS_TRUE                     event was set (and cleared, if the
+ *                                     event is auto-reset)
+ */
+static os_bool_t os_thread_event_take(
+	os_thread_event_t *event );
+
+/**
+ * @brief Waits for an event, until a deadline or a relative time out
+ *
+ * @param[in,out]  event               previously created event
+ * @param[in]      deadline            absolute deadline (optional)
+ * @param[in]      max_time_out        relative time out, used if no absolute
+ *                                     deadline is given (0 = indefinite)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+static os_status_t os_thread_event_wait_internal(
+	os_thread_event_t *event,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out );
+
+/**
+ * @brief Waits for a latch to reach zero, until a deadline or a relative
+ *        time out
+ *
+ * @param[in,out]  latch               previously created latch
+ * @param[in]      deadline            absolute deadline (optional)
+ * @param[in]      max_time_out        relative time out, used if no absolute
+ *                                     deadline is given (0 = indefinite)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+static os_status_t os_thread_latch_wait_internal(
+	os_thread_latch_t *latch,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out );
+
+/**
+ * @brief Takes a resource from a semaphore if one is available
+ *
+ * @param[in,out]  sem                 semaphore to take a resource from
+ *
+ * @retval OS_FALSE                    no resource available
+ * @retval OS_TRUE                     resource taken
+ */
+static os_bool_t os_thread_semaphore_take(
+	os_thread_semaphore_t *sem );
+
+/**
+ * @brief Waits for a semaphore, until a deadline or a relative time out
+ *
+ * @param[in,out]  sem                 previously created semaphore
+ * @param[in]      deadline            absolute deadline (optional)
+ * @param[in]      max_time_out        relative time out, used if no absolute
+ *                                     deadline is given (0 = indefinite)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+static os_status_t os_thread_semaphore_wait_internal(
+	os_thread_semaphore_t *sem,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out );
+
+/**
+ * @brief Adds a timer to the timing wheel, the service must be locked
+ *
+ * @param[in,out]  service             timer service
+ * @param[in,out]  timer               timer to add, with its expiry set
+ */
+static void os_timer_add(
+	os_timer_service_t *service,
+	os_timer_t *timer );
+
+/**
+ * @brief Removes a timer from the timing wheel, the service must be locked
+ *
+ * @param[in,out]  timer               scheduled timer to remove
+ */
+static void os_timer_remove(
+	os_timer_t *timer );
+
+/**
+ * @brief Moves the timers from a slot of a higher level of the timing wheel
+ *        to the levels below, the service must be locked
+ *
+ * @param[in,out]  service             timer service
+ * @param[in]      level               level of the wheel (1 or higher)
+ *
+ * @return the index of the slot cascaded within its level
+ */
+static os_uint32_t os_timer_service_cascade(
+	os_timer_service_t *service,
+	unsigned int level );
+
+/**
+ * @brief Thread running the timers of a service
+ *
+ * @param[in,out]  arg                 timer service
+ *
+ * @return 0
+ */
+static OS_THREAD_DECL os_timer_service_main(
+	void *arg );
+
+/**
+ * @brief Finds the time the next timer of a service may expire, the service
+ *        must be locked
+ *
+ * @param[in]      service             timer service
+ * @param[out]     expiry              time to process the timers
+ *
+ * @retval OS_FALSE                    no timers scheduled
+ * @retval OS_TRUE                     expiry time found
+ */
+static os_bool_t os_timer_service_next(
+	const os_timer_service_t *service,
+	os_timestamp_t *expiry );
+
+/**
+ * @brief Thread checking the threads monitored by a watchdog
+ *
+ * @param[in,out]  arg                 watchdog
+ *
+ * @return 0
+ */
+static OS_THREAD_DECL os_watchdog_main(
+	void *arg );
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+void os_lock_stats_acquired(
+	os_lock_stats_t *stats,
+	os_uint64_t start,
+	os_uint64_t acquired )
+{
+	if ( stats )
+	{
+		os_atomic_fetch_add_u64( &stats->acquisitions, 1u,
+			OS_ATOMIC_RELAXED );
+		if ( start != 0u )
+		{
+			const os_uint64_t wait = acquired - start;
+			os_atomic_fetch_add_u64( &stats->wait_total, wait,
+				OS_ATOMIC_RELAXED );
+			os_atomic_fetch_add_u64(
+				&stats->wait[os_lock_stats_bucket( wait )], 1u,
+				OS_ATOMIC_RELAXED );
+		}
+	}
+}
+
+unsigned int os_lock_stats_bucket(
+	os_uint64_t ns )
+{
+	unsigned int result = 0u;
+	while ( ns > 1u && result < OS_LOCK_STATS_BUCKETS - 1u )
+	{
+		ns >>= 1;
+		++result;
+	}
+	return result;
+}
+
+os_status_t os_lock_stats_dump(
+	os_file_t out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( out )
+	{
+		const struct os_lock_stats *stats;
+		os_lock_stats_list_lock();
+		for ( stats = OS_LOCK_STATS_LIST; stats; stats = stats->next )
+		{
+			const unsigned long long acquisitions =
+				os_atomic_load_u64( &stats->acquisitions,
+					OS_ATOMIC_RELAXED );
+			unsigned long long contended = 0u;
+			unsigned long long holds = 0u;
+			unsigned int i;
+
+			for ( i = 0u; i < OS_LOCK_STATS_BUCKETS; ++i )
+			{
+				contended += os_atomic_load_u64( &stats->wait[i],
+					OS_ATOMIC_RELAXED );
+				holds += os_atomic_load_u64( &stats->hold[i],
+					OS_ATOMIC_RELAXED );
+			}
+
+			if ( stats->name[0] != '\0' )
+				os_fprintf( out, "%s \"%s\":", stats->kind,
+					stats->name );
+			else
+				os_fprintf( out, "%s %p:", stats->kind,
+					stats->lock );
+			os_fprintf( out, " acquired %llu, contended %llu (%.1f%%)",
+				acquisitions, contended, acquisitions > 0u ?
+				100.0 * (double)contended / (double)acquisitions :
+				0.0 );
+			if ( contended > 0u )
+				os_fprintf( out, ", mean wait %llu ns",
+					(unsigned long long)os_atomic_load_u64(
+						&stats->wait_total,
+						OS_ATOMIC_RELAXED ) / contended );
+			if ( holds > 0u )
+				os_fprintf( out, ", mean hold %llu ns",
+					(unsigned long long)os_atomic_load_u64(
+						&stats->hold_total,
+						OS_ATOMIC_RELAXED ) / holds );
+			os_fprintf( out, "\n" );
+
+			/* only non-empty buckets, as 2^bucket ns: count */
+			if ( contended > 0u )
+			{
+				os_fprintf( out, "    wait" );
+				for ( i = 0u; i < OS_LOCK_STATS_BUCKETS; ++i )
+					if ( stats->wait[i] > 0u )
+						os_fprintf( out, " 2^%u: %llu", i,
+							(unsigned long long)
+							stats->wait[i] );
+				os_fprintf( out, "\n" );
+			}
+			if ( holds > 0u )
+			{
+				os_fprintf( out, "    hold" );
+				for ( i = 0u; i < OS_LOCK_STATS_BUCKETS; ++i )
+					if ( stats->hold[i] > 0u )
+						os_fprintf( out, " 2^%u: %llu", i,
+							(unsigned long long)
+							stats->hold[i] );
+				os_fprintf( out, "\n" );
+			}
+		}
+		os_lock_stats_list_unlock();
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_lock_stats_t *os_lock_stats_register(
+	const char *kind,
+	const char *name,
+	const void *lock )
+{
+	struct os_lock_stats *result = NULL;
+	os_lock_stats_list_lock();
+
+	/* locks with the same name share their statistics */
+	if ( name && *name != '\0' )
+	{
+		result = OS_LOCK_STATS_LIST;
+		while ( result && ( os_strcmp( result->kind, kind ) != 0 ||
+			os_strncmp( result->name, name,
+				OS_LOCK_STATS_NAME_MAX - 1u ) != 0 ) )
+			result = result->next;
+	}
+
+	if ( !result )
+	{
+		result = (struct os_lock_stats *)os_malloc_tagged(
+			sizeof( struct os_lock_stats ), OS_MEMORY_TAG_THREAD );
+		if ( result )
+		{
+			os_memzero( result, sizeof( struct os_lock_stats ) );
+			result->kind = kind;
+			if ( name )
+				os_strncpy( result->name, name,
+					OS_LOCK_STATS_NAME_MAX - 1u );
+			result->lock = lock;
+			result->next = OS_LOCK_STATS_LIST;
+			OS_LOCK_STATS_LIST = result;
+		}
+	}
+
+	if ( result )
+		++result->users;
+	os_lock_stats_list_unlock();
+	return result;
+}
+
+void os_lock_stats_released(
+	os_lock_stats_t *stats,
+	os_uint64_t hold )
+{
+	if ( stats )
+	{
+		os_atomic_fetch_add_u64( &stats->hold_total, hold,
+			OS_ATOMIC_RELAXED );
+		os_atomic_fetch_add_u64( &stats->hold[os_lock_stats_bucket( hold )],
+			1u, OS_ATOMIC_RELAXED );
+	}
+}
+
+void os_lock_stats_unregister(
+	os_lock_stats_t *stats )
+{
+	if ( stats )
+	{
+		os_lock_stats_list_lock();
+		--stats->users;
+		if ( stats->users == 0u && stats->name[0] == '\0' )
+		{
+			struct os_lock_stats **prev = &OS_LOCK_STATS_LIST;
+			while ( *prev && *prev != stats )
+				prev = &(*prev)->next;
+			if ( *prev )
+				*prev = stats->next;
+			os_free( stats );
+		}
+		os_lock_stats_list_unlock();
+	}
+}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+os_status_t os_lock_stats_dump(
+	os_file_t out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( out )
+		result = OS_STATUS_NOT_SUPPORTED;
+	return result;
+}
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+os_status_t os_parallel_for(
+	size_t begin,
+	size_t end,
+	size_t grain,
+	os_parallel_for_t fn,
+	void *arg )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( begin <= end && fn )
+	{
+		struct os_parallel parallel;
+		os_memzero( &parallel, sizeof( struct os_parallel ) );
+		parallel.arg = arg;
+		parallel.begin = begin;
+		parallel.end = end;
+		parallel.fn = fn;
+		parallel.grain = grain;
+		result = os_parallel_run( &parallel, NULL, NULL, 0u );
+	}
+	return result;
+}
+
+OS_THREAD_DECL os_parallel_main(
+	void *arg )
+{
+	struct os_parallel_worker *const worker =
+		(struct os_parallel_worker *)arg;
+	while ( os_thread_event_wait( &worker->wake ) == OS_STATUS_SUCCESS )
+	{
+		os_parallel_work( worker );
+		os_atomic_fetch_add_u32( &OS_PARALLEL_POOL.done, 1u,
+			OS_ATOMIC_RELEASE );
+		os_atomic_wake_u32( &OS_PARALLEL_POOL.done, OS_FALSE );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+void os_parallel_pool_start(
+	void *UNUSED(arg) )
+{
+	struct os_parallel_pool *const pool = &OS_PARALLEL_POOL;
+	const os_allocator_t *const system = os_allocator_system();
+	const size_t count = os_system_cpu_count() - 1u;
+
+	/* kept for the life of the process, whichever allocator is set */
+	if ( count > 0u )
+		pool->workers = (struct os_parallel_worker *)system->malloc_fn(
+			sizeof( struct os_parallel_worker ) * count,
+			system->user_data );
+	if ( pool->workers )
+	{
+		size_t i;
+		os_memzero( pool->workers,
+			sizeof( struct os_parallel_worker ) * count );
+		/* threads that fail to start leave the pool smaller */
+		for ( i = 0u; i < count; ++i )
+		{
+			struct os_parallel_worker *const worker =
+				&pool->workers[pool->worker_count];
+			if ( os_thread_event_create( &worker->wake, OS_FALSE ) ==
+				OS_STATUS_SUCCESS )
+			{
+				if ( os_thread_create( &worker->thread,
+					os_parallel_main, worker, 0u ) ==
+					OS_STATUS_SUCCESS )
+					++pool->worker_count;
+				else
+					os_thread_event_destroy( &worker->wake );
+			}
+		}
+	}
+}
+
+os_status_t os_parallel_reduce(
+	size_t begin,
+	size_t end,
+	size_t grain,
+	os_parallel_map_t map,
+	os_parallel_combine_t combine,
+	void *total,
+	size_t total_size,
+	void *arg )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( begin <= end && map && combine && total && total_size > 0u )
+	{
+		struct os_parallel parallel;
+		os_memzero( &parallel, sizeof( struct os_parallel ) );
+		parallel.arg = arg;
+		parallel.begin = begin;
+		parallel.end = end;
+		parallel.grain = grain;
+		parallel.map = map;
+		result = os_parallel_run( &parallel, combine, total,
+			total_size );
+	}
+	return result;
+}
+
+os_status_t os_parallel_run(
+	struct os_parallel *parallel,
+	os_parallel_combine_t combine,
+	void *total,
+	size_t total_size )
+{
+	struct os_parallel_pool *const pool = &OS_PARALLEL_POOL;
+	const size_t range = parallel->end - parallel->begin;
+	/* each partial result on its own cache lines */
+	const size_t partial_size = ( total_size + OS_CACHE_LINE_SIZE - 1u ) &
+		~(size_t)( OS_CACHE_LINE_SIZE - 1u );
+	size_t worker_count = os_system_cpu_count();
+	struct os_parallel_worker worker;
+	os_uint32_t busy = 0u;
+	os_bool_t pooled = OS_FALSE;
+	size_t used = 0u;
+
+	/* by default, give each thread several chunks to balance the load */
+	if ( parallel->grain == 0u )
+		parallel->grain = range / ( worker_count * 8u );
+	if ( parallel->grain == 0u )
+		parallel->grain = 1u;
+	parallel->chunk_count = range / parallel->grain;
+	if ( range % parallel->grain != 0u )
+		++parallel->chunk_count;
+	if ( worker_count > parallel->chunk_count )
+		worker_count = parallel->chunk_count;
+
+	/* the pool serves one operation at a time, others (such as one
+	 * started from a chunk) are processed by their calling thread */
+	if ( worker_count > 1u &&
+		os_thread_once( &OS_PARALLEL_POOL_ONCE, os_parallel_pool_start,
+			NULL ) == OS_STATUS_SUCCESS &&
+		os_atomic_cas_u32( &pool->busy, &busy, 1u, OS_ATOMIC_ACQUIRE ) )
+	{
+		const size_t partials_size = partial_size *
+			pool->worker_count + OS_CACHE_LINE_SIZE;
+		pooled = OS_TRUE;
+		used = worker_count - 1u;
+		if ( used > pool->worker_count )
+			used = pool->worker_count;
+		if ( total_size > 0u && pool->partials_size < partials_size )
+		{
+			const os_allocator_t *const system =
+				os_allocator_system();
+			char *const partials = (char *)system->realloc_fn(
+				pool->partials, partials_size,
+				system->user_data );
+			if ( partials )
+			{
+				pool->partials = partials;
+				pool->partials_size = partials_size;
+			}
+			else
+				used = 0u;
+		}
+	}
+
+	if ( used > 0u )
+	{
+		char *partials = pool->partials;
+		size_t i;
+		if ( partials )
+			partials += OS_CACHE_LINE_SIZE -
+				( (size_t)partials % OS_CACHE_LINE_SIZE );
+		os_atomic_store_u32( &pool->done, 0u, OS_ATOMIC_RELAXED );
+		for ( i = 0u; i < used; ++i )
+		{
+			struct os_parallel_worker *const w = &pool->workers[i];
+			w->parallel = parallel;
+			w->partial = NULL;
+			if ( total_size > 0u )
+			{
+				w->partial = &partials[partial_size * i];
+				os_memcpy( w->partial, total, total_size );
+			}
+			os_thread_event_set( &w->wake );
+		}
+	}
+
+	/* calling thread accumulates directly into the total */
+	os_memzero( &worker, sizeof( struct os_parallel_worker ) );
+	worker.parallel = parallel;
+	worker.partial = total;
+	os_parallel_work( &worker );
+
+	if ( used > 0u )
+	{
+		os_uint32_t done;
+		size_t i;
+		while ( ( done = os_atomic_load_u32( &pool->done,
+			OS_ATOMIC_ACQUIRE ) ) < used )
+			os_atomic_wait_u32( &pool->done, done, NULL );
+		for ( i = 0u; combine && i < used; ++i )
+			combine( total, pool->workers[i].partial,
+				parallel->arg );
+	}
+	if ( pooled != OS_FALSE )
+		os_atomic_store_u32( &pool->busy, 0u, OS_ATOMIC_RELEASE );
+	return OS_STATUS_SUCCESS;
+}
+
+void os_parallel_work(
+	struct os_parallel_worker *worker )
+{
+	struct os_parallel *const parallel = worker->parallel;
+	os_uint64_t chunk = os_atomic_fetch_add_u64( &parallel->next, 1u,
+		OS_ATOMIC_RELAXED );
+	while ( chunk < parallel->chunk_count )
+	{
+		const size_t begin = parallel->begin +
+			(size_t)chunk * parallel->grain;
+		size_t end = parallel->end;
+		if ( end - begin > parallel->grain )
+			end = begin + parallel->grain;
+		if ( parallel->map )
+			parallel->map( begin, end, worker->partial,
+				parallel->arg );
+		else
+			parallel->fn( begin, end, parallel->arg );
+		chunk = os_atomic_fetch_add_u64( &parallel->next, 1u,
+			OS_ATOMIC_RELAXED );
+	}
+}
+
+os_status_t os_rcu_ptr_create(
+	os_rcu_ptr_t *rcu,
+	void *snapshot,
+	os_rcu_free_t free_fn )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu )
+	{
+		result = OS_STATUS_NO_MEMORY;
+		rcu->slots = (struct os_rcu_slot *)os_thread_slots_allocate(
+			sizeof( struct os_rcu_slot ), &rcu->slot_count,
+			&rcu->memory );
+		if ( rcu->slots )
+		{
+			os_atomic_store_ptr( &rcu->snapshot, snapshot,
+				OS_ATOMIC_RELEASE );
+			os_atomic_store_u32( &rcu->epoch, 0u,
+				OS_ATOMIC_RELAXED );
+			rcu->free_fn = free_fn;
+			result = os_thread_adaptive_mutex_create(
+				&rcu->write_lock );
+		}
+	}
+	return result;
+}
+
+os_status_t os_rcu_ptr_destroy(
+	os_rcu_ptr_t *rcu )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu )
+	{
+		void *const snapshot = os_atomic_exchange_ptr(
+			&rcu->snapshot, NULL, OS_ATOMIC_ACQ_REL );
+		if ( snapshot && rcu->free_fn )
+			rcu->free_fn( snapshot );
+		os_thread_adaptive_mutex_destroy( &rcu->write_lock );
+		os_free_null( (void **)&rcu->memory );
+		rcu->slots = NULL;
+		rcu->slot_count = 0u;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_rcu_ptr_publish(
+	os_rcu_ptr_t *rcu,
+	void *snapshot )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu && rcu->slots )
+	{
+		void *old_snapshot;
+
+		os_thread_adaptive_mutex_lock( &rcu->write_lock );
+		old_snapshot = os_atomic_exchange_ptr( &rcu->snapshot,
+			snapshot, OS_ATOMIC_SEQ_CST );
+		os_thread_adaptive_mutex_unlock( &rcu->write_lock );
+
+		result = os_rcu_ptr_synchronize( rcu );
+		if ( old_snapshot && old_snapshot != snapshot && rcu->free_fn )
+			rcu->free_fn( old_snapshot );
+	}
+	return result;
+}
+
+os_status_t os_rcu_ptr_read_lock(
+	os_rcu_ptr_t *rcu,
+	os_rcu_reader_t *reader,
+	void **snapshot )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu && rcu->slots && reader && snapshot )
+	{
+		struct os_rcu_slot *const slot = &rcu->slots[
+			os_thread_slot_index( rcu->slot_count )];
+		const os_uint32_t side = os_atomic_load_u32( &rcu->epoch,
+			OS_ATOMIC_SEQ_CST ) & 1u;
+
+		/* the snapshot is read after announcing the reader: if a
+		 * writer already checked the counter, the reader is
+		 * guaranteed to see the writer's new snapshot */
+		reader->counter = &slot->readers[side];
+		os_atomic_fetch_add_u32( reader->counter, 1u,
+			OS_ATOMIC_SEQ_CST );
+		*snapshot = os_atomic_load_ptr( &rcu->snapshot,
+			OS_ATOMIC_SEQ_CST );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_rcu_ptr_read_unlock(
+	os_rcu_ptr_t *rcu,
+	os_rcu_reader_t *reader )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu && reader && reader->counter )
+	{
+		/* the last reader on a counter wakes a waiting writer */
+		if ( os_atomic_fetch_add_u32( reader->counter, (os_uint32_t)-1,
+			OS_ATOMIC_SEQ_CST ) == 1u )
+			os_atomic_wake_u32( reader->counter, OS_TRUE );
+		reader->counter = NULL;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_rcu_ptr_synchronize(
+	os_rcu_ptr_t *rcu )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( rcu && rcu->slots )
+	{
+		unsigned int flip;
+
+		/* flip the counters used by new readers and wait for the
+		 * readers on the old side, twice: a reader may have read the
+		 * epoch before the first flip, but only announced itself
+		 * after its counter was checked */
+		os_thread_adaptive_mutex_lock( &rcu->write_lock );
+		for ( flip = 0u; flip < 2u; ++flip )
+		{
+			const os_uint32_t side = os_atomic_fetch_add_u32(
+				&rcu->epoch, 1u, OS_ATOMIC_SEQ_CST ) & 1u;
+			os_uint32_t i;
+			for ( i = 0u; i < rcu->slot_count; ++i )
+				os_rcu_wait_readers(
+					&rcu->slots[i].readers[side] );
+		}
+		os_thread_adaptive_mutex_unlock( &rcu->write_lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_rcu_wait_readers(
+	os_atomic_uint32_t *counter )
+{
+	os_uint32_t count = os_atomic_load_u32( counter, OS_ATOMIC_SEQ_CST );
+	while ( count != 0u )
+	{
+		os_atomic_wait_u32( counter, count, NULL );
+		count = os_atomic_load_u32( counter, OS_ATOMIC_SEQ_CST );
+	}
+}
+
+os_status_t os_seqlock_create(
+	os_seqlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_atomic_store_u32( &lock->sequence, 0u, OS_ATOMIC_RELAXED );
+		result = os_thread_adaptive_mutex_create( &lock->write_lock );
+	}
+	return result;
+}
+
+os_status_t os_seqlock_destroy(
+	os_seqlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+		result = os_thread_adaptive_mutex_destroy( &lock->write_lock );
+	return result;
+}
+
+os_status_t os_seqlock_read(
+	os_seqlock_t *lock,
+	void *dest,
+	const void *src,
+	size_t size )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && dest && src )
+	{
+		os_uint32_t sequence;
+		do
+		{
+			sequence = os_seqlock_read_begin( lock );
+			os_memcpy( dest, src, size );
+		} while ( os_seqlock_read_retry( lock, sequence ) != OS_FALSE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_uint32_t os_seqlock_read_begin(
+	os_seqlock_t *lock )
+{
+	os_uint32_t result = 0u;
+	if ( lock )
+	{
+		/* wait for a write in progress to finish */
+		result = os_atomic_load_u32( &lock->sequence,
+			OS_ATOMIC_ACQUIRE );
+		while ( result & 1u )
+		{
+			os_thread_cpu_relax();
+			result = os_atomic_load_u32( &lock->sequence,
+				OS_ATOMIC_ACQUIRE );
+		}
+	}
+	return result;
+}
+
+os_bool_t os_seqlock_read_retry(
+	os_seqlock_t *lock,
+	os_uint32_t sequence )
+{
+	os_bool_t result = OS_FALSE;
+	if ( lock )
+	{
+		/* the data must be read before the sequence is checked */
+		os_atomic_thread_fence( OS_ATOMIC_ACQUIRE );
+		if ( os_atomic_load_u32( &lock->sequence,
+			OS_ATOMIC_RELAXED ) != sequence )
+			result = OS_TRUE;
+	}
+	return result;
+}
+
+os_status_t os_seqlock_write(
+	os_seqlock_t *lock,
+	void *dest,
+	const void *src,
+	size_t size )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && dest && src )
+	{
+		os_seqlock_write_lock( lock );
+		os_memcpy( dest, src, size );
+		result = os_seqlock_write_unlock( lock );
+	}
+	return result;
+}
+
+os_status_t os_seqlock_write_lock(
+	os_seqlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_thread_adaptive_mutex_lock( &lock->write_lock );
+
+		/* mark the write as in progress before modifying the data */
+		os_atomic_store_u32( &lock->sequence,
+			os_atomic_load_u32( &lock->sequence,
+				OS_ATOMIC_RELAXED ) + 1u, OS_ATOMIC_RELAXED );
+		os_atomic_thread_fence( OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_seqlock_write_unlock(
+	os_seqlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_atomic_store_u32( &lock->sequence,
+			os_atomic_load_u32( &lock->sequence,
+				OS_ATOMIC_RELAXED ) + 1u, OS_ATOMIC_RELEASE );
+		os_thread_adaptive_mutex_unlock( &lock->write_lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+const os_timestamp_t *os_thread_deadline(
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out,
+	os_timestamp_t *out )
+{
+	if ( !deadline && max_time_out > 0u &&
+		os_time_monotonic( out ) == OS_STATUS_SUCCESS )
+	{
+		*out += max_time_out;
+		deadline = out;
+	}
+	return deadline;
+}
+
+os_status_t os_thread_adaptive_mutex_create(
+	os_thread_adaptive_mutex_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_atomic_store_u32( &lock->state, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_adaptive_mutex_destroy(
+	os_thread_adaptive_mutex_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_adaptive_mutex_lock(
+	os_thread_adaptive_mutex_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_uint32_t state = 0u;
+		if ( os_atomic_cas_u32( &lock->state, &state, 1u,
+			OS_ATOMIC_ACQUIRE ) == OS_FALSE )
+		{
+			unsigned int spin;
+
+			/* spin while the holder is likely to release soon,
+			 * don't bother if other threads are already asleep */
+			for ( spin = 0u; state == 1u &&
+				spin < OS_THREAD_ADAPTIVE_SPIN_COUNT; ++spin )
+			{
+				os_thread_cpu_relax();
+				state = os_atomic_load_u32( &lock->state,
+					OS_ATOMIC_RELAXED );
+				if ( state == 0u && os_atomic_cas_u32(
+					&lock->state, &state, 1u,
+					OS_ATOMIC_ACQUIRE ) != OS_FALSE )
+					break;
+			}
+
+			/* mark the lock as having sleepers and park */
+			if ( state != 0u )
+			{
+				state = os_atomic_exchange_u32( &lock->state,
+					2u, OS_ATOMIC_ACQUIRE );
+				while ( state != 0u )
+				{
+					os_atomic_wait_u32( &lock->state, 2u,
+						NULL );
+					state = os_atomic_exchange_u32(
+						&lock->state, 2u,
+						OS_ATOMIC_ACQUIRE );
+				}
+			}
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_adaptive_mutex_try_lock(
+	os_thread_adaptive_mutex_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_uint32_t state = 0u;
+		result = OS_STATUS_TRY_AGAIN;
+		if ( os_atomic_cas_u32( &lock->state, &state, 1u,
+			OS_ATOMIC_ACQUIRE ) != OS_FALSE )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_adaptive_mutex_unlock(
+	os_thread_adaptive_mutex_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		if ( os_atomic_exchange_u32( &lock->state, 0u,
+			OS_ATOMIC_RELEASE ) == 2u )
+			os_atomic_wake_u32( &lock->state, OS_FALSE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_barrier_create(
+	os_thread_barrier_t *barrier,
+	os_uint32_t thread_count )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( barrier && thread_count > 0u )
+	{
+		barrier->thread_count = thread_count;
+		os_atomic_store_u32( &barrier->arrived, 0u, OS_ATOMIC_RELAXED );
+		os_atomic_store_u32( &barrier->phase, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_barrier_destroy(
+	os_thread_barrier_t *barrier )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( barrier )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_barrier_wait(
+	os_thread_barrier_t *barrier,
+	os_bool_t *last )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( barrier )
+	{
+		/* read the phase before arriving, the last thread to arrive
+		 * changes it */
+		const os_uint32_t phase = os_atomic_load_u32( &barrier->phase,
+			OS_ATOMIC_ACQUIRE );
+		const os_uint32_t arrived = os_atomic_fetch_add_u32(
+			&barrier->arrived, 1u, OS_ATOMIC_ACQ_REL ) + 1u;
+		if ( last )
+			*last = OS_FALSE;
+		if ( arrived == barrier->thread_count )
+		{
+			/* reset for the next phase before releasing the others */
+			os_atomic_store_u32( &barrier->arrived, 0u,
+				OS_ATOMIC_RELAXED );
+			os_atomic_fetch_add_u32( &barrier->phase, 1u,
+				OS_ATOMIC_RELEASE );
+			os_atomic_wake_u32( &barrier->phase, OS_TRUE );
+			if ( last )
+				*last = OS_TRUE;
+		}
+		else
+		{
+			while ( os_atomic_load_u32( &barrier->phase,
+				OS_ATOMIC_ACQUIRE ) == phase )
+				os_atomic_wait_u32( &barrier->phase, phase, NULL );
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_brlock_create(
+	os_thread_brlock_t *lock,
+	os_bool_t writer_preference )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		result = OS_STATUS_NO_MEMORY;
+		lock->slots = (struct os_thread_brlock_slot *)
+			os_thread_slots_allocate(
+				sizeof( struct os_thread_brlock_slot ),
+				&lock->slot_count, &lock->memory );
+		if ( lock->slots )
+		{
+			os_atomic_store_u32( &lock->state, 0u,
+				OS_ATOMIC_RELAXED );
+			lock->writer_preference = writer_preference;
+			result = os_thread_adaptive_mutex_create(
+				&lock->write_lock );
+		}
+	}
+	return result;
+}
+
+os_status_t os_thread_brlock_destroy(
+	os_thread_brlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_thread_adaptive_mutex_destroy( &lock->write_lock );
+		os_free_null( (void **)&lock->memory );
+		lock->slots = NULL;
+		lock->slot_count = 0u;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_brlock_read_lock(
+	os_thread_brlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && lock->slots )
+	{
+		struct os_thread_brlock_slot *const slot = &lock->slots[
+			os_thread_slot_index( lock->slot_count )];
+		/* a waiting writer only blocks readers with writer preference */
+		const os_uint32_t blocked = lock->writer_preference ? 1u : 2u;
+		os_uint32_t state;
+
+		/* announce the reader, then check for a writer: a writer sets
+		 * its state before checking the counters, so one of the two
+		 * always sees the other */
+		os_atomic_fetch_add_u32( &slot->readers, 1u,
+			OS_ATOMIC_SEQ_CST );
+		state = os_atomic_load_u32( &lock->state, OS_ATOMIC_SEQ_CST );
+		while ( state >= blocked )
+		{
+			os_thread_brlock_slot_leave( lock, slot );
+			while ( state >= blocked )
+			{
+				os_atomic_wait_u32( &lock->state, state, NULL );
+				state = os_atomic_load_u32( &lock->state,
+					OS_ATOMIC_SEQ_CST );
+			}
+			os_atomic_fetch_add_u32( &slot->readers, 1u,
+				OS_ATOMIC_SEQ_CST );
+			state = os_atomic_load_u32( &lock->state,
+				OS_ATOMIC_SEQ_CST );
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_brlock_read_unlock(
+	os_thread_brlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && lock->slots )
+	{
+		os_thread_brlock_slot_leave( lock, &lock->slots[
+			os_thread_slot_index( lock->slot_count )] );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_thread_brlock_slot_leave(
+	os_thread_brlock_t *lock,
+	struct os_thread_brlock_slot *slot )
+{
+	/* the last reader on a counter wakes a writer waiting for it */
+	if ( os_atomic_fetch_add_u32( &slot->readers, (os_uint32_t)-1,
+		OS_ATOMIC_SEQ_CST ) == 1u &&
+		os_atomic_load_u32( &lock->state, OS_ATOMIC_SEQ_CST ) != 0u )
+		os_atomic_wake_u32( &slot->readers, OS_TRUE );
+}
+
+void os_thread_brlock_wait_readers(
+	os_thread_brlock_t *lock )
+{
+	os_uint32_t i;
+	for ( i = 0u; i < lock->slot_count; ++i )
+	{
+		os_atomic_uint32_t *const readers = &lock->slots[i].readers;
+		os_uint32_t count = os_atomic_load_u32( readers,
+			OS_ATOMIC_SEQ_CST );
+		while ( count != 0u )
+		{
+			os_atomic_wait_u32( readers, count, NULL );
+			count = os_atomic_load_u32( readers,
+				OS_ATOMIC_SEQ_CST );
+		}
+	}
+}
+
+os_status_t os_thread_brlock_write_lock(
+	os_thread_brlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && lock->slots )
+	{
+		os_thread_adaptive_mutex_lock( &lock->write_lock );
+		if ( lock->writer_preference != OS_FALSE )
+		{
+			/* new readers wait, so only existing readers drain */
+			os_atomic_store_u32( &lock->state, 2u,
+				OS_ATOMIC_SEQ_CST );
+			os_thread_brlock_wait_readers( lock );
+		}
+		else
+		{
+			os_bool_t has_readers;
+			do
+			{
+				os_uint32_t i;
+
+				/* let readers in until none are left, then
+				 * block new readers and check no reader
+				 * arrived in between */
+				if ( os_atomic_exchange_u32( &lock->state, 1u,
+					OS_ATOMIC_SEQ_CST ) == 2u )
+					os_atomic_wake_u32( &lock->state,
+						OS_TRUE );
+				os_thread_brlock_wait_readers( lock );
+				os_atomic_store_u32( &lock->state, 2u,
+					OS_ATOMIC_SEQ_CST );
+				has_readers = OS_FALSE;
+				for ( i = 0u; i < lock->slot_count &&
+					has_readers == OS_FALSE; ++i )
+					if ( os_atomic_load_u32(
+						&lock->slots[i].readers,
+						OS_ATOMIC_SEQ_CST ) != 0u )
+						has_readers = OS_TRUE;
+			} while ( has_readers != OS_FALSE );
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_brlock_write_unlock(
+	os_thread_brlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock && lock->slots )
+	{
+		os_atomic_store_u32( &lock->state, 0u, OS_ATOMIC_SEQ_CST );
+		os_atomic_wake_u32( &lock->state, OS_TRUE );
+		os_thread_adaptive_mutex_unlock( &lock->write_lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_thread_cpu_relax( void )
+{
+#if defined( _MSC_VER )
+	YieldProcessor();
+#elif defined( __i386__ ) || defined( __x86_64__ )
+	__builtin_ia32_pause();
+#elif defined( __aarch64__ ) || ( defined( __ARM_ARCH ) && __ARM_ARCH >= 7 )
+	__asm__ __volatile__( "yield" ::: "memory" );
+#elif defined( __GNUC__ )
+	__asm__ __volatile__( "" ::: "memory" );
+#endif
+}
+
+os_status_t os_thread_event_create(
+	os_thread_event_t *event,
+	os_bool_t manual_reset )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( event )
+	{
+		event->manual_reset = manual_reset;
+		os_atomic_store_u32( &event->waiters, 0u, OS_ATOMIC_RELAXED );
+		os_atomic_store_u32( &event->state, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_event_destroy(
+	os_thread_event_t *event )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( event )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_event_reset(
+	os_thread_event_t *event )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( event )
+	{
+		os_atomic_store_u32( &event->state, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_event_set(
+	os_thread_event_t *event )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( event )
+	{
+		/* the store & load must not be reordered (waiters do the
+		 * opposite) so a thread going to sleep is never missed */
+		os_atomic_store_u32( &event->state, 1u, OS_ATOMIC_SEQ_CST );
+		if ( os_atomic_load_u32( &event->waiters,
+			OS_ATOMIC_SEQ_CST ) != 0u )
+			os_atomic_wake_u32( &event->state,
+				event->manual_reset );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_bool_t os_thread_event_take(
+	os_thread_event_t *event )
+{
+	os_bool_t result = OS_FALSE;
+	if ( os_atomic_load_u32( &event->state, OS_ATOMIC_SEQ_CST ) != 0u )
+	{
+		os_uint32_t expected = 1u;
+		result = OS_TRUE;
+		if ( event->manual_reset == OS_FALSE )
+			result = os_atomic_cas_u32( &event->state, &expected,
+				0u, OS_ATOMIC_SEQ_CST );
+	}
+	return result;
+}
+
+os_status_t os_thread_event_timed_wait(
+	os_thread_event_t *event,
+	os_millisecond_t max_time_out )
+{
+	return os_thread_event_wait_internal( event, NULL, max_time_out );
+}
+
+os_status_t os_thread_event_wait(
+	os_thread_event_t *event )
+{
+	return os_thread_event_wait_internal( event, NULL, 0u );
+}
+
+os_status_t os_thread_event_wait_internal(
+	os_thread_event_t *event,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( event )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( os_thread_event_take( event ) == OS_FALSE )
+		{
+			os_timestamp_t time_out;
+			deadline = os_thread_deadline( deadline, max_time_out,
+				&time_out );
+			os_atomic_fetch_add_u32( &event->waiters, 1u,
+				OS_ATOMIC_SEQ_CST );
+			while ( result == OS_STATUS_SUCCESS &&
+				os_thread_event_take( event ) == OS_FALSE )
+				result = os_atomic_wait_u32( &event->state, 0u,
+					deadline );
+			os_atomic_fetch_add_u32( &event->waiters,
+				(os_uint32_t)-1, OS_ATOMIC_SEQ_CST );
+		}
+	}
+	return result;
+}
+
+os_status_t os_thread_event_wait_until(
+	os_thread_event_t *event,
+	os_timestamp_t deadline )
+{
+	return os_thread_event_wait_internal( event, &deadline, 0u );
+}
+
+os_status_t os_thread_latch_count_down(
+	os_thread_latch_t *latch )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( latch )
+	{
+		os_uint32_t count = os_atomic_load_u32( &latch->count,
+			OS_ATOMIC_RELAXED );
+		while ( count > 0u && os_atomic_cas_u32( &latch->count, &count,
+			count - 1u, OS_ATOMIC_ACQ_REL ) == OS_FALSE )
+			continue;
+		result = OS_STATUS_OUT_OF_RANGE;
+		if ( count > 0u )
+		{
+			if ( count == 1u )
+				os_atomic_wake_u32( &latch->count, OS_TRUE );
+			result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+os_status_t os_thread_latch_create(
+	os_thread_latch_t *latch,
+	os_uint32_t count )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( latch )
+	{
+		os_atomic_store_u32( &latch->count, count, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_latch_destroy(
+	os_thread_latch_t *latch )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( latch )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_latch_timed_wait(
+	os_thread_latch_t *latch,
+	os_millisecond_t max_time_out )
+{
+	return os_thread_latch_wait_internal( latch, NULL, max_time_out );
+}
+
+os_status_t os_thread_latch_try_wait(
+	os_thread_latch_t *latch )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( latch )
+	{
+		result = OS_STATUS_TRY_AGAIN;
+		if ( os_atomic_load_u32( &latch->count,
+			OS_ATOMIC_ACQUIRE ) == 0u )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_latch_wait(
+	os_thread_latch_t *latch )
+{
+	return os_thread_latch_wait_internal( latch, NULL, 0u );
+}
+
+os_status_t os_thread_latch_wait_internal(
+	os_thread_latch_t *latch,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( latch )
+	{
+		os_uint32_t count = os_atomic_load_u32( &latch->count,
+			OS_ATOMIC_ACQUIRE );
+		result = OS_STATUS_SUCCESS;
+		if ( count > 0u )
+		{
+			os_timestamp_t time_out;
+			deadline = os_thread_deadline( deadline, max_time_out,
+				&time_out );
+			while ( result == OS_STATUS_SUCCESS && count > 0u )
+			{
+				result = os_atomic_wait_u32( &latch->count, count,
+					deadline );
+				count = os_atomic_load_u32( &latch->count,
+					OS_ATOMIC_ACQUIRE );
+			}
+			/* reaching zero as the time out expires is a success */
+			if ( count == 0u )
+				result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+os_status_t os_thread_latch_wait_until(
+	os_thread_latch_t *latch,
+	os_timestamp_t deadline )
+{
+	return os_thread_latch_wait_internal( latch, &deadline, 0u );
+}
+
+os_status_t os_thread_once(
+	os_thread_once_t *once,
+	os_thread_once_func_t fn,
+	void *arg )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( once && fn )
+	{
+		/* after the first call, only this load is needed */
+		os_uint32_t state = os_atomic_load_u32( once,
+			OS_ATOMIC_ACQUIRE );
+		if ( state != OS_THREAD_ONCE_DONE )
+		{
+			state = OS_THREAD_ONCE_INIT;
+			if ( os_atomic_cas_u32( once, &state,
+				OS_THREAD_ONCE_RUNNING, OS_ATOMIC_ACQUIRE ) !=
+				OS_FALSE )
+			{
+				fn( arg );
+				if ( os_atomic_exchange_u32( once, OS_THREAD_ONCE_DONE,
+					OS_ATOMIC_ACQ_REL ) == OS_THREAD_ONCE_WAITING )
+					os_atomic_wake_u32( once, OS_TRUE );
+			}
+			else
+			{
+				/* let the running thread know it must wake us */
+				while ( state != OS_THREAD_ONCE_DONE )
+				{
+					if ( state == OS_THREAD_ONCE_WAITING ||
+						os_atomic_cas_u32( once, &state,
+							OS_THREAD_ONCE_WAITING,
+							OS_ATOMIC_ACQUIRE ) != OS_FALSE )
+					{
+						os_atomic_wait_u32( once,
+							OS_THREAD_ONCE_WAITING, NULL );
+						state = os_atomic_load_u32( once,
+							OS_ATOMIC_ACQUIRE );
+					}
+				}
+			}
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_semaphore_create(
+	os_thread_semaphore_t *sem,
+	os_uint32_t initial_count )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( sem )
+	{
+		os_atomic_store_u32( &sem->waiters, 0u, OS_ATOMIC_RELAXED );
+		os_atomic_store_u32( &sem->count, initial_count,
+			OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_semaphore_destroy(
+	os_thread_semaphore_t *sem )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( sem )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_semaphore_post(
+	os_thread_semaphore_t *sem )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( sem )
+	{
+		os_atomic_fetch_add_u32( &sem->count, 1u, OS_ATOMIC_SEQ_CST );
+		if ( os_atomic_load_u32( &sem->waiters,
+			OS_ATOMIC_SEQ_CST ) != 0u )
+			os_atomic_wake_u32( &sem->count, OS_FALSE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_bool_t os_thread_semaphore_take(
+	os_thread_semaphore_t *sem )
+{
+	os_uint32_t count = os_atomic_load_u32( &sem->count,
+		OS_ATOMIC_SEQ_CST );
+	while ( count > 0u && os_atomic_cas_u32( &sem->count, &count,
+		count - 1u, OS_ATOMIC_SEQ_CST ) == OS_FALSE )
+		continue;
+	return count > 0u;
+}
+
+os_status_t os_thread_semaphore_timed_wait(
+	os_thread_semaphore_t *sem,
+	os_millisecond_t max_time_out )
+{
+	return os_thread_semaphore_wait_internal( sem, NULL, max_time_out );
+}
+
+os_status_t os_thread_semaphore_try_wait(
+	os_thread_semaphore_t *sem )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( sem )
+	{
+		result = OS_STATUS_TRY_AGAIN;
+		if ( os_thread_semaphore_take( sem ) != OS_FALSE )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_semaphore_wait(
+	os_thread_semaphore_t *sem )
+{
+	return os_thread_semaphore_wait_internal( sem, NULL, 0u );
+}
+
+os_status_t os_thread_semaphore_wait_internal(
+	os_thread_semaphore_t *sem,
+	const os_timestamp_t *deadline,
+	os_millisecond_t max_time_out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( sem )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( os_thread_semaphore_take( sem ) == OS_FALSE )
+		{
+			os_timestamp_t time_out;
+			deadline = os_thread_deadline( deadline, max_time_out,
+				&time_out );
+			os_atomic_fetch_add_u32( &sem->waiters, 1u,
+				OS_ATOMIC_SEQ_CST );
+			while ( result == OS_STATUS_SUCCESS &&
+				os_thread_semaphore_take( sem ) == OS_FALSE )
+				result = os_atomic_wait_u32( &sem->count, 0u,
+					deadline );
+			os_atomic_fetch_add_u32( &sem->waiters,
+				(os_uint32_t)-1, OS_ATOMIC_SEQ_CST );
+		}
+	}
+	return result;
+}
+
+os_status_t os_thread_semaphore_wait_until(
+	os_thread_semaphore_t *sem,
+	os_timestamp_t deadline )
+{
+	return os_thread_semaphore_wait_internal( sem, &deadline, 0u );
+}
+
+os_uint32_t os_thread_slot_index(
+	os_uint32_t slot_count )
+{
+	while ( OS_THREAD_SLOT_ID == 0u )
+		OS_THREAD_SLOT_ID = os_atomic_fetch_add_u32(
+			&OS_THREAD_SLOT_NEXT_ID, 1u, OS_ATOMIC_RELAXED ) + 1u;
+	return ( OS_THREAD_SLOT_ID - 1u ) & ( slot_count - 1u );
+}
+
+void *os_thread_slots_allocate(
+	size_t slot_size,
+	os_uint32_t *slot_count,
+	void **memory )
+{
+	void *result = NULL;
+	const unsigned int cpu_count = os_system_cpu_count();
+	os_uint32_t count = 1u;
+
+	while ( count < cpu_count )
+		count <<= 1;
+	*memory = os_malloc( count * slot_size + OS_CACHE_LINE_SIZE );
+	if ( *memory )
+	{
+		char *const start = (char *)*memory;
+		const size_t offset = ( OS_CACHE_LINE_SIZE -
+			(size_t)start % OS_CACHE_LINE_SIZE ) % OS_CACHE_LINE_SIZE;
+
+		result = start + offset;
+		os_memzero( result, count * slot_size );
+		*slot_count = count;
+	}
+	return result;
+}
+
+os_status_t os_thread_spinlock_create(
+	os_thread_spinlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_atomic_store_u32( &lock->locked, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_spinlock_destroy(
+	os_thread_spinlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_spinlock_lock(
+	os_thread_spinlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		/* test-and-test-and-set: only attempt the (cache line
+		 * invalidating) exchange once the lock is seen free */
+		while ( os_atomic_exchange_u32( &lock->locked, 1u,
+			OS_ATOMIC_ACQUIRE ) != 0u )
+		{
+			unsigned int backoff = 1u;
+			unsigned int rounds = 0u;
+			while ( os_atomic_load_u32( &lock->locked,
+				OS_ATOMIC_RELAXED ) != 0u )
+			{
+				unsigned int i;
+				for ( i = 0u; i < backoff; ++i )
+					os_thread_cpu_relax();
+				if ( backoff < OS_THREAD_SPIN_BACKOFF_MAX )
+					backoff *= 2u;
+				else if ( ++rounds >= OS_THREAD_SPIN_YIELD_COUNT )
+				{
+					os_thread_yield();
+					rounds = 0u;
+				}
+			}
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_spinlock_try_lock(
+	os_thread_spinlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		result = OS_STATUS_TRY_AGAIN;
+		if ( os_atomic_load_u32( &lock->locked,
+			OS_ATOMIC_RELAXED ) == 0u &&
+			os_atomic_exchange_u32( &lock->locked, 1u,
+				OS_ATOMIC_ACQUIRE ) == 0u )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_spinlock_unlock(
+	os_thread_spinlock_t *lock )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( lock )
+	{
+		os_atomic_store_u32( &lock->locked, 0u, OS_ATOMIC_RELEASE );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_timer_add(
+	os_timer_service_t *service,
+	os_timer_t *timer )
+{
+	os_timestamp_t expiry = timer->expiry;
+	os_timestamp_t delta = 0u;
+	unsigned int level = 0u;
+	os_timer_t **slot;
+
+	/* expired timers are run on the next tick processed */
+	if ( expiry < service->current )
+		expiry = service->current;
+	delta = expiry - service->current;
+
+	/* timers beyond the range of the wheel wait in the last slot of the
+	 * top level, and are placed again each time it is reached */
+	if ( delta >> ( OS_TIMER_WHEEL_BITS * OS_TIMER_WHEEL_LEVELS ) )
+	{
+		delta = ( (os_timestamp_t)1u << ( OS_TIMER_WHEEL_BITS *
+			OS_TIMER_WHEEL_LEVELS ) ) - 1u;
+		expiry = service->current + delta;
+	}
+	while ( delta >> ( OS_TIMER_WHEEL_BITS * ( level + 1u ) ) )
+		++level;
+
+	slot = &service->wheel[level][( expiry >>
+		( OS_TIMER_WHEEL_BITS * level ) ) &
+		( OS_TIMER_WHEEL_SLOTS - 1u )];
+	timer->next = *slot;
+	if ( timer->next )
+		timer->next->prev = &timer->next;
+	timer->prev = slot;
+	*slot = timer;
+	timer->service = service;
+	++service->count;
+}
+
+os_status_t os_timer_create(
+	os_timer_t *timer,
+	os_timer_callback_t callback,
+	void *user_data )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( timer && callback )
+	{
+		os_memzero( timer, sizeof( os_timer_t ) );
+		timer->callback = callback;
+		timer->user_data = user_data;
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_timer_destroy(
+	os_timer_t *timer )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( timer )
+	{
+		os_timer_stop( timer );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+void os_timer_remove(
+	os_timer_t *timer )
+{
+	*timer->prev = timer->next;
+	if ( timer->next )
+		timer->next->prev = timer->prev;
+	timer->next = NULL;
+	timer->prev = NULL;
+	--timer->service->count;
+	timer->service = NULL;
+}
+
+os_uint32_t os_timer_service_cascade(
+	os_timer_service_t *service,
+	unsigned int level )
+{
+	const os_uint32_t index = (os_uint32_t)( ( service->current >>
+		( OS_TIMER_WHEEL_BITS * level ) ) &
+		( OS_TIMER_WHEEL_SLOTS - 1u ) );
+	os_timer_t *timer = service->wheel[level][index];
+
+	service->wheel[level][index] = NULL;
+	while ( timer )
+	{
+		os_timer_t *const next = timer->next;
+		--service->count;
+		os_timer_add( service, timer );
+		timer = next;
+	}
+	return index;
+}
+
+os_status_t os_timer_service_create(
+	os_timer_service_t *service )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service )
+	{
+		os_memzero( service, sizeof( os_timer_service_t ) );
+		os_time_monotonic( &service->current );
+		result = os_thread_mutex_create( &service->lock );
+		if ( result == OS_STATUS_SUCCESS )
+		{
+			result = os_thread_event_create( &service->wake_up,
+				OS_FALSE );
+			if ( result != OS_STATUS_SUCCESS )
+				os_thread_mutex_destroy( &service->lock );
+		}
+	}
+	return result;
+}
+
+os_status_t os_timer_service_destroy(
+	os_timer_service_t *service )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service )
+	{
+		unsigned int level;
+
+		os_timer_service_stop( service );
+		os_thread_mutex_lock( &service->lock );
+		for ( level = 0u; level < OS_TIMER_WHEEL_LEVELS; ++level )
+		{
+			unsigned int i;
+			for ( i = 0u; i < OS_TIMER_WHEEL_SLOTS; ++i )
+				while ( service->wheel[level][i] )
+					os_timer_remove(
+						service->wheel[level][i] );
+		}
+		os_thread_mutex_unlock( &service->lock );
+		os_thread_event_destroy( &service->wake_up );
+		os_thread_mutex_destroy( &service->lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+OS_THREAD_DECL os_timer_service_main(
+	void *arg )
+{
+	os_timer_service_t *const service = (os_timer_service_t *)arg;
+	os_bool_t running = OS_TRUE;
+
+	while ( running != OS_FALSE )
+	{
+		os_timestamp_t expiry = 0u;
+		os_bool_t has_timer;
+
+		os_timer_service_poll( service );
+
+		/* sleep until the next timer, timers started meanwhile that
+		 * expire earlier wake the thread up */
+		os_thread_mutex_lock( &service->lock );
+		has_timer = os_timer_service_next( service, &expiry );
+		service->sleep_until = (os_timestamp_t)-1;
+		if ( has_timer != OS_FALSE )
+			service->sleep_until = expiry;
+		running = service->running;
+		os_thread_mutex_unlock( &service->lock );
+
+		if ( running != OS_FALSE && has_timer != OS_FALSE )
+			os_thread_event_wait_until( &service->wake_up,
+				expiry );
+		else if ( running != OS_FALSE )
+			os_thread_event_wait( &service->wake_up );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+os_bool_t os_timer_service_next(
+	const os_timer_service_t *service,
+	os_timestamp_t *expiry )
+{
+	os_bool_t result = OS_FALSE;
+	if ( service->count > 0u )
+	{
+		unsigned int level;
+		for ( level = 0u; level < OS_TIMER_WHEEL_LEVELS; ++level )
+		{
+			/* slots of higher levels are only reached once their
+			 * index comes round again */
+			const unsigned int shift = OS_TIMER_WHEEL_BITS * level;
+			os_timestamp_t tick = ( service->current >> shift );
+			os_timestamp_t last = tick + OS_TIMER_WHEEL_SLOTS;
+
+			if ( level == 0u )
+				--last;
+			else
+				++tick;
+			for ( ; tick <= last; ++tick )
+			{
+				if ( service->wheel[level][tick &
+					( OS_TIMER_WHEEL_SLOTS - 1u )] )
+				{
+					os_timestamp_t time = tick << shift;
+					if ( time < service->current )
+						time = service->current;
+					if ( result == OS_FALSE ||
+						time < *expiry )
+						*expiry = time;
+					result = OS_TRUE;
+					break;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+os_status_t os_timer_service_next_expiry(
+	os_timer_service_t *service,
+	os_timestamp_t *expiry )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service && expiry )
+	{
+		os_thread_mutex_lock( &service->lock );
+		result = OS_STATUS_NOT_FOUND;
+		if ( os_timer_service_next( service, expiry ) != OS_FALSE )
+			result = OS_STATUS_SUCCESS;
+		os_thread_mutex_unlock( &service->lock );
+	}
+	return result;
+}
+
+os_status_t os_timer_service_poll(
+	os_timer_service_t *service )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service )
+	{
+		os_timestamp_t now = 0u;
+
+		os_time_monotonic( &now );
+		os_thread_mutex_lock( &service->lock );
+		if ( service->count == 0u && service->current <= now )
+			service->current = now + 1u;
+		while ( service->current <= now )
+		{
+			const os_uint32_t index = (os_uint32_t)(
+				service->current & ( OS_TIMER_WHEEL_SLOTS - 1u ) );
+			os_timer_t *expired;
+
+			/* each time a level wraps, move the timers of the
+			 * next slot of the level above down */
+			if ( index == 0u )
+			{
+				unsigned int level = 1u;
+				while ( level < OS_TIMER_WHEEL_LEVELS &&
+					os_timer_service_cascade( service,
+						level ) == 0u )
+					++level;
+			}
+
+			/* detach the expired timers, the list can still be
+			 * modified by os_timer_stop while a callback runs */
+			expired = service->wheel[0][index];
+			service->wheel[0][index] = NULL;
+			if ( expired )
+				expired->prev = &expired;
+			++service->current;
+
+			while ( expired )
+			{
+				os_timer_t *const timer = expired;
+				const os_timer_callback_t callback =
+					timer->callback;
+				void *const user_data = timer->user_data;
+
+				os_timer_remove( timer );
+				if ( timer->period > 0u )
+				{
+					/* skip periods missed entirely */
+					timer->expiry += timer->period;
+					if ( timer->expiry <= now )
+						timer->expiry =
+							now + timer->period;
+					os_timer_add( service, timer );
+				}
+
+				os_thread_mutex_unlock( &service->lock );
+				callback( timer, user_data );
+				os_thread_mutex_lock( &service->lock );
+			}
+		}
+		os_thread_mutex_unlock( &service->lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_timer_service_start(
+	os_timer_service_t *service )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service )
+	{
+		os_thread_mutex_lock( &service->lock );
+		result = OS_STATUS_SUCCESS;
+		if ( service->running == OS_FALSE )
+		{
+			service->running = OS_TRUE;
+			result = os_thread_create( &service->thread,
+				os_timer_service_main, service, 0u );
+			if ( result != OS_STATUS_SUCCESS )
+				service->running = OS_FALSE;
+		}
+		os_thread_mutex_unlock( &service->lock );
+	}
+	return result;
+}
+
+os_status_t os_timer_service_stop(
+	os_timer_service_t *service )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service )
+	{
+		os_bool_t was_running;
+
+		os_thread_mutex_lock( &service->lock );
+		was_running = service->running;
+		service->running = OS_FALSE;
+		os_thread_mutex_unlock( &service->lock );
+		if ( was_running != OS_FALSE )
+		{
+			os_thread_event_set( &service->wake_up );
+			os_thread_wait( &service->thread );
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_timer_start(
+	os_timer_service_t *service,
+	os_timer_t *timer,
+	os_millisecond_t delay,
+	os_millisecond_t period )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( service && timer && timer->callback )
+	{
+		os_timestamp_t now = 0u;
+		os_bool_t wake_up = OS_FALSE;
+
+		os_timer_stop( timer );
+		os_time_monotonic( &now );
+		os_thread_mutex_lock( &service->lock );
+
+		/* an idle wheel catches up, instead of processing each
+		 * millisecond since it was last used */
+		if ( service->count == 0u && service->current < now )
+			service->current = now;
+		timer->expiry = now + delay;
+		timer->period = period;
+		os_timer_add( service, timer );
+		if ( service->running != OS_FALSE &&
+			timer->expiry < service->sleep_until )
+			wake_up = OS_TRUE;
+		os_thread_mutex_unlock( &service->lock );
+
+		if ( wake_up != OS_FALSE )
+			os_thread_event_set( &service->wake_up );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_timer_stop(
+	os_timer_t *timer )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( timer )
+	{
+		os_timer_service_t *const service = timer->service;
+		result = OS_STATUS_NOT_FOUND;
+		if ( service )
+		{
+			os_thread_mutex_lock( &service->lock );
+			if ( timer->service == service )
+			{
+				os_timer_remove( timer );
+				result = OS_STATUS_SUCCESS;
+			}
+			os_thread_mutex_unlock( &service->lock );
+		}
+	}
+	return result;
+}
+
+os_status_t os_watchdog_check(
+	os_watchdog_t *watchdog )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog )
+	{
+		os_watchdog_entry_t *entry;
+		os_timestamp_t now = 0u;
+
+		os_time_monotonic( &now );
+		os_thread_mutex_lock( &watchdog->lock );
+		for ( entry = watchdog->entries; entry; entry = entry->next )
+		{
+			const os_timestamp_t heartbeat = (os_timestamp_t)
+				os_atomic_load_u64( &entry->heartbeat,
+					OS_ATOMIC_RELAXED );
+
+			/* a new heartbeat ends a stall */
+			if ( heartbeat != entry->checked )
+			{
+				entry->checked = heartbeat;
+				entry->report = heartbeat + entry->threshold;
+			}
+			if ( now > entry->report )
+			{
+				entry->report = now + entry->threshold;
+				watchdog->callback( entry,
+					(os_millisecond_t)( now - heartbeat ),
+					watchdog->user_data );
+			}
+		}
+		os_thread_mutex_unlock( &watchdog->lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_watchdog_create(
+	os_watchdog_t *watchdog,
+	os_watchdog_callback_t callback,
+	void *user_data,
+	os_millisecond_t interval )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog && callback && interval > 0u )
+	{
+		os_memzero( watchdog, sizeof( os_watchdog_t ) );
+		watchdog->callback = callback;
+		watchdog->user_data = user_data;
+		watchdog->interval = interval;
+		result = os_thread_mutex_create( &watchdog->lock );
+		if ( result == OS_STATUS_SUCCESS )
+		{
+			result = os_thread_event_create( &watchdog->wake_up,
+				OS_FALSE );
+			if ( result != OS_STATUS_SUCCESS )
+				os_thread_mutex_destroy( &watchdog->lock );
+		}
+	}
+	return result;
+}
+
+os_status_t os_watchdog_destroy(
+	os_watchdog_t *watchdog )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog )
+	{
+		os_watchdog_stop( watchdog );
+		os_thread_mutex_lock( &watchdog->lock );
+		while ( watchdog->entries )
+		{
+			os_watchdog_entry_t *const entry = watchdog->entries;
+			watchdog->entries = entry->next;
+			entry->next = NULL;
+			entry->prev = NULL;
+			entry->watchdog = NULL;
+		}
+		os_thread_mutex_unlock( &watchdog->lock );
+		os_thread_event_destroy( &watchdog->wake_up );
+		os_thread_mutex_destroy( &watchdog->lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_watchdog_heartbeat(
+	os_watchdog_entry_t *entry )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( entry )
+	{
+		os_timestamp_t now = 0u;
+		os_time_monotonic( &now );
+		os_atomic_store_u64( &entry->heartbeat, now,
+			OS_ATOMIC_RELAXED );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+OS_THREAD_DECL os_watchdog_main(
+	void *arg )
+{
+	os_watchdog_t *const watchdog = (os_watchdog_t *)arg;
+	os_bool_t running = OS_TRUE;
+
+	while ( running != OS_FALSE )
+	{
+		os_timestamp_t next = 0u;
+
+		os_watchdog_check( watchdog );
+		os_time_monotonic( &next );
+		next += watchdog->interval;
+
+		os_thread_mutex_lock( &watchdog->lock );
+		running = watchdog->running;
+		os_thread_mutex_unlock( &watchdog->lock );
+		if ( running != OS_FALSE )
+			os_thread_event_wait_until( &watchdog->wake_up, next );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+os_status_t os_watchdog_register(
+	os_watchdog_t *watchdog,
+	os_watchdog_entry_t *entry,
+	const char *name,
+	os_millisecond_t threshold )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog && entry && threshold > 0u )
+	{
+		os_timestamp_t now = 0u;
+
+		os_time_monotonic( &now );
+		os_atomic_store_u64( &entry->heartbeat, now,
+			OS_ATOMIC_RELAXED );
+		entry->checked = now;
+		entry->report = now + threshold;
+		entry->threshold = threshold;
+		entry->name = name;
+
+		os_thread_mutex_lock( &watchdog->lock );
+		entry->next = watchdog->entries;
+		if ( entry->next )
+			entry->next->prev = &entry->next;
+		entry->prev = &watchdog->entries;
+		watchdog->entries = entry;
+		entry->watchdog = watchdog;
+		os_thread_mutex_unlock( &watchdog->lock );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_watchdog_start(
+	os_watchdog_t *watchdog )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog )
+	{
+		os_thread_mutex_lock( &watchdog->lock );
+		result = OS_STATUS_SUCCESS;
+		if ( watchdog->running == OS_FALSE )
+		{
+			watchdog->running = OS_TRUE;
+			result = os_thread_create( &watchdog->thread,
+				os_watchdog_main, watchdog, 0u );
+			if ( result != OS_STATUS_SUCCESS )
+				watchdog->running = OS_FALSE;
+		}
+		os_thread_mutex_unlock( &watchdog->lock );
+	}
+	return result;
+}
+
+os_status_t os_watchdog_stop(
+	os_watchdog_t *watchdog )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( watchdog )
+	{
+		os_bool_t was_running;
+
+		os_thread_mutex_lock( &watchdog->lock );
+		was_running = watchdog->running;
+		watchdog->running = OS_FALSE;
+		os_thread_mutex_unlock( &watchdog->lock );
+		if ( was_running != OS_FALSE )
+		{
+			os_thread_event_set( &watchdog->wake_up );
+			os_thread_wait( &watchdog->thread );
+		}
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_watchdog_unregister(
+	os_watchdog_entry_t *entry )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( entry )
+	{
+		os_watchdog_t *const watchdog = entry->watchdog;
+		result = OS_STATUS_NOT_FOUND;
+		if ( watchdog )
+		{
+			os_thread_mutex_lock( &watchdog->lock );
+			if ( entry->watchdog == watchdog )
+			{
+				*entry->prev = entry->next;
+				if ( entry->next )
+					entry->next->prev = entry->prev;
+				entry->next = NULL;
+				entry->prev = NULL;
+				entry->watchdog = NULL;
+				result = OS_STATUS_SUCCESS;
+			}
+			os_thread_mutex_unlock( &watchdog->lock );
+		}
+	}
+	return result;
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
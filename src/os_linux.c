@@ -16,6 +16,7 @@
  */
 
 #include "os.h"
+#include "os_posix_private.h"
 
 #include <dirent.h>      /* for closedir */
 #include <dlfcn.h>       /* for dlclose, dlopen, dlsym */
@@ -129,7 +130,8 @@ os_status_t os_directory_delete(
 						size_t buf_size =
 							strlen( path ) +
 							strlen( p->d_name ) + 2u;
-						buf = (char *)malloc( buf_size );
+						buf = (char *)os_malloc_tagged( buf_size,
+							OS_MEMORY_TAG_FILE );
 						if ( buf )
 						{
 							struct stat st;
@@ -165,7 +167,7 @@ os_status_t os_directory_delete(
 							}
 							else
 								result = OS_STATUS_FAILURE;
-							free( buf );
+							os_free( buf );
 						}
 						else
 							result = OS_STATUS_NO_MEMORY;
@@ -287,7 +289,7 @@ os_status_t os_service_run(
 	if ( id && service_function )
 	{
 		int i;
-		char** good_argv = (char**)malloc( (unsigned long)argc * sizeof( char* ) );
+		char** good_argv = (char**)os_malloc( (unsigned long)argc * sizeof( char* ) );
 		result = OS_STATUS_FAILURE;
 		/* remove bad arguments */
 		if ( good_argv )
@@ -322,7 +324,7 @@ os_status_t os_service_run(
 			if ( ( *service_function )( good_argc, good_argv ) == EXIT_SUCCESS )
 				result = OS_STATUS_SUCCESS;
 
-			free( good_argv );
+			os_free( good_argv );
 		}
 	}
 	return result;
@@ -641,13 +643,30 @@ os_status_t os_system_shutdown(
 #if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
 os_status_t os_thread_rwlock_create(
 	os_thread_rwlock_t *lock )
+{
+	return os_thread_rwlock_create_named( lock, NULL );
+}
+
+os_status_t os_thread_rwlock_create_named(
+	os_thread_rwlock_t *lock,
+	const char *name )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( pthread_rwlock_init( lock, NULL ) == 0 )
+		if ( pthread_rwlock_init( OS_THREAD_LOCK_NATIVE( lock ),
+			NULL ) == 0 )
+		{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+			lock->stats = os_lock_stats_register( "rwlock", name,
+				lock );
+			lock->acquired = 0u;
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+			(void)name;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 			result = OS_STATUS_SUCCESS;
+		}
 	}
 	return result;
 }
@@ -658,9 +677,27 @@ os_status_t os_thread_rwlock_read_lock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		int error_number = pthread_rwlock_tryrdlock( &lock->lock );
+		if ( error_number == EBUSY )
+		{
+			start = os_lock_stats_now();
+			error_number = pthread_rwlock_rdlock( &lock->lock );
+		}
+		result = OS_STATUS_FAILURE;
+		if ( error_number == 0 )
+		{
+			/* readers share the lock, so only waiting is timed */
+			os_lock_stats_acquired( lock->stats, start,
+				start != 0u ? os_lock_stats_now() : 0u );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( pthread_rwlock_rdlock( lock ) == 0 )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 	return result;
 }
@@ -672,7 +709,7 @@ os_status_t os_thread_rwlock_read_unlock(
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( pthread_rwlock_unlock( lock ) == 0 )
+		if ( pthread_rwlock_unlock( OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
 			result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -684,9 +721,27 @@ os_status_t os_thread_rwlock_write_lock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		int error_number = pthread_rwlock_trywrlock( &lock->lock );
+		if ( error_number == EBUSY )
+		{
+			start = os_lock_stats_now();
+			error_number = pthread_rwlock_wrlock( &lock->lock );
+		}
+		result = OS_STATUS_FAILURE;
+		if ( error_number == 0 )
+		{
+			lock->acquired = os_lock_stats_now();
+			os_lock_stats_acquired( lock->stats, start,
+				lock->acquired );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( pthread_rwlock_wrlock( lock ) == 0 )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 	return result;
 }
@@ -697,9 +752,20 @@ os_status_t os_thread_rwlock_write_unlock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		/* measured before another thread can acquire the lock */
+		const os_uint64_t hold = os_lock_stats_now() - lock->acquired;
+		result = OS_STATUS_FAILURE;
+		if ( pthread_rwlock_unlock( &lock->lock ) == 0 )
+		{
+			os_lock_stats_released( lock->stats, hold );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( pthread_rwlock_unlock( lock ) == 0 )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 	return result;
 }
@@ -711,8 +777,14 @@ os_status_t os_thread_rwlock_destroy(
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( pthread_rwlock_destroy( lock ) == 0 )
+		if ( pthread_rwlock_destroy( OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
+		{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+			os_lock_stats_unregister( lock->stats );
+			lock->stats = NULL;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 			result = OS_STATUS_SUCCESS;
+		}
 	}
 	return result;
 }
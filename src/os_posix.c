@@ -15,11 +15,17 @@
  * OR CONDITIONS OF ANY KIND, either express or implied."
  */
 
+/* 64-bit file offsets (off_t), even on 32-bit systems */
+#if !defined( _FILE_OFFSET_BITS )
+#	define _FILE_OFFSET_BITS 64
+#endif /* if !defined( _FILE_OFFSET_BITS ) */
+
 #include "os_posix_private.h"
 
 #include <ctype.h>       /* for isalpha, isalnum, isxdigit */
 #include <errno.h>       /* for errno */
 #include <ifaddrs.h>     /* for getifaddrs, freeifaddrs */
+#include <sched.h>       /* for sched_setaffinity, sched_yield */
 #include <stdarg.h>      /* for va_start, va_end, va_list */
 #include <stdlib.h>      /* for getenv */
 #include <stdio.h>       /* for snprintf */
@@ -28,6 +34,7 @@
 #include <net/if.h>      /* for if_nametoindex */
 #include <netinet/in.h>  /* for AF_LINK (apple) */
 #include <sys/ioctl.h>   /* for ioctl */
+#include <sys/mman.h>    /* for mmap, mlock, mprotect, munmap */
 #include <sys/socket.h>  /* for setsockopt + AF_LINK (freebsd) */
 #include <sys/stat.h>    /* for lstat */
 #include <sys/time.h>    /* for gettimeofday */
@@ -35,7 +42,14 @@
 #include <sys/utsname.h> /* for struct utsname */
 
 #if defined( __linux__ )
+#	include <linux/futex.h>     /* for FUTEX_WAIT_BITSET_PRIVATE */
 #	include <linux/if_packet.h> /* for sockaddr_ll */
+#	include <sys/epoll.h>       /* for epoll_create1, epoll_ctl, epoll_wait */
+#	include <sys/sendfile.h>    /* for sendfile */
+#	include <sys/syscall.h>     /* for SYS_copy_file_range, SYS_futex */
+#	if !defined( __ANDROID__ ) && !defined( __x86_64__ )
+#		include <ucontext.h>    /* for makecontext, swapcontext */
+#	endif /* if !defined( __ANDROID__ ) && !defined( __x86_64__ ) */
 #elif defined( __VXWORKS__ )
 #	include <net/if_ll.h>       /* for sockaddr_ll */
 #elif defined( __APPLE__ )
@@ -80,7 +94,417 @@ typedef u_short in_port_t;
  */
 #define LOOP_WAIT_TIME                 100u
 
+#if !defined( MAP_ANONYMOUS ) && defined( MAP_ANON )
+/** @brief Maps memory not backed by a file (older name on some systems) */
+#	define MAP_ANONYMOUS MAP_ANON
+#endif /* if !defined( MAP_ANONYMOUS ) && defined( MAP_ANON ) */
+
+/**
+ * @brief Size of a huge page, large allocations of at least this size are
+ *        rounded up to a multiple of it and aligned to it
+ */
+#define OS_MEMORY_HUGE_PAGE_SIZE       0x200000u
+
+/** @brief Size of the buffer used to copy files that the system cannot */
+#define OS_FILE_COPY_BUFFER_SIZE       0x100000u
+
+/** @brief Largest number of bytes the system is asked to copy at once */
+#define OS_FILE_COPY_CHUNK_SIZE        0x40000000u
+
+/** @brief Files are copied within the kernel (copy_file_range) */
+#define OS_FILE_COPY_METHOD_RANGE      0u
+/** @brief Files are copied by sending one to the other (sendfile) */
+#define OS_FILE_COPY_METHOD_SENDFILE   1u
+/** @brief Files are copied by reading into a buffer and writing it */
+#define OS_FILE_COPY_METHOD_BUFFER     2u
+
+#if defined( SYS_copy_file_range )
+/** @brief Fastest method to try first when copying files */
+#	define OS_FILE_COPY_METHOD_FIRST OS_FILE_COPY_METHOD_RANGE
+#else /* if defined( SYS_copy_file_range ) */
+/** @brief Fastest method to try first when copying files (copy_file_range
+ *         is not known to the system headers) */
+#	define OS_FILE_COPY_METHOD_FIRST OS_FILE_COPY_METHOD_SENDFILE
+#endif /* else if defined( SYS_copy_file_range ) */
+
+#if !defined( IOV_MAX )
+/** @brief Largest number of buffers a vectored operation takes at once */
+#	define IOV_MAX                 16
+#endif /* if !defined( IOV_MAX ) */
+
+#if defined( __linux__ ) && !defined( FICLONE )
+/** @brief Shares the contents of a file with another (reflink) */
+#	define FICLONE                 _IOW( 0x94, 9, int )
+#endif /* if defined( __linux__ ) && !defined( FICLONE ) */
+
+#if defined( __APPLE__ )
+/** @brief Time of last access of a file, from its status */
+#	define OS_STAT_ATIME(s)        ( (s).st_atimespec )
+/** @brief Time of last modification of a file, from its status */
+#	define OS_STAT_MTIME(s)        ( (s).st_mtimespec )
+#else /* if defined( __APPLE__ ) */
+/** @brief Time of last access of a file, from its status */
+#	define OS_STAT_ATIME(s)        ( (s).st_atim )
+/** @brief Time of last modification of a file, from its status */
+#	define OS_STAT_MTIME(s)        ( (s).st_mtim )
+#endif /* else if defined( __APPLE__ ) */
+
+/** @brief Number of entries a directory copy list grows by at once */
+#define OS_DIRECTORY_COPY_GROW         64u
+
+/** @brief Entry found while walking a directory being copied */
+struct os_directory_copy_entry
+{
+	/** @brief Path of the entry, relative to the directory copied */
+	const char *path;
+	/** @brief Size of the entry in bytes */
+	os_uint64_t size;
+	/** @brief Permissions of the entry */
+	mode_t mode;
+	/** @brief Time of last access and modification of the entry */
+	struct timespec times[2];
+};
+
+/** @brief List of entries found while walking a directory being copied */
+struct os_directory_copy_list
+{
+	/** @brief Entries in the list */
+	struct os_directory_copy_entry *entry;
+	/** @brief Number of entries in the list */
+	size_t count;
+	/** @brief Number of entries the list has room for */
+	size_t max;
+};
+
+/** @brief State shared by the threads copying a directory */
+struct os_directory_copy
+{
+	/** @brief Arena holding the paths of all entries */
+	os_arena_t arena;
+	/** @brief Directories created, parents before their children */
+	struct os_directory_copy_list dirs;
+	/** @brief Files to copy */
+	struct os_directory_copy_list files;
+	/** @brief Directory being copied */
+	int fd_from;
+	/** @brief Directory being copied to */
+	int fd_to;
+	/** @brief Device of the directory copied to, skipped when found within
+	 *         the directory copied */
+	dev_t dev_to;
+	/** @brief Inode of the directory copied to, skipped when found within
+	 *         the directory copied */
+	ino_t ino_to;
+	/** @brief Options for each file copied (OS_FILE_COPY_*) */
+	unsigned int flags;
+	/** @brief Options for the copy */
+	const os_directory_copy_options_t *options;
+	/** @brief Index of the next file to copy */
+	os_atomic_uint64_t next;
+	/** @brief Whether copying a file failed */
+	os_atomic_uint32_t failed;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	/** @brief Lock protecting the progress of the copy */
+	os_thread_mutex_t lock;
+	/** @brief Whether the lock was created (several threads copy files) */
+	os_bool_t locked;
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	/** @brief Number of files copied */
+	os_uint64_t files_done;
+	/** @brief Number of bytes copied */
+	os_uint64_t bytes_done;
+	/** @brief Number of bytes to copy */
+	os_uint64_t bytes_total;
+};
+
+/**
+ * @brief Allocates aligned memory from the system allocator
+ *
+ * @param[in]      alignment           alignment, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_aligned_alloc( size_t alignment,
+	size_t size, void *user_data );
+
+/**
+ * @brief Allocates zeroed memory from the system allocator
+ *
+ * @param[in]      nmemb               number of elements
+ * @param[in]      size                size of each element in bytes
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_calloc( size_t nmemb, size_t size,
+	void *user_data );
+
+/**
+ * @brief Frees memory to the system allocator
+ *
+ * @param[in]      ptr                 memory to free
+ * @param[in]      user_data           not used
+ */
+static void os_allocator_system_free( void *ptr, void *user_data );
+
+/**
+ * @brief Allocates memory from the system allocator
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_malloc( size_t size, void *user_data );
+
+/**
+ * @brief Changes the size of memory from the system allocator
+ *
+ * @param[in]      ptr                 previously allocated memory (optional)
+ * @param[in]      size                new size of the memory
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_realloc( void *ptr, size_t size,
+	void *user_data );
+
+/** @brief Allocator of the operating system */
+static const os_allocator_t OS_ALLOCATOR_SYSTEM = {
+	os_allocator_system_malloc,
+	os_allocator_system_calloc,
+	os_allocator_system_realloc,
+	os_allocator_system_free,
+	os_allocator_system_aligned_alloc,
+	NULL
+};
+
+/**
+ * @brief Returns the size of the memory mapped for a large allocation
+ *
+ * @param[in]      size                amount of memory requested
+ *
+ * @return the size rounded up to whole pages, or whole huge pages for
+ *         sizes of at least a huge page (0 if too large)
+ */
+static size_t os_memory_large_size( size_t size );
+
+/**
+ * @brief Adds an entry to a list of entries of a directory being copied
+ *
+ * @param[in,out]  list                list to add the entry to
+ * @param[in]      path                path of the entry
+ * @param[in]      s                   information about the entry
+ *
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_add(
+	struct os_directory_copy_list *list, const char *path,
+	const struct stat *s );
+
+/**
+ * @brief Copies files of a directory until there are none left
+ *
+ * @param[in,out]  copy                directory copy in progress
+ */
+static void os_directory_copy_files( struct os_directory_copy *copy );
+
+/**
+ * @brief Recreates a symbolic link found in a directory being copied
+ *
+ * @param[in]      copy                directory copy in progress
+ * @param[in]      fd                  directory containing the link
+ * @param[in]      name                name of the link within @p fd
+ * @param[in]      path                path of the link, relative to the
+ *                                     directory copied
+ * @param[in]      s                   information about the link
+ *
+ * @retval OS_STATUS_FAILURE           failed to recreate the link
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_link(
+	struct os_directory_copy *copy, int fd, const char *name,
+	const char *path, const struct stat *s );
+
+/**
+ * @brief Walks a directory being copied, creating its subdirectories and
+ *        links and listing its files
+ *
+ * @param[in,out]  copy                directory copy in progress
+ * @param[in]      path                directory to walk, relative to the
+ *                                     directory copied
+ *
+ * @retval OS_STATUS_FAILURE           failed to read or create an entry
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_scan(
+	struct os_directory_copy *copy, const char *path );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/**
+ * @brief Copies files of a directory from a thread of a parallel loop
+ *
+ * @param[in]      begin               unused
+ * @param[in]      end                 unused
+ * @param[in,out]  arg                 directory copy in progress
+ *                                     (struct os_directory_copy)
+ */
+static void os_directory_copy_thread( size_t begin, size_t end, void *arg );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+/**
+ * @brief Copies the contents of an open file to another
+ *
+ * @param[in]      fd_from             file to copy from
+ * @param[in]      from_stat           status of the file to copy from
+ * @param[in]      fd_to               file to copy to, closed on return
+ * @param[in]      flags               options for the copy (OS_FILE_COPY_*)
+ *
+ * @retval OS_STATUS_FAILURE           on failure
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_file_copy_fd( int fd_from,
+	const struct stat *from_stat, int fd_to, unsigned int flags );
+
+/**
+ * @brief Copies a range of a file to the same position in another file
+ *
+ * The copy stops early at the end of the file to copy from.
+ *
+ * @param[in]      fd_from             file to copy from
+ * @param[in]      fd_to               file to copy to
+ * @param[in,out]  offset              start of the range, on return the
+ *                                     position the copy reached
+ * @param[in]      end                 end of the range
+ * @param[in,out]  method              fastest method supported so far
+ *                                     (OS_FILE_COPY_METHOD_*)
+ * @param[in,out]  buffer              buffer for copying, allocated when
+ *                                     first needed
+ *
+ * @retval OS_STATUS_FAILURE           on failure
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_file_copy_range( int fd_from, int fd_to,
+	os_uint64_t *offset, os_uint64_t end, unsigned int *method,
+	char **buffer );
+
+/**
+ * @brief Copies the contents of a file to another, skipping its holes
+ *
+ * The file is copied until its end, as some file systems (procfs, sysfs)
+ * report sizes that are not those of their contents.
+ *
+ * @param[in]      fd_from             file to copy from
+ * @param[in]      fd_to               file to copy to, empty
+ * @param[in]      size                reported size of the file to copy
+ *
+ * @retval OS_STATUS_FAILURE           on failure
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_file_copy_sparse( int fd_from, int fd_to,
+	os_uint64_t size );
+
+/**
+ * @brief Reads or writes buffers at a position in a file, as many at once
+ *        as the system takes
+ *
+ * A buffer only partially transferred by the system is completed on its
+ * own, before the following buffers are passed to the system again.
+ *
+ * @param[in]      stream              open file to read from or write to
+ * @param[in]      vector              buffers to read into or write from
+ * @param[in]      count               number of buffers
+ * @param[in]      offset              position in the file of the operation
+ * @param[out]     total               number of bytes transferred
+ * @param[in]      write               whether the buffers are written
+ *
+ * @retval OS_STATUS_FAILURE           failed to read or write the file
+ * @retval OS_STATUS_SUCCESS           on success (reads stop at the end of
+ *                                     the file)
+ */
+static os_status_t os_file_io_vector( os_file_t stream,
+	const os_file_io_vector_t *vector, size_t count, os_uint64_t offset,
+	size_t *total, os_bool_t write );
+
+/**
+ * @brief Returns the time from a clock that is not affected by changes to the
+ *        system time
+ *
+ * @param[out]     ts                  time stamp output
+ *
+ * @retval         -1                  on failure
+ * @retval         0                   on success
+ */
+static int os_clock_monotonic( struct timespec *ts );
+
+/** @brief Number of CPUs available to the process, once counted */
+static unsigned int OS_SYSTEM_CPU_COUNT = 1u;
+/** @brief Ensures the CPUs available are only counted once */
+static pthread_once_t OS_SYSTEM_CPU_ONCE = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Counts the CPUs available to the process
+ */
+static void os_system_cpu_count_initialize( void );
+
+#if defined( __linux__ )
+/**
+ * @brief Returns the number of CPUs allowed by the CPU quota of the
+ *        control group of the process
+ *
+ * @retval         0                   no CPU quota set
+ * @retval         >0                  CPU quota, rounded up to whole CPUs
+ */
+static unsigned int os_system_cpu_quota( void );
+#endif /* if defined( __linux__ ) */
+
 #if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+#if !defined( __linux__ )
+/**
+ * @brief Number of buckets used to emulate waiting on an address
+ */
+#define OS_ATOMIC_WAIT_BUCKETS         64u
+
+/**
+ * @brief Threads waiting on addresses that hash to the same bucket
+ */
+struct os_atomic_wait_bucket
+{
+	/** @brief Lock protecting the bucket */
+	pthread_mutex_t lock;
+	/** @brief Signalled when a value within the bucket may have changed */
+	pthread_cond_t cond;
+};
+
+/** @brief Table of buckets for threads waiting on an address */
+static struct os_atomic_wait_bucket OS_ATOMIC_WAIT_TABLE[OS_ATOMIC_WAIT_BUCKETS];
+/** @brief Ensures the wait table is only initialized once */
+static pthread_once_t OS_ATOMIC_WAIT_ONCE = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Initializes the table of buckets for waiting on an address
+ */
+static void os_atomic_wait_initialize( void );
+#endif /* if !defined( __linux__ ) */
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+/** @brief Lock protecting the list of lock statistics */
+static pthread_mutex_t OS_LOCK_STATS_LOCK = PTHREAD_MUTEX_INITIALIZER;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+#if defined( CLOCK_MONOTONIC ) && !defined( __APPLE__ )
+/** @brief Condition variables are timed using the monotonic clock */
+#define OS_THREAD_CONDITION_MONOTONIC  1
+#else /* if defined( CLOCK_MONOTONIC ) && !defined( __APPLE__ ) */
 /**
  * @brief Returns the systems "best guess" at the actual time
  *
@@ -90,8 +514,328 @@ typedef u_short in_port_t;
  * @retval         0                   on success
  */
 static int os_clock_realtime( struct timespec *ts );
+#endif /* else if defined( CLOCK_MONOTONIC ) && !defined( __APPLE__ ) */
+
+/**
+ * @brief Converts a deadline to the absolute time used by condition
+ *        variables
+ *
+ * @param[in]      deadline            deadline, as returned by
+ *                                     os_time_monotonic
+ * @param[out]     abs_time_out        absolute time on the clock of
+ *                                     condition variables
+ *
+ * @retval         -1                  on failure
+ * @retval         0                   on success
+ */
+static int os_thread_condition_deadline(
+	os_timestamp_t deadline,
+	struct timespec *abs_time_out );
+
+/**
+ * @brief Initializes a condition variable, timed using the monotonic clock
+ *        where supported
+ *
+ * @param[out]     cond                condition variable to initialize
+ *
+ * @retval         0                   on success
+ * @retval         other               error number on failure
+ */
+static int os_thread_condition_init(
+	pthread_cond_t *cond );
+
+/**
+ * @brief Converts a relative time out to the absolute time used by
+ *        condition variables
+ *
+ * @param[in]      time_out            time out in milliseconds
+ * @param[out]     abs_time_out        absolute time on the clock of
+ *                                     condition variables
+ *
+ * @retval         -1                  on failure
+ * @retval         0                   on success
+ */
+static int os_thread_condition_time_out(
+	os_millisecond_t time_out,
+	struct timespec *abs_time_out );
+
+/**
+ * @brief Waits on a condition variable, until an optional absolute time
+ *
+ * @param[in,out]  cond                condition variable to wait on
+ * @param[in,out]  lock                lock protecting condition variable
+ * @param[in]      abs_time_out        absolute time to give up, on the
+ *                                     clock of condition variables (NULL
+ *                                     waits indefinitely)
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_OWNER_DIED        woken up, previous owner of the lock
+ *                                     ended while holding it
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         absolute time reached
+ */
+static os_status_t os_thread_condition_wait_internal(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	const struct timespec *abs_time_out );
+
+/**
+ * @brief Settings a new thread applies to itself before calling its main
+ *        method
+ */
+struct os_thread_start
+{
+	/** @brief Mask of CPUs to run on (0 = any) */
+	os_uint64_t affinity;
+	/** @brief User specific data */
+	void *arg;
+	/** @brief Main method to call for the thread */
+	os_thread_main_t main;
+	/** @brief Name of the thread (empty = unnamed) */
+	char name[OS_THREAD_NAME_MAX];
+};
+
+#if defined( __linux__ )
+/**
+ * @brief Converts a mask of CPUs to a CPU set
+ *
+ * @param[in]      affinity            mask of CPUs (0 = any)
+ * @param[out]     cpus                CPU set output
+ */
+static void os_thread_affinity_to_cpus(
+	os_uint64_t affinity,
+	cpu_set_t *cpus );
+#endif /* if defined( __linux__ ) */
+
+/**
+ * @brief Converts a scheduling policy to the native scheduling policy
+ *
+ * @param[in]      policy              scheduling policy
+ *
+ * @retval         -1                  invalid scheduling policy
+ * @retval         >=0                 native scheduling policy
+ */
+static int os_thread_policy_native(
+	os_thread_policy_t policy );
+
+/**
+ * @brief Main method for threads that apply settings to themselves
+ *
+ * @param[in]      arg                 settings to apply (struct
+ *                                     os_thread_start), freed by the thread
+ *
+ * @returns the value returned by the user's main method
+ */
+static OS_THREAD_DECL os_thread_start_main(
+	void *arg );
+
+#if defined( _POSIX_THREAD_ROBUST_PRIO_INHERIT ) && \
+	_POSIX_THREAD_ROBUST_PRIO_INHERIT > 0
+/** @brief Robust mutexes are supported */
+#define OS_THREAD_MUTEX_ROBUST_SUPPORT 1
+#endif /* if _POSIX_THREAD_ROBUST_PRIO_INHERIT > 0 */
+
+#if defined( __linux__ ) && !defined( __ANDROID__ )
+/** @brief Fibers are supported, waiting on sockets using epoll */
+#define OS_FIBER_SUPPORT               1
+
+/**
+ * @brief Maximum number of socket events handled by each wait of a
+ *        fiber scheduler
+ */
+#define OS_FIBER_EVENTS_MAX            64
+
+#if defined( __x86_64__ )
+/** @brief Saved context of a fiber (stack pointer holding its registers) */
+typedef void *os_fiber_context_t;
+#else /* if defined( __x86_64__ ) */
+/** @brief Saved context of a fiber */
+typedef ucontext_t os_fiber_context_t;
+#endif /* else if defined( __x86_64__ ) */
+
+/**
+ * @brief Fiber, kept at the top of its own stack
+ */
+struct os_fiber
+{
+	/** @brief User specific data */
+	void *arg;
+	/** @brief Saved context, while the fiber is not running */
+	os_fiber_context_t context;
+	/** @brief Whether the fiber's main method has returned */
+	os_bool_t finished;
+	/** @brief Main method for the fiber */
+	os_fiber_main_t main;
+	/** @brief Memory mapped for the stack, including the guard page */
+	void *memory;
+	/** @brief Size of the memory mapped */
+	size_t memory_size;
+	/** @brief Next fiber, in the ready queue or the pool of free fibers */
+	struct os_fiber *next;
+	/** @brief Next fiber allocated by the same scheduler */
+	struct os_fiber *next_allocated;
+	/** @brief Scheduler running the fiber */
+	struct os_fiber_scheduler *scheduler;
+	/** @brief Lowest address of the stack, above the guard page */
+	void *stack;
+	/** @brief Whether the last wait of the fiber timed out */
+	os_bool_t timed_out;
+	/** @brief Timer waking up the fiber */
+	os_timer_t timer;
+};
+
+/**
+ * @brief Fibers waiting on a socket, one to read and one to write
+ */
+struct os_fiber_socket
+{
+	/** @brief Fiber waiting to read from the socket */
+	struct os_fiber *reader;
+	/** @brief Fiber waiting to write to the socket */
+	struct os_fiber *writer;
+};
+
+/**
+ * @brief Scheduler running fibers on a thread
+ */
+struct os_fiber_scheduler
+{
+	/** @brief Saved context of the scheduler, while a fiber is running */
+	os_fiber_context_t context;
+	/** @brief Number of fibers that have not returned */
+	unsigned int count;
+	/** @brief Fiber running (NULL = scheduler running) */
+	struct os_fiber *current;
+	/** @brief File descriptor waiting on socket events */
+	int epoll_fd;
+	/** @brief All fibers allocated by the scheduler */
+	struct os_fiber *fibers;
+	/** @brief Fibers that have returned, with stacks ready to reuse */
+	struct os_fiber *pool;
+	/** @brief Fibers ready to run */
+	struct os_fiber *ready;
+	/** @brief Link at the end of the ready queue */
+	struct os_fiber **ready_tail;
+	/** @brief Fibers waiting on each socket, indexed by file descriptor */
+	struct os_fiber_socket *sockets;
+	/** @brief Number of file descriptors @p sockets has room for */
+	size_t socket_count;
+	/** @brief Size of the stack of each fiber */
+	size_t stack_size;
+	/** @brief Timers waking up fibers */
+	os_timer_service_t timers;
+};
+
+/** @brief Scheduler running on the calling thread */
+static __thread struct os_fiber_scheduler *OS_FIBER_SCHEDULER = NULL;
+
+/**
+ * @brief Allocates a new fiber and its stack, with a guard page below it
+ *
+ * @param[in]      stack_size          size of the stack
+ *
+ * @retval NULL                        not enough memory
+ * @retval !NULL                       fiber allocated
+ */
+static struct os_fiber *os_fiber_allocate(
+	size_t stack_size );
+
+#if defined( __x86_64__ )
+/**
+ * @brief Saves the registers of the running context on its stack, and
+ *        restores the registers of another context
+ *
+ * @note implemented in assembly, swapcontext also saves the signal mask,
+ * which requires a system call on each switch
+ *
+ * @param[out]     from                saved stack pointer of running context
+ * @param[in]      to                  saved stack pointer of context to run
+ */
+void os_fiber_context_switch(
+	void **from,
+	void *to );
+#endif /* if defined( __x86_64__ ) */
+
+/**
+ * @brief Entry point of fibers, calls the fiber's main method
+ */
+static void os_fiber_entry( void );
+
+/**
+ * @brief Adds a fiber to the end of its scheduler's ready queue
+ *
+ * @param[in,out]  fiber               fiber that is ready to run
+ */
+static void os_fiber_ready(
+	struct os_fiber *fiber );
+
+/**
+ * @brief Registers the events of a socket that its fibers wait for
+ *
+ * The socket is removed once no fiber waits on it.
+ *
+ * @param[in]      scheduler           scheduler the fibers wait in
+ * @param[in]      fd                  socket waited on
+ *
+ * @retval         -1                  failure (errno set)
+ * @retval         0                   on success
+ */
+static int os_fiber_socket_arm(
+	struct os_fiber_scheduler *scheduler,
+	int fd );
+
+/**
+ * @brief Waits in the scheduler for a socket to be ready, running other
+ *        fibers
+ *
+ * One fiber may wait to read from a socket while another waits to write
+ * to it.
+ *
+ * @param[in]      fd                  socket to wait on
+ * @param[in]      for_write           whether to wait to write (or read)
+ * @param[in]      max_time_out        maximum time to wait
+ *                                     (0 = indefinitely)
+ *
+ * @retval         -1                  failure (errno set, ETIMEDOUT if the
+ *                                     time out expired, EBUSY if another
+ *                                     fiber waits the same way)
+ * @retval         0                   socket is ready
+ */
+static int os_fiber_socket_wait(
+	int fd,
+	os_bool_t for_write,
+	os_millisecond_t max_time_out );
+
+/**
+ * @brief Switches from the running context to another
+ *
+ * @param[out]     from                context to save the running context to
+ * @param[in]      to                  context to run
+ */
+static void os_fiber_switch(
+	os_fiber_context_t *from,
+	os_fiber_context_t *to );
+
+/**
+ * @brief Called when the timer of a fiber expires, makes it ready to run
+ *
+ * @param[in,out]  timer               timer that expired
+ * @param[in]      user_data           fiber the timer belongs to
+ */
+static void os_fiber_timer_expired(
+	os_timer_t *timer,
+	void *user_data );
+#endif /* if defined( __linux__ ) && !defined( __ANDROID__ ) */
 #endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
 
+#if defined( OS_FIBER_SUPPORT )
+/** @brief Whether the calling thread is running a fiber */
+#define OS_FIBER_ACTIVE()              ( os_fiber_self() != NULL )
+#else /* if defined( OS_FIBER_SUPPORT ) */
+/** @brief Whether the calling thread is running a fiber */
+#define OS_FIBER_ACTIVE()              OS_FALSE
+#endif /* else if defined( OS_FIBER_SUPPORT ) */
+
 os_status_t os_adapters_address(
 	os_adapter_address_t *address,
 	unsigned int *index,
@@ -455,7 +1199,24 @@ char os_char_toupper(
 }
 #endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
 
-#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+int os_clock_monotonic( struct timespec *ts )
+{
+#ifdef CLOCK_MONOTONIC
+	return clock_gettime( CLOCK_MONOTONIC, ts );
+#else
+	clock_serv_t cclock;
+	mach_timespec_t mts;
+	host_get_clock_service( mach_host_self(), SYSTEM_CLOCK, &cclock );
+	clock_get_time( cclock, &mts );
+	mach_port_deallocate( mach_task_self(), cclock );
+	ts->tv_sec = mts.tv_sec;
+	ts->tv_nsec = mts.tv_nsec;
+	return 0;
+#endif
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT && \
+	!defined( OS_THREAD_CONDITION_MONOTONIC )
 int os_clock_realtime( struct timespec *ts )
 {
 #ifdef CLOCK_REALTIME
@@ -471,7 +1232,8 @@ int os_clock_realtime( struct timespec *ts )
 	return 0;
 #endif
 }
-#endif /* defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+#endif /* defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT &&
+	!defined( OS_THREAD_CONDITION_MONOTONIC ) */
 
 /* directory support */
 os_status_t os_directory_create(
@@ -567,33 +1329,327 @@ os_status_t os_directory_close(
 	if( dir && dir->dir && closedir( dir->dir ) == 0 )
 	{
 		dir->dir = NULL;
-		free( dir );
+		os_free( dir );
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
 }
 
-os_bool_t os_directory_exists(
-	const char *dir_path )
+os_status_t os_directory_copy(
+	const char *src,
+	const char *dst,
+	const os_directory_copy_options_t *options )
 {
-	DIR *dir;
-	os_bool_t result = OS_FALSE;
-
-	dir = opendir( dir_path );
-	if ( dir )
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( src && dst )
 	{
-		result = OS_TRUE;
-		if ( closedir( dir ) != 0 )
-			os_fprintf( OS_STDERR,
-				"Failed to close dir %s due to %s\n",
-				dir_path,
-				os_system_error_string( errno ) );
-	}
-	return result;
-}
-
-const char *os_directory_get_temp_dir( char *dest, size_t size )
-{
+		struct os_directory_copy copy;
+		struct stat s;
+		struct stat s_to;
+
+		os_memzero( &copy, sizeof( struct os_directory_copy ) );
+		copy.options = options;
+		if ( options )
+			copy.flags = options->file_flags;
+		copy.fd_from = open( src, O_RDONLY | O_DIRECTORY );
+		copy.fd_to = -1;
+		result = OS_STATUS_FAILURE;
+		/* created writable, the permissions are set once the copy
+		 * is complete */
+		if ( copy.fd_from >= 0 && fstat( copy.fd_from, &s ) == 0 &&
+			( mkdir( dst, S_IRWXU ) == 0 || errno == EEXIST ) )
+			copy.fd_to = open( dst, O_RDONLY | O_DIRECTORY );
+		/* a directory is not copied onto itself, and a destination
+		 * within the directory copied is skipped while scanning */
+		if ( copy.fd_to >= 0 && fstat( copy.fd_to, &s_to ) == 0 &&
+			( s_to.st_dev != s.st_dev || s_to.st_ino != s.st_ino ) &&
+			os_arena_create( &copy.arena, 0u ) == OS_STATUS_SUCCESS )
+		{
+			size_t i;
+			copy.dev_to = s_to.st_dev;
+			copy.ino_to = s_to.st_ino;
+			result = os_directory_copy_scan( &copy, "." );
+			if ( result == OS_STATUS_SUCCESS )
+			{
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+				size_t threads = os_system_cpu_count();
+				if ( options && options->max_threads > 0u &&
+					options->max_threads < threads )
+					threads = options->max_threads;
+				if ( threads > copy.files.count )
+					threads = copy.files.count;
+				if ( threads > 1u &&
+					os_thread_mutex_create( &copy.lock ) ==
+						OS_STATUS_SUCCESS )
+				{
+					copy.locked = OS_TRUE;
+					result = os_parallel_for( 0u, threads, 1u,
+						os_directory_copy_thread, &copy );
+					os_thread_mutex_destroy( &copy.lock );
+				}
+				else
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+					os_directory_copy_files( &copy );
+				if ( copy.failed )
+					result = OS_STATUS_FAILURE;
+			}
+
+			/* children last, as creating entries updates the
+			 * timestamps of the directory containing them */
+			for ( i = copy.dirs.count; result == OS_STATUS_SUCCESS &&
+				i > 0u; --i )
+			{
+				const struct os_directory_copy_entry *const dir =
+					&copy.dirs.entry[i - 1u];
+				if ( fchmodat( copy.fd_to, dir->path,
+					dir->mode & 07777, 0 ) != 0 ||
+					utimensat( copy.fd_to, dir->path,
+					dir->times, 0 ) != 0 )
+					result = OS_STATUS_FAILURE;
+			}
+			if ( result == OS_STATUS_SUCCESS )
+			{
+				struct timespec times[2];
+				times[0] = OS_STAT_ATIME( s );
+				times[1] = OS_STAT_MTIME( s );
+				if ( fchmod( copy.fd_to, s.st_mode & 07777 ) != 0 ||
+					futimens( copy.fd_to, times ) != 0 )
+					result = OS_STATUS_FAILURE;
+			}
+			os_free( copy.dirs.entry );
+			os_free( copy.files.entry );
+			os_arena_destroy( &copy.arena );
+		}
+		if ( copy.fd_to >= 0 )
+			close( copy.fd_to );
+		if ( copy.fd_from >= 0 )
+			close( copy.fd_from );
+	}
+	return result;
+}
+
+os_status_t os_directory_copy_add(
+	struct os_directory_copy_list *list,
+	const char *path,
+	const struct stat *s )
+{
+	os_status_t result = OS_STATUS_SUCCESS;
+	if ( list->count == list->max )
+	{
+		struct os_directory_copy_entry *const entry =
+			(struct os_directory_copy_entry *)os_realloc(
+				list->entry, sizeof( struct os_directory_copy_entry ) *
+				( list->max + OS_DIRECTORY_COPY_GROW ) );
+		if ( entry )
+		{
+			list->entry = entry;
+			list->max += OS_DIRECTORY_COPY_GROW;
+		}
+		else
+			result = OS_STATUS_NO_MEMORY;
+	}
+	if ( result == OS_STATUS_SUCCESS )
+	{
+		struct os_directory_copy_entry *const entry =
+			&list->entry[list->count++];
+		entry->path = path;
+		entry->size = (os_uint64_t)s->st_size;
+		entry->mode = s->st_mode;
+		entry->times[0] = OS_STAT_ATIME( *s );
+		entry->times[1] = OS_STAT_MTIME( *s );
+	}
+	return result;
+}
+
+void os_directory_copy_files(
+	struct os_directory_copy *copy )
+{
+	os_uint64_t i;
+	while ( !os_atomic_load_u32( &copy->failed, OS_ATOMIC_RELAXED ) &&
+		( i = os_atomic_fetch_add_u64( &copy->next, 1u,
+			OS_ATOMIC_RELAXED ) ) < copy->files.count )
+	{
+		const char *const path = copy->files.entry[i].path;
+		os_status_t result = OS_STATUS_FAILURE;
+		struct stat s;
+		const int fd_from = openat( copy->fd_from, path, O_RDONLY );
+		if ( fd_from >= 0 && fstat( fd_from, &s ) == 0 )
+		{
+			const int fd_to = openat( copy->fd_to, path,
+				O_WRONLY | O_CREAT, s.st_mode & 07777 );
+			if ( fd_to >= 0 )
+				result = os_file_copy_fd( fd_from, &s, fd_to,
+					copy->flags | OS_FILE_COPY_PRESERVE );
+		}
+		if ( fd_from >= 0 )
+			close( fd_from );
+
+		if ( result != OS_STATUS_SUCCESS )
+			os_atomic_store_u32( &copy->failed, 1u,
+				OS_ATOMIC_RELAXED );
+		else
+		{
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			/* only created when several threads copy files */
+			const os_bool_t locked = copy->locked &&
+				os_thread_mutex_lock( &copy->lock ) ==
+					OS_STATUS_SUCCESS;
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+			++copy->files_done;
+			copy->bytes_done += (os_uint64_t)s.st_size;
+			if ( copy->options && copy->options->progress )
+				copy->options->progress( path,
+					copy->files_done, copy->files.count,
+					copy->bytes_done, copy->bytes_total,
+					copy->options->user_data );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+			if ( locked )
+				os_thread_mutex_unlock( &copy->lock );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+		}
+	}
+}
+
+os_status_t os_directory_copy_link(
+	struct os_directory_copy *copy,
+	int fd,
+	const char *name,
+	const char *path,
+	const struct stat *s )
+{
+	os_status_t result = OS_STATUS_NO_MEMORY;
+	const size_t size = (size_t)s->st_size + 1u;
+	char *const target = (char *)os_arena_alloc( &copy->arena, size );
+	if ( target )
+	{
+		const ssize_t len = readlinkat( fd, name, target, size );
+		result = OS_STATUS_FAILURE;
+		/* a link changed while reading it may not fit */
+		if ( len >= 0 && (size_t)len < size )
+		{
+			struct timespec times[2];
+			target[len] = '\0';
+			times[0] = OS_STAT_ATIME( *s );
+			times[1] = OS_STAT_MTIME( *s );
+			if ( ( unlinkat( copy->fd_to, path, 0 ) == 0 ||
+				errno == ENOENT ) &&
+				symlinkat( target, copy->fd_to, path ) == 0 &&
+				utimensat( copy->fd_to, path, times,
+					AT_SYMLINK_NOFOLLOW ) == 0 )
+				result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+os_status_t os_directory_copy_scan(
+	struct os_directory_copy *copy,
+	const char *path )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	const int fd = openat( copy->fd_from, path, O_RDONLY | O_DIRECTORY );
+	DIR *const dir = fd >= 0 ? fdopendir( fd ) : NULL;
+	if ( dir )
+	{
+		const os_bool_t root = strcmp( path, "." ) == 0;
+		const size_t path_len = strlen( path );
+		struct dirent *d;
+
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && ( d = readdir( dir ) ) )
+		{
+			const size_t name_len = strlen( d->d_name );
+			char *child;
+			struct stat s;
+
+			if ( strcmp( d->d_name, "." ) == 0 ||
+				strcmp( d->d_name, ".." ) == 0 )
+				continue;
+
+			/* entries are relative to the directory copied */
+			child = (char *)os_arena_alloc( &copy->arena,
+				( root ? 0u : path_len + 1u ) + name_len + 1u );
+			if ( !child )
+				result = OS_STATUS_NO_MEMORY;
+			else if ( root )
+				memcpy( child, d->d_name, name_len + 1u );
+			else
+			{
+				memcpy( child, path, path_len );
+				child[path_len] = OS_DIR_SEP;
+				memcpy( &child[path_len + 1u], d->d_name,
+					name_len + 1u );
+			}
+
+			if ( result != OS_STATUS_SUCCESS )
+				break;
+			if ( fstatat( fd, d->d_name, &s,
+				AT_SYMLINK_NOFOLLOW ) != 0 )
+				result = OS_STATUS_FAILURE;
+			/* destination within the directory copied */
+			else if ( S_ISDIR( s.st_mode ) &&
+				s.st_dev == copy->dev_to && s.st_ino == copy->ino_to )
+				continue;
+			else if ( S_ISDIR( s.st_mode ) )
+			{
+				if ( mkdirat( copy->fd_to, child, S_IRWXU ) != 0 &&
+					errno != EEXIST )
+					result = OS_STATUS_FAILURE;
+				else
+					result = os_directory_copy_add(
+						&copy->dirs, child, &s );
+				if ( result == OS_STATUS_SUCCESS )
+					result = os_directory_copy_scan( copy,
+						child );
+			}
+			else if ( S_ISLNK( s.st_mode ) )
+				result = os_directory_copy_link( copy, fd,
+					d->d_name, child, &s );
+			else if ( S_ISREG( s.st_mode ) )
+			{
+				result = os_directory_copy_add( &copy->files,
+					child, &s );
+				copy->bytes_total += (os_uint64_t)s.st_size;
+			}
+		}
+		closedir( dir );
+	}
+	else if ( fd >= 0 )
+		close( fd );
+	return result;
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+void os_directory_copy_thread(
+	size_t UNUSED(begin),
+	size_t UNUSED(end),
+	void *arg )
+{
+	os_directory_copy_files( (struct os_directory_copy *)arg );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+os_bool_t os_directory_exists(
+	const char *dir_path )
+{
+	DIR *dir;
+	os_bool_t result = OS_FALSE;
+
+	dir = opendir( dir_path );
+	if ( dir )
+	{
+		result = OS_TRUE;
+		if ( closedir( dir ) != 0 )
+			os_fprintf( OS_STDERR,
+				"Failed to close dir %s due to %s\n",
+				dir_path,
+				os_system_error_string( errno ) );
+	}
+	return result;
+}
+
+const char *os_directory_get_temp_dir( char *dest, size_t size )
+{
 	const char *result = NULL;
 	const char *tmp_dir = getenv( "TMPDIR" );
 #if defined( P_tmpdir )
@@ -672,14 +1728,15 @@ os_status_t os_directory_rewind(
 os_dir_t *os_directory_open(
 	const char *dir_path )
 {
-	os_dir_t *out = malloc( sizeof( struct os_dir ) );
+	os_dir_t *out = os_malloc_tagged( sizeof( struct os_dir ),
+		OS_MEMORY_TAG_FILE );
 	if ( dir_path && out )
 	{
 		out->path = dir_path;
 		out->dir = opendir( dir_path );
 		if ( !out->dir )
 		{
-			free( out );
+			os_free( out );
 			out = NULL;
 		}
 	}
@@ -699,11 +1756,20 @@ os_status_t os_file_close(
 os_status_t os_file_copy(
 	const char *old_path,
 	const char *new_path )
+{
+	return os_file_copy_ex( old_path, new_path, 0u );
+}
+
+os_status_t os_file_copy_ex(
+	const char *old_path,
+	const char *new_path,
+	unsigned int flags )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( old_path && new_path )
 	{
 		int fd_from;
+		struct stat from_stat;
 
 		result = OS_STATUS_FAILURE;
 #ifndef _WRS_KERNEL
@@ -711,48 +1777,210 @@ os_status_t os_file_copy(
 #else
 		fd_from = open( old_path, O_RDONLY, 0 );
 #endif
-		if ( fd_from >= 0 )
+		if ( fd_from >= 0 && fstat( fd_from, &from_stat ) == 0 )
 		{
-			char buf[4096];
-			int fd_to;
-			ssize_t nread;
-			struct stat file_stats;
-			memset( &file_stats, 0, sizeof( struct stat ) );
-			file_stats.st_mode = 0666;
-			fstat( fd_from, &file_stats );
-
-			if ( os_file_exists( new_path ) != OS_FALSE )
-				os_file_delete( new_path );
-			fd_to = open( new_path, O_WRONLY | O_CREAT | O_EXCL,
-				file_stats.st_mode );
+			/* an existing file is replaced in place, keeping its
+			 * permissions and any links to it */
+			const int fd_to = open( new_path, O_WRONLY | O_CREAT,
+				from_stat.st_mode & 07777 );
 			if ( fd_to >= 0 )
+				result = os_file_copy_fd( fd_from, &from_stat,
+					fd_to, flags );
+		}
+		if ( fd_from >= 0 )
+			close( fd_from );
+	}
+	return result;
+}
+
+os_status_t os_file_copy_fd(
+	int fd_from,
+	const struct stat *from_stat,
+	int fd_to,
+	unsigned int flags )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	struct stat to_stat;
+
+	/* truncating a file copied onto itself would lose its contents */
+	if ( fstat( fd_to, &to_stat ) == 0 &&
+		( to_stat.st_dev != from_stat->st_dev ||
+		  to_stat.st_ino != from_stat->st_ino ) &&
+		ftruncate( fd_to, 0 ) == 0 )
+	{
+		result = OS_STATUS_SUCCESS;
+#if defined( FICLONE )
+		/* file systems supporting it share the contents, until
+		 * either file is changed */
+		if ( ioctl( fd_to, FICLONE, fd_from ) != 0 )
+#endif /* if defined( FICLONE ) */
+			result = os_file_copy_sparse( fd_from, fd_to,
+				(os_uint64_t)from_stat->st_size );
+		if ( result == OS_STATUS_SUCCESS &&
+			( flags & OS_FILE_COPY_PRESERVE ) )
+		{
+			struct timespec times[2];
+			times[0] = OS_STAT_ATIME( *from_stat );
+			times[1] = OS_STAT_MTIME( *from_stat );
+			if ( fchmod( fd_to, from_stat->st_mode & 07777 ) != 0 ||
+				futimens( fd_to, times ) != 0 )
+				result = OS_STATUS_FAILURE;
+		}
+		if ( result == OS_STATUS_SUCCESS &&
+			( flags & OS_FILE_COPY_SYNC ) && fsync( fd_to ) != 0 )
+			result = OS_STATUS_FAILURE;
+	}
+	if ( close( fd_to ) < 0 )
+		result = OS_STATUS_FAILURE;
+	return result;
+}
+
+os_status_t os_file_copy_range(
+	int fd_from,
+	int fd_to,
+	os_uint64_t *offset,
+	os_uint64_t end,
+	unsigned int *method,
+	char **buffer )
+{
+	os_status_t result = OS_STATUS_SUCCESS;
+	while ( result == OS_STATUS_SUCCESS && *offset < end )
+	{
+		size_t count = OS_FILE_COPY_CHUNK_SIZE;
+		ssize_t copied = -1;
+		if ( end - *offset < count )
+			count = (size_t)( end - *offset );
+
+#if defined( __linux__ )
+#	if defined( SYS_copy_file_range )
+		if ( *method == OS_FILE_COPY_METHOD_RANGE )
+		{
+			loff_t in = (loff_t)*offset;
+			loff_t out = (loff_t)*offset;
+			copied = (ssize_t)syscall( SYS_copy_file_range, fd_from,
+				&in, fd_to, &out, count, 0u );
+			/* not supported by the kernel, or between these file
+			 * systems */
+			if ( copied < 0 && errno != EINTR )
+				*method = OS_FILE_COPY_METHOD_SENDFILE;
+		}
+		else
+#	endif /* if defined( SYS_copy_file_range ) */
+		if ( *method == OS_FILE_COPY_METHOD_SENDFILE )
+		{
+			off_t in = (off_t)*offset;
+			if ( lseek( fd_to, (off_t)*offset, SEEK_SET ) ==
+				(off_t)*offset )
+				copied = sendfile( fd_to, fd_from, &in, count );
+			if ( copied < 0 && errno != EINTR )
+				*method = OS_FILE_COPY_METHOD_BUFFER;
+		}
+		else
+#endif /* if defined( __linux__ ) */
+		{
+			if ( *buffer == NULL )
+				*buffer = (char *)os_malloc_tagged(
+					OS_FILE_COPY_BUFFER_SIZE,
+					OS_MEMORY_TAG_FILE );
+			if ( count > OS_FILE_COPY_BUFFER_SIZE )
+				count = OS_FILE_COPY_BUFFER_SIZE;
+			if ( *buffer &&
+				lseek( fd_from, (off_t)*offset, SEEK_SET ) ==
+					(off_t)*offset &&
+				lseek( fd_to, (off_t)*offset, SEEK_SET ) ==
+					(off_t)*offset )
 			{
-				result = OS_STATUS_SUCCESS;
-				while ( result == OS_STATUS_SUCCESS &&
-					( nread = read( fd_from, &buf[0],
-					  sizeof( buf ) ) ) > 0 )
+				copied = read( fd_from, *buffer, count );
+				if ( copied > 0 )
 				{
-					char *out_ptr = buf;
-					ssize_t nwritten;
-					do {
-						nwritten = write( fd_to,
-							out_ptr, (size_t)nread );
-						if ( nwritten >= 0 )
-						{
-							nread -= nwritten;
-							out_ptr += nwritten;
-						}
+					ssize_t written = 0;
+					while ( result == OS_STATUS_SUCCESS &&
+						written < copied )
+					{
+						const ssize_t n = write( fd_to,
+							*buffer + written,
+							(size_t)( copied - written ) );
+						if ( n >= 0 )
+							written += n;
 						else if ( errno != EINTR )
 							result = OS_STATUS_FAILURE;
-					} while ( result == OS_STATUS_SUCCESS
-						&& nread > 0 );
+					}
 				}
-				if ( close( fd_to ) < 0 )
+				else if ( copied < 0 && errno != EINTR )
 					result = OS_STATUS_FAILURE;
 			}
-			close( fd_from );
+			else
+				result = OS_STATUS_FAILURE;
+		}
+
+		if ( copied > 0 )
+			*offset += (os_uint64_t)copied;
+		else if ( copied == 0 )
+		{
+			char probe;
+			/* the system copies nothing from files whose contents
+			 * are generated when read (procfs, sysfs), so the end
+			 * of the file is only trusted from a read */
+			if ( *method == OS_FILE_COPY_METHOD_BUFFER ||
+				pread( fd_from, &probe, 1u,
+					(off_t)*offset ) == 0 )
+				end = *offset;
+			else
+				*method = OS_FILE_COPY_METHOD_BUFFER;
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_copy_sparse(
+	int fd_from,
+	int fd_to,
+	os_uint64_t size )
+{
+	os_status_t result = OS_STATUS_SUCCESS;
+	unsigned int method = OS_FILE_COPY_METHOD_FIRST;
+	char *buffer = NULL;
+	os_uint64_t offset = 0u;
+	os_bool_t at_end = OS_FALSE;
+
+	while ( result == OS_STATUS_SUCCESS && at_end == OS_FALSE &&
+		offset < size )
+	{
+		os_uint64_t end = size;
+#if defined( SEEK_DATA ) && defined( SEEK_HOLE )
+		/* only the data between holes is copied */
+		const off_t data = lseek( fd_from, (off_t)offset, SEEK_DATA );
+		if ( data >= 0 )
+		{
+			const off_t hole = lseek( fd_from, data, SEEK_HOLE );
+			offset = (os_uint64_t)data;
+			if ( hole > data && (os_uint64_t)hole < size )
+				end = (os_uint64_t)hole;
+		}
+		else if ( errno == ENXIO )
+			offset = size; /* rest of the file is a hole */
+#endif /* if defined( SEEK_DATA ) && defined( SEEK_HOLE ) */
+		if ( offset < end )
+		{
+			result = os_file_copy_range( fd_from, fd_to, &offset,
+				end, &method, &buffer );
+			/* file shorter than reported (or truncated) */
+			if ( offset < end )
+				at_end = OS_TRUE;
 		}
 	}
+
+	/* anything past the reported size is copied as well */
+	if ( result == OS_STATUS_SUCCESS && at_end == OS_FALSE )
+		result = os_file_copy_range( fd_from, fd_to, &offset,
+			~(os_uint64_t)0u, &method, &buffer );
+
+	/* extends the copy over a hole at the end of the file, never past
+	 * what was read from it */
+	if ( result == OS_STATUS_SUCCESS &&
+		ftruncate( fd_to, (off_t)offset ) != 0 )
+		result = OS_STATUS_FAILURE;
+	os_free( buffer );
 	return result;
 }
 
@@ -802,6 +2030,122 @@ char *os_file_gets(
 }
 #endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
 
+os_status_t os_file_map(
+	const char *file_path,
+	int mode,
+	os_uint64_t offset,
+	size_t size,
+	os_file_map_t *map )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( file_path && map && mode >= OS_FILE_MAP_READ_ONLY &&
+		mode <= OS_FILE_MAP_PRIVATE )
+	{
+		const int flags = ( mode == OS_FILE_MAP_READ_WRITE ) ?
+			O_RDWR : O_RDONLY;
+		struct stat file_stat;
+		int fd;
+
+		os_memzero( map, sizeof( os_file_map_t ) );
+		result = OS_STATUS_FAILURE;
+#if !defined(__VXWORKS__)
+		fd = open( file_path, flags );
+#else /* if !defined(__VXWORKS__) */
+		fd = open( file_path, flags, 0 );
+#endif /* else if !defined(__VXWORKS__) */
+		if ( fd >= 0 && fstat( fd, &file_stat ) == 0 )
+		{
+			const os_uint64_t file_size =
+				(os_uint64_t)file_stat.st_size;
+			/* 0 maps the rest of the file, if it can fit in memory */
+			if ( size == 0u && offset <= file_size &&
+				file_size - offset <= (size_t)-1 )
+				size = (size_t)( file_size - offset );
+			if ( offset > file_size || size > file_size - offset ||
+				( size == 0u && offset < file_size ) )
+				result = OS_STATUS_BAD_PARAMETER;
+			else if ( size == 0u )
+				result = OS_STATUS_SUCCESS;
+			else
+			{
+				/* mappings start on a page of the file */
+				const size_t delta = (size_t)( offset %
+					(os_uint64_t)sysconf( _SC_PAGESIZE ) );
+				int prot = PROT_READ;
+				void *base;
+
+				if ( mode != OS_FILE_MAP_READ_ONLY )
+					prot |= PROT_WRITE;
+				base = mmap( NULL, size + delta, prot,
+					mode == OS_FILE_MAP_PRIVATE ?
+					MAP_PRIVATE : MAP_SHARED, fd,
+					(off_t)( offset - delta ) );
+				if ( base != MAP_FAILED )
+				{
+					map->address = (char *)base + delta;
+					map->size = size;
+					map->base = base;
+					map->base_size = size + delta;
+					result = OS_STATUS_SUCCESS;
+				}
+			}
+		}
+		/* the mapping remains valid once the file is closed */
+		if ( fd >= 0 )
+			close( fd );
+	}
+	return result;
+}
+
+os_status_t os_file_map_advise(
+	os_file_map_t *map,
+	size_t offset,
+	size_t size,
+	int advice )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map && offset <= map->size &&
+		advice >= OS_FILE_MAP_ADVICE_SEQUENTIAL &&
+		advice <= OS_FILE_MAP_ADVICE_DONTNEED )
+	{
+		if ( size == 0u )
+			size = map->size - offset;
+		if ( size <= map->size - offset )
+		{
+			result = OS_STATUS_SUCCESS;
+			if ( size > 0u )
+			{
+				/* advice applies to whole pages */
+				char *const start = (char *)map->address + offset;
+				const size_t delta = (size_t)start &
+					( (size_t)sysconf( _SC_PAGESIZE ) - 1u );
+				int sys_advice = MADV_SEQUENTIAL;
+				if ( advice == OS_FILE_MAP_ADVICE_WILLNEED )
+					sys_advice = MADV_WILLNEED;
+				else if ( advice == OS_FILE_MAP_ADVICE_DONTNEED )
+					sys_advice = MADV_DONTNEED;
+				madvise( start - delta, size + delta, sys_advice );
+			}
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_map_sync(
+	os_file_map_t *map,
+	os_bool_t wait )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( map->base && msync( map->base, map->base_size,
+			wait ? MS_SYNC : MS_ASYNC ) != 0 )
+			result = OS_STATUS_FAILURE;
+	}
+	return result;
+}
+
 os_status_t os_file_move(
 	const char *old_path,
 	const char *new_path
@@ -881,33 +2225,210 @@ os_file_t os_file_open(
 	return result;
 }
 
-#if defined(OSAL_WRAP) && OSAL_WRAP
-size_t os_file_puts(
-	char *str,
-	os_file_t stream )
-{
-	return (size_t)fputs( str, stream );
-}
-
-size_t os_file_read(
-	void *ptr,
-	size_t size,
-	size_t nmemb,
-	os_file_t stream )
-{
-	return fread( ptr, size, nmemb, stream );
-}
-#endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
-
-os_status_t os_file_seek(
+os_status_t os_file_io_vector(
 	os_file_t stream,
-	long offset,
-	int whence
-)
+	const os_file_io_vector_t *vector,
+	size_t count,
+	os_uint64_t offset,
+	size_t *total,
+	os_bool_t write )
 {
-	os_status_t result = OS_STATUS_BAD_PARAMETER;
-	if ( stream != OS_FILE_INVALID )
-	{
+	os_status_t result = OS_STATUS_SUCCESS;
+	const int fd = fileno( stream );
+	size_t partial = 0u;
+	size_t i = 0u;
+
+	*total = 0u;
+	while ( result == OS_STATUS_SUCCESS && i < count )
+	{
+		if ( partial > 0u )
+		{
+			/* rest of a buffer partially transferred */
+			char *const buf = (char *)vector[i].iov_base + partial;
+			size_t size = vector[i].iov_len - partial;
+			if ( write )
+				result = os_file_pwrite( stream, buf, size,
+					offset + *total );
+			else
+			{
+				size_t bytes_read = 0u;
+				result = os_file_pread( stream, buf, size,
+					offset + *total, &bytes_read );
+				/* end of the file */
+				if ( bytes_read < size )
+					count = i;
+				size = bytes_read;
+			}
+			if ( result == OS_STATUS_SUCCESS )
+				*total += size;
+			partial = 0u;
+			++i;
+		}
+		else
+		{
+			const size_t first = i;
+			const int window = count - i < (size_t)IOV_MAX ?
+				(int)( count - i ) : IOV_MAX;
+			ssize_t done;
+			do
+			{
+				if ( write )
+					done = pwritev( fd, &vector[i], window,
+						(off_t)( offset + *total ) );
+				else
+					done = preadv( fd, &vector[i], window,
+						(off_t)( offset + *total ) );
+			} while ( done < 0 && errno == EINTR );
+
+			if ( done < 0 )
+				result = OS_STATUS_FAILURE;
+			else
+			{
+				/* skip the buffers fully transferred */
+				partial = (size_t)done;
+				*total += partial;
+				while ( i < count && partial >= vector[i].iov_len )
+				{
+					partial -= vector[i].iov_len;
+					++i;
+				}
+
+				/* nothing transferred, the end of the file for
+				 * reads */
+				if ( i == first && partial == 0u )
+				{
+					if ( write )
+						result = OS_STATUS_FAILURE;
+					else
+						count = i;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_pread(
+	os_file_t stream,
+	void *buf,
+	size_t size,
+	os_uint64_t offset,
+	size_t *bytes_read )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && ( buf || size == 0u ) )
+	{
+		const int fd = fileno( stream );
+		size_t total = 0u;
+		ssize_t got = 1;
+
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && got > 0 && total < size )
+		{
+			got = pread( fd, (char *)buf + total, size - total,
+				(off_t)( offset + total ) );
+			if ( got > 0 )
+				total += (size_t)got;
+			else if ( got < 0 && errno == EINTR )
+				got = 1;
+			else if ( got < 0 )
+				result = OS_STATUS_FAILURE;
+		}
+		if ( bytes_read )
+			*bytes_read = total;
+	}
+	return result;
+}
+
+os_status_t os_file_preadv(
+	os_file_t stream,
+	const os_file_io_vector_t *vector,
+	size_t count,
+	os_uint64_t offset,
+	size_t *bytes_read )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && ( vector || count == 0u ) )
+	{
+		size_t total = 0u;
+		result = os_file_io_vector( stream, vector, count, offset,
+			&total, OS_FALSE );
+		if ( bytes_read )
+			*bytes_read = total;
+	}
+	return result;
+}
+
+os_status_t os_file_pwrite(
+	os_file_t stream,
+	const void *buf,
+	size_t size,
+	os_uint64_t offset )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && ( buf || size == 0u ) )
+	{
+		const int fd = fileno( stream );
+		size_t total = 0u;
+
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && total < size )
+		{
+			const ssize_t put = pwrite( fd,
+				(const char *)buf + total, size - total,
+				(off_t)( offset + total ) );
+			if ( put > 0 )
+				total += (size_t)put;
+			else if ( put == 0 || errno != EINTR )
+				result = OS_STATUS_FAILURE;
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_pwritev(
+	os_file_t stream,
+	const os_file_io_vector_t *vector,
+	size_t count,
+	os_uint64_t offset )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && ( vector || count == 0u ) )
+	{
+		size_t total = 0u;
+		result = os_file_io_vector( stream, vector, count, offset,
+			&total, OS_TRUE );
+	}
+	return result;
+}
+
+#if defined(OSAL_WRAP) && OSAL_WRAP
+size_t os_file_puts(
+	char *str,
+	os_file_t stream )
+{
+	return (size_t)fputs( str, stream );
+}
+
+size_t os_file_read(
+	void *ptr,
+	size_t size,
+	size_t nmemb,
+	os_file_t stream )
+{
+	return fread( ptr, size, nmemb, stream );
+}
+#endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
+
+os_status_t os_file_seek(
+	os_file_t stream,
+	long offset,
+	int whence
+)
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream != OS_FILE_INVALID )
+	{
 		result = OS_STATUS_FAILURE;
 		if ( fseek( stream, offset, whence ) == 0 )
 			result = OS_STATUS_SUCCESS;
@@ -915,6 +2436,23 @@ os_status_t os_file_seek(
 	return result;
 }
 
+os_status_t os_file_seek64(
+	os_file_t stream,
+	os_int64_t offset,
+	int whence )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	/* offsets must fit in the type used by the system */
+	if ( stream != OS_FILE_INVALID &&
+		(os_int64_t)(off_t)offset == offset )
+	{
+		result = OS_STATUS_FAILURE;
+		if ( fseeko( stream, (off_t)offset, whence ) == 0 )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
 os_uint64_t os_file_size(
 	const char *file_path )
 {
@@ -929,19 +2467,14 @@ os_uint64_t os_file_size(
 os_uint64_t os_file_size_handle(
 	os_file_t file_handle )
 {
-	long int file_size = 0L;
+	os_uint64_t result = 0u;
+	struct stat file_stat;
 
-	if ( file_handle )
-	{
-		long int cur_pos = ftell( file_handle );
-		if ( fseek( file_handle, 0, SEEK_END ) == 0 )
-		{
-			file_size = ftell( file_handle );
-			if ( cur_pos != file_size )
-				fseek( file_handle, cur_pos, SEEK_SET );
-		}
-	}
-	return (os_uint64_t)file_size;
+	/* the size is known to the system, the position of the stream is
+	 * neither moved nor its buffer flushed */
+	if ( file_handle && fstat( fileno( file_handle ), &file_stat ) == 0 )
+		result = (os_uint64_t)file_stat.st_size;
+	return result;
 }
 
 os_status_t os_file_sync(
@@ -982,6 +2515,15 @@ long int os_file_tell(
 }
 #endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
 
+os_int64_t os_file_tell64(
+	os_file_t stream )
+{
+	os_int64_t result = -1;
+	if ( stream != OS_FILE_INVALID )
+		result = (os_int64_t)ftello( stream );
+	return result;
+}
+
 os_status_t os_file_temp(
 	char *prototype,
 	size_t suffix_len )
@@ -996,6 +2538,20 @@ os_status_t os_file_temp(
 	return result;
 }
 
+os_status_t os_file_unmap(
+	os_file_map_t *map )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( map->base && munmap( map->base, map->base_size ) != 0 )
+			result = OS_STATUS_FAILURE;
+		os_memzero( map, sizeof( os_file_map_t ) );
+	}
+	return result;
+}
+
 #if defined(OSAL_WRAP) && OSAL_WRAP
 size_t os_file_write(
 	const void *ptr,
@@ -1008,36 +2564,146 @@ size_t os_file_write(
 #endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
 
 /* memory functions */
-#if defined(OSAL_WRAP) && OSAL_WRAP
-void *os_calloc( size_t nmemb, size_t size )
+void *os_allocator_system_aligned_alloc(
+	size_t alignment,
+	size_t size,
+	void *UNUSED(user_data) )
 {
-	return calloc( nmemb, size );
+	void *result = NULL;
+	/* posix_memalign requires a multiple of the size of a pointer */
+	if ( alignment < sizeof( void * ) )
+		alignment = sizeof( void * );
+	if ( posix_memalign( &result, alignment, size ) != 0 )
+		result = NULL;
+	return result;
 }
 
-void os_free( void *ptr )
+void *os_allocator_system_calloc(
+	size_t nmemb,
+	size_t size,
+	void *UNUSED(user_data) )
 {
-	free( ptr );
+	return calloc( nmemb, size );
 }
 
-void os_free_null( void **ptr )
+void os_allocator_system_free(
+	void *ptr,
+	void *UNUSED(user_data) )
 {
-	if ( ptr && *ptr )
-	{
-		free( *ptr );
-		*ptr = NULL;
-	}
+	free( ptr );
 }
 
-void *os_malloc( size_t size )
+void *os_allocator_system_malloc(
+	size_t size,
+	void *UNUSED(user_data) )
 {
 	return malloc( size );
 }
 
-void *os_realloc( void *ptr, size_t size )
+void *os_allocator_system_realloc(
+	void *ptr,
+	size_t size,
+	void *UNUSED(user_data) )
 {
 	return realloc( ptr, size );
 }
 
+const os_allocator_t *os_allocator_system( void )
+{
+	return &OS_ALLOCATOR_SYSTEM;
+}
+
+void os_free_large(
+	void *ptr,
+	size_t size )
+{
+	if ( ptr )
+		munmap( ptr, os_memory_large_size( size ) );
+}
+
+void *os_malloc_large(
+	size_t size,
+	unsigned int flags )
+{
+	void *result = NULL;
+	const size_t length = os_memory_large_size( size );
+	if ( size > 0u && length > 0u )
+	{
+		void *memory = MAP_FAILED;
+		const os_bool_t huge = ( flags & OS_MEMORY_FLAG_HUGE_PAGES ) &&
+			length % OS_MEMORY_HUGE_PAGE_SIZE == 0u;
+#if defined( MAP_HUGETLB )
+		/* pages reserved by the system, fails if none are available */
+		if ( huge )
+			memory = mmap( NULL, length, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+#endif /* if defined( MAP_HUGETLB ) */
+		if ( memory == MAP_FAILED && huge &&
+			length <= (size_t)-1 - OS_MEMORY_HUGE_PAGE_SIZE )
+		{
+			/* transparent huge pages need memory aligned to them, so
+			 * map extra memory and unmap what is around it */
+			char *const start = (char *)mmap( NULL,
+				length + OS_MEMORY_HUGE_PAGE_SIZE,
+				PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+				-1, 0 );
+			if ( start != MAP_FAILED )
+			{
+				char *const p = start + ( ( 0u - (size_t)start ) &
+					( OS_MEMORY_HUGE_PAGE_SIZE - 1u ) );
+				if ( p > start )
+					munmap( start, (size_t)( p - start ) );
+				munmap( p + length, (size_t)( start +
+					OS_MEMORY_HUGE_PAGE_SIZE - p ) );
+#if defined( MADV_HUGEPAGE )
+				madvise( p, length, MADV_HUGEPAGE );
+#endif /* if defined( MADV_HUGEPAGE ) */
+				memory = p;
+			}
+		}
+		if ( memory == MAP_FAILED )
+			memory = mmap( NULL, length, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+		if ( memory != MAP_FAILED )
+		{
+			result = memory;
+			if ( flags & OS_MEMORY_FLAG_LOCK )
+			{
+				/* locking also faults in every page */
+				if ( mlock( memory, length ) != 0 )
+				{
+					munmap( memory, length );
+					result = NULL;
+				}
+			}
+			else if ( flags & OS_MEMORY_FLAG_PREFAULT )
+			{
+				const size_t page_size =
+					(size_t)sysconf( _SC_PAGESIZE );
+				volatile char *const p = (volatile char *)memory;
+				size_t i;
+				for ( i = 0u; i < length; i += page_size )
+					p[i] = 0;
+			}
+		}
+	}
+	return result;
+}
+
+size_t os_memory_large_size(
+	size_t size )
+{
+	size_t result = 0u;
+	size_t page_size = (size_t)sysconf( _SC_PAGESIZE );
+	if ( size >= OS_MEMORY_HUGE_PAGE_SIZE )
+		page_size = OS_MEMORY_HUGE_PAGE_SIZE;
+	if ( size <= (size_t)-1 - page_size )
+		result = ( size + page_size - 1u ) & ~( page_size - 1u );
+	return result;
+}
+
+#if defined(OSAL_WRAP) && OSAL_WRAP
 int os_memcmp(
 	const void *ptr1,
 	const void *ptr2,
@@ -1365,7 +3031,8 @@ os_status_t os_socket_accept(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( socket && out )
 	{
-		os_socket_t *s = malloc( sizeof( struct os_socket ) );
+		os_socket_t *s = os_malloc_tagged( sizeof( struct os_socket ),
+			OS_MEMORY_TAG_SOCKET );
 		result = OS_STATUS_NO_MEMORY;
 		if ( s )
 		{
@@ -1373,6 +3040,20 @@ os_status_t os_socket_accept(
 			if ( socket->fd != OS_SOCKET_INVALID )
 			{
 				int select_result = 1;
+#if defined( OS_FIBER_SUPPORT )
+				if ( OS_FIBER_ACTIVE() )
+				{
+					/* wait in the scheduler, running other fibers */
+					if ( os_fiber_socket_wait( socket->fd, OS_FALSE,
+						max_time_out ) != 0 )
+					{
+						select_result = -1;
+						if ( errno == ETIMEDOUT )
+							result = OS_STATUS_TIMED_OUT;
+					}
+				}
+				else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 				if ( max_time_out > 0u )
 				{
 					struct timeval ts;
@@ -1402,7 +3083,7 @@ os_status_t os_socket_accept(
 			if ( result == OS_STATUS_SUCCESS )
 				*out = s;
 			else
-				free( s );
+				os_free( s );
 		}
 	}
 	return result;
@@ -1462,7 +3143,7 @@ os_status_t os_socket_close(
 		if ( socket->fd != OS_SOCKET_INVALID &&
 			close( socket->fd ) == 0 )
 		{
-			free( socket );
+			os_free( socket );
 			result = OS_STATUS_SUCCESS;
 		}
 	}
@@ -1476,6 +3157,34 @@ os_status_t os_socket_connect(
 	if ( socket )
 	{
 		result = OS_STATUS_FAILURE;
+#if defined( OS_FIBER_SUPPORT )
+		if ( socket->fd != OS_SOCKET_INVALID && OS_FIBER_ACTIVE() )
+		{
+			/* connect without blocking, and wait in the scheduler
+			 * for the connection to complete */
+			const int flags = fcntl( socket->fd, F_GETFL );
+			if ( flags >= 0 && fcntl( socket->fd, F_SETFL,
+				flags | O_NONBLOCK ) == 0 )
+			{
+				if ( connect( socket->fd, &socket->addr,
+					sizeof( struct sockaddr ) ) == 0 )
+					result = OS_STATUS_SUCCESS;
+				else if ( errno == EINPROGRESS &&
+					os_fiber_socket_wait( socket->fd, OS_TRUE,
+						0u ) == 0 )
+				{
+					int error = -1;
+					socklen_t error_len = sizeof( int );
+					if ( getsockopt( socket->fd, SOL_SOCKET,
+						SO_ERROR, &error, &error_len ) == 0 &&
+						error == 0 )
+						result = OS_STATUS_SUCCESS;
+				}
+				fcntl( socket->fd, F_SETFL, flags );
+			}
+		}
+		else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 		if ( socket->fd != OS_SOCKET_INVALID &&
 			connect( socket->fd, &socket->addr,
 				sizeof( struct sockaddr ) ) == 0 )
@@ -1502,7 +3211,8 @@ os_status_t os_socket_open(
 
 	if ( out && address && port > 0u )
 	{
-		os_socket_t *s = malloc( sizeof( os_socket_t ) );
+		os_socket_t *s = os_malloc_tagged( sizeof( os_socket_t ),
+			OS_MEMORY_TAG_SOCKET );
 		result = OS_STATUS_NO_MEMORY;
 		*out = NULL;
 		if ( s )
@@ -1565,7 +3275,7 @@ os_status_t os_socket_open(
 			if ( result == OS_STATUS_SUCCESS )
 				*out = s;
 			else
-				free( s );
+				os_free( s );
 		}
 	}
 	return result;
@@ -1602,8 +3312,9 @@ os_status_t os_socket_read(
 	if ( socket && socket->fd != OS_SOCKET_INVALID )
 	{
 		ssize_t retval = 0;
+		const os_bool_t in_fiber = OS_FIBER_ACTIVE();
 		result = OS_STATUS_FAILURE;
-		if ( max_time_out > 0u )
+		if ( max_time_out > 0u && !in_fiber )
 		{
 			struct timeval tv;
 			tv.tv_sec = max_time_out / OS_MILLISECONDS_IN_SECOND;
@@ -1614,6 +3325,17 @@ os_status_t os_socket_read(
 		}
 		if ( retval >= 0 )
 		{
+#if defined( OS_FIBER_SUPPORT )
+			if ( in_fiber )
+			{
+				while ( ( retval = recv( socket->fd, buf, len,
+					MSG_DONTWAIT ) ) < 0 &&
+					( errno == EAGAIN || errno == EWOULDBLOCK ) &&
+					os_fiber_socket_wait( socket->fd, OS_FALSE,
+						max_time_out ) == 0 ) {}
+			}
+			else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 			retval = read( socket->fd, buf, len );
 			if ( retval > 0 )
 			{
@@ -1642,8 +3364,9 @@ ssize_t os_socket_receive(
 	ssize_t result = -1;
 	if ( socket && socket->fd != OS_SOCKET_INVALID )
 	{
+		const os_bool_t in_fiber = OS_FIBER_ACTIVE();
 		result = 0;
-		if ( max_time_out > 0u )
+		if ( max_time_out > 0u && !in_fiber )
 		{
 			struct timeval tv;
 			tv.tv_sec = max_time_out / OS_MILLISECONDS_IN_SECOND;
@@ -1656,6 +3379,17 @@ ssize_t os_socket_receive(
 		{
 			struct sockaddr peer_addr;
 			socklen_t peer_addr_len = sizeof( struct sockaddr );
+#if defined( OS_FIBER_SUPPORT )
+			if ( in_fiber )
+			{
+				while ( ( result = recvfrom( socket->fd, buf, len,
+					MSG_DONTWAIT, &peer_addr, &peer_addr_len ) ) < 0 &&
+					( errno == EAGAIN || errno == EWOULDBLOCK ) &&
+					os_fiber_socket_wait( socket->fd, OS_FALSE,
+						max_time_out ) == 0 ) {}
+			}
+			else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 			result = recvfrom( socket->fd, buf, len, 0, &peer_addr,
 				&peer_addr_len );
 			if ( result >= 0 && ( src_addr || port ) )
@@ -1701,8 +3435,9 @@ ssize_t os_socket_send(
 	ssize_t result = -1;
 	if( socket && socket->fd != OS_SOCKET_INVALID && dest_addr )
 	{
+		const os_bool_t in_fiber = OS_FIBER_ACTIVE();
 		result = 0;
-		if ( max_time_out > 0u )
+		if ( max_time_out > 0u && !in_fiber )
 		{
 			struct timeval tv;
 			tv.tv_sec = max_time_out / OS_MILLISECONDS_IN_SECOND;
@@ -1736,6 +3471,18 @@ ssize_t os_socket_send(
 				addr6->sin6_port = (in_port_t)htons( port );
 				result = 0;
 			}
+#if defined( OS_FIBER_SUPPORT )
+			if ( result >= 0 && in_fiber )
+			{
+				while ( ( result = sendto( socket->fd, buf, len,
+					MSG_DONTWAIT, (struct sockaddr*)&addr,
+					sizeof( struct sockaddr ) ) ) < 0 &&
+					( errno == EAGAIN || errno == EWOULDBLOCK ) &&
+					os_fiber_socket_wait( socket->fd, OS_TRUE,
+						max_time_out ) == 0 ) {}
+			}
+			else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 			if ( result >= 0 )
 				result = sendto( socket->fd, buf, len, 0,
 					(struct sockaddr*)&addr,
@@ -1763,8 +3510,9 @@ os_status_t os_socket_write(
 	if ( socket && socket->fd != OS_SOCKET_INVALID )
 	{
 		ssize_t retval = 0;
+		const os_bool_t in_fiber = OS_FIBER_ACTIVE();
 		result = OS_STATUS_FAILURE;
-		if ( max_time_out > 0u )
+		if ( max_time_out > 0u && !in_fiber )
 		{
 			struct timeval tv;
 			tv.tv_sec = max_time_out / OS_MILLISECONDS_IN_SECOND;
@@ -1775,6 +3523,17 @@ os_status_t os_socket_write(
 		}
 		if ( retval >= 0 )
 		{
+#if defined( OS_FIBER_SUPPORT )
+			if ( in_fiber )
+			{
+				while ( ( retval = send( socket->fd, buf, len,
+					MSG_DONTWAIT ) ) < 0 &&
+					( errno == EAGAIN || errno == EWOULDBLOCK ) &&
+					os_fiber_socket_wait( socket->fd, OS_TRUE,
+						max_time_out ) == 0 ) {}
+			}
+			else
+#endif /* if defined( OS_FIBER_SUPPORT ) */
 			retval = write( socket->fd, buf, len );
 			if ( retval >= 0 )
 			{
@@ -1914,6 +3673,121 @@ int os_system_error_last( void )
 }
 #endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
 
+unsigned int os_system_cpu_count( void )
+{
+	/* reading the quota of the control group takes several files, so
+	 * the count is kept for later calls */
+	pthread_once( &OS_SYSTEM_CPU_ONCE, os_system_cpu_count_initialize );
+	return OS_SYSTEM_CPU_COUNT;
+}
+
+void os_system_cpu_count_initialize( void )
+{
+	unsigned int result = 0u;
+#if defined( __linux__ )
+	/* only count the CPUs the process is allowed to run on */
+	cpu_set_t cpus;
+	if ( sched_getaffinity( 0, sizeof( cpu_set_t ), &cpus ) == 0 )
+		result = (unsigned int)CPU_COUNT( &cpus );
+#endif /* if defined( __linux__ ) */
+#if defined( _SC_NPROCESSORS_ONLN )
+	if ( result == 0u )
+	{
+		const long cpu_count = sysconf( _SC_NPROCESSORS_ONLN );
+		if ( cpu_count > 0 )
+			result = (unsigned int)cpu_count;
+	}
+#endif /* if defined( _SC_NPROCESSORS_ONLN ) */
+#if defined( __linux__ )
+	{
+		/* a container may be given less CPU time than it has CPUs */
+		const unsigned int quota = os_system_cpu_quota();
+		if ( quota > 0u && ( result == 0u || quota < result ) )
+			result = quota;
+	}
+#endif /* if defined( __linux__ ) */
+	if ( result > 0u )
+		OS_SYSTEM_CPU_COUNT = result;
+}
+
+#if defined( __linux__ )
+unsigned int os_system_cpu_quota( void )
+{
+	unsigned int result = 0u;
+	char group[PATH_MAX] = "";
+	char line[PATH_MAX];
+	char path[PATH_MAX + 32u];
+	long long period = 0;
+	long long quota = 0;
+	os_bool_t more = OS_TRUE;
+	FILE *file = fopen( "/proc/self/cgroup", "r" );
+
+	/* control group of the process in the unified (v2) hierarchy */
+	if ( file )
+	{
+		while ( fgets( line, sizeof( line ), file ) )
+		{
+			if ( strncmp( line, "0::", 3u ) == 0 )
+			{
+				snprintf( group, sizeof( group ), "%s", &line[3] );
+				group[strcspn( group, "\n" )] = '\0';
+			}
+		}
+		fclose( file );
+	}
+
+	/* quotas of the group and of each of its parents apply */
+	while ( more != OS_FALSE )
+	{
+		char *const slash = strrchr( group, '/' );
+		snprintf( path, sizeof( path ), "/sys/fs/cgroup%s/cpu.max",
+			group );
+		file = fopen( path, "r" );
+		if ( file )
+		{
+			/* "max <period>" when there is no quota */
+			if ( fscanf( file, "%lld %lld", &quota, &period ) == 2 &&
+				quota > 0 && period > 0 )
+			{
+				const unsigned int cpus = (unsigned int)(
+					( quota + period - 1 ) / period );
+				if ( result == 0u || cpus < result )
+					result = cpus;
+			}
+			fclose( file );
+		}
+		more = OS_FALSE;
+		if ( slash )
+		{
+			*slash = '\0';
+			more = OS_TRUE;
+		}
+	}
+
+	/* control group (v1) hierarchy, as mounted in a container */
+	if ( result == 0u )
+	{
+		file = fopen( "/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r" );
+		if ( file )
+		{
+			if ( fscanf( file, "%lld", &quota ) != 1 )
+				quota = -1;
+			fclose( file );
+		}
+		file = fopen( "/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r" );
+		if ( file )
+		{
+			if ( fscanf( file, "%lld", &period ) != 1 )
+				period = 0;
+			fclose( file );
+		}
+		if ( quota > 0 && period > 0 )
+			result = (unsigned int)( ( quota + period - 1 ) / period );
+	}
+	return result;
+}
+#endif /* if defined( __linux__ ) */
+
 const char *os_system_error_string(
 	int error_number )
 {
@@ -2028,16 +3902,18 @@ os_status_t os_system_run(
 					if ( args->cmd )
 						cmd_len = strlen( args->cmd );
 
-					argv = malloc( sizeof(char *) * 1u );
-					argv[argc++] = malloc(cmd_len + 1u);
+					argv = os_malloc_tagged( sizeof(char *) * 1u,
+						OS_MEMORY_TAG_PROCESS );
+					argv[argc++] = os_malloc_tagged( cmd_len + 1u,
+						OS_MEMORY_TAG_PROCESS );
 					if ( args->cmd )
 						strncpy( argv[0],
 							args->cmd, cmd_len );
 					argv[0][cmd_len] = '\0';
 
 					rc = args->fptr( argc, argv );
-					free( argv[0] );
-					free( argv );
+					os_free( argv[0] );
+					os_free( argv );
 					exit( rc );
 				}
 				else
@@ -2250,13 +4126,34 @@ size_t os_time_format(
 	return result;
 }
 
-os_status_t os_time_sleep(
-	os_millisecond_t ms,
-	os_bool_t allow_interrupts )
+os_status_t os_time_monotonic(
+	os_timestamp_t *time_stamp )
 {
-	struct timespec rem;
-	os_status_t result = OS_STATUS_FAILURE;
-	struct timespec s;
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( time_stamp )
+	{
+		struct timespec ts;
+
+		result = OS_STATUS_FAILURE;
+		if ( os_clock_monotonic( &ts ) == 0 )
+		{
+			*time_stamp = (os_timestamp_t)ts.tv_sec *
+				OS_MILLISECONDS_IN_SECOND +
+				(os_timestamp_t)ts.tv_nsec /
+				OS_NANOSECONDS_IN_MILLISECOND;
+			result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+os_status_t os_time_sleep(
+	os_millisecond_t ms,
+	os_bool_t allow_interrupts )
+{
+	struct timespec rem;
+	os_status_t result = OS_STATUS_FAILURE;
+	struct timespec s;
 	int sleep_result;
 	s.tv_sec = ms / OS_MILLISECONDS_IN_SECOND;
 	s.tv_nsec = ( ms % OS_MILLISECONDS_IN_SECOND ) *
@@ -2278,6 +4175,673 @@ os_status_t os_time_sleep(
 
 /* threads & lock support */
 #if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+#if !defined( __linux__ )
+void os_atomic_wait_initialize( void )
+{
+	unsigned int i;
+	for ( i = 0u; i < OS_ATOMIC_WAIT_BUCKETS; ++i )
+	{
+		pthread_mutex_init( &OS_ATOMIC_WAIT_TABLE[i].lock, NULL );
+		os_thread_condition_init( &OS_ATOMIC_WAIT_TABLE[i].cond );
+	}
+}
+#endif /* if !defined( __linux__ ) */
+
+os_status_t os_atomic_wait_u32(
+	os_atomic_uint32_t *ptr,
+	os_uint32_t expected,
+	const os_timestamp_t *deadline )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( ptr )
+	{
+#if defined( __linux__ )
+		struct timespec abs_time_out;
+		struct timespec *time_out = NULL;
+
+		/* FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC time */
+		if ( deadline )
+		{
+			abs_time_out.tv_sec = (time_t)( *deadline /
+				OS_MILLISECONDS_IN_SECOND );
+			abs_time_out.tv_nsec = (long)( *deadline %
+				OS_MILLISECONDS_IN_SECOND ) *
+				OS_NANOSECONDS_IN_MILLISECOND;
+			time_out = &abs_time_out;
+		}
+
+		/* EAGAIN (value changed) & EINTR are reported as a wake up,
+		 * other errors would have callers retrying forever */
+		result = OS_STATUS_SUCCESS;
+		if ( syscall( SYS_futex, ptr, FUTEX_WAIT_BITSET_PRIVATE,
+			expected, time_out, NULL, FUTEX_BITSET_MATCH_ANY ) != 0 )
+		{
+			if ( errno == ETIMEDOUT )
+				result = OS_STATUS_TIMED_OUT;
+			else if ( errno != EAGAIN && errno != EINTR )
+				result = OS_STATUS_FAILURE;
+		}
+#else /* if defined( __linux__ ) */
+		struct os_atomic_wait_bucket *const bucket =
+			&OS_ATOMIC_WAIT_TABLE[( (size_t)ptr >> 2 ) %
+				OS_ATOMIC_WAIT_BUCKETS];
+
+		pthread_once( &OS_ATOMIC_WAIT_ONCE, os_atomic_wait_initialize );
+		result = OS_STATUS_SUCCESS;
+		pthread_mutex_lock( &bucket->lock );
+		if ( os_atomic_load_u32( ptr, OS_ATOMIC_SEQ_CST ) == expected )
+		{
+			if ( deadline )
+			{
+				os_timestamp_t now = 0u;
+				struct timespec abs_time_out;
+
+				os_time_monotonic( &now );
+				result = OS_STATUS_TIMED_OUT;
+				if ( now < *deadline &&
+					os_thread_condition_deadline( *deadline,
+						&abs_time_out ) == 0 )
+				{
+					const int error = pthread_cond_timedwait(
+						&bucket->cond, &bucket->lock,
+						&abs_time_out );
+					result = OS_STATUS_SUCCESS;
+					if ( error == ETIMEDOUT )
+						result = OS_STATUS_TIMED_OUT;
+					else if ( error != 0 )
+						result = OS_STATUS_FAILURE;
+				}
+			}
+			else if ( pthread_cond_wait( &bucket->cond,
+				&bucket->lock ) != 0 )
+				result = OS_STATUS_FAILURE;
+		}
+		pthread_mutex_unlock( &bucket->lock );
+#endif /* else if defined( __linux__ ) */
+	}
+	return result;
+}
+
+os_status_t os_atomic_wake_u32(
+	os_atomic_uint32_t *ptr,
+	os_bool_t wake_all )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( ptr )
+	{
+#if defined( __linux__ )
+		syscall( SYS_futex, ptr, FUTEX_WAKE_PRIVATE,
+			wake_all != OS_FALSE ? INT_MAX : 1, NULL, NULL, 0 );
+#else /* if defined( __linux__ ) */
+		struct os_atomic_wait_bucket *const bucket =
+			&OS_ATOMIC_WAIT_TABLE[( (size_t)ptr >> 2 ) %
+				OS_ATOMIC_WAIT_BUCKETS];
+
+		/* buckets are shared between addresses, so wake everyone */
+		(void)wake_all;
+		pthread_once( &OS_ATOMIC_WAIT_ONCE, os_atomic_wait_initialize );
+		pthread_mutex_lock( &bucket->lock );
+		pthread_cond_broadcast( &bucket->cond );
+		pthread_mutex_unlock( &bucket->lock );
+#endif /* else if defined( __linux__ ) */
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+#if defined( OS_FIBER_SUPPORT )
+struct os_fiber *os_fiber_allocate(
+	size_t stack_size )
+{
+	struct os_fiber *fiber = NULL;
+	const size_t page_size = (size_t)sysconf( _SC_PAGESIZE );
+	/* fiber information is kept at the top of the stack, 16-byte aligned */
+	const size_t fiber_size = ( sizeof( struct os_fiber ) + 15u ) &
+		~(size_t)15u;
+	/* stack rounded up to whole pages, plus a guard page below it */
+	const size_t memory_size = ( ( stack_size + fiber_size +
+		page_size - 1u ) / page_size + 1u ) * page_size;
+	void *const memory = mmap( NULL, memory_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0 );
+	if ( memory != MAP_FAILED )
+	{
+		/* overflowing the stack faults, instead of corrupting memory */
+		if ( mprotect( memory, page_size, PROT_NONE ) == 0 )
+		{
+			fiber = (struct os_fiber *)( (char *)memory +
+				memory_size - fiber_size );
+			memset( fiber, 0, sizeof( struct os_fiber ) );
+			fiber->memory = memory;
+			fiber->memory_size = memory_size;
+			fiber->stack = (char *)memory + page_size;
+		}
+		else
+			munmap( memory, memory_size );
+	}
+	return fiber;
+}
+
+#if defined( __x86_64__ )
+__asm__(
+	".text\n"
+	".globl os_fiber_context_switch\n"
+	".hidden os_fiber_context_switch\n"
+	".type os_fiber_context_switch, @function\n"
+	"os_fiber_context_switch:\n"
+	/* save callee-saved registers and floating point control words */
+	"\tpushq %rbp\n"
+	"\tpushq %rbx\n"
+	"\tpushq %r12\n"
+	"\tpushq %r13\n"
+	"\tpushq %r14\n"
+	"\tpushq %r15\n"
+	"\tsubq $8, %rsp\n"
+	"\tstmxcsr (%rsp)\n"
+	"\tfnstcw 4(%rsp)\n"
+	/* switch stacks */
+	"\tmovq %rsp, (%rdi)\n"
+	"\tmovq %rsi, %rsp\n"
+	/* restore the context saved on the new stack */
+	"\tldmxcsr (%rsp)\n"
+	"\tfldcw 4(%rsp)\n"
+	"\taddq $8, %rsp\n"
+	"\tpopq %r15\n"
+	"\tpopq %r14\n"
+	"\tpopq %r13\n"
+	"\tpopq %r12\n"
+	"\tpopq %rbx\n"
+	"\tpopq %rbp\n"
+	"\tret\n"
+	".size os_fiber_context_switch, .-os_fiber_context_switch\n"
+);
+#endif /* if defined( __x86_64__ ) */
+
+os_status_t os_fiber_create(
+	os_fiber_scheduler_t *scheduler,
+	os_fiber_main_t main,
+	void *arg )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( scheduler && main )
+	{
+		struct os_fiber *fiber = scheduler->pool;
+		result = OS_STATUS_NO_MEMORY;
+		if ( fiber )
+			scheduler->pool = fiber->next;
+		else
+		{
+			fiber = os_fiber_allocate( scheduler->stack_size );
+			if ( fiber )
+			{
+				fiber->next_allocated = scheduler->fibers;
+				scheduler->fibers = fiber;
+			}
+		}
+
+		if ( fiber )
+		{
+#if defined( __x86_64__ )
+			/* build the frame restored by os_fiber_context_switch,
+			 * "returning" into os_fiber_entry, at the top of the stack */
+			void (*const entry)( void ) = os_fiber_entry;
+			const os_uint32_t control[2] = { 0x1F80u, 0x037Fu };
+			void **sp = (void **)fiber;
+			*--sp = NULL; /* return address of os_fiber_entry */
+			--sp;
+			memcpy( sp, &entry, sizeof( entry ) );
+			sp -= 6; /* rbp, rbx, r12, r13, r14 & r15 */
+			memset( sp, 0, sizeof( void * ) * 6u );
+			--sp; /* mxcsr & x87 control word */
+			memcpy( sp, control, sizeof( control ) );
+			fiber->context = sp;
+#else /* if defined( __x86_64__ ) */
+			getcontext( &fiber->context );
+			fiber->context.uc_stack.ss_sp = fiber->stack;
+			fiber->context.uc_stack.ss_size = (size_t)(
+				(char *)fiber - (char *)fiber->stack );
+			fiber->context.uc_link = NULL;
+			makecontext( &fiber->context, os_fiber_entry, 0 );
+#endif /* else if defined( __x86_64__ ) */
+			fiber->arg = arg;
+			fiber->finished = OS_FALSE;
+			fiber->main = main;
+			fiber->scheduler = scheduler;
+			fiber->timed_out = OS_FALSE;
+			os_timer_create( &fiber->timer, os_fiber_timer_expired,
+				fiber );
+			++scheduler->count;
+			os_fiber_ready( fiber );
+			result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+void os_fiber_entry( void )
+{
+	struct os_fiber_scheduler *const scheduler = OS_FIBER_SCHEDULER;
+	struct os_fiber *const fiber = scheduler->current;
+	fiber->main( fiber->arg );
+	fiber->finished = OS_TRUE;
+	/* never resumed, stack is reused by the next fiber created */
+	os_fiber_switch( &fiber->context, &scheduler->context );
+}
+
+void os_fiber_ready(
+	struct os_fiber *fiber )
+{
+	struct os_fiber_scheduler *const scheduler = fiber->scheduler;
+	fiber->next = NULL;
+	*scheduler->ready_tail = fiber;
+	scheduler->ready_tail = &fiber->next;
+}
+
+os_status_t os_fiber_scheduler_create(
+	os_fiber_scheduler_t **scheduler,
+	size_t stack_size )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( scheduler )
+	{
+		struct os_fiber_scheduler *const s =
+			os_malloc_tagged( sizeof( struct os_fiber_scheduler ),
+				OS_MEMORY_TAG_THREAD );
+		*scheduler = NULL;
+		result = OS_STATUS_NO_MEMORY;
+		if ( s )
+		{
+			memset( s, 0, sizeof( struct os_fiber_scheduler ) );
+			s->ready_tail = &s->ready;
+			s->stack_size = stack_size;
+			if ( s->stack_size == 0u )
+				s->stack_size = OS_FIBER_STACK_SIZE;
+			result = OS_STATUS_FAILURE;
+			s->epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+			if ( s->epoll_fd >= 0 )
+			{
+				result = os_timer_service_create( &s->timers );
+				if ( result != OS_STATUS_SUCCESS )
+					close( s->epoll_fd );
+			}
+
+			if ( result == OS_STATUS_SUCCESS )
+				*scheduler = s;
+			else
+				os_free( s );
+		}
+	}
+	return result;
+}
+
+os_status_t os_fiber_scheduler_destroy(
+	os_fiber_scheduler_t *scheduler )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( scheduler && scheduler != OS_FIBER_SCHEDULER )
+	{
+		struct os_fiber *fiber = scheduler->fibers;
+		os_timer_service_destroy( &scheduler->timers );
+		while ( fiber )
+		{
+			struct os_fiber *const next = fiber->next_allocated;
+			munmap( fiber->memory, fiber->memory_size );
+			fiber = next;
+		}
+		close( scheduler->epoll_fd );
+		os_free( scheduler->sockets );
+		os_free( scheduler );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_fiber_scheduler_run(
+	os_fiber_scheduler_t *scheduler )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( scheduler && OS_FIBER_SCHEDULER == NULL )
+	{
+		struct epoll_event events[OS_FIBER_EVENTS_MAX];
+		OS_FIBER_SCHEDULER = scheduler;
+		result = OS_STATUS_SUCCESS;
+		while ( scheduler->count > 0u && result == OS_STATUS_SUCCESS )
+		{
+			/* run the fibers that are ready, fibers that yield are
+			 * run on the next pass, after checking for events */
+			struct os_fiber *fiber = scheduler->ready;
+			scheduler->ready = NULL;
+			scheduler->ready_tail = &scheduler->ready;
+			while ( fiber )
+			{
+				struct os_fiber *const next = fiber->next;
+				scheduler->current = fiber;
+				os_fiber_switch( &scheduler->context,
+					&fiber->context );
+				scheduler->current = NULL;
+				if ( fiber->finished )
+				{
+					fiber->next = scheduler->pool;
+					scheduler->pool = fiber;
+					--scheduler->count;
+				}
+				fiber = next;
+			}
+
+			if ( scheduler->count > 0u )
+			{
+				int event_count;
+				int i;
+				int time_out = -1;
+				os_timestamp_t expiry;
+				os_timestamp_t now;
+
+				if ( scheduler->ready )
+					time_out = 0;
+				else if ( os_timer_service_next_expiry(
+						&scheduler->timers, &expiry ) ==
+						OS_STATUS_SUCCESS &&
+					os_time_monotonic( &now ) == OS_STATUS_SUCCESS )
+				{
+					time_out = 0;
+					if ( expiry > now + INT_MAX )
+						time_out = INT_MAX;
+					else if ( expiry > now )
+						time_out = (int)( expiry - now );
+				}
+
+				event_count = epoll_wait( scheduler->epoll_fd,
+					events, OS_FIBER_EVENTS_MAX, time_out );
+				if ( event_count < 0 && errno != EINTR )
+					result = OS_STATUS_FAILURE;
+				for ( i = 0; i < event_count; ++i )
+				{
+					const int fd = events[i].data.fd;
+					struct os_fiber_socket *const socket =
+						&scheduler->sockets[fd];
+					struct os_fiber *const reader =
+						socket->reader;
+					struct os_fiber *const writer =
+						socket->writer;
+					const os_uint32_t errors =
+						EPOLLERR | EPOLLHUP;
+
+					/* fibers that timed out are already
+					 * ready to run */
+					if ( reader && !reader->timed_out &&
+						( events[i].events &
+						  ( EPOLLIN | errors ) ) )
+					{
+						socket->reader = NULL;
+						os_timer_stop( &reader->timer );
+						os_fiber_ready( reader );
+					}
+					if ( writer && !writer->timed_out &&
+						( events[i].events &
+						  ( EPOLLOUT | errors ) ) )
+					{
+						socket->writer = NULL;
+						os_timer_stop( &writer->timer );
+						os_fiber_ready( writer );
+					}
+
+					/* sockets are disarmed after each event,
+					 * for a fiber still waiting */
+					if ( socket->reader || socket->writer )
+						os_fiber_socket_arm( scheduler,
+							fd );
+				}
+				os_timer_service_poll( &scheduler->timers );
+			}
+		}
+		OS_FIBER_SCHEDULER = NULL;
+	}
+	return result;
+}
+
+os_fiber_t *os_fiber_self( void )
+{
+	os_fiber_t *result = NULL;
+	if ( OS_FIBER_SCHEDULER )
+		result = OS_FIBER_SCHEDULER->current;
+	return result;
+}
+
+os_status_t os_fiber_sleep(
+	os_millisecond_t time_out )
+{
+	os_status_t result = OS_STATUS_BAD_REQUEST;
+	struct os_fiber *const fiber = os_fiber_self();
+	if ( fiber )
+	{
+		struct os_fiber_scheduler *const scheduler = fiber->scheduler;
+		result = os_timer_start( &scheduler->timers, &fiber->timer,
+			time_out, 0u );
+		if ( result == OS_STATUS_SUCCESS )
+			os_fiber_switch( &fiber->context, &scheduler->context );
+	}
+	return result;
+}
+
+int os_fiber_socket_arm(
+	struct os_fiber_scheduler *scheduler,
+	int fd )
+{
+	int result = 0;
+	const struct os_fiber_socket *const socket = &scheduler->sockets[fd];
+	struct epoll_event event;
+	memset( &event, 0, sizeof( event ) );
+	event.events = EPOLLONESHOT;
+	if ( socket->reader )
+		event.events |= EPOLLIN;
+	if ( socket->writer )
+		event.events |= EPOLLOUT;
+	event.data.fd = fd;
+
+	/* sockets stay registered, disarmed, between waits */
+	if ( socket->reader || socket->writer )
+	{
+		result = epoll_ctl( scheduler->epoll_fd, EPOLL_CTL_MOD, fd,
+			&event );
+		if ( result != 0 && errno == ENOENT )
+			result = epoll_ctl( scheduler->epoll_fd, EPOLL_CTL_ADD,
+				fd, &event );
+	}
+	else
+		/* socket must not wake up a fiber later */
+		epoll_ctl( scheduler->epoll_fd, EPOLL_CTL_DEL, fd, &event );
+	return result;
+}
+
+int os_fiber_socket_wait(
+	int fd,
+	os_bool_t for_write,
+	os_millisecond_t max_time_out )
+{
+	int result = -1;
+	struct os_fiber *const fiber = os_fiber_self();
+	if ( fiber && fd >= 0 )
+	{
+		struct os_fiber_scheduler *const scheduler = fiber->scheduler;
+		if ( (size_t)fd >= scheduler->socket_count )
+		{
+			size_t count = scheduler->socket_count * 2u;
+			struct os_fiber_socket *sockets;
+			if ( count <= (size_t)fd )
+				count = (size_t)fd + 1u;
+			sockets = (struct os_fiber_socket *)os_realloc(
+				scheduler->sockets,
+				sizeof( struct os_fiber_socket ) * count );
+			if ( sockets )
+			{
+				memset( &sockets[scheduler->socket_count], 0,
+					sizeof( struct os_fiber_socket ) *
+					( count - scheduler->socket_count ) );
+				scheduler->sockets = sockets;
+				scheduler->socket_count = count;
+			}
+		}
+
+		if ( (size_t)fd < scheduler->socket_count )
+		{
+			struct os_fiber **slot = &scheduler->sockets[fd].reader;
+			if ( for_write )
+				slot = &scheduler->sockets[fd].writer;
+			if ( *slot == NULL )
+			{
+				*slot = fiber;
+				if ( os_fiber_socket_arm( scheduler, fd ) == 0 )
+				{
+					fiber->timed_out = OS_FALSE;
+					if ( max_time_out > 0u )
+						os_timer_start(
+							&scheduler->timers,
+							&fiber->timer,
+							max_time_out, 0u );
+					os_fiber_switch( &fiber->context,
+						&scheduler->context );
+
+					/* the scheduler clears the fibers the
+					 * socket wakes up */
+					if ( fiber->timed_out )
+					{
+						*slot = NULL;
+						os_fiber_socket_arm( scheduler,
+							fd );
+						errno = ETIMEDOUT;
+					}
+					else
+						result = 0;
+				}
+				else
+					*slot = NULL;
+			}
+			else
+				errno = EBUSY;
+		}
+		else
+			errno = ENOMEM;
+	}
+	else
+		errno = EINVAL;
+	return result;
+}
+
+void os_fiber_switch(
+	os_fiber_context_t *from,
+	os_fiber_context_t *to )
+{
+#if defined( __x86_64__ )
+	os_fiber_context_switch( from, *to );
+#else /* if defined( __x86_64__ ) */
+	swapcontext( from, to );
+#endif /* else if defined( __x86_64__ ) */
+}
+
+void os_fiber_timer_expired(
+	os_timer_t *UNUSED(timer),
+	void *user_data )
+{
+	struct os_fiber *const fiber = (struct os_fiber *)user_data;
+	fiber->timed_out = OS_TRUE;
+	os_fiber_ready( fiber );
+}
+
+os_status_t os_fiber_yield( void )
+{
+	os_status_t result = OS_STATUS_BAD_REQUEST;
+	struct os_fiber *const fiber = os_fiber_self();
+	if ( fiber )
+	{
+		os_fiber_ready( fiber );
+		os_fiber_switch( &fiber->context,
+			&fiber->scheduler->context );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+#else /* if defined( OS_FIBER_SUPPORT ) */
+os_status_t os_fiber_create(
+	os_fiber_scheduler_t *UNUSED(scheduler),
+	os_fiber_main_t UNUSED(main),
+	void *UNUSED(arg) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_create(
+	os_fiber_scheduler_t **UNUSED(scheduler),
+	size_t UNUSED(stack_size) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_destroy(
+	os_fiber_scheduler_t *UNUSED(scheduler) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_run(
+	os_fiber_scheduler_t *UNUSED(scheduler) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_fiber_t *os_fiber_self( void )
+{
+	return NULL;
+}
+
+os_status_t os_fiber_sleep(
+	os_millisecond_t UNUSED(time_out) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_yield( void )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+#endif /* else if defined( OS_FIBER_SUPPORT ) */
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+void os_lock_stats_list_lock( void )
+{
+	pthread_mutex_lock( &OS_LOCK_STATS_LOCK );
+}
+
+void os_lock_stats_list_unlock( void )
+{
+	pthread_mutex_unlock( &OS_LOCK_STATS_LOCK );
+}
+
+os_uint64_t os_lock_stats_now( void )
+{
+	os_uint64_t result = 0u;
+	struct timespec ts;
+	if ( os_clock_monotonic( &ts ) == 0 )
+		result = (os_uint64_t)ts.tv_sec * OS_NANOSECONDS_IN_SECOND +
+			(os_uint64_t)ts.tv_nsec;
+	return result;
+}
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+#if defined( __linux__ )
+void os_thread_affinity_to_cpus(
+	os_uint64_t affinity,
+	cpu_set_t *cpus )
+{
+	unsigned int i;
+	CPU_ZERO( cpus );
+	for ( i = 0u; i < CPU_SETSIZE; ++i )
+	{
+		if ( affinity == 0u ||
+			( i < 64u && ( affinity & ( (os_uint64_t)1u << i ) ) ) )
+			CPU_SET( i, cpus );
+	}
+}
+#endif /* if defined( __linux__ ) */
+
 os_status_t os_thread_condition_broadcast(
 	os_thread_condition_t *cond )
 {
@@ -2298,7 +4862,7 @@ os_status_t os_thread_condition_create(
 	if ( cond )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( pthread_cond_init( cond, NULL ) == 0 )
+		if ( os_thread_condition_init( cond ) == 0 )
 			result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -2325,16 +4889,55 @@ os_status_t os_thread_condition_signal(
 	if ( cond && lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if (  pthread_mutex_lock( lock ) == 0 )
+		if (  pthread_mutex_lock( OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
 		{
 			if ( pthread_cond_signal( cond ) == 0 )
 				result = OS_STATUS_SUCCESS;
-			pthread_mutex_unlock( lock );
+			pthread_mutex_unlock( OS_THREAD_LOCK_NATIVE( lock ) );
 		}
 	}
 	return result;
 }
 
+int os_thread_condition_deadline(
+	os_timestamp_t deadline,
+	struct timespec *abs_time_out )
+{
+#if defined( OS_THREAD_CONDITION_MONOTONIC )
+	/* same clock as os_time_monotonic */
+	abs_time_out->tv_sec = (time_t)( deadline / OS_MILLISECONDS_IN_SECOND );
+	abs_time_out->tv_nsec = (long)( deadline % OS_MILLISECONDS_IN_SECOND ) *
+		OS_NANOSECONDS_IN_MILLISECOND;
+	return 0;
+#else /* if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+	os_timestamp_t now = 0u;
+	os_time_monotonic( &now );
+	if ( deadline < now )
+		deadline = now;
+	return os_thread_condition_time_out(
+		(os_millisecond_t)( deadline - now ), abs_time_out );
+#endif /* else if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+}
+
+int os_thread_condition_init(
+	pthread_cond_t *cond )
+{
+#if defined( OS_THREAD_CONDITION_MONOTONIC )
+	pthread_condattr_t attr;
+	int result = pthread_condattr_init( &attr );
+	if ( result == 0 )
+	{
+		result = pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+		if ( result == 0 )
+			result = pthread_cond_init( cond, &attr );
+		pthread_condattr_destroy( &attr );
+	}
+	return result;
+#else /* if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+	return pthread_cond_init( cond, NULL );
+#endif /* else if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+}
+
 os_status_t os_thread_condition_timed_wait(
 	os_thread_condition_t *cond,
 	os_thread_mutex_t *lock,
@@ -2343,29 +4946,93 @@ os_status_t os_thread_condition_timed_wait(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( cond && lock )
 	{
-		result = OS_STATUS_FAILURE;
 		if ( max_time_out > 0u )
 		{
-			int error_number;
 			struct timespec abs_time_out;
-			os_clock_realtime( &abs_time_out );
-			abs_time_out.tv_nsec +=
-				( max_time_out % OS_MILLISECONDS_IN_SECOND ) *
-				OS_NANOSECONDS_IN_MILLISECOND;
-			abs_time_out.tv_sec +=
-				( max_time_out / OS_MILLISECONDS_IN_SECOND ) +
-				( (unsigned long)abs_time_out.tv_nsec /
-					OS_NANOSECONDS_IN_SECOND );
-			abs_time_out.tv_nsec %= OS_NANOSECONDS_IN_SECOND;
-			error_number = pthread_cond_timedwait( cond, lock,
-				&abs_time_out );
-			if ( error_number == 0 )
-				result = OS_STATUS_SUCCESS;
-			else if ( error_number == ETIMEDOUT )
-				result = OS_STATUS_TIMED_OUT;
+			result = OS_STATUS_FAILURE;
+			if ( os_thread_condition_time_out( max_time_out,
+				&abs_time_out ) == 0 )
+				result = os_thread_condition_wait_internal( cond,
+					lock, &abs_time_out );
 		}
-		else if ( pthread_cond_wait( cond, lock ) == 0 )
-			result = OS_STATUS_SUCCESS;
+		else
+			result = os_thread_condition_wait_internal( cond, lock,
+				NULL );
+	}
+	return result;
+}
+
+int os_thread_condition_time_out(
+	os_millisecond_t time_out,
+	struct timespec *abs_time_out )
+{
+#if defined( OS_THREAD_CONDITION_MONOTONIC )
+	const int result = os_clock_monotonic( abs_time_out );
+#else /* if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+	const int result = os_clock_realtime( abs_time_out );
+#endif /* else if defined( OS_THREAD_CONDITION_MONOTONIC ) */
+	if ( result == 0 )
+	{
+		abs_time_out->tv_nsec += (long)( time_out %
+			OS_MILLISECONDS_IN_SECOND ) *
+			OS_NANOSECONDS_IN_MILLISECOND;
+		abs_time_out->tv_sec += (time_t)( time_out /
+			OS_MILLISECONDS_IN_SECOND ) +
+			abs_time_out->tv_nsec / OS_NANOSECONDS_IN_SECOND;
+		abs_time_out->tv_nsec %= OS_NANOSECONDS_IN_SECOND;
+	}
+	return result;
+}
+
+os_status_t os_thread_condition_wait_internal(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	const struct timespec *abs_time_out )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	int error_number;
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+	/* the lock is not held while waiting */
+	os_lock_stats_released( lock->stats,
+		os_lock_stats_now() - lock->acquired );
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+	if ( abs_time_out )
+		error_number = pthread_cond_timedwait( cond,
+			OS_THREAD_LOCK_NATIVE( lock ), abs_time_out );
+	else
+		error_number = pthread_cond_wait( cond,
+			OS_THREAD_LOCK_NATIVE( lock ) );
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+	lock->acquired = os_lock_stats_now();
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+
+	if ( error_number == 0 )
+		result = OS_STATUS_SUCCESS;
+	else if ( error_number == ETIMEDOUT )
+		result = OS_STATUS_TIMED_OUT;
+#if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT )
+	/* owner of a robust lock ended while holding it */
+	else if ( error_number == EOWNERDEAD &&
+		pthread_mutex_consistent( OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
+		result = OS_STATUS_OWNER_DIED;
+#endif /* if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT ) */
+	return result;
+}
+
+os_status_t os_thread_condition_wait_until(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	os_timestamp_t deadline )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( cond && lock )
+	{
+		struct timespec abs_time_out;
+		result = OS_STATUS_FAILURE;
+		if ( os_thread_condition_deadline( deadline,
+			&abs_time_out ) == 0 )
+			result = os_thread_condition_wait_internal( cond, lock,
+				&abs_time_out );
 	}
 	return result;
 }
@@ -2410,6 +5077,106 @@ os_status_t os_thread_create(
 	return result;
 }
 
+os_status_t os_thread_create_ex(
+	os_thread_t *thread,
+	os_thread_main_t main,
+	void *arg,
+	const os_thread_attr_t *attr )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( !attr )
+		result = os_thread_create( thread, main, arg, 0u );
+	else if ( thread && main &&
+		os_thread_policy_native( attr->policy ) >= 0 )
+	{
+		pthread_attr_t pattr;
+		os_uint64_t affinity = attr->affinity;
+
+		result = OS_STATUS_FAILURE;
+		if ( pthread_attr_init( &pattr ) == 0 )
+		{
+			struct os_thread_start *start = NULL;
+			int rc = 0;
+
+			if ( attr->stack_size > 0u )
+				rc = pthread_attr_setstacksize( &pattr,
+					attr->stack_size );
+			if ( rc == 0 && attr->detached != OS_FALSE )
+				rc = pthread_attr_setdetachstate( &pattr,
+					PTHREAD_CREATE_DETACHED );
+			if ( rc == 0 && attr->policy != OS_THREAD_POLICY_DEFAULT )
+			{
+				struct sched_param param;
+				memset( &param, 0, sizeof( struct sched_param ) );
+				param.sched_priority = attr->priority;
+				rc = pthread_attr_setinheritsched( &pattr,
+					PTHREAD_EXPLICIT_SCHED );
+				if ( rc == 0 )
+					rc = pthread_attr_setschedpolicy( &pattr,
+						os_thread_policy_native( attr->policy ) );
+				if ( rc == 0 )
+					rc = pthread_attr_setschedparam( &pattr,
+						&param );
+			}
+#if defined( __linux__ ) && !defined( __ANDROID__ )
+			if ( rc == 0 && affinity != 0u )
+			{
+				cpu_set_t cpus;
+				os_thread_affinity_to_cpus( affinity, &cpus );
+				rc = pthread_attr_setaffinity_np( &pattr,
+					sizeof( cpu_set_t ), &cpus );
+				affinity = 0u;
+			}
+#endif /* if defined( __linux__ ) && !defined( __ANDROID__ ) */
+
+			/* settings without a creation attribute are applied by
+			 * the new thread itself */
+			if ( rc == 0 && ( affinity != 0u ||
+				( attr->name && *attr->name != '\0' ) ) )
+			{
+				start = (struct os_thread_start *)os_malloc_tagged(
+					sizeof( struct os_thread_start ),
+					OS_MEMORY_TAG_THREAD );
+				if ( start )
+				{
+					memset( start, 0,
+						sizeof( struct os_thread_start ) );
+					start->affinity = affinity;
+					start->arg = arg;
+					start->main = main;
+					if ( attr->name )
+						strncpy( start->name, attr->name,
+							OS_THREAD_NAME_MAX - 1u );
+				}
+				else
+				{
+					result = OS_STATUS_NO_MEMORY;
+					rc = ENOMEM;
+				}
+			}
+
+			if ( rc == 0 )
+			{
+				if ( start )
+					rc = pthread_create( thread, &pattr,
+						os_thread_start_main, start );
+				else
+					rc = pthread_create( thread, &pattr,
+						main, arg );
+				if ( rc != 0 )
+					os_free_null( (void **)&start );
+			}
+
+			if ( rc == 0 )
+				result = OS_STATUS_SUCCESS;
+			else if ( rc == EPERM )
+				result = OS_STATUS_NO_PERMISSION;
+			pthread_attr_destroy( &pattr );
+		}
+	}
+	return result;
+}
+
 os_status_t os_thread_destroy(
 	os_thread_t *thread )
 {
@@ -2438,28 +5205,189 @@ os_status_t os_thread_wait(
 	return result;
 }
 
+os_status_t os_thread_local_key_create(
+	os_thread_local_key_t *key,
+	os_thread_local_destructor_t destructor )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		const int rc = pthread_key_create( key, destructor );
+		result = OS_STATUS_FAILURE;
+		if ( rc == 0 )
+			result = OS_STATUS_SUCCESS;
+		else if ( rc == EAGAIN || rc == ENOMEM )
+			result = OS_STATUS_NO_MEMORY;
+	}
+	return result;
+}
+
+os_status_t os_thread_local_key_destroy(
+	os_thread_local_key_t *key )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		result = OS_STATUS_FAILURE;
+		if ( pthread_key_delete( *key ) == 0 )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+#if defined(OSAL_WRAP) && OSAL_WRAP
+void *os_thread_local_key_get(
+	const os_thread_local_key_t *key )
+{
+	void *result = NULL;
+	if ( key )
+		result = pthread_getspecific( *key );
+	return result;
+}
+#endif /* if defined(OSAL_WRAP) && OSAL_WRAP */
+
+os_status_t os_thread_local_key_set(
+	const os_thread_local_key_t *key,
+	void *value )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		const int rc = pthread_setspecific( *key, value );
+		result = OS_STATUS_FAILURE;
+		if ( rc == 0 )
+			result = OS_STATUS_SUCCESS;
+		else if ( rc == ENOMEM )
+			result = OS_STATUS_NO_MEMORY;
+	}
+	return result;
+}
+
 os_status_t os_thread_mutex_create(
 	os_thread_mutex_t *lock )
+{
+	return os_thread_mutex_create_ex( lock, NULL );
+}
+
+os_status_t os_thread_mutex_create_ex(
+	os_thread_mutex_t *lock,
+	const os_thread_mutex_attr_t *attr )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
-	if ( lock )
+	if ( lock && ( !attr ||
+		attr->protocol == OS_THREAD_MUTEX_PROTOCOL_NONE ||
+		attr->protocol == OS_THREAD_MUTEX_PROTOCOL_INHERIT ||
+		( attr->protocol == OS_THREAD_MUTEX_PROTOCOL_PROTECT &&
+		  attr->priority >= 1 && attr->priority <= 99 ) ) )
 	{
+		pthread_mutexattr_t pattr;
 		result = OS_STATUS_FAILURE;
-		if ( pthread_mutex_init( lock, NULL ) == 0 )
-			result = OS_STATUS_SUCCESS;
+		if ( pthread_mutexattr_init( &pattr ) == 0 )
+		{
+			int rc = 0;
+			if ( attr && attr->protocol ==
+				OS_THREAD_MUTEX_PROTOCOL_INHERIT )
+			{
+#if defined( _POSIX_THREAD_PRIO_INHERIT ) && _POSIX_THREAD_PRIO_INHERIT > 0
+				rc = pthread_mutexattr_setprotocol( &pattr,
+					PTHREAD_PRIO_INHERIT );
+#else /* if _POSIX_THREAD_PRIO_INHERIT > 0 */
+				rc = ENOTSUP;
+#endif /* else if _POSIX_THREAD_PRIO_INHERIT > 0 */
+			}
+			else if ( attr && attr->protocol ==
+				OS_THREAD_MUTEX_PROTOCOL_PROTECT )
+			{
+#if defined( _POSIX_THREAD_PRIO_PROTECT ) && _POSIX_THREAD_PRIO_PROTECT > 0
+				rc = pthread_mutexattr_setprotocol( &pattr,
+					PTHREAD_PRIO_PROTECT );
+				if ( rc == 0 )
+					rc = pthread_mutexattr_setprioceiling(
+						&pattr, attr->priority );
+#else /* if _POSIX_THREAD_PRIO_PROTECT > 0 */
+				rc = ENOTSUP;
+#endif /* else if _POSIX_THREAD_PRIO_PROTECT > 0 */
+			}
+			if ( rc == 0 && attr && attr->robust != OS_FALSE )
+			{
+#if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT )
+				rc = pthread_mutexattr_setrobust( &pattr,
+					PTHREAD_MUTEX_ROBUST );
+#else /* if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT ) */
+				rc = ENOTSUP;
+#endif /* else if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT ) */
+			}
+			if ( rc == 0 )
+				rc = pthread_mutex_init(
+					OS_THREAD_LOCK_NATIVE( lock ), &pattr );
+
+			if ( rc == 0 )
+			{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+				lock->stats = os_lock_stats_register( "mutex",
+					attr ? attr->name : NULL, lock );
+				lock->acquired = 0u;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+				result = OS_STATUS_SUCCESS;
+			}
+			else if ( rc == ENOTSUP )
+				result = OS_STATUS_NOT_SUPPORTED;
+			else if ( rc == EPERM )
+				result = OS_STATUS_NO_PERMISSION;
+			else if ( rc == ENOMEM )
+				result = OS_STATUS_NO_MEMORY;
+			pthread_mutexattr_destroy( &pattr );
+		}
 	}
 	return result;
 }
 
+os_status_t os_thread_mutex_create_named(
+	os_thread_mutex_t *lock,
+	const char *name )
+{
+	os_thread_mutex_attr_t attr;
+	memset( &attr, 0, sizeof( os_thread_mutex_attr_t ) );
+	attr.name = name;
+	return os_thread_mutex_create_ex( lock, &attr );
+}
+
 os_status_t os_thread_mutex_lock(
 	os_thread_mutex_t *lock )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+		int error_number;
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		error_number = pthread_mutex_trylock( &lock->lock );
+		if ( error_number == EBUSY )
+		{
+			start = os_lock_stats_now();
+			error_number = pthread_mutex_lock( &lock->lock );
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+		error_number = pthread_mutex_lock( lock );
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
-		if ( pthread_mutex_lock( lock ) == 0 )
+		if ( error_number == 0 )
 			result = OS_STATUS_SUCCESS;
+#if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT )
+		/* owner of a robust lock ended while holding it */
+		else if ( error_number == EOWNERDEAD &&
+			pthread_mutex_consistent(
+				OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
+			result = OS_STATUS_OWNER_DIED;
+#endif /* if defined( OS_THREAD_MUTEX_ROBUST_SUPPORT ) */
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		if ( result != OS_STATUS_FAILURE )
+		{
+			lock->acquired = os_lock_stats_now();
+			os_lock_stats_acquired( lock->stats, start,
+				lock->acquired );
+		}
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 	return result;
 }
@@ -2470,9 +5398,20 @@ os_status_t os_thread_mutex_unlock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		/* measured before another thread can acquire the lock */
+		const os_uint64_t hold = os_lock_stats_now() - lock->acquired;
+		result = OS_STATUS_FAILURE;
+		if ( pthread_mutex_unlock( &lock->lock ) == 0 )
+		{
+			os_lock_stats_released( lock->stats, hold );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( pthread_mutex_unlock( lock ) == 0 )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 	return result;
 }
@@ -2484,11 +5423,119 @@ os_status_t os_thread_mutex_destroy(
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( pthread_mutex_destroy( lock ) == 0 )
+		if ( pthread_mutex_destroy( OS_THREAD_LOCK_NATIVE( lock ) ) == 0 )
+		{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+			os_lock_stats_unregister( lock->stats );
+			lock->stats = NULL;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+			result = OS_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+int os_thread_policy_native(
+	os_thread_policy_t policy )
+{
+	int result = -1;
+	if ( policy == OS_THREAD_POLICY_DEFAULT )
+		result = SCHED_OTHER;
+	else if ( policy == OS_THREAD_POLICY_FIFO )
+		result = SCHED_FIFO;
+	else if ( policy == OS_THREAD_POLICY_ROUND_ROBIN )
+		result = SCHED_RR;
+	return result;
+}
+
+os_status_t os_thread_self_affinity_set(
+	os_uint64_t affinity )
+{
+	os_status_t result = OS_STATUS_NOT_SUPPORTED;
+#if defined( __linux__ )
+	cpu_set_t cpus;
+	os_thread_affinity_to_cpus( affinity, &cpus );
+	result = OS_STATUS_FAILURE;
+	/* a process id of 0 refers to the calling thread */
+	if ( sched_setaffinity( 0, sizeof( cpu_set_t ), &cpus ) == 0 )
+		result = OS_STATUS_SUCCESS;
+#else /* if defined( __linux__ ) */
+	(void)affinity;
+#endif /* else if defined( __linux__ ) */
+	return result;
+}
+
+os_status_t os_thread_self_name_set(
+	const char *name )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( name )
+	{
+#if defined( __linux__ ) || defined( __APPLE__ )
+		char thread_name[OS_THREAD_NAME_MAX];
+		strncpy( thread_name, name, OS_THREAD_NAME_MAX - 1u );
+		thread_name[OS_THREAD_NAME_MAX - 1u] = '\0';
+		result = OS_STATUS_FAILURE;
+#	if defined( __APPLE__ )
+		if ( pthread_setname_np( thread_name ) == 0 )
+#	else /* if defined( __APPLE__ ) */
+		if ( pthread_setname_np( pthread_self(), thread_name ) == 0 )
+#	endif /* else if defined( __APPLE__ ) */
 			result = OS_STATUS_SUCCESS;
+#else /* if defined( __linux__ ) || defined( __APPLE__ ) */
+		result = OS_STATUS_NOT_SUPPORTED;
+#endif /* else if defined( __linux__ ) || defined( __APPLE__ ) */
 	}
 	return result;
 }
+
+os_status_t os_thread_self_scheduling_set(
+	os_thread_policy_t policy,
+	int priority )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	const int native_policy = os_thread_policy_native( policy );
+	if ( native_policy >= 0 )
+	{
+		struct sched_param param;
+		int rc;
+
+		memset( &param, 0, sizeof( struct sched_param ) );
+		if ( policy != OS_THREAD_POLICY_DEFAULT )
+			param.sched_priority = priority;
+		rc = pthread_setschedparam( pthread_self(), native_policy,
+			&param );
+		result = OS_STATUS_FAILURE;
+		if ( rc == 0 )
+			result = OS_STATUS_SUCCESS;
+		else if ( rc == EPERM )
+			result = OS_STATUS_NO_PERMISSION;
+	}
+	return result;
+}
+
+OS_THREAD_DECL os_thread_start_main(
+	void *arg )
+{
+	struct os_thread_start *start = (struct os_thread_start *)arg;
+	const os_thread_main_t main = start->main;
+	void *const main_arg = start->arg;
+
+	if ( start->affinity != 0u )
+		os_thread_self_affinity_set( start->affinity );
+	if ( start->name[0] != '\0' )
+		os_thread_self_name_set( start->name );
+	os_free_null( (void **)&start );
+	return main( main_arg );
+}
+
+os_status_t os_thread_yield( void )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	if ( sched_yield() == 0 )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
 #endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
 
 /* uuid support */
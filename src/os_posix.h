@@ -34,6 +34,7 @@
 #include <signal.h> /* for SIGINT, ... */
 #include <sys/socket.h>  /* for AF_INET, SOCK_STREAM, SOCK_DGRAM definition */
 #include <netdb.h>  /* for: (service entry) servent functions */
+#include <sys/uio.h> /* for: struct iovec */
 
 /** @brief Structure representing a network adapter address */
 struct os_adapter_address
@@ -53,6 +54,31 @@ struct os_adapter
  */
 typedef FILE *os_file_t;
 
+/**
+ * @brief Buffer read or written by a vectored file operation
+ *
+ * @see os_file_preadv
+ * @see os_file_pwritev
+ */
+typedef struct iovec os_file_io_vector_t;
+
+/**
+ * @brief Contents of a file mapped into memory
+ *
+ * @see os_file_map
+ */
+typedef struct os_file_map
+{
+	/** @brief Address of the mapped contents */
+	void *address;
+	/** @brief Number of bytes mapped */
+	size_t size;
+	/** @brief Start of the mapping, the address rounded down to a page */
+	void *base;
+	/** @brief Size of the mapping from its start */
+	size_t base_size;
+} os_file_map_t;
+
 /**
  * @brief Handle to an open shared library
  */
@@ -72,6 +98,41 @@ typedef pthread_t os_thread_t;
  * @brief Thread condition lock
  */
 typedef pthread_cond_t os_thread_condition_t;
+#if OSAL_LOCK_STATS
+/**
+ * @brief Contention statistics recorded for a lock
+ */
+typedef struct os_lock_stats os_lock_stats_t;
+/**
+ * @brief Thread mutually exclusive (mutex) lock
+ */
+typedef struct os_thread_mutex
+{
+	/** @brief Native lock */
+	pthread_mutex_t lock;
+	/** @brief Statistics recorded for the lock */
+	os_lock_stats_t *stats;
+	/** @brief Time the lock was acquired, in nanoseconds */
+	os_uint64_t acquired;
+} os_thread_mutex_t;
+/**
+ * @brief Thread read/write lock
+ */
+typedef struct os_thread_rwlock
+{
+	/** @brief Native lock */
+#if defined(__VXWORKS__)
+	SEM_ID lock;
+#else /* defined(__VXWORKS__) */
+	pthread_rwlock_t lock;
+#endif /* else if defined(__VXWORKS__) */
+	/** @brief Statistics recorded for the lock */
+	os_lock_stats_t *stats;
+	/** @brief Time the write lock was acquired, in nanoseconds */
+	os_uint64_t acquired;
+} os_thread_rwlock_t;
+#endif /* if OSAL_LOCK_STATS */
+#if !OSAL_LOCK_STATS
 /**
  * @brief Thread mutually exclusive (mutex) lock
  */
@@ -85,6 +146,7 @@ typedef SEM_ID os_thread_rwlock_t;
 #else /* defined(__VXWORKS__) */
 typedef pthread_rwlock_t os_thread_rwlock_t;
 #endif /* else if defined(__VXWORKS__) */
+#endif /* if !OSAL_LOCK_STATS */
 #endif /* if OSAL_THREAD_SUPPORT */
 
 /**
@@ -156,6 +218,15 @@ typedef char os_uuid_t[16u];
  */
 #define OS_THREAD_DECL OS_THREAD_RETURN OS_THREAD_LINK
 
+/**
+ * @brief Declares a static or global variable with a separate instance for
+ *        each thread
+ *
+ * No destructor is called when a thread exits, use a key from
+ * @p os_thread_local_key_create for values that must be freed.
+ */
+#define OS_THREAD_LOCAL                __thread
+
 /**
  * @brief Type defining the starting point for a thread
  */
@@ -540,6 +611,164 @@ OS_API unsigned long os_strtoul(
 );
 #endif
 
+/* atomic operations */
+/** @brief Memory order: atomicity only, no ordering constraints */
+#define OS_ATOMIC_RELAXED              __ATOMIC_RELAXED
+/** @brief Memory order: no reads or writes can be reordered before this */
+#define OS_ATOMIC_ACQUIRE              __ATOMIC_ACQUIRE
+/** @brief Memory order: no reads or writes can be reordered after this */
+#define OS_ATOMIC_RELEASE              __ATOMIC_RELEASE
+/** @brief Memory order: both acquire and release semantics */
+#define OS_ATOMIC_ACQ_REL              __ATOMIC_ACQ_REL
+/** @brief Memory order: sequentially consistent (total order) */
+#define OS_ATOMIC_SEQ_CST              __ATOMIC_SEQ_CST
+
+/**
+ * @brief 32-bit unsigned integer that is accessed atomically
+ */
+typedef volatile os_uint32_t os_atomic_uint32_t;
+/**
+ * @brief 64-bit unsigned integer that is accessed atomically
+ *
+ * @note Forced to natural alignment, as some 32-bit ABIs only align 64-bit
+ *       integers to 4 bytes which would make the operations non-atomic
+ */
+typedef volatile os_uint64_t os_atomic_uint64_t __attribute__((aligned(8)));
+/**
+ * @brief Pointer that is accessed atomically
+ */
+typedef void *volatile os_atomic_ptr_t;
+
+/**
+ * @brief Memory order to use on failure of a compare & exchange operation
+ *
+ * A failed compare & exchange only performs a load, so it cannot have
+ * release semantics.
+ *
+ * @param[in]      order               memory order requested on success
+ */
+#define OS_ATOMIC_FAILURE_ORDER(order) ( (order) == OS_ATOMIC_ACQ_REL ? OS_ATOMIC_ACQUIRE : ( (order) == OS_ATOMIC_RELEASE ? OS_ATOMIC_RELAXED : (order) ) )
+
+/**
+ * @brief Atomically compares a value and if equal replaces it
+ *
+ * If the value at @p ptr equals @p expected, then @p desired is written to
+ * @p ptr, otherwise the current value is written to @p expected.
+ *
+ * @param[in,out]  ptr                 value to operate on
+ * @param[in,out]  expected            pointer to the expected value
+ * @param[in]      desired             value to write if equal
+ * @param[in]      order               memory order (OS_ATOMIC_*)
+ *
+ * @retval OS_FALSE                    value did not match, nothing written
+ * @retval OS_TRUE                     value matched and was replaced
+ */
+#define os_atomic_cas_u32(ptr, expected, desired, order) (os_bool_t)__atomic_compare_exchange_n( ptr, expected, desired, 0, order, OS_ATOMIC_FAILURE_ORDER( order ) )
+
+/**
+ * @brief Atomically compares a 64-bit value and if equal replaces it
+ * @see os_atomic_cas_u32
+ */
+#define os_atomic_cas_u64(ptr, expected, desired, order) (os_bool_t)__atomic_compare_exchange_n( ptr, expected, desired, 0, order, OS_ATOMIC_FAILURE_ORDER( order ) )
+
+/**
+ * @brief Atomically compares a pointer and if equal replaces it
+ * @see os_atomic_cas_u32
+ */
+#define os_atomic_cas_ptr(ptr, expected, desired, order) (os_bool_t)__atomic_compare_exchange_n( ptr, expected, desired, 0, order, OS_ATOMIC_FAILURE_ORDER( order ) )
+
+/**
+ * @brief Atomically replaces a value
+ *
+ * @param[in,out]  ptr                 value to operate on
+ * @param[in]      value               new value to store
+ * @param[in]      order               memory order (OS_ATOMIC_*)
+ *
+ * @return the value held before the exchange
+ */
+#define os_atomic_exchange_u32(ptr, value, order) __atomic_exchange_n( ptr, value, order )
+
+/**
+ * @brief Atomically replaces a 64-bit value
+ * @see os_atomic_exchange_u32
+ */
+#define os_atomic_exchange_u64(ptr, value, order) __atomic_exchange_n( ptr, value, order )
+
+/**
+ * @brief Atomically replaces a pointer
+ * @see os_atomic_exchange_u32
+ */
+#define os_atomic_exchange_ptr(ptr, value, order) __atomic_exchange_n( ptr, value, order )
+
+/**
+ * @brief Atomically adds to a value
+ *
+ * @param[in,out]  ptr                 value to operate on
+ * @param[in]      value               amount to add (wraps on overflow)
+ * @param[in]      order               memory order (OS_ATOMIC_*)
+ *
+ * @return the value held before the addition
+ */
+#define os_atomic_fetch_add_u32(ptr, value, order) __atomic_fetch_add( ptr, value, order )
+
+/**
+ * @brief Atomically adds to a 64-bit value
+ * @see os_atomic_fetch_add_u32
+ */
+#define os_atomic_fetch_add_u64(ptr, value, order) __atomic_fetch_add( ptr, value, order )
+
+/**
+ * @brief Atomically reads a value
+ *
+ * @param[in]      ptr                 value to read
+ * @param[in]      order               memory order (OS_ATOMIC_RELAXED,
+ *                                     OS_ATOMIC_ACQUIRE or OS_ATOMIC_SEQ_CST)
+ *
+ * @return the value read
+ */
+#define os_atomic_load_u32(ptr, order) __atomic_load_n( ptr, order )
+
+/**
+ * @brief Atomically reads a 64-bit value
+ * @see os_atomic_load_u32
+ */
+#define os_atomic_load_u64(ptr, order) __atomic_load_n( ptr, order )
+
+/**
+ * @brief Atomically reads a pointer
+ * @see os_atomic_load_u32
+ */
+#define os_atomic_load_ptr(ptr, order) __atomic_load_n( ptr, order )
+
+/**
+ * @brief Atomically writes a value
+ *
+ * @param[out]     ptr                 value to write
+ * @param[in]      value               new value
+ * @param[in]      order               memory order (OS_ATOMIC_RELAXED,
+ *                                     OS_ATOMIC_RELEASE or OS_ATOMIC_SEQ_CST)
+ */
+#define os_atomic_store_u32(ptr, value, order) __atomic_store_n( ptr, value, order )
+
+/**
+ * @brief Atomically writes a 64-bit value
+ * @see os_atomic_store_u32
+ */
+#define os_atomic_store_u64(ptr, value, order) __atomic_store_n( ptr, value, order )
+
+/**
+ * @brief Atomically writes a pointer
+ * @see os_atomic_store_u32
+ */
+#define os_atomic_store_ptr(ptr, value, order) __atomic_store_n( ptr, value, order )
+
+/**
+ * @brief Issues a memory fence between threads
+ *
+ * @param[in]      order               memory order (OS_ATOMIC_*)
+ */
+#define os_atomic_thread_fence(order) __atomic_thread_fence( order )
+
 /* memory functions */
 /**
  * @brief Compares two blocks of memory
@@ -718,10 +947,308 @@ OS_API int os_vsnprintf(
 	va_list args
 ) __attribute__((format(printf,3,0)));
 
+/**
+ * @brief Memory allocator used by @p os_malloc and the related functions
+ *
+ * Each function is passed the allocator's user data.  Memory returned by
+ * any function, including @p aligned_alloc_fn, is released by @p free_fn.
+ *
+ * @see os_allocator_set
+ */
+typedef struct os_allocator
+{
+	/** @brief Allocates memory, see @p os_malloc */
+	void *(*malloc_fn)( size_t size, void *user_data );
+	/** @brief Allocates zeroed memory for an array, see @p os_calloc */
+	void *(*calloc_fn)( size_t nmemb, size_t size, void *user_data );
+	/** @brief Changes the size of allocated memory, see @p os_realloc */
+	void *(*realloc_fn)( void *ptr, size_t size, void *user_data );
+	/** @brief Frees allocated memory (ptr is never NULL), see @p os_free */
+	void (*free_fn)( void *ptr, void *user_data );
+	/** @brief Allocates memory aligned to a power of 2 (NULL if the
+	 *         alignment is not supported) */
+	void *(*aligned_alloc_fn)( size_t alignment, size_t size,
+		void *user_data );
+	/** @brief User specific data passed to each function */
+	void *user_data;
+} os_allocator_t;
+
+/**
+ * @brief Returns the allocator used by @p os_malloc and the related
+ *        functions
+ *
+ * @return the allocator set for the calling thread by
+ *         @p os_allocator_thread_set, else the allocator set by
+ *         @p os_allocator_set, or the system allocator
+ *
+ * @see os_allocator_set
+ * @see os_allocator_thread_set
+ */
+OS_API const os_allocator_t *os_allocator_get( void );
+
+/**
+ * @brief Sets the allocator used by @p os_malloc and the related functions
+ *
+ * This includes all memory allocated within the library.  Memory must be
+ * freed by the allocator that allocated it, so the allocator should be set
+ * before any memory is allocated, and before threads are started.  To use
+ * another allocator for only part of the program, see
+ * @p os_allocator_thread_set.
+ *
+ * @param[in]      allocator           allocator to use, must remain valid
+ *                                     while in use (NULL = system allocator)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_allocator_system
+ * @see os_allocator_thread_cache
+ */
+OS_API os_status_t os_allocator_set(
+	const os_allocator_t *allocator
+);
+
+/**
+ * @brief Returns the allocator of the operating system
+ *
+ * @return the system allocator
+ */
+OS_API const os_allocator_t *os_allocator_system( void );
+
+/**
+ * @brief Returns an allocator keeping per-thread caches of small blocks
+ *
+ * Small blocks freed are kept in a cache of the freeing thread, and reused
+ * by its next allocations of the same size class without taking a lock.
+ * Larger blocks, and blocks beyond the cache limit, are passed to the system
+ * allocator.  A thread's cache is returned to the system when it exits.
+ *
+ * @return the thread caching allocator
+ */
+OS_API const os_allocator_t *os_allocator_thread_cache( void );
+
+/**
+ * @brief Sets the allocator used by @p os_malloc and the related functions
+ *        on the calling thread, in place of the one set by
+ *        @p os_allocator_set
+ *
+ * The previous allocator is given back, to be restored by passing it
+ * once done, so that these calls can be nested.  Memory must be freed by
+ * the allocator that allocated it, so memory allocated while an allocator
+ * is set should also be freed while it is set (or released with it, as for
+ * an arena), and memory allocated before should not be freed until the
+ * previous allocator is restored.  Other threads are not affected.
+ *
+ * @param[in]      allocator           allocator to use, must remain valid
+ *                                     while in use (NULL = allocator set by
+ *                                     @p os_allocator_set)
+ * @param[out]     previous            allocator previously set for the
+ *                                     calling thread, NULL if none
+ *                                     (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ *                                     (the allocator is left unchanged)
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_allocator_get
+ * @see os_arena_allocator
+ */
+OS_API os_status_t os_allocator_thread_set(
+	const os_allocator_t *allocator,
+	const os_allocator_t **previous
+);
+
+/**
+ * @brief Chunk of memory owned by an arena
+ */
+struct os_arena_chunk;
+
+/**
+ * @brief Arena handing out memory from large chunks, all released together
+ *
+ * @see os_arena_create
+ */
+typedef struct os_arena
+{
+	/** @brief Most recent chunk, linked to the previous chunks */
+	struct os_arena_chunk *chunk;
+	/** @brief Next free byte of the most recent chunk */
+	char *position;
+	/** @brief End of the most recent chunk */
+	char *end;
+	/** @brief Minimum size of each chunk */
+	size_t chunk_size;
+	/** @brief Allocator providing the chunks */
+	const os_allocator_t *allocator;
+} os_arena_t;
+
+/**
+ * @brief Position within an arena that it can be rewound to
+ *
+ * @see os_arena_checkpoint
+ * @see os_arena_rewind
+ */
+typedef struct os_arena_checkpoint
+{
+	/** @brief Most recent chunk at the time of the checkpoint */
+	struct os_arena_chunk *chunk;
+	/** @brief Next free byte at the time of the checkpoint */
+	char *position;
+} os_arena_checkpoint_t;
+
+/**
+ * @brief Allocates memory from an arena
+ *
+ * The memory returned is suitably aligned for any type, and is NOT
+ * initialized.  It is only released when the arena is rewound, reset or
+ * destroyed.
+ *
+ * @note An arena must not be used by multiple threads at the same time
+ *
+ * @param[in,out]  arena               arena to allocate from
+ * @param[in]      size                amount of memory to allocate
+ *
+ * @retval NULL    invalid parameter or not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ *
+ * @see os_arena_alloc_aligned
+ */
+OS_API void *os_arena_alloc(
+	os_arena_t *arena,
+	size_t size
+) __attribute__((malloc));
+
+/**
+ * @brief Allocates memory with a specific alignment from an arena
+ *
+ * @param[in,out]  arena               arena to allocate from
+ * @param[in]      alignment           alignment of the memory, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ *
+ * @retval NULL    invalid parameter or not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ *
+ * @see os_arena_alloc
+ */
+OS_API void *os_arena_alloc_aligned(
+	os_arena_t *arena,
+	size_t alignment,
+	size_t size
+) __attribute__((malloc));
+
+/**
+ * @brief Sets up an allocator taking its memory from an arena
+ *
+ * This allows functions allocating with @p os_malloc to allocate from the
+ * arena, by setting the allocator for the calling thread with
+ * @p os_allocator_thread_set around the calls, then restoring the previous
+ * one.  Freeing memory only gives it back if it was the arena's most recent
+ * allocation; all of the memory is released with the arena.
+ *
+ * @param[in]      arena               arena to allocate from, must remain
+ *                                     valid while the allocator is in use
+ * @param[out]     allocator           allocator to set up
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_arena_allocator(
+	os_arena_t *arena,
+	os_allocator_t *allocator
+);
+
+/**
+ * @brief Records the current position of an arena
+ *
+ * @param[in]      arena               arena to record the position of
+ * @param[out]     checkpoint          position recorded
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_arena_rewind
+ */
+OS_API os_status_t os_arena_checkpoint(
+	const os_arena_t *arena,
+	os_arena_checkpoint_t *checkpoint
+);
+
+/**
+ * @brief Creates an arena
+ *
+ * No memory is taken until the first allocation.  Chunks are allocated
+ * with the allocator set when the arena is created.
+ *
+ * @param[out]     arena               arena to create
+ * @param[in]      chunk_size          minimum size of each chunk in bytes
+ *                                     (0 = default size)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_arena_destroy
+ */
+OS_API os_status_t os_arena_create(
+	os_arena_t *arena,
+	size_t chunk_size
+);
+
+/**
+ * @brief Releases all of the memory of an arena
+ *
+ * @param[in,out]  arena               arena to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_arena_create
+ */
+OS_API os_status_t os_arena_destroy(
+	os_arena_t *arena
+);
+
+/**
+ * @brief Releases all of the allocations of an arena, keeping its memory
+ *        for reuse
+ *
+ * If the arena holds more than one chunk, they are replaced by a single
+ * chunk of the same total size, so the next allocations of a similar amount
+ * fit in it.
+ *
+ * @note Any checkpoints of the arena are no longer valid
+ *
+ * @param[in,out]  arena               arena to reset
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_arena_reset(
+	os_arena_t *arena
+);
+
+/**
+ * @brief Releases the allocations of an arena made since a checkpoint
+ *
+ * Checkpoints recorded after @p checkpoint are no longer valid.
+ *
+ * @param[in,out]  arena               arena to rewind
+ * @param[in]      checkpoint          position to rewind the arena to
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function,
+ *                                     or checkpoint not from the arena
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_arena_checkpoint
+ */
+OS_API os_status_t os_arena_rewind(
+	os_arena_t *arena,
+	const os_arena_checkpoint_t *checkpoint
+);
+
 /**
  * @brief Allocates memory for an array of elements
  *
- * The memory returned is NOT initialized. Any allocated memory should be
+ * The memory returned is set to zero. Any allocated memory should be
  * deallocated with the corrosponding @p os_free command
  *
  * @note Specifying either 0 elements or elements with a size of 0 may return a
@@ -737,34 +1264,26 @@ OS_API int os_vsnprintf(
  * @see os_malloc
  * @see os_realloc
  */
-#if !OSAL_WRAP
-#define os_calloc(nmemb, size)           calloc(nmemb, size)
-#else
 OS_API void *os_calloc(
 	size_t nmemb,
 	size_t size
 ) __attribute__((malloc));
-#endif
 
 /**
  * @brief Frees previously allocated memory
  *
  * @param[in]      ptr            pointer to the allocated memory to free
  *
- * @warning @c ptr is not checked for NULL prior to deallocation
+ * @note passing NULL does nothing
  *
  * @see os_calloc
  * @see os_free_null
  * @see os_malloc
  * @see os_realloc
  */
-#if !OSAL_WRAP
-#define os_free                        free
-#else
 OS_API void os_free(
 	void *ptr
 );
-#endif
 
 /**
  * @brief Frees previously allocated memory, setting the variable to NULL
@@ -777,13 +1296,37 @@ OS_API void os_free(
  * @see os_malloc
  * @see os_realloc
  */
-#if !OSAL_WRAP
-#define os_free_null(ptr)              { if ( *ptr ) free( *ptr ); *ptr = NULL; }
-#else
 OS_API void os_free_null(
 	void **ptr
 );
-#endif
+
+/**
+ * @brief Frees memory allocated by @p os_malloc_aligned
+ *
+ * @param[in]      ptr            pointer to the allocated memory to free
+ *
+ * @note passing NULL does nothing
+ *
+ * @see os_malloc_aligned
+ */
+OS_API void os_free_aligned(
+	void *ptr
+);
+
+/**
+ * @brief Frees memory allocated by @p os_malloc_large
+ *
+ * @param[in]      ptr            pointer to the allocated memory to free
+ * @param[in]      size           size passed to @p os_malloc_large
+ *
+ * @note passing NULL does nothing
+ *
+ * @see os_malloc_large
+ */
+OS_API void os_free_large(
+	void *ptr,
+	size_t size
+);
 
 /**
  * @brief Allocates the specified amount of bytes
@@ -801,13 +1344,394 @@ OS_API void os_free_null(
  * @see os_free_null
  * @see os_realloc
  */
-#if !OSAL_WRAP
-#define os_malloc(size)                malloc(size)
-#else
 OS_API void *os_malloc(
 	size_t size
 ) __attribute__((malloc));
-#endif
+
+/**
+ * @brief Allocates the specified amount of bytes with a specific alignment
+ *
+ * The memory returned is NOT initialized, and must be freed with
+ * @p os_free_aligned.  It is taken from the @p aligned_alloc_fn function of
+ * the allocator of @p os_malloc, with room before it for the address to
+ * free, so the memory used is larger by up to the alignment requested.
+ *
+ * @param[in]      alignment           alignment of the memory, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ *
+ * @retval NULL    invalid alignment, alignment not supported by the
+ *                 allocator or not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ *
+ * @see os_free_aligned
+ * @see os_malloc
+ * @see os_malloc_large
+ */
+OS_API void *os_malloc_aligned(
+	size_t alignment,
+	size_t size
+) __attribute__((malloc));
+
+/**
+ * @brief Backs a large allocation with huge pages when available, to reduce
+ *        the number of TLB misses when accessing it
+ * @see os_malloc_large
+ */
+#define OS_MEMORY_FLAG_HUGE_PAGES      0x1u
+
+/**
+ * @brief Faults in every page of a large allocation before it is returned,
+ *        so the first access to it never waits for the operating system
+ * @see os_malloc_large
+ */
+#define OS_MEMORY_FLAG_PREFAULT        0x2u
+
+/**
+ * @brief Locks a large allocation in physical memory, so it is never paged
+ *        out (for real-time use)
+ * @see os_malloc_large
+ */
+#define OS_MEMORY_FLAG_LOCK            0x4u
+
+/**
+ * @brief Allocates a large amount of memory directly from the operating
+ *        system
+ *
+ * The memory returned is page aligned and zeroed, and must be freed with
+ * @p os_free_large.  It is not taken from the allocator of @p os_malloc,
+ * and is not accounted by @p os_memory_stats.
+ *
+ * Huge pages are reserved pages of the system if any are available,
+ * otherwise the system is advised to use transparent huge pages.  When
+ * neither is possible, regular pages are used.  Locking the memory however
+ * fails the allocation when it is not permitted.
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      flags               options for the memory
+ *                                     (OS_MEMORY_FLAG_*)
+ *
+ * @retval NULL    invalid parameter, not enough memory available or the
+ *                 memory could not be locked
+ * @retval !NULL   a pointer to the allocated memory
+ *
+ * @see os_free_large
+ * @see os_malloc_aligned
+ */
+OS_API void *os_malloc_large(
+	size_t size,
+	unsigned int flags
+) __attribute__((malloc));
+
+/**
+ * @brief Memory tag for allocations not tagged otherwise, and the
+ *        application's own
+ * @see os_memory_tag_set
+ */
+#define OS_MEMORY_TAG_DEFAULT          0u
+
+/**
+ * @brief Memory tag for allocations made by the socket functions
+ */
+#define OS_MEMORY_TAG_SOCKET           1u
+
+/**
+ * @brief Memory tag for allocations made by the file and directory
+ *        functions
+ */
+#define OS_MEMORY_TAG_FILE             2u
+
+/**
+ * @brief Memory tag for allocations made by the process and service
+ *        functions
+ */
+#define OS_MEMORY_TAG_PROCESS          3u
+
+/**
+ * @brief Memory tag for allocations made by the thread functions
+ */
+#define OS_MEMORY_TAG_THREAD           4u
+
+/**
+ * @brief First memory tag available for application-defined tags
+ */
+#define OS_MEMORY_TAG_APP              8u
+
+/**
+ * @brief Number of memory tags, application-defined tags are below this
+ */
+#define OS_MEMORY_TAG_MAX              16u
+
+/**
+ * @brief Identifies the subsystem holding allocated memory
+ *        (OS_MEMORY_TAG_*)
+ */
+typedef unsigned int os_memory_tag_t;
+
+/**
+ * @brief Memory held under a tag
+ */
+typedef struct os_memory_tag_stats
+{
+	/** @brief Number of bytes allocated and not yet freed */
+	os_uint64_t bytes;
+	/** @brief Highest number of bytes allocated at once */
+	os_uint64_t bytes_max;
+	/** @brief Number of allocations not yet freed */
+	os_uint64_t count;
+	/** @brief Total number of allocations made */
+	os_uint64_t allocations;
+} os_memory_tag_stats_t;
+
+/**
+ * @brief Snapshot of the memory held by each tag
+ *
+ * @see os_memory_stats
+ */
+typedef struct os_memory_stats
+{
+	/** @brief Memory held by each tag */
+	os_memory_tag_stats_t tags[OS_MEMORY_TAG_MAX];
+	/** @brief Memory held by all tags */
+	os_memory_tag_stats_t total;
+} os_memory_stats_t;
+
+/**
+ * @brief Allocates the specified amount of bytes, accounted under a tag
+ *
+ * The tag stays with the memory when it is resized or freed.  Without
+ * OSAL_MEMORY_STATS this is the same as @p os_malloc.
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      tag                 tag to account the memory under
+ *                                     (OS_MEMORY_TAG_*)
+ *
+ * @retval NULL    the specified amount of memory is not continously available
+ * @retval !NULL   a pointer to the allocated memory
+ *
+ * @see os_free
+ * @see os_malloc
+ * @see os_memory_stats
+ */
+OS_API void *os_malloc_tagged(
+	size_t size,
+	os_memory_tag_t tag
+) __attribute__((malloc));
+
+/**
+ * @brief Retrieves a snapshot of the memory held by each tag
+ *
+ * Memory is only accounted when the library is built with
+ * OSAL_MEMORY_STATS.  Each thread counts its own allocations, and adds them
+ * to shared totals once they change by more than a few kilobytes; the
+ * snapshot adds up the totals and the counts of the running threads.  The
+ * highest number of bytes is tracked from these totals, so it may miss
+ * short peaks smaller than that amount per thread.
+ *
+ * Blocks of pools and chunks of arenas are accounted under the tag of the
+ * thread that allocated them.
+ *
+ * @param[out]     stats               snapshot of the memory held
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_SUPPORTED     statistics not built into the library
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_memory_tag_set
+ */
+OS_API os_status_t os_memory_stats(
+	os_memory_stats_t *stats
+);
+
+/**
+ * @brief Sets the tag of the memory allocated by the calling thread
+ *
+ * Applies to @p os_malloc, @p os_calloc and @p os_realloc of a NULL
+ * pointer, until the tag is set again.  Returning the previous tag allows a
+ * scope to restore it.
+ *
+ * @param[in]      tag                 tag to account allocations under
+ *                                     (OS_MEMORY_TAG_*)
+ *
+ * @return the previous tag of the calling thread (always
+ *         OS_MEMORY_TAG_DEFAULT without OSAL_MEMORY_STATS)
+ */
+OS_API os_memory_tag_t os_memory_tag_set(
+	os_memory_tag_t tag
+);
+
+/**
+ * @brief Aligns each object of a pool to a cache line, so objects used by
+ *        different threads never share one
+ * @see os_pool_create
+ */
+#define OS_POOL_FLAG_CACHE_ALIGN       0x1u
+
+/**
+ * @brief Fills free objects of a pool with a pattern, checked when they are
+ *        reused, to detect writes to objects after they are freed
+ * @see os_pool_create
+ * @see os_pool_stats_t
+ */
+#define OS_POOL_FLAG_POISON            0x2u
+
+/**
+ * @brief Free objects of a pool cached by a thread
+ */
+struct os_pool_cache;
+
+/**
+ * @brief Pool of objects of a fixed size
+ *
+ * Each thread keeps a cache of free objects, so most allocations and frees
+ * take no lock.  Caches are refilled from, and return their excess to, a
+ * list shared by all threads without taking a lock.
+ *
+ * @see os_pool_create
+ */
+typedef struct os_pool
+{
+	/** @brief Free objects shared by all threads */
+	os_atomic_ptr_t free_list;
+	/** @brief Blocks of memory the objects are carved from */
+	void *blocks;
+	/** @brief Caches of free objects kept by threads */
+	struct os_pool_cache *caches;
+	/** @brief Allocator providing the blocks */
+	const os_allocator_t *allocator;
+	/** @brief Size of each object, including padding */
+	size_t object_size;
+	/** @brief Alignment of each object */
+	size_t alignment;
+	/** @brief Number of objects carved from each block */
+	size_t block_objects;
+	/** @brief Flags the pool was created with (OS_POOL_FLAG_*) */
+	unsigned int flags;
+	/** @brief Number of blocks allocated */
+	os_atomic_uint32_t block_count;
+	/** @brief Number of objects held by threads, in use or cached */
+	os_atomic_uint32_t held;
+	/** @brief Highest number of objects held by threads */
+	os_atomic_uint32_t held_max;
+	/** @brief Number of times a thread's cache was refilled */
+	os_atomic_uint32_t refills;
+	/** @brief Number of free objects found modified when reused */
+	os_atomic_uint32_t poison_errors;
+#if OSAL_THREAD_SUPPORT
+	/** @brief Lock protecting the blocks and the list of caches */
+	os_thread_mutex_t lock;
+	/** @brief Key holding each thread's cache */
+	pthread_key_t key;
+#endif /* if OSAL_THREAD_SUPPORT */
+} os_pool_t;
+
+/**
+ * @brief Statistics of a pool
+ *
+ * @see os_pool_stats
+ */
+typedef struct os_pool_stats
+{
+	/** @brief Number of objects allocated and not yet freed */
+	os_uint32_t in_use;
+	/** @brief Highest number of objects held by threads, either in use or
+	 *         in their caches, an upper bound of the highest in use */
+	os_uint32_t high_watermark;
+	/** @brief Number of objects carved from the blocks allocated */
+	os_uint32_t capacity;
+	/** @brief Number of times a thread's cache was refilled from the
+	 *         objects shared by all threads */
+	os_uint32_t refills;
+	/** @brief Number of free objects found modified when reused, with
+	 *         OS_POOL_FLAG_POISON */
+	os_uint32_t poison_errors;
+} os_pool_stats_t;
+
+/**
+ * @brief Allocates an object from a pool
+ *
+ * The memory returned is NOT initialized.
+ *
+ * @param[in,out]  pool                pool to allocate from
+ *
+ * @retval NULL    invalid parameter or not enough memory available
+ * @retval !NULL   a pointer to the object
+ *
+ * @see os_pool_free
+ */
+OS_API void *os_pool_alloc(
+	os_pool_t *pool
+) __attribute__((malloc));
+
+/**
+ * @brief Creates a pool of objects of a fixed size
+ *
+ * Objects are carved from blocks taken from the allocator set when the pool
+ * is created, and the blocks are only released when the pool is destroyed.
+ *
+ * @param[out]     pool                pool to create
+ * @param[in]      object_size         size of each object in bytes
+ * @param[in]      block_objects       number of objects carved from each
+ *                                     block (0 = default number)
+ * @param[in]      flags               options (OS_POOL_FLAG_*)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           failed to create the pool
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_pool_destroy
+ */
+OS_API os_status_t os_pool_create(
+	os_pool_t *pool,
+	size_t object_size,
+	size_t block_objects,
+	unsigned int flags
+);
+
+/**
+ * @brief Destroys a pool, releasing all of its objects
+ *
+ * @param[in,out]  pool                pool to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_pool_create
+ */
+OS_API os_status_t os_pool_destroy(
+	os_pool_t *pool
+);
+
+/**
+ * @brief Returns an object to a pool
+ *
+ * The object may be freed by a different thread than the one that
+ * allocated it.
+ *
+ * @param[in,out]  pool                pool the object was allocated from
+ * @param[in]      ptr                 object to free
+ *
+ * @note passing NULL does nothing
+ *
+ * @see os_pool_alloc
+ */
+OS_API void os_pool_free(
+	os_pool_t *pool,
+	void *ptr
+);
+
+/**
+ * @brief Retrieves the statistics of a pool
+ *
+ * @param[in]      pool                pool to retrieve the statistics of
+ * @param[out]     stats               statistics of the pool
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_pool_stats(
+	os_pool_t *pool,
+	os_pool_stats_t *stats
+);
 
 /**
  * @brief Change the size of an allocated memory block
@@ -831,14 +1755,10 @@ OS_API void *os_malloc(
  * @see os_free
  * @see os_malloc
  */
-#if !OSAL_WRAP
-#define os_realloc(ptr, size)          realloc(ptr, size)
-#else
 OS_API void *os_realloc(
 	void *ptr,
 	size_t size
 ) __attribute__((malloc));
-#endif
 
 /* service entry (servent) functions */
 /**
@@ -1013,237 +1933,1997 @@ OS_API os_lib_handle os_library_open(
 #if OSAL_THREAD_SUPPORT
 /* thread support */
 /**
- * @brief Wakes up all threads waiting on a condition variable
- *
- * @param[in,out]  cond                condition variable to wake up
+ * @brief Lightweight event that threads can wait on
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_event_create
  */
-OS_API os_status_t os_thread_condition_broadcast(
-	os_thread_condition_t *cond
-);
+typedef struct os_thread_event
+{
+	/** @brief Non-zero if the event is currently set */
+	os_atomic_uint32_t state;
+	/** @brief Number of threads blocked waiting on the event */
+	os_atomic_uint32_t waiters;
+	/** @brief Whether the event remains set until explicitly reset */
+	os_bool_t manual_reset;
+} os_thread_event_t;
 
 /**
- * @brief Creates a new condition variable
- *
- * @param[in,out]  cond                newly created condition variable
+ * @brief Lightweight counting semaphore
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_semaphore_create
  */
-OS_API os_status_t os_thread_condition_create(
-	os_thread_condition_t *cond
-);
+typedef struct os_thread_semaphore
+{
+	/** @brief Number of resources currently available */
+	os_atomic_uint32_t count;
+	/** @brief Number of threads blocked waiting on a resource */
+	os_atomic_uint32_t waiters;
+} os_thread_semaphore_t;
 
 /**
- * @brief Destroys a previously created condition variable
- *
- * @param[in,out]  cond                previously created condition variable
+ * @brief Countdown latch, releasing the threads waiting on it once counted
+ *        down to zero
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_latch_create
  */
-OS_API os_status_t os_thread_condition_destroy(
-	os_thread_condition_t *cond
-);
+typedef struct os_thread_latch
+{
+	/** @brief Number of count downs remaining */
+	os_atomic_uint32_t count;
+} os_thread_latch_t;
 
 /**
- * @brief Signals a thread waiting on a condition variable to wake up
- *
- * @param[in,out]  cond                condition variable to signal
- * @param[in,out]  lock                lock prototecting condition variable
+ * @brief Barrier, where a set number of threads wait for each other
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_barrier_create
  */
-OS_API os_status_t os_thread_condition_signal(
-	os_thread_condition_t *cond,
-	os_thread_mutex_t *lock
-);
+typedef struct os_thread_barrier
+{
+	/** @brief Number of threads that arrived in the current phase */
+	os_atomic_uint32_t arrived;
+	/** @brief Number of the current phase, changes when it completes */
+	os_atomic_uint32_t phase;
+	/** @brief Number of threads taking part */
+	os_uint32_t thread_count;
+} os_thread_barrier_t;
 
 /**
- * @brief Waits a specified amount of time for a condition variable
- *
- * @param[in,out]  cond                condition variable to wait on
- * @param[in,out]  lock                lock protecting condition variable
- * @param[in]      max_time_out        maximum amount of time to wait
+ * @brief State of a one-time initialization
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
- * @retval OS_STATUS_TIMED_OUT         maximum wait time reached
+ * @see os_thread_once
  */
-OS_API os_status_t os_thread_condition_timed_wait(
-	os_thread_condition_t *cond,
-	os_thread_mutex_t *lock,
-	os_millisecond_t max_time_out
-);
+typedef os_atomic_uint32_t os_thread_once_t;
+
+/** @brief Initial value of an @p os_thread_once_t */
+#define OS_THREAD_ONCE_INIT            0u
 
 /**
- * @brief Creates a new thread
+ * @brief Function called by @p os_thread_once
  *
- * @param[in,out]  thread              newly created thread object
- * @param[in]      main                main method to call for the thread
  * @param[in]      arg                 user specific data
- * @param[in]      stack_size          size of stack to use (0 = default)
- *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_create(
-	os_thread_t *thread,
-	os_thread_main_t main,
-	void *arg,
-	size_t stack_size
-);
+typedef void (*os_thread_once_func_t)( void *arg );
 
 /**
- * @brief Destroys a previously created thread
+ * @brief Key identifying a value stored separately by each thread
  *
- * @param[in,out]  thread              thread object to destroy
- *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_local_key_create
  */
-OS_API os_status_t os_thread_destroy(
-	os_thread_t *thread
-);
+typedef pthread_key_t os_thread_local_key_t;
 
 /**
- * @brief Creates a new mutally exclusive lock
+ * @brief Function called for a thread's value of a key, when the thread exits
  *
- * @param[in,out]  lock                newly created lock
+ * @param[in]      value               thread's value for the key (not NULL)
+ */
+typedef void (OS_THREAD_LINK *os_thread_local_destructor_t)( void *value );
+
+/**
+ * @brief Mutex that spins briefly before sleeping when contended
  *
- * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
- * @retval OS_STATUS_SUCCESS           on success
+ * @see os_thread_adaptive_mutex_create
+ */
+typedef struct os_thread_adaptive_mutex
+{
+	/** @brief 0 = unlocked, 1 = locked, 2 = locked with threads sleeping */
+	os_atomic_uint32_t state;
+} os_thread_adaptive_mutex_t;
+
+/**
+ * @brief Spin lock, for very short critical sections
+ *
+ * @see os_thread_spinlock_create
+ */
+typedef struct os_thread_spinlock
+{
+	/** @brief Non-zero while the lock is held */
+	os_atomic_uint32_t locked;
+} os_thread_spinlock_t;
+
+/**
+ * @brief Reader-writer lock for data that is read far more often than it is
+ *        written, readers do not contend on a shared counter
+ *
+ * @see os_thread_brlock_create
+ */
+typedef struct os_thread_brlock
+{
+	/** @brief Reader counters, one per CPU and each on its own cache line */
+	struct os_thread_brlock_slot *slots;
+	/** @brief Number of reader counters (power of 2) */
+	os_uint32_t slot_count;
+	/** @brief 0 = no writer, 1 = writer waiting, 2 = writer holds the lock */
+	os_atomic_uint32_t state;
+	/** @brief New readers wait while a writer is waiting for the lock */
+	os_bool_t writer_preference;
+	/** @brief Serializes writers */
+	os_thread_adaptive_mutex_t write_lock;
+	/** @brief Memory allocated for the reader counters */
+	void *memory;
+} os_thread_brlock_t;
+
+/**
+ * @brief Function called to free a snapshot once no reader can access it
+ *
+ * @param[in]      snapshot            snapshot to free
+ */
+typedef void (*os_rcu_free_t)( void *snapshot );
+
+/**
+ * @brief Pointer to a snapshot of data, which readers access without locking
+ *        and writers replace as a whole (read-copy-update)
+ *
+ * @see os_rcu_ptr_create
+ */
+typedef struct os_rcu_ptr
+{
+	/** @brief Current snapshot */
+	os_atomic_ptr_t snapshot;
+	/** @brief Reader counters, two per CPU and each CPU on its own cache line */
+	struct os_rcu_slot *slots;
+	/** @brief Number of reader counters per side (power of 2) */
+	os_uint32_t slot_count;
+	/** @brief Grace period counter, the lowest bit selects the counters new
+	 *         readers use */
+	os_atomic_uint32_t epoch;
+	/** @brief Function to free replaced snapshots (optional) */
+	os_rcu_free_t free_fn;
+	/** @brief Serializes writers */
+	os_thread_adaptive_mutex_t write_lock;
+	/** @brief Memory allocated for the reader counters */
+	void *memory;
+} os_rcu_ptr_t;
+
+/**
+ * @brief Handle of a reader of a read-copy-update pointer, between locking
+ *        and unlocking
+ *
+ * @see os_rcu_ptr_read_lock
+ */
+typedef struct os_rcu_reader
+{
+	/** @brief Reader counter incremented by the reader */
+	os_atomic_uint32_t *counter;
+} os_rcu_reader_t;
+
+/**
+ * @brief Sequence lock, for small records that are read far more often than
+ *        they are written
+ *
+ * @see os_seqlock_create
+ */
+typedef struct os_seqlock
+{
+	/** @brief Sequence number, odd while a write is in progress */
+	os_atomic_uint32_t sequence;
+	/** @brief Serializes writers */
+	os_thread_adaptive_mutex_t write_lock;
+} os_seqlock_t;
+
+/**
+ * @brief Number of levels in the timing wheel of a timer service
+ */
+#define OS_TIMER_WHEEL_LEVELS          4u
+
+/**
+ * @brief Number of bits of the expiry time handled by each level of the
+ *        timing wheel
+ */
+#define OS_TIMER_WHEEL_BITS            8u
+
+/**
+ * @brief Number of slots in each level of the timing wheel
+ */
+#define OS_TIMER_WHEEL_SLOTS           256u
+
+/** @brief Type for a timer */
+typedef struct os_timer os_timer_t;
+
+/**
+ * @brief Function called when a timer expires
+ *
+ * @param[in,out]  timer               timer that expired
+ * @param[in]      user_data           user specific data given when the
+ *                                     timer was created
+ */
+typedef void (*os_timer_callback_t)( os_timer_t *timer, void *user_data );
+
+/**
+ * @brief Timer, scheduled on a timer service
+ *
+ * The structure is owned by the caller and linked directly into the timer
+ * service, so starting and stopping a timer does not allocate memory.
+ *
+ * @see os_timer_create
+ */
+struct os_timer
+{
+	/** @brief Next timer in the same slot of the timing wheel */
+	struct os_timer *next;
+	/** @brief Link pointing to this timer, in the slot or previous timer */
+	struct os_timer **prev;
+	/** @brief Time the timer expires, as returned by os_time_monotonic */
+	os_timestamp_t expiry;
+	/** @brief Interval between expiries of a periodic timer (0 = one-shot) */
+	os_millisecond_t period;
+	/** @brief Function called when the timer expires */
+	os_timer_callback_t callback;
+	/** @brief User specific data passed to the callback */
+	void *user_data;
+	/** @brief Service the timer is scheduled on (NULL = not scheduled) */
+	struct os_timer_service *service;
+};
+
+/**
+ * @brief Service running timers from a hierarchical timing wheel
+ *
+ * The lowest level of the wheel has a slot for each millisecond, each
+ * higher level covers OS_TIMER_WHEEL_SLOTS times the range of the level
+ * below.  Timers in higher levels are moved down when their slot is reached.
+ *
+ * @see os_timer_service_create
+ */
+typedef struct os_timer_service
+{
+	/** @brief Slots of the timing wheel, each a list of timers */
+	os_timer_t *wheel[OS_TIMER_WHEEL_LEVELS][OS_TIMER_WHEEL_SLOTS];
+	/** @brief Next time (in milliseconds) to process */
+	os_timestamp_t current;
+	/** @brief Number of timers scheduled */
+	os_uint32_t count;
+	/** @brief Protects the timing wheel */
+	os_thread_mutex_t lock;
+	/** @brief Wakes up the service thread */
+	os_thread_event_t wake_up;
+	/** @brief Time the service thread sleeps until (0 = not sleeping) */
+	os_timestamp_t sleep_until;
+	/** @brief Whether the service thread is running */
+	os_bool_t running;
+	/** @brief Service thread */
+	os_thread_t thread;
+} os_timer_service_t;
+
+/** @brief Type for a thread monitored by a watchdog */
+typedef struct os_watchdog_entry os_watchdog_entry_t;
+
+/**
+ * @brief Function called when a monitored thread has stalled
+ *
+ * @param[in]      entry               entry of the stalled thread
+ * @param[in]      stalled             time since the thread's last heartbeat,
+ *                                     in milliseconds
+ * @param[in]      user_data           user specific data given when the
+ *                                     watchdog was created
+ */
+typedef void (*os_watchdog_callback_t)( os_watchdog_entry_t *entry,
+	os_millisecond_t stalled, void *user_data );
+
+/**
+ * @brief Thread monitored by a watchdog
+ *
+ * The structure is owned by the caller and linked directly into the
+ * watchdog, a heartbeat only stores the current time.
+ *
+ * @see os_watchdog_register
+ */
+struct os_watchdog_entry
+{
+	/** @brief Time of the last heartbeat, as returned by os_time_monotonic */
+	os_atomic_uint64_t heartbeat;
+	/** @brief Heartbeat seen by the last check */
+	os_timestamp_t checked;
+	/** @brief Time to report the thread as stalled, unless it heartbeats */
+	os_timestamp_t report;
+	/** @brief Longest time allowed between heartbeats */
+	os_millisecond_t threshold;
+	/** @brief Name identifying the thread (optional) */
+	const char *name;
+	/** @brief Next entry of the watchdog */
+	struct os_watchdog_entry *next;
+	/** @brief Link pointing to this entry, in the watchdog or previous entry */
+	struct os_watchdog_entry **prev;
+	/** @brief Watchdog the entry is registered with (NULL = none) */
+	struct os_watchdog *watchdog;
+};
+
+/**
+ * @brief Watchdog, detecting threads that stop sending heartbeats
+ *
+ * @see os_watchdog_create
+ */
+typedef struct os_watchdog
+{
+	/** @brief Threads monitored */
+	os_watchdog_entry_t *entries;
+	/** @brief Function called for each stalled thread */
+	os_watchdog_callback_t callback;
+	/** @brief User specific data passed to the callback */
+	void *user_data;
+	/** @brief Time between checks by the monitor thread */
+	os_millisecond_t interval;
+	/** @brief Protects the list of threads monitored */
+	os_thread_mutex_t lock;
+	/** @brief Wakes up the monitor thread */
+	os_thread_event_t wake_up;
+	/** @brief Whether the monitor thread is running */
+	os_bool_t running;
+	/** @brief Monitor thread */
+	os_thread_t thread;
+} os_watchdog_t;
+
+/**
+ * @brief Size of the stack of a fiber, if the scheduler is not given one
+ */
+#define OS_FIBER_STACK_SIZE            65536u
+
+/** @brief Type for a fiber */
+typedef struct os_fiber os_fiber_t;
+
+/** @brief Type for a scheduler running fibers on a thread */
+typedef struct os_fiber_scheduler os_fiber_scheduler_t;
+
+/**
+ * @brief Main method for a fiber
+ *
+ * @param[in]      arg                 user specific data
+ */
+typedef void (*os_fiber_main_t)( void *arg );
+
+/**
+ * @brief Function processing part of a range, for @p os_parallel_for
+ *
+ * @param[in]      begin               first index to process
+ * @param[in]      end                 index after the last one to process
+ * @param[in]      arg                 user specific data
+ */
+typedef void (*os_parallel_for_t)( size_t begin, size_t end, void *arg );
+
+/**
+ * @brief Function accumulating part of a range into a partial result, for
+ *        @p os_parallel_reduce
+ *
+ * @param[in]      begin               first index to process
+ * @param[in]      end                 index after the last one to process
+ * @param[in,out]  partial             partial result to accumulate into
+ * @param[in]      arg                 user specific data
+ */
+typedef void (*os_parallel_map_t)( size_t begin, size_t end,
+	void *partial, void *arg );
+
+/**
+ * @brief Function combining a partial result into the total, for
+ *        @p os_parallel_reduce
+ *
+ * @param[in,out]  total               total to combine into
+ * @param[in]      partial             partial result of a thread
+ * @param[in]      arg                 user specific data
+ */
+typedef void (*os_parallel_combine_t)( void *total, const void *partial,
+	void *arg );
+
+/**
+ * @brief Maximum length of a thread name, including the null-terminator
+ */
+#define OS_THREAD_NAME_MAX             16u
+
+/**
+ * @brief Scheduling policies for a thread
+ */
+typedef enum os_thread_policy
+{
+	/** @brief Default time-sharing scheduling of the operating system */
+	OS_THREAD_POLICY_DEFAULT = 0,
+	/** @brief Real-time, first-in first-out scheduling */
+	OS_THREAD_POLICY_FIFO,
+	/** @brief Real-time, round-robin scheduling */
+	OS_THREAD_POLICY_ROUND_ROBIN
+} os_thread_policy_t;
+
+/**
+ * @brief Attributes used when creating a thread
+ *
+ * A zero-initialized structure creates a thread with the default attributes.
+ *
+ * @see os_thread_create_ex
+ */
+typedef struct os_thread_attr
+{
+	/** @brief Mask of the CPUs the thread may run on (bit n = CPU n, 0 = any) */
+	os_uint64_t affinity;
+	/** @brief Thread resources are released on exit, it can not be waited on */
+	os_bool_t detached;
+	/** @brief Name of the thread (optional, truncated if too long) */
+	const char *name;
+	/** @brief Scheduling policy */
+	os_thread_policy_t policy;
+	/** @brief Real-time priority, from 1 (lowest) to 99 (highest) */
+	int priority;
+	/** @brief Size of stack to use (0 = default) */
+	size_t stack_size;
+} os_thread_attr_t;
+
+/**
+ * @brief Protocols avoiding priority inversion on a mutex
+ */
+typedef enum os_thread_mutex_protocol
+{
+	/** @brief Locking does not change the priority of the owner */
+	OS_THREAD_MUTEX_PROTOCOL_NONE = 0,
+	/** @brief Owner inherits the priority of the highest waiting thread */
+	OS_THREAD_MUTEX_PROTOCOL_INHERIT,
+	/** @brief Owner runs at the priority ceiling of the mutex */
+	OS_THREAD_MUTEX_PROTOCOL_PROTECT
+} os_thread_mutex_protocol_t;
+
+/**
+ * @brief Attributes used when creating a mutex
+ *
+ * A zero-initialized structure creates a mutex with the default attributes.
+ *
+ * @see os_thread_mutex_create_ex
+ */
+typedef struct os_thread_mutex_attr
+{
+	/** @brief Name reported by os_lock_stats_dump (optional) */
+	const char *name;
+	/** @brief Priority ceiling, from 1 (lowest) to 99 (highest), used by
+	 *         OS_THREAD_MUTEX_PROTOCOL_PROTECT */
+	int priority;
+	/** @brief Protocol avoiding priority inversion */
+	os_thread_mutex_protocol_t protocol;
+	/** @brief Lock is recovered if its owner ends while holding it */
+	os_bool_t robust;
+} os_thread_mutex_attr_t;
+
+/**
+ * @brief Blocks while a value is equal to an expected value
+ *
+ * The value is compared atomically with the caller being put to sleep, so a
+ * call to @p os_atomic_wake_u32 made after changing the value can not be
+ * missed.  The function may return spuriously, so callers are expected to
+ * re-check the value in a loop.
+ *
+ * @param[in]      ptr                 value to wait on
+ * @param[in]      expected            value to sleep on
+ * @param[in]      deadline            absolute time to give up, as returned
+ *                                     by @p os_time_monotonic (optional,
+ *                                     NULL waits indefinitely)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           woken up, value changed or spurious
+ *                                     wake up
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ *
+ * @see os_atomic_wake_u32
+ */
+OS_API os_status_t os_atomic_wait_u32(
+	os_atomic_uint32_t *ptr,
+	os_uint32_t expected,
+	const os_timestamp_t *deadline
+);
+
+/**
+ * @brief Wakes threads blocked in @p os_atomic_wait_u32 on a value
+ *
+ * @param[in]      ptr                 value being waited on
+ * @param[in]      wake_all            wake all waiting threads, instead of
+ *                                     just one
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_atomic_wait_u32
+ */
+OS_API os_status_t os_atomic_wake_u32(
+	os_atomic_uint32_t *ptr,
+	os_bool_t wake_all
+);
+
+/**
+ * @brief Creates a fiber, ready to run on a scheduler
+ *
+ * A fiber has its own stack, and runs until it waits, yields or returns
+ * from its main method.  Its resources are reused for the next fiber
+ * created on the same scheduler once it returns.
+ *
+ * @param[in,out]  scheduler           scheduler to run the fiber on
+ * @param[in]      main                main method for the fiber
+ * @param[in]      arg                 user specific data for main method
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NO_MEMORY         not enough memory for the stack
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_fiber_scheduler_run
+ */
+OS_API os_status_t os_fiber_create(
+	os_fiber_scheduler_t *scheduler,
+	os_fiber_main_t main,
+	void *arg
+);
+
+/**
+ * @brief Creates a scheduler for running fibers
+ *
+ * Socket functions called from a fiber wait in the scheduler's event loop,
+ * running other fibers, instead of blocking the thread.  One fiber may wait
+ * to read from a socket while another waits to write to it, a second fiber
+ * waiting the same way on a socket fails instead.
+ *
+ * @param[out]     scheduler           scheduler created
+ * @param[in]      stack_size          size of the stack of each fiber
+ *                                     (0 = OS_FIBER_STACK_SIZE)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_fiber_scheduler_create(
+	os_fiber_scheduler_t **scheduler,
+	size_t stack_size
+);
+
+/**
+ * @brief Destroys a scheduler, and the stacks of all its fibers
+ *
+ * @note Fibers that have not returned are discarded without being resumed
+ *
+ * @param[in,out]  scheduler           scheduler to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_fiber_scheduler_destroy(
+	os_fiber_scheduler_t *scheduler
+);
+
+/**
+ * @brief Runs the fibers of a scheduler on the calling thread, until all
+ *        have returned
+ *
+ * @param[in,out]  scheduler           scheduler to run
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           waiting for events failed
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_fiber_scheduler_run(
+	os_fiber_scheduler_t *scheduler
+);
+
+/**
+ * @brief Returns the fiber running on the calling thread
+ *
+ * @retval NULL                        not called from a fiber
+ * @retval !NULL                       fiber running
+ */
+OS_API os_fiber_t *os_fiber_self( void );
+
+/**
+ * @brief Suspends the calling fiber for a period of time, running other
+ *        fibers
+ *
+ * @param[in]      time_out            time to sleep for
+ *
+ * @retval OS_STATUS_BAD_REQUEST       not called from a fiber
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_fiber_sleep(
+	os_millisecond_t time_out
+);
+
+/**
+ * @brief Lets the other fibers that are ready run, before continuing
+ *
+ * @retval OS_STATUS_BAD_REQUEST       not called from a fiber
+ * @retval OS_STATUS_NOT_SUPPORTED     fibers not supported on platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_fiber_yield( void );
+
+/**
+ * @brief Writes the contention statistics recorded for each lock
+ *
+ * Statistics are only recorded when the library is built with
+ * OSAL_LOCK_STATS.  For each mutex and read/write lock it lists the number
+ * of acquisitions, how many of them had to wait and histograms of the time
+ * spent waiting and holding the lock.  Histogram bucket "n" counts times
+ * from 2^n up to 2^(n+1) nanoseconds.  Locks are labelled by the name given
+ * at creation, or by their address.
+ *
+ * @param[in]      out                 stream to write to
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_SUPPORTED     statistics not built into the library
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_thread_mutex_create_named
+ * @see os_thread_rwlock_create_named
+ */
+OS_API os_status_t os_lock_stats_dump(
+	os_file_t out
+);
+
+/**
+ * @brief Calls a function over a range of indexes, split in chunks run in
+ *        parallel by up to one thread per available CPU
+ *
+ * Chunks are handed out to threads as they finish the previous one, so
+ * chunks that take longer do not hold up the others.  The calling thread
+ * processes chunks too, and returns once all chunks are done.  The other
+ * threads come from a pool started on first use and kept for the life of
+ * the process; while the pool runs another operation (i.e. when called
+ * from within a chunk), the calling thread processes all the chunks.
+ *
+ * @param[in]      begin               first index of the range
+ * @param[in]      end                 index after the last one of the range
+ * @param[in]      grain               number of indexes in each chunk
+ *                                     (0 = chosen automatically)
+ * @param[in]      fn                  function to call for each chunk
+ * @param[in]      arg                 user specific data for the function
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_system_cpu_count
+ */
+OS_API os_status_t os_parallel_for(
+	size_t begin,
+	size_t end,
+	size_t grain,
+	os_parallel_for_t fn,
+	void *arg
+);
+
+/**
+ * @brief Reduces a range of indexes to a single value, accumulating chunks
+ *        in parallel
+ *
+ * Each thread accumulates the chunks it processes into its own partial
+ * result, starting as a copy of @p total, which must hold the identity
+ * value (i.e. 0 for a sum) on entry.  The partial results are then
+ * combined into @p total on the calling thread, in an unspecified order.
+ *
+ * @param[in]      begin               first index of the range
+ * @param[in]      end                 index after the last one of the range
+ * @param[in]      grain               number of indexes in each chunk
+ *                                     (0 = chosen automatically)
+ * @param[in]      map                 function accumulating each chunk
+ * @param[in]      combine             function combining partial results
+ * @param[in,out]  total               identity value on entry, result of
+ *                                     the reduction on return
+ * @param[in]      total_size          size of the result
+ * @param[in]      arg                 user specific data for the functions
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_parallel_for
+ */
+OS_API os_status_t os_parallel_reduce(
+	size_t begin,
+	size_t end,
+	size_t grain,
+	os_parallel_map_t map,
+	os_parallel_combine_t combine,
+	void *total,
+	size_t total_size,
+	void *arg
+);
+
+/**
+ * @brief Creates a new read-copy-update pointer
+ *
+ * Readers access the current snapshot without locks, atomic read-modify-write
+ * operations on shared data or waiting: each reader only increments a counter
+ * of its own CPU.  Writers publish a new snapshot atomically, then wait until
+ * all readers of the previous snapshot are done (a grace period) before
+ * freeing it.
+ *
+ * @param[out]     rcu                 pointer to initialize
+ * @param[in]      snapshot            initial snapshot (optional)
+ * @param[in]      free_fn             function to free replaced snapshots
+ *                                     (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NO_MEMORY         out of memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_create(
+	os_rcu_ptr_t *rcu,
+	void *snapshot,
+	os_rcu_free_t free_fn
+);
+
+/**
+ * @brief Destroys a read-copy-update pointer, freeing the current snapshot
+ *
+ * @param[in,out]  rcu                 previously created pointer
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_destroy(
+	os_rcu_ptr_t *rcu
+);
+
+/**
+ * @brief Publishes a new snapshot, freeing the previous snapshot once no
+ *        reader can access it
+ *
+ * @note The call blocks until a grace period has passed, so it must not be
+ *       made by a thread holding a read lock on the same pointer.
+ *
+ * @param[in,out]  rcu                 previously created pointer
+ * @param[in]      snapshot            new snapshot
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_publish(
+	os_rcu_ptr_t *rcu,
+	void *snapshot
+);
+
+/**
+ * @brief Starts reading the current snapshot
+ *
+ * The snapshot remains valid until @p os_rcu_ptr_read_unlock is called with
+ * the same reader handle.
+ *
+ * @param[in,out]  rcu                 previously created pointer
+ * @param[out]     reader              reader handle
+ * @param[out]     snapshot            current snapshot
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_read_lock(
+	os_rcu_ptr_t *rcu,
+	os_rcu_reader_t *reader,
+	void **snapshot
+);
+
+/**
+ * @brief Stops reading a snapshot
+ *
+ * @param[in,out]  rcu                 previously created pointer
+ * @param[in,out]  reader              reader handle from
+ *                                     @p os_rcu_ptr_read_lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_read_unlock(
+	os_rcu_ptr_t *rcu,
+	os_rcu_reader_t *reader
+);
+
+/**
+ * @brief Waits until all readers that may access a snapshot published before
+ *        the call are done
+ *
+ * @param[in,out]  rcu                 previously created pointer
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_rcu_ptr_synchronize(
+	os_rcu_ptr_t *rcu
+);
+
+/**
+ * @brief Creates a new sequence lock
+ *
+ * Readers never block writers or each other: a reader copies the data, then
+ * checks the sequence number to detect whether a write happened in between
+ * and retries if it did.  Only suitable for plain data, which can safely be
+ * copied while it is being modified.
+ *
+ * @param[out]     lock                lock to initialize
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_create(
+	os_seqlock_t *lock
+);
+
+/**
+ * @brief Destroys a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_destroy(
+	os_seqlock_t *lock
+);
+
+/**
+ * @brief Copies a record protected by a sequence lock, retrying until a
+ *        consistent copy is made
+ *
+ * @param[in,out]  lock                previously created lock
+ * @param[out]     dest                destination for the copy
+ * @param[in]      src                 protected record
+ * @param[in]      size                size of the record
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_read(
+	os_seqlock_t *lock,
+	void *dest,
+	const void *src,
+	size_t size
+);
+
+/**
+ * @brief Starts a read of data protected by a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @return the sequence number to pass to @p os_seqlock_read_retry
+ */
+OS_API os_uint32_t os_seqlock_read_begin(
+	os_seqlock_t *lock
+);
+
+/**
+ * @brief Ends a read of data protected by a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ * @param[in]      sequence            sequence number from
+ *                                     @p os_seqlock_read_begin
+ *
+ * @retval OS_FALSE                    the data read is consistent
+ * @retval OS_TRUE                     a write happened, the read must be
+ *                                     retried
+ */
+OS_API os_bool_t os_seqlock_read_retry(
+	os_seqlock_t *lock,
+	os_uint32_t sequence
+);
+
+/**
+ * @brief Updates a record protected by a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ * @param[out]     dest                protected record
+ * @param[in]      src                 new value for the record
+ * @param[in]      size                size of the record
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_write(
+	os_seqlock_t *lock,
+	void *dest,
+	const void *src,
+	size_t size
+);
+
+/**
+ * @brief Starts a write of data protected by a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_write_lock(
+	os_seqlock_t *lock
+);
+
+/**
+ * @brief Ends a write of data protected by a sequence lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_seqlock_write_unlock(
+	os_seqlock_t *lock
+);
+
+/**
+ * @brief Creates a new adaptive mutually exclusive lock
+ *
+ * An adaptive lock spins for a short while when the lock is held by another
+ * thread, before putting the calling thread to sleep.  Locking and unlocking
+ * an uncontended lock do not enter the kernel.
+ *
+ * @param[in,out]  lock                newly created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_adaptive_mutex_create(
+	os_thread_adaptive_mutex_t *lock
+);
+
+/**
+ * @brief Destroys an adaptive mutually exclusive lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_adaptive_mutex_destroy(
+	os_thread_adaptive_mutex_t *lock
+);
+
+/**
+ * @brief Obtains an adaptive lock (waits until lock is available)
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_adaptive_mutex_lock(
+	os_thread_adaptive_mutex_t *lock
+);
+
+/**
+ * @brief Obtains an adaptive lock, only if it is immediately available
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TRY_AGAIN         lock is held by another thread
+ */
+OS_API os_status_t os_thread_adaptive_mutex_try_lock(
+	os_thread_adaptive_mutex_t *lock
+);
+
+/**
+ * @brief Releases an adaptive lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_adaptive_mutex_unlock(
+	os_thread_adaptive_mutex_t *lock
+);
+
+/**
+ * @brief Creates a barrier
+ *
+ * @param[out]     barrier             barrier to initialize
+ * @param[in]      thread_count        number of threads to wait for each
+ *                                     other at the barrier
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_barrier_create(
+	os_thread_barrier_t *barrier,
+	os_uint32_t thread_count
+);
+
+/**
+ * @brief Destroys a barrier
+ *
+ * @param[in,out]  barrier             previously created barrier
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_barrier_destroy(
+	os_thread_barrier_t *barrier
+);
+
+/**
+ * @brief Waits until all threads have arrived at a barrier
+ *
+ * The barrier is reset once all threads arrive, so it can be used for the
+ * next phase straight away.
+ *
+ * @param[in,out]  barrier             previously created barrier
+ * @param[out]     last                set to OS_TRUE for the last thread to
+ *                                     arrive, OS_FALSE for the others
+ *                                     (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_barrier_wait(
+	os_thread_barrier_t *barrier,
+	os_bool_t *last
+);
+
+/**
+ * @brief Creates a new big-reader lock
+ *
+ * Each CPU has its own reader counter, so read locks taken on different CPUs
+ * do not share a cache line.  Taking a write lock is more expensive than for
+ * @p os_thread_rwlock_t, as the writer must check the counter of each CPU.
+ *
+ * @param[out]     lock                lock to initialize
+ * @param[in]      writer_preference   if OS_TRUE, new readers wait while a
+ *                                     writer is waiting for the lock;
+ *                                     otherwise readers are preferred and a
+ *                                     writer waits until there are no readers
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NO_MEMORY         out of memory
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_thread_rwlock_create
+ */
+OS_API os_status_t os_thread_brlock_create(
+	os_thread_brlock_t *lock,
+	os_bool_t writer_preference
+);
+
+/**
+ * @brief Destroys a big-reader lock
+ *
+ * @param[in,out]  lock                lock to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_brlock_destroy(
+	os_thread_brlock_t *lock
+);
+
+/**
+ * @brief Obtains a read lock on a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_brlock_read_lock(
+	os_thread_brlock_t *lock
+);
+
+/**
+ * @brief Releases a read lock on a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_brlock_read_unlock(
+	os_thread_brlock_t *lock
+);
+
+/**
+ * @brief Obtains a write lock on a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_brlock_write_lock(
+	os_thread_brlock_t *lock
+);
+
+/**
+ * @brief Releases a write lock on a big-reader lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_brlock_write_unlock(
+	os_thread_brlock_t *lock
+);
+
+/**
+ * @brief Wakes up all threads waiting on a condition variable
+ *
+ * @param[in,out]  cond                condition variable to wake up
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_condition_broadcast(
+	os_thread_condition_t *cond
+);
+
+/**
+ * @brief Creates a new condition variable
+ *
+ * @param[in,out]  cond                newly created condition variable
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_condition_create(
+	os_thread_condition_t *cond
+);
+
+/**
+ * @brief Destroys a previously created condition variable
+ *
+ * @param[in,out]  cond                previously created condition variable
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_condition_destroy(
+	os_thread_condition_t *cond
+);
+
+/**
+ * @brief Signals a thread waiting on a condition variable to wake up
+ *
+ * @param[in,out]  cond                condition variable to signal
+ * @param[in,out]  lock                lock prototecting condition variable
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_condition_signal(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock
+);
+
+/**
+ * @brief Waits a specified amount of time for a condition variable
+ *
+ * The time is measured on the monotonic clock, so setting the system time
+ * does not shorten or extend the wait.
+ *
+ * @param[in,out]  cond                condition variable to wait on
+ * @param[in,out]  lock                lock protecting condition variable
+ * @param[in]      max_time_out        maximum amount of time to wait
+ *                                     (0 = wait indefinitely)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         maximum wait time reached
+ *
+ * @see os_thread_condition_wait_until
+ */
+OS_API os_status_t os_thread_condition_timed_wait(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	os_millisecond_t max_time_out
+);
+
+/**
+ * @brief Waits until an absolute deadline for a condition variable
+ *
+ * A loop waiting for a predicate can compute its deadline once, so spurious
+ * and unrelated wake ups do not extend the total time waited.
+ *
+ * @param[in,out]  cond                condition variable to wait on
+ * @param[in,out]  lock                lock protecting condition variable
+ * @param[in]      deadline            time to give up, as returned by
+ *                                     @p os_time_monotonic
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+OS_API os_status_t os_thread_condition_wait_until(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	os_timestamp_t deadline
+);
+
+/**
+ * @brief Creates a new thread
+ *
+ * @param[in,out]  thread              newly created thread object
+ * @param[in]      main                main method to call for the thread
+ * @param[in]      arg                 user specific data
+ * @param[in]      stack_size          size of stack to use (0 = default)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_create(
+	os_thread_t *thread,
+	os_thread_main_t main,
+	void *arg,
+	size_t stack_size
+);
+
+/**
+ * @brief Creates a new thread with the given attributes
+ *
+ * @param[in,out]  thread              newly created thread object
+ * @param[in]      main                main method to call for the thread
+ * @param[in]      arg                 user specific data
+ * @param[in]      attr                attributes for the thread (optional,
+ *                                     NULL uses the default attributes)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_MEMORY         out of memory
+ * @retval OS_STATUS_NO_PERMISSION     not permitted to use the requested
+ *                                     scheduling policy or priority
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_thread_create
+ */
+OS_API os_status_t os_thread_create_ex(
+	os_thread_t *thread,
+	os_thread_main_t main,
+	void *arg,
+	const os_thread_attr_t *attr
+);
+
+/**
+ * @brief Destroys a previously created thread
+ *
+ * @param[in,out]  thread              thread object to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_destroy(
+	os_thread_t *thread
+);
+
+/**
+ * @brief Creates a new event (initially not set)
+ *
+ * Setting an event that has no waiters and waiting on an event that is
+ * already set do not enter the kernel.
+ *
+ * @param[out]     event               event to initialize
+ * @param[in]      manual_reset        if OS_TRUE, the event stays set and
+ *                                     releases all waiters until
+ *                                     @p os_thread_event_reset is called;
+ *                                     otherwise a single waiter is released
+ *                                     and the event is cleared automatically
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_event_create(
+	os_thread_event_t *event,
+	os_bool_t manual_reset
+);
+
+/**
+ * @brief Destroys a previously created event
+ *
+ * @param[in,out]  event               previously created event
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_event_destroy(
+	os_thread_event_t *event
+);
+
+/**
+ * @brief Clears an event
+ *
+ * @param[in,out]  event               previously created event
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_event_reset(
+	os_thread_event_t *event
+);
+
+/**
+ * @brief Sets an event, releasing waiting threads
+ *
+ * @param[in,out]  event               previously created event
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_event_set(
+	os_thread_event_t *event
+);
+
+/**
+ * @brief Waits a specified amount of time for an event to be set
+ *
+ * @param[in,out]  event               previously created event
+ * @param[in]      max_time_out        maximum amount of time to wait
+ *                                     (0 = wait indefinitely)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         maximum wait time reached
+ */
+OS_API os_status_t os_thread_event_timed_wait(
+	os_thread_event_t *event,
+	os_millisecond_t max_time_out
+);
+
+/**
+ * @brief Waits indefinitely for an event to be set
+ *
+ * @param[in,out]  event               previously created event
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_event_wait(
+	os_thread_event_t *event
+);
+
+/**
+ * @brief Waits until an absolute deadline for an event to be set
+ *
+ * @param[in,out]  event               previously created event
+ * @param[in]      deadline            time to give up, as returned by
+ *                                     @p os_time_monotonic
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+OS_API os_status_t os_thread_event_wait_until(
+	os_thread_event_t *event,
+	os_timestamp_t deadline
+);
+
+/**
+ * @brief Counts down a latch, releasing the waiting threads when the count
+ *        reaches zero
+ *
+ * @param[in,out]  latch               previously created latch
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_OUT_OF_RANGE      latch already counted down to zero
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_latch_count_down(
+	os_thread_latch_t *latch
+);
+
+/**
+ * @brief Creates a countdown latch
+ *
+ * @param[out]     latch               latch to initialize
+ * @param[in]      count               number of count downs before threads
+ *                                     waiting are released
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_latch_create(
+	os_thread_latch_t *latch,
+	os_uint32_t count
+);
+
+/**
+ * @brief Destroys a countdown latch
+ *
+ * @param[in,out]  latch               previously created latch
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_latch_destroy(
+	os_thread_latch_t *latch
+);
+
+/**
+ * @brief Waits a specified amount of time for a latch to reach zero
+ *
+ * @param[in,out]  latch               previously created latch
+ * @param[in]      max_time_out        maximum amount of time to wait
+ *                                     (0 = wait indefinitely)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         maximum wait time reached
+ */
+OS_API os_status_t os_thread_latch_timed_wait(
+	os_thread_latch_t *latch,
+	os_millisecond_t max_time_out
+);
+
+/**
+ * @brief Checks whether a latch has reached zero, without waiting
+ *
+ * @param[in,out]  latch               previously created latch
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           latch has reached zero
+ * @retval OS_STATUS_TRY_AGAIN         latch has not reached zero
+ */
+OS_API os_status_t os_thread_latch_try_wait(
+	os_thread_latch_t *latch
+);
+
+/**
+ * @brief Waits indefinitely for a latch to reach zero
+ *
+ * @param[in,out]  latch               previously created latch
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_latch_wait(
+	os_thread_latch_t *latch
+);
+
+/**
+ * @brief Waits until an absolute deadline for a latch to reach zero
+ *
+ * @param[in,out]  latch               previously created latch
+ * @param[in]      deadline            time to give up, as returned by
+ *                                     @p os_time_monotonic
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+OS_API os_status_t os_thread_latch_wait_until(
+	os_thread_latch_t *latch,
+	os_timestamp_t deadline
+);
+
+/**
+ * @brief Creates a key for a value stored separately by each thread
+ *
+ * Each thread's value for a new key is NULL.  When a thread with a value
+ * other than NULL exits, the destructor is called with that value.  For
+ * variables known at compile time, @p OS_THREAD_LOCAL is faster.
+ *
+ * @param[out]     key                 newly created key
+ * @param[in]      destructor          function called with a thread's value
+ *                                     when it exits (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_MEMORY         no more keys are available
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_thread_local_key_destroy
+ * @see os_thread_local_key_get
+ * @see os_thread_local_key_set
+ */
+OS_API os_status_t os_thread_local_key_create(
+	os_thread_local_key_t *key,
+	os_thread_local_destructor_t destructor
+);
+
+/**
+ * @brief Destroys a key created by @p os_thread_local_key_create
+ *
+ * Whether the destructor is called for values still set by other threads
+ * is platform specific, those values should be cleared first.
+ *
+ * @param[in,out]  key                 key to destroy
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_local_key_destroy(
+	os_thread_local_key_t *key
+);
+
+/**
+ * @brief Returns the calling thread's value for a key
+ *
+ * @param[in]      key                 previously created key
+ *
+ * @return the value, NULL if the thread has not set one
+ */
+#if !OSAL_WRAP
+#define os_thread_local_key_get(key)   pthread_getspecific(*(key))
+#else
+OS_API void *os_thread_local_key_get(
+	const os_thread_local_key_t *key
+);
+#endif
+
+/**
+ * @brief Sets the calling thread's value for a key
+ *
+ * @param[in]      key                 previously created key
+ * @param[in]      value               value to set
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_MEMORY         not enough memory to store the value
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_local_key_set(
+	const os_thread_local_key_t *key,
+	void *value
+);
+
+/**
+ * @brief Creates a new mutally exclusive lock
+ *
+ * @param[in,out]  lock                newly created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
  */
 OS_API os_status_t os_thread_mutex_create(
 	os_thread_mutex_t *lock
 );
 
 /**
- * @brief Destroys a mutally exclusive lock
+ * @brief Creates a new mutally exclusive lock with the given attributes
+ *
+ * A real-time thread waiting on a mutex owned by a lower priority thread
+ * can be delayed by any thread of intermediate priority (priority
+ * inversion).  With OS_THREAD_MUTEX_PROTOCOL_INHERIT the owner runs at the
+ * priority of the highest thread waiting for the lock, which bounds the
+ * delay to the time the lock is held.
+ *
+ * @param[in,out]  lock                newly created lock
+ * @param[in]      attr                attributes for the lock (optional,
+ *                                     NULL uses the default attributes)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_MEMORY         out of memory
+ * @retval OS_STATUS_NO_PERMISSION     not permitted to use the requested
+ *                                     priority ceiling
+ * @retval OS_STATUS_NOT_SUPPORTED     attribute not supported on this
+ *                                     platform
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_thread_mutex_create
+ * @see os_thread_mutex_lock
+ */
+OS_API os_status_t os_thread_mutex_create_ex(
+	os_thread_mutex_t *lock,
+	const os_thread_mutex_attr_t *attr
+);
+
+/**
+ * @brief Creates a new mutally exclusive lock, with a name for statistics
+ *
+ * Locks created with the same name share their statistics, so a lock that
+ * is created and destroyed repeatedly accumulates under one entry.
+ *
+ * @param[in,out]  lock                newly created lock
+ * @param[in]      name                name reported by os_lock_stats_dump
+ *                                     (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_lock_stats_dump
+ */
+OS_API os_status_t os_thread_mutex_create_named(
+	os_thread_mutex_t *lock,
+	const char *name
+);
+
+/**
+ * @brief Destroys a mutally exclusive lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_mutex_destroy(
+	os_thread_mutex_t *lock
+);
+
+/**
+ * @brief Obtains a mutally exclusive lock (waits until lock is available)
+ *
+ * For a robust lock whose previous owner ended while holding it, the lock
+ * is obtained and marked usable again, but the data it protects may need
+ * to be repaired.
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_OWNER_DIED        lock obtained, previous owner ended
+ *                                     while holding it
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_mutex_lock(
+	os_thread_mutex_t *lock
+);
+
+/**
+ * @brief Releases a mutally exclusive lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_mutex_unlock(
+	os_thread_mutex_t *lock
+);
+
+/**
+ * @brief Calls a function exactly once, for all threads
+ *
+ * Threads calling while the function runs wait for it to return.  Once it
+ * has returned, calls only read the state, without taking a lock.
+ *
+ * @param[in,out]  once                state, initialized to
+ *                                     OS_THREAD_ONCE_INIT
+ * @param[in]      fn                  function to call
+ * @param[in]      arg                 user specific data for the function
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_once(
+	os_thread_once_t *once,
+	os_thread_once_func_t fn,
+	void *arg
+);
+
+/**
+ * @brief Creates a new read/write lock
+ *
+ * @param[in,out]  lock                newly created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_create(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Creates a new read/write lock, with a name for statistics
+ *
+ * Locks created with the same name share their statistics.  Hold times are
+ * only recorded for the write lock, as readers hold it concurrently.
+ *
+ * @param[in,out]  lock                newly created lock
+ * @param[in]      name                name reported by os_lock_stats_dump
+ *                                     (optional)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ *
+ * @see os_lock_stats_dump
+ */
+OS_API os_status_t os_thread_rwlock_create_named(
+	os_thread_rwlock_t *lock,
+	const char *name
+);
+
+/**
+ * @brief Destroys a previously created read/write lock
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_destroy(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Obtains a read/write lock for reading
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_read_lock(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Releases read/write lock from reading
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_read_unlock(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Obtains a read/write lock for writing
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_write_lock(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Releases read/write lock from writing
+ *
+ * @param[in,out]  lock                previously created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_rwlock_write_unlock(
+	os_thread_rwlock_t *lock
+);
+
+/**
+ * @brief Sets the CPUs the calling thread may run on
+ *
+ * @param[in]      affinity            mask of CPUs (bit n = CPU n, 0 = any)
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NOT_SUPPORTED     not supported on this platform
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_self_affinity_set(
+	os_uint64_t affinity
+);
+
+/**
+ * @brief Sets the name of the calling thread
  *
- * @param[in,out]  lock                previously created lock
+ * @param[in]      name                name of the thread (truncated to
+ *                                     OS_THREAD_NAME_MAX - 1 characters)
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
  * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NOT_SUPPORTED     not supported on this platform
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_mutex_destroy(
-	os_thread_mutex_t *lock
+OS_API os_status_t os_thread_self_name_set(
+	const char *name
 );
 
 /**
- * @brief Obtains a mutally exclusive lock (waits until lock is available)
+ * @brief Sets the scheduling policy and priority of the calling thread
  *
- * @param[in,out]  lock                previously created lock
+ * @param[in]      policy              scheduling policy
+ * @param[in]      priority            real-time priority, from 1 (lowest) to
+ *                                     99 (highest); ignored for
+ *                                     OS_THREAD_POLICY_DEFAULT
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
  * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NO_PERMISSION     not permitted to use the requested
+ *                                     scheduling policy or priority
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_mutex_lock(
-	os_thread_mutex_t *lock
+OS_API os_status_t os_thread_self_scheduling_set(
+	os_thread_policy_t policy,
+	int priority
 );
 
 /**
- * @brief Releases a mutally exclusive lock
+ * @brief Creates a new counting semaphore
  *
- * @param[in,out]  lock                previously created lock
+ * Posting to a semaphore that has no waiters and taking an available
+ * resource do not enter the kernel.
+ *
+ * @param[out]     sem                 semaphore to initialize
+ * @param[in]      initial_count       number of resources initially
+ *                                     available
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_mutex_unlock(
-	os_thread_mutex_t *lock
+OS_API os_status_t os_thread_semaphore_create(
+	os_thread_semaphore_t *sem,
+	os_uint32_t initial_count
 );
 
 /**
- * @brief Creates a new read/write lock
+ * @brief Destroys a previously created semaphore
  *
- * @param[in,out]  lock                newly created lock
+ * @param[in,out]  sem                 previously created semaphore
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_rwlock_create(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_semaphore_destroy(
+	os_thread_semaphore_t *sem
 );
 
 /**
- * @brief Destroys a previously created read/write lock
+ * @brief Releases a resource, waking a waiting thread if there is one
  *
- * @param[in,out]  lock                previously created lock
+ * @param[in,out]  sem                 previously created semaphore
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_rwlock_destroy(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_semaphore_post(
+	os_thread_semaphore_t *sem
 );
 
 /**
- * @brief Obtains a read/write lock for reading
+ * @brief Waits a specified amount of time to take a resource
+ *
+ * @param[in,out]  sem                 previously created semaphore
+ * @param[in]      max_time_out        maximum amount of time to wait
+ *                                     (0 = wait indefinitely)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         maximum wait time reached
+ */
+OS_API os_status_t os_thread_semaphore_timed_wait(
+	os_thread_semaphore_t *sem,
+	os_millisecond_t max_time_out
+);
+
+/**
+ * @brief Takes a resource, if one is available without waiting
+ *
+ * @param[in,out]  sem                 previously created semaphore
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TRY_AGAIN         no resource currently available
+ */
+OS_API os_status_t os_thread_semaphore_try_wait(
+	os_thread_semaphore_t *sem
+);
+
+/**
+ * @brief Waits indefinitely to take a resource
+ *
+ * @param[in,out]  sem                 previously created semaphore
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_semaphore_wait(
+	os_thread_semaphore_t *sem
+);
+
+/**
+ * @brief Waits until an absolute deadline to take a resource
+ *
+ * @param[in,out]  sem                 previously created semaphore
+ * @param[in]      deadline            time to give up, as returned by
+ *                                     @p os_time_monotonic
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           the system failed to wait
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         deadline reached
+ */
+OS_API os_status_t os_thread_semaphore_wait_until(
+	os_thread_semaphore_t *sem,
+	os_timestamp_t deadline
+);
+
+/**
+ * @brief Creates a new spin lock
+ *
+ * A spin lock never puts the calling thread to sleep, it is only suitable
+ * for protecting critical sections of a few instructions.
+ *
+ * @param[in,out]  lock                newly created lock
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_spinlock_create(
+	os_thread_spinlock_t *lock
+);
+
+/**
+ * @brief Destroys a spin lock
  *
  * @param[in,out]  lock                previously created lock
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_rwlock_read_lock(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_spinlock_destroy(
+	os_thread_spinlock_t *lock
 );
 
 /**
- * @brief Releases read/write lock from reading
+ * @brief Obtains a spin lock (spins until lock is available)
  *
  * @param[in,out]  lock                previously created lock
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_rwlock_read_unlock(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_spinlock_lock(
+	os_thread_spinlock_t *lock
 );
 
 /**
- * @brief Obtains a read/write lock for writing
+ * @brief Obtains a spin lock, only if it is immediately available
  *
  * @param[in,out]  lock                previously created lock
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TRY_AGAIN         lock is held by another thread
  */
-OS_API os_status_t os_thread_rwlock_write_lock(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_spinlock_try_lock(
+	os_thread_spinlock_t *lock
 );
 
 /**
- * @brief Releases read/write lock from writing
+ * @brief Releases a spin lock
  *
  * @param[in,out]  lock                previously created lock
  *
  * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
- * @retval OS_STATUS_FAILURE           function failed
  * @retval OS_STATUS_SUCCESS           on success
  */
-OS_API os_status_t os_thread_rwlock_write_unlock(
-	os_thread_rwlock_t *lock
+OS_API os_status_t os_thread_spinlock_unlock(
+	os_thread_spinlock_t *lock
 );
 
 /**
@@ -1259,6 +3939,300 @@ OS_API os_status_t os_thread_wait(
 	os_thread_t *thread
 );
 
+/**
+ * @brief Gives up the remainder of the calling thread's time slice
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_thread_yield( void );
+
+/**
+ * @brief Initializes a timer
+ *
+ * @param[out]     timer               timer to initialize
+ * @param[in]      callback            function to call when the timer expires
+ * @param[in]      user_data           user specific data for the callback
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_create(
+	os_timer_t *timer,
+	os_timer_callback_t callback,
+	void *user_data
+);
+
+/**
+ * @brief Destroys a timer, stopping it if it is scheduled
+ *
+ * @param[in,out]  timer               previously created timer
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_destroy(
+	os_timer_t *timer
+);
+
+/**
+ * @brief Creates a new timer service
+ *
+ * Timers are run either by a service thread (see
+ * @p os_timer_service_start), or by calling @p os_timer_service_poll from
+ * an existing event loop.
+ *
+ * @param[out]     service             timer service to initialize
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_create(
+	os_timer_service_t *service
+);
+
+/**
+ * @brief Destroys a timer service, stopping its thread if running
+ *
+ * Timers still scheduled are stopped, without calling their callbacks.
+ *
+ * @param[in,out]  service             previously created timer service
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_destroy(
+	os_timer_service_t *service
+);
+
+/**
+ * @brief Returns the time the next timer of a service may expire
+ *
+ * The time returned is never later than the expiry of the next timer, and
+ * may be earlier, so event loops can use it as the time out to wait for.
+ *
+ * @param[in,out]  service             previously created timer service
+ * @param[out]     expiry              time to call @p os_timer_service_poll,
+ *                                     as returned by @p os_time_monotonic
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_FOUND         no timers scheduled
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_next_expiry(
+	os_timer_service_t *service,
+	os_timestamp_t *expiry
+);
+
+/**
+ * @brief Runs the callbacks of all timers that expired
+ *
+ * Callbacks are called without the service locked, so they may start and
+ * stop timers, including the timer that expired.
+ *
+ * @param[in,out]  service             previously created timer service
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_poll(
+	os_timer_service_t *service
+);
+
+/**
+ * @brief Starts a thread running the timers of a service
+ *
+ * @param[in,out]  service             previously created timer service
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_start(
+	os_timer_service_t *service
+);
+
+/**
+ * @brief Stops the thread running the timers of a service
+ *
+ * @param[in,out]  service             previously created timer service
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_service_stop(
+	os_timer_service_t *service
+);
+
+/**
+ * @brief Schedules a timer on a timer service
+ *
+ * A timer that is already scheduled is rescheduled.  Starting and stopping
+ * a timer take constant time, regardless of the number of timers.
+ *
+ * @param[in,out]  service             previously created timer service
+ * @param[in,out]  timer               previously created timer
+ * @param[in]      delay               time until the timer first expires
+ * @param[in]      period              interval between following expiries
+ *                                     (0 = expire only once)
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_start(
+	os_timer_service_t *service,
+	os_timer_t *timer,
+	os_millisecond_t delay,
+	os_millisecond_t period
+);
+
+/**
+ * @brief Stops a scheduled timer
+ *
+ * @note A callback already running on another thread is not waited for.
+ *
+ * @param[in,out]  timer               previously created timer
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_FOUND         timer was not scheduled
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_timer_stop(
+	os_timer_t *timer
+);
+
+/**
+ * @brief Checks the threads monitored by a watchdog
+ *
+ * The callback is called for each thread whose last heartbeat is older than
+ * its threshold, and again each time the threshold passes while it stays
+ * stalled.  Callbacks are called with the watchdog locked, so they must not
+ * register or unregister threads.
+ *
+ * @param[in,out]  watchdog            previously created watchdog
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_check(
+	os_watchdog_t *watchdog
+);
+
+/**
+ * @brief Creates a new watchdog
+ *
+ * Threads are checked either by a monitor thread (see
+ * @p os_watchdog_start), or by calling @p os_watchdog_check from an
+ * existing event loop.
+ *
+ * @param[out]     watchdog            watchdog to initialize
+ * @param[in]      callback            function to call for stalled threads
+ * @param[in]      user_data           user specific data for the callback
+ * @param[in]      interval            time between checks by the monitor
+ *                                     thread, in milliseconds
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_create(
+	os_watchdog_t *watchdog,
+	os_watchdog_callback_t callback,
+	void *user_data,
+	os_millisecond_t interval
+);
+
+/**
+ * @brief Destroys a watchdog, stopping its monitor thread if running
+ *
+ * Threads still registered are unregistered.
+ *
+ * @param[in,out]  watchdog            previously created watchdog
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_destroy(
+	os_watchdog_t *watchdog
+);
+
+/**
+ * @brief Records that a monitored thread is making progress
+ *
+ * Only stores the current time, without taking a lock.
+ *
+ * @param[in,out]  entry               registered entry of the thread
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_heartbeat(
+	os_watchdog_entry_t *entry
+);
+
+/**
+ * @brief Starts monitoring a thread
+ *
+ * The thread is expected to call @p os_watchdog_heartbeat more often than
+ * the threshold, registering counts as the first heartbeat.
+ *
+ * @param[in,out]  watchdog            previously created watchdog
+ * @param[out]     entry               entry of the thread
+ * @param[in]      name                name identifying the thread, must
+ *                                     remain valid while registered
+ *                                     (optional)
+ * @param[in]      threshold           longest time allowed between
+ *                                     heartbeats, in milliseconds
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_register(
+	os_watchdog_t *watchdog,
+	os_watchdog_entry_t *entry,
+	const char *name,
+	os_millisecond_t threshold
+);
+
+/**
+ * @brief Starts a thread checking the threads monitored by a watchdog
+ *
+ * @param[in,out]  watchdog            previously created watchdog
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_start(
+	os_watchdog_t *watchdog
+);
+
+/**
+ * @brief Stops the thread checking the threads monitored by a watchdog
+ *
+ * @param[in,out]  watchdog            previously created watchdog
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_stop(
+	os_watchdog_t *watchdog
+);
+
+/**
+ * @brief Stops monitoring a thread
+ *
+ * @param[in,out]  entry               registered entry of the thread
+ *
+ * @retval OS_STATUS_BAD_PARAMETER     invalid parameter passed to function
+ * @retval OS_STATUS_NOT_FOUND         entry was not registered
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+OS_API os_status_t os_watchdog_unregister(
+	os_watchdog_entry_t *entry
+);
+
 /**
  * @brief Wait indefinitely on a condition variable
  *
@@ -16,6 +16,7 @@
  */
 
 #include "os.h"
+#include "os_posix_private.h"
 
 #include <ioLib.h>
 #include <pthread.h>
@@ -144,7 +145,7 @@ os_status_t os_service_run(
 	if ( id && service_function )
 	{
 		int i;
-		char** good_argv = (char**)malloc( (unsigned long)argc * sizeof( char* ) );
+		char** good_argv = (char**)os_malloc( (unsigned long)argc * sizeof( char* ) );
 		result = OS_STATUS_FAILURE;
 		/* remove bad arguments */
 		if ( good_argv )
@@ -179,7 +180,7 @@ os_status_t os_service_run(
 			if ( ( *service_function )( good_argc, good_argv ) == EXIT_SUCCESS )
 				result = OS_STATUS_SUCCESS;
 
-			free( good_argv );
+			os_free( good_argv );
 		}
 	}
 	return result;
@@ -233,6 +234,13 @@ os_status_t os_system_info(
 #if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
 os_status_t os_thread_rwlock_create(
 	os_thread_rwlock_t *lock )
+{
+	return os_thread_rwlock_create_named( lock, NULL );
+}
+
+os_status_t os_thread_rwlock_create_named(
+	os_thread_rwlock_t *lock,
+	const char *name )
 {
 	SEM_ID semId;
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
@@ -243,7 +251,15 @@ os_status_t os_thread_rwlock_create(
 		semId = semRWCreate( 0, VX_RW_SEM_MAX_READERS );
 		if ( SEM_ID_NULL != semId )
 		{
-			*lock = semId;
+			*OS_THREAD_LOCK_NATIVE( lock ) = semId;
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+			lock->stats = os_lock_stats_register( "rwlock", name,
+				lock );
+			lock->acquired = 0u;
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+			(void)name;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+			result = OS_STATUS_SUCCESS;
 		}
 	}
 
@@ -257,9 +273,27 @@ os_status_t os_thread_rwlock_read_lock(
 
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		STATUS status = semRTake( lock->lock, NO_WAIT );
+		if ( OK != status )
+		{
+			start = os_lock_stats_now();
+			status = semRTake( lock->lock, WAIT_FOREVER );
+		}
+		result = OS_STATUS_FAILURE;
+		if ( OK == status )
+		{
+			/* readers share the lock, so only waiting is timed */
+			os_lock_stats_acquired( lock->stats, start,
+				start != 0u ? os_lock_stats_now() : 0u );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( OK == semRTake( *lock, WAIT_FOREVER ) )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 
 	return result;
@@ -273,7 +307,7 @@ os_status_t os_thread_rwlock_read_unlock(
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if (  OK == semGive( *lock ) )
+		if (  OK == semGive( *OS_THREAD_LOCK_NATIVE( lock ) ) )
 			result = OS_STATUS_SUCCESS;
 	}
 
@@ -287,9 +321,27 @@ os_status_t os_thread_rwlock_write_lock(
 
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		STATUS status = semWTake( lock->lock, NO_WAIT );
+		if ( OK != status )
+		{
+			start = os_lock_stats_now();
+			status = semWTake( lock->lock, WAIT_FOREVER );
+		}
+		result = OS_STATUS_FAILURE;
+		if ( OK == status )
+		{
+			lock->acquired = os_lock_stats_now();
+			os_lock_stats_acquired( lock->stats, start,
+				lock->acquired );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if ( OK == semWTake( *lock, WAIT_FOREVER ) )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 
 	return result;
@@ -302,9 +354,20 @@ os_status_t os_thread_rwlock_write_unlock(
 
 	if ( lock )
 	{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+		/* measured before another thread can acquire the lock */
+		const os_uint64_t hold = os_lock_stats_now() - lock->acquired;
+		result = OS_STATUS_FAILURE;
+		if (  OK == semGive( lock->lock ) )
+		{
+			os_lock_stats_released( lock->stats, hold );
+			result = OS_STATUS_SUCCESS;
+		}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 		result = OS_STATUS_FAILURE;
 		if (  OK == semGive( *lock ) )
 			result = OS_STATUS_SUCCESS;
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 	}
 
 	return result;
@@ -318,8 +381,14 @@ os_status_t os_thread_rwlock_destroy(
 	if ( lock )
 	{
 		result = OS_STATUS_FAILURE;
-		if ( OK == semDelete( *lock ) )
+		if ( OK == semDelete( *OS_THREAD_LOCK_NATIVE( lock ) ) )
+		{
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+			os_lock_stats_unregister( lock->stats );
+			lock->stats = NULL;
+#endif /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
 			result = OS_STATUS_SUCCESS;
+		}
 	}
 
 	return result;
@@ -455,7 +524,7 @@ os_status_t os_system_run(
 		if ( i == 0u )
 		{
 			int j;
-			argv = (char**)malloc((sizeof(char *) * (argc + 1)) +
+			argv = (char**)os_malloc((sizeof(char *) * (argc + 1)) +
 				              (sizeof(char) * (cmd_len + 1)));
 			argc_total = argc;
 			if ( argv )
@@ -510,7 +579,7 @@ os_status_t os_system_run(
 			args->priority, args->stack_size,
 			RTP_LOADED_WAIT, VX_FP_TASK) == RTP_ID_ERROR)
 		{
-			free( argv );
+			os_free( argv );
 			return OS_STATUS_FAILURE;
 		}
 	}
@@ -525,7 +594,7 @@ os_status_t os_system_run(
 			argc, argv, 0, 0, 0, 0, 0, 0, 0, 0) == TASK_ID_ERROR)
 		{
 			if ( argv )
-				free( argv );
+				os_free( argv );
 			return OS_STATUS_FAILURE;
 		}
 	}
@@ -533,13 +602,13 @@ os_status_t os_system_run(
 	{
 		if (os_vxworks_script(argv[1]) == OS_STATUS_FAILURE)
 		{
-			free( argv );
+			os_free( argv );
 			return OS_STATUS_FAILURE;
 		}
 	}
 	else if ( argv && os_vxworks_script(argv[0]) == OS_STATUS_FAILURE )
 	{
-		free( argv );
+		os_free( argv );
 		return OS_STATUS_FAILURE;
 	}
 #else /* if defined( _WRS_KERNEL ) */
@@ -547,14 +616,14 @@ os_status_t os_system_run(
 	{
 		printf( "Invalid command: %s\n", args->cmd );
 		if ( argv )
-			free( argv );
+			os_free( argv );
 		return OS_STATUS_FAILURE;
 	}
 #endif /* else if defined( _WRS_KERNEL ) */
 
 	args->return_code = 0;
 	if ( argv )
-		free( argv );
+		os_free( argv );
 	return OS_STATUS_SUCCESS;
 }
 
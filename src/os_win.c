@@ -191,6 +191,214 @@ static VOID WINAPI os_service_handler( DWORD control_code );
  */
 static void WINAPI os_service_main( DWORD argc, LPTSTR *argv );
 
+/**
+ * @brief Allocates aligned memory from the system allocator
+ *
+ * @param[in]      alignment           alignment, a power of 2
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_aligned_alloc( size_t alignment,
+	size_t size, void *user_data );
+
+/**
+ * @brief Allocates zeroed memory from the system allocator
+ *
+ * @param[in]      nmemb               number of elements
+ * @param[in]      size                size of each element in bytes
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_calloc( size_t nmemb, size_t size,
+	void *user_data );
+
+/**
+ * @brief Frees memory to the system allocator
+ *
+ * @param[in]      ptr                 memory to free
+ * @param[in]      user_data           not used
+ */
+static void os_allocator_system_free( void *ptr, void *user_data );
+
+/**
+ * @brief Allocates memory from the system allocator
+ *
+ * @param[in]      size                amount of memory to allocate
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_malloc( size_t size, void *user_data );
+
+/**
+ * @brief Changes the size of memory from the system allocator
+ *
+ * @param[in]      ptr                 previously allocated memory (optional)
+ * @param[in]      size                new size of the memory
+ * @param[in]      user_data           not used
+ *
+ * @retval NULL    not enough memory available
+ * @retval !NULL   a pointer to the allocated memory
+ */
+static void *os_allocator_system_realloc( void *ptr, size_t size,
+	void *user_data );
+
+/** @brief Allocator of the operating system */
+static const os_allocator_t OS_ALLOCATOR_SYSTEM = {
+	os_allocator_system_malloc,
+	os_allocator_system_calloc,
+	os_allocator_system_realloc,
+	os_allocator_system_free,
+	os_allocator_system_aligned_alloc,
+	NULL
+};
+
+/** @brief Largest number of bytes the system is asked to transfer at once */
+#define OS_FILE_IO_CHUNK_SIZE          0x40000000u
+
+/** @brief Number of entries a directory copy list grows by at once */
+#define OS_DIRECTORY_COPY_GROW         64u
+
+/** @brief Entry found while walking a directory being copied */
+struct os_directory_copy_entry
+{
+	/** @brief Path of the entry being copied */
+	const char *from;
+	/** @brief Path the entry is copied to */
+	const char *to;
+	/** @brief Size of the entry in bytes */
+	os_uint64_t size;
+	/** @brief Attributes of the entry */
+	DWORD attributes;
+};
+
+/** @brief List of entries found while walking a directory being copied */
+struct os_directory_copy_list
+{
+	/** @brief Entries in the list */
+	struct os_directory_copy_entry *entry;
+	/** @brief Number of entries in the list */
+	size_t count;
+	/** @brief Number of entries the list has room for */
+	size_t max;
+};
+
+/** @brief State shared by the threads copying a directory */
+struct os_directory_copy
+{
+	/** @brief Arena holding the paths of all entries */
+	os_arena_t arena;
+	/** @brief Directories created, parents before their children */
+	struct os_directory_copy_list dirs;
+	/** @brief Files to copy */
+	struct os_directory_copy_list files;
+	/** @brief Length of the path of the directory being copied */
+	size_t from_len;
+	/** @brief Volume of the directory copied to, skipped when found within
+	 *         the directory copied */
+	DWORD volume_to;
+	/** @brief File index of the directory copied to, skipped when found
+	 *         within the directory copied */
+	os_uint64_t index_to;
+	/** @brief Options for the copy */
+	const os_directory_copy_options_t *options;
+	/** @brief Index of the next file to copy */
+	os_atomic_uint64_t next;
+	/** @brief Whether copying a file failed */
+	os_atomic_uint32_t failed;
+#if OSAL_THREAD_SUPPORT
+	/** @brief Lock protecting the progress of the copy */
+	os_thread_mutex_t lock;
+	/** @brief Whether the lock was created (several threads copy files) */
+	os_bool_t locked;
+#endif /* if OSAL_THREAD_SUPPORT */
+	/** @brief Number of files copied */
+	os_uint64_t files_done;
+	/** @brief Number of bytes copied */
+	os_uint64_t bytes_done;
+	/** @brief Number of bytes to copy */
+	os_uint64_t bytes_total;
+};
+
+/**
+ * @brief Adds an entry to a list of entries of a directory being copied
+ *
+ * @param[in,out]  list                list to add the entry to
+ * @param[in]      from                path of the entry being copied
+ * @param[in]      to                  path the entry is copied to
+ * @param[in]      wfd                 information about the entry
+ *
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_add(
+	struct os_directory_copy_list *list, const char *from,
+	const char *to, const WIN32_FIND_DATA *wfd );
+
+/**
+ * @brief Gives a copied directory the attributes and times of the original
+ *
+ * @param[in]      dir                 directory copied
+ *
+ * @retval OS_STATUS_FAILURE           failed to set the attributes or times
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_attributes(
+	const struct os_directory_copy_entry *dir );
+
+/**
+ * @brief Copies files of a directory until there are none left
+ *
+ * @param[in,out]  copy                directory copy in progress
+ */
+static void os_directory_copy_files( struct os_directory_copy *copy );
+
+/**
+ * @brief Identifies a directory by its volume and its index on the volume
+ *
+ * @param[in]      path                path of the directory
+ * @param[out]     volume              serial number of the volume
+ * @param[out]     index               index of the directory on the volume
+ *
+ * @retval OS_STATUS_FAILURE           failed to open the directory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_identity( const char *path,
+	DWORD *volume, os_uint64_t *index );
+
+/**
+ * @brief Walks a directory being copied, creating its subdirectories and
+ *        links and listing its files
+ *
+ * @param[in,out]  copy                directory copy in progress
+ * @param[in]      from                directory to walk
+ * @param[in]      to                  directory to copy it to
+ *
+ * @retval OS_STATUS_FAILURE           failed to read or create an entry
+ * @retval OS_STATUS_NO_MEMORY         not enough memory
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_directory_copy_scan(
+	struct os_directory_copy *copy, const char *from, const char *to );
+
+#if OSAL_THREAD_SUPPORT
+/**
+ * @brief Copies files of a directory from a thread of a parallel loop
+ *
+ * @param[in]      begin               unused
+ * @param[in]      end                 unused
+ * @param[in,out]  arg                 directory copy in progress
+ *                                     (struct os_directory_copy)
+ */
+static void os_directory_copy_thread( size_t begin, size_t end, void *arg );
+#endif /* if OSAL_THREAD_SUPPORT */
+
 /**
  * @brief Internal helper function to convert a time stamp to a date & time
  *
@@ -202,6 +410,80 @@ static void WINAPI os_service_main( DWORD argc, LPTSTR *argv );
 static os_status_t os_time_stamp_to_date_time(
 	os_date_time_t* date_time, os_timestamp_t time_stamp );
 
+#if OSAL_THREAD_SUPPORT
+/**
+ * @brief Sets the CPUs a thread may run on
+ *
+ * @param[in]      thread              thread to modify
+ * @param[in]      affinity            mask of CPUs (0 = any)
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_thread_affinity_apply(
+	HANDLE thread,
+	os_uint64_t affinity );
+
+/**
+ * @brief Waits on a condition variable, for a time out
+ *
+ * @param[in,out]  cond                condition variable to wait on
+ * @param[in,out]  lock                lock protecting condition variable
+ * @param[in]      time_out            time out in milliseconds, INFINITE
+ *                                     waits indefinitely
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_SUCCESS           on success
+ * @retval OS_STATUS_TIMED_OUT         time out reached
+ */
+static os_status_t os_thread_condition_wait_internal(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	DWORD time_out );
+
+/**
+ * @brief Sets the name of a thread
+ *
+ * @param[in]      thread              thread to modify
+ * @param[in]      name                name of the thread
+ *
+ * @retval OS_STATUS_FAILURE           function failed
+ * @retval OS_STATUS_NOT_SUPPORTED     not supported by this version of Windows
+ * @retval OS_STATUS_SUCCESS           on success
+ */
+static os_status_t os_thread_name_apply(
+	HANDLE thread,
+	const char *name );
+
+/**
+ * @brief Converts a scheduling policy and priority to a Windows thread
+ *        priority
+ *
+ * Windows has no real-time scheduling policies for a thread, so real-time
+ * priorities are mapped to the highest thread priorities instead.
+ *
+ * @param[in]      policy              scheduling policy
+ * @param[in]      priority            real-time priority (1 - 99)
+ *
+ * @retval THREAD_PRIORITY_ERROR_RETURN invalid scheduling policy
+ * @retval other                       Windows thread priority
+ */
+static int os_thread_priority_native(
+	os_thread_policy_t policy,
+	int priority );
+
+#if OSAL_LOCK_STATS
+/** @brief Lock protecting the list of lock statistics */
+static SRWLOCK OS_LOCK_STATS_LOCK = SRWLOCK_INIT;
+
+/** @brief Native lock within a mutex or read/write lock */
+#define OS_THREAD_LOCK_NATIVE(x)       (&(x)->lock)
+#else /* if OSAL_LOCK_STATS */
+/** @brief Native lock within a mutex or read/write lock */
+#define OS_THREAD_LOCK_NATIVE(x)       (x)
+#endif /* else if OSAL_LOCK_STATS */
+#endif /* if OSAL_THREAD_SUPPORT */
+
 
 os_status_t os_adapters_address(
 	os_adapter_address_t *address,
@@ -351,8 +633,7 @@ os_status_t os_adapters_name(
 		tmp_len = WideCharToMultiByte( CP_UTF8, 0,
 			adapter->cur->FriendlyName, fname_len,
 			NULL, 0u, NULL, NULL );
-		tmp = (char *)HeapAlloc( GetProcessHeap(), 0,
-			sizeof( char ) * ( tmp_len + 1u ) );
+		tmp = (char *)os_malloc( sizeof( char ) * ( tmp_len + 1u ) );
 		if ( tmp )
 		{
 			WideCharToMultiByte( CP_UTF8, 0,
@@ -360,7 +641,7 @@ os_status_t os_adapters_name(
 				tmp, tmp_len + 1u, NULL, NULL );
 			tmp[tmp_len] = '\0';
 			StringCchCopy( name, name_len, tmp );
-			HeapFree( GetProcessHeap(), 0, tmp );
+			os_free( tmp );
 			result = OS_STATUS_SUCCESS;
 		}
 	}
@@ -396,7 +677,8 @@ os_status_t os_adapters_obtain(
 			NULL, NULL, &buf_len ) == ERROR_BUFFER_OVERFLOW )
 		{
 			IP_ADAPTER_ADDRESSES *aa =
-				HeapAlloc( GetProcessHeap(), 0, buf_len );
+				os_malloc_tagged( buf_len,
+					OS_MEMORY_TAG_SOCKET );
 			result = OS_STATUS_NO_MEMORY;
 			if ( aa &&  GetAdaptersAddresses( family, flags,
 				NULL, aa, &buf_len ) == NO_ERROR )
@@ -416,7 +698,7 @@ os_status_t os_adapters_release(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( adapter && adapter->first )
 	{
-		HeapFree( GetProcessHeap(), 0, adapter->first );
+		os_free( adapter->first );
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -562,6 +844,321 @@ os_status_t os_directory_close(
 	return result;
 }
 
+os_status_t os_directory_copy(
+	const char *src,
+	const char *dst,
+	const os_directory_copy_options_t *options )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( src && dst )
+	{
+		struct os_directory_copy copy;
+		WIN32_FIND_DATA wfd;
+		DWORD volume_from = 0u;
+		os_uint64_t index_from = 0u;
+
+		ZeroMemory( &copy, sizeof( struct os_directory_copy ) );
+		ZeroMemory( &wfd, sizeof( wfd ) );
+		copy.from_len = os_strlen( src );
+		copy.options = options;
+		result = OS_STATUS_FAILURE;
+		wfd.dwFileAttributes = GetFileAttributes( src );
+		if ( wfd.dwFileAttributes != INVALID_FILE_ATTRIBUTES &&
+			( wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) &&
+			( CreateDirectory( dst, NULL ) ||
+			  GetLastError() == ERROR_ALREADY_EXISTS ) &&
+			/* a directory is not copied onto itself, and a
+			 * destination within the directory copied is skipped
+			 * while scanning */
+			os_directory_copy_identity( src, &volume_from,
+				&index_from ) == OS_STATUS_SUCCESS &&
+			os_directory_copy_identity( dst, &copy.volume_to,
+				&copy.index_to ) == OS_STATUS_SUCCESS &&
+			( copy.volume_to != volume_from ||
+			  copy.index_to != index_from ) &&
+			os_arena_create( &copy.arena, 0u ) == OS_STATUS_SUCCESS )
+		{
+			size_t i;
+			/* the directory itself is given its attributes last */
+			result = os_directory_copy_add( &copy.dirs, src, dst,
+				&wfd );
+			if ( result == OS_STATUS_SUCCESS )
+				result = os_directory_copy_scan( &copy, src, dst );
+			if ( result == OS_STATUS_SUCCESS )
+			{
+#if OSAL_THREAD_SUPPORT
+				size_t threads = os_system_cpu_count();
+				if ( options && options->max_threads > 0u &&
+					options->max_threads < threads )
+					threads = options->max_threads;
+				if ( threads > copy.files.count )
+					threads = copy.files.count;
+				if ( threads > 1u &&
+					os_thread_mutex_create( &copy.lock ) ==
+						OS_STATUS_SUCCESS )
+				{
+					copy.locked = OS_TRUE;
+					result = os_parallel_for( 0u, threads, 1u,
+						os_directory_copy_thread, &copy );
+					os_thread_mutex_destroy( &copy.lock );
+				}
+				else
+#endif /* if OSAL_THREAD_SUPPORT */
+					os_directory_copy_files( &copy );
+				if ( copy.failed )
+					result = OS_STATUS_FAILURE;
+			}
+
+			/* children last, as creating entries updates the
+			 * times of the directory containing them */
+			for ( i = copy.dirs.count; result == OS_STATUS_SUCCESS &&
+				i > 0u; --i )
+				result = os_directory_copy_attributes(
+					&copy.dirs.entry[i - 1u] );
+			os_free( copy.dirs.entry );
+			os_free( copy.files.entry );
+			os_arena_destroy( &copy.arena );
+		}
+	}
+	return result;
+}
+
+os_status_t os_directory_copy_add(
+	struct os_directory_copy_list *list,
+	const char *from,
+	const char *to,
+	const WIN32_FIND_DATA *wfd )
+{
+	os_status_t result = OS_STATUS_SUCCESS;
+	if ( list->count == list->max )
+	{
+		struct os_directory_copy_entry *const entry =
+			(struct os_directory_copy_entry *)os_realloc(
+				list->entry, sizeof( struct os_directory_copy_entry ) *
+				( list->max + OS_DIRECTORY_COPY_GROW ) );
+		if ( entry )
+		{
+			list->entry = entry;
+			list->max += OS_DIRECTORY_COPY_GROW;
+		}
+		else
+			result = OS_STATUS_NO_MEMORY;
+	}
+	if ( result == OS_STATUS_SUCCESS )
+	{
+		struct os_directory_copy_entry *const entry =
+			&list->entry[list->count++];
+		entry->from = from;
+		entry->to = to;
+		entry->size = ( (os_uint64_t)wfd->nFileSizeHigh << 32 ) |
+			wfd->nFileSizeLow;
+		entry->attributes = wfd->dwFileAttributes;
+	}
+	return result;
+}
+
+os_status_t os_directory_copy_attributes(
+	const struct os_directory_copy_entry *dir )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	const DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE |
+		FILE_SHARE_DELETE;
+	/* directories can only be opened with backup semantics */
+	const HANDLE from = CreateFile( dir->from, FILE_READ_ATTRIBUTES,
+		share, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL );
+	const HANDLE to = CreateFile( dir->to, FILE_WRITE_ATTRIBUTES,
+		share, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL );
+	if ( from != INVALID_HANDLE_VALUE && to != INVALID_HANDLE_VALUE )
+	{
+		FILETIME created, accessed, written;
+		if ( GetFileTime( from, &created, &accessed, &written ) &&
+			SetFileTime( to, &created, &accessed, &written ) )
+			result = OS_STATUS_SUCCESS;
+	}
+	if ( from != INVALID_HANDLE_VALUE )
+		CloseHandle( from );
+	if ( to != INVALID_HANDLE_VALUE )
+		CloseHandle( to );
+	if ( result == OS_STATUS_SUCCESS &&
+		!SetFileAttributes( dir->to, dir->attributes ) )
+		result = OS_STATUS_FAILURE;
+	return result;
+}
+
+void os_directory_copy_files(
+	struct os_directory_copy *copy )
+{
+	os_uint64_t i;
+	while ( !os_atomic_load_u32( &copy->failed, OS_ATOMIC_RELAXED ) &&
+		( i = os_atomic_fetch_add_u64( &copy->next, 1u,
+			OS_ATOMIC_RELAXED ) ) < copy->files.count )
+	{
+		const struct os_directory_copy_entry *const file =
+			&copy->files.entry[i];
+		unsigned int flags = 0u;
+		if ( copy->options )
+			flags = copy->options->file_flags;
+		if ( os_file_copy_ex( file->from, file->to, flags ) !=
+			OS_STATUS_SUCCESS )
+			os_atomic_store_u32( &copy->failed, 1u,
+				OS_ATOMIC_RELAXED );
+		else
+		{
+#if OSAL_THREAD_SUPPORT
+			/* only created when several threads copy files */
+			const os_bool_t locked = copy->locked &&
+				os_thread_mutex_lock( &copy->lock ) ==
+					OS_STATUS_SUCCESS;
+#endif /* if OSAL_THREAD_SUPPORT */
+			++copy->files_done;
+			copy->bytes_done += file->size;
+			if ( copy->options && copy->options->progress )
+				copy->options->progress(
+					&file->from[copy->from_len + 1u],
+					copy->files_done, copy->files.count,
+					copy->bytes_done, copy->bytes_total,
+					copy->options->user_data );
+#if OSAL_THREAD_SUPPORT
+			if ( locked )
+				os_thread_mutex_unlock( &copy->lock );
+#endif /* if OSAL_THREAD_SUPPORT */
+		}
+	}
+}
+
+os_status_t os_directory_copy_identity(
+	const char *path,
+	DWORD *volume,
+	os_uint64_t *index )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	/* directories can only be opened with backup semantics */
+	const HANDLE dir = CreateFile( path, FILE_READ_ATTRIBUTES,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL );
+	if ( dir != INVALID_HANDLE_VALUE )
+	{
+		BY_HANDLE_FILE_INFORMATION info;
+		if ( GetFileInformationByHandle( dir, &info ) )
+		{
+			*volume = info.dwVolumeSerialNumber;
+			*index = ( (os_uint64_t)info.nFileIndexHigh << 32 ) |
+				info.nFileIndexLow;
+			result = OS_STATUS_SUCCESS;
+		}
+		CloseHandle( dir );
+	}
+	return result;
+}
+
+os_status_t os_directory_copy_scan(
+	struct os_directory_copy *copy,
+	const char *from,
+	const char *to )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	char search_path[MAX_PATH];
+	WIN32_FIND_DATA wfd;
+	HANDLE dir;
+
+	ZeroMemory( &wfd, sizeof( wfd ) );
+	os_snprintf( search_path, MAX_PATH - 1u, "%s\\*", from );
+	search_path[ MAX_PATH - 1u ] = '\0';
+	dir = FindFirstFile( search_path, &wfd );
+	if ( dir != INVALID_HANDLE_VALUE )
+	{
+		result = OS_STATUS_SUCCESS;
+		do
+		{
+			if ( os_strncmp( wfd.cFileName, ".", 2u ) != 0 &&
+				os_strncmp( wfd.cFileName, "..", 3u ) != 0 )
+			{
+				const size_t name_len = os_strlen( wfd.cFileName );
+				const size_t from_len = os_strlen( from ) +
+					name_len + 2u;
+				const size_t to_len = os_strlen( to ) +
+					name_len + 2u;
+				char *const child_from = (char *)os_arena_alloc(
+					&copy->arena, from_len );
+				char *const child_to = (char *)os_arena_alloc(
+					&copy->arena, to_len );
+
+				result = OS_STATUS_NO_MEMORY;
+				if ( child_from && child_to )
+				{
+					os_snprintf( child_from, from_len, "%s\\%s",
+						from, wfd.cFileName );
+					os_snprintf( child_to, to_len, "%s\\%s",
+						to, wfd.cFileName );
+					result = OS_STATUS_FAILURE;
+					/* links are copied, not followed */
+					if ( wfd.dwFileAttributes &
+						FILE_ATTRIBUTE_REPARSE_POINT )
+					{
+						if ( CopyFileEx( child_from, child_to,
+							NULL, NULL, NULL,
+							COPY_FILE_COPY_SYMLINK ) )
+							result = OS_STATUS_SUCCESS;
+					}
+					else if ( wfd.dwFileAttributes &
+						FILE_ATTRIBUTE_DIRECTORY )
+					{
+						DWORD volume = 0u;
+						os_uint64_t index = 0u;
+						/* destination within the directory
+						 * copied */
+						if ( os_directory_copy_identity(
+							child_from, &volume, &index ) ==
+							OS_STATUS_SUCCESS &&
+							volume == copy->volume_to &&
+							index == copy->index_to )
+							result = OS_STATUS_SUCCESS;
+						else
+						{
+							if ( CreateDirectory( child_to,
+								NULL ) ||
+								GetLastError() ==
+								ERROR_ALREADY_EXISTS )
+								result = os_directory_copy_add(
+									&copy->dirs,
+									child_from, child_to,
+									&wfd );
+							if ( result == OS_STATUS_SUCCESS )
+								result =
+									os_directory_copy_scan(
+									copy, child_from,
+									child_to );
+						}
+					}
+					else
+					{
+						result = os_directory_copy_add(
+							&copy->files, child_from,
+							child_to, &wfd );
+						if ( result == OS_STATUS_SUCCESS )
+							copy->bytes_total +=
+								copy->files.entry[
+								copy->files.count - 1u].size;
+					}
+				}
+			}
+		} while ( result == OS_STATUS_SUCCESS &&
+			FindNextFile( dir, &wfd ) );
+		FindClose( dir );
+	}
+	return result;
+}
+
+#if OSAL_THREAD_SUPPORT
+void os_directory_copy_thread(
+	size_t UNUSED(begin),
+	size_t UNUSED(end),
+	void *arg )
+{
+	os_directory_copy_files( (struct os_directory_copy *)arg );
+}
+#endif /* if OSAL_THREAD_SUPPORT */
+
 os_status_t os_directory_change(const char *path)
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
@@ -615,7 +1212,8 @@ os_status_t os_directory_delete(
 						{
 							size_t buf_len = os_strlen( path ) +
 								os_strlen( wfd.cFileName ) + 2u;
-							char *buf = (char*)os_malloc( buf_len );
+							char *buf = (char*)os_malloc_tagged( buf_len,
+								OS_MEMORY_TAG_FILE );
 
 							result = OS_STATUS_NO_MEMORY;
 							if ( buf )
@@ -654,7 +1252,8 @@ os_status_t os_directory_delete(
 					{
 						size_t buf_len = os_strlen( path ) +
 							os_strlen( wfd.cFileName ) + 2u;
-						char *buf = (char*)os_malloc( buf_len );
+						char *buf = (char*)os_malloc_tagged( buf_len,
+							OS_MEMORY_TAG_FILE );
 
 						result = OS_STATUS_NO_MEMORY;
 						if ( buf )
@@ -760,7 +1359,8 @@ os_status_t os_directory_next(
 os_dir_t *os_directory_open(
 	const char *dir_path )
 {
-	os_dir_t *out = (os_dir_t*)os_malloc( sizeof( struct os_dir ) );
+	os_dir_t *out = (os_dir_t*)os_malloc_tagged( sizeof( struct os_dir ),
+		OS_MEMORY_TAG_FILE );
 	if ( dir_path && out )
 	{
 		char new_dir_path[ PATH_MAX + 1u ];
@@ -834,13 +1434,34 @@ os_status_t os_file_close(
 os_status_t os_file_copy(
 	const char *old_path,
 	const char *new_path )
+{
+	return os_file_copy_ex( old_path, new_path, 0u );
+}
+
+os_status_t os_file_copy_ex(
+	const char *old_path,
+	const char *new_path,
+	unsigned int flags )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( old_path && new_path )
 	{
 		result = OS_STATUS_FAILURE;
+		/* the system copies the contents, and the attributes */
 		if ( CopyFileEx( old_path, new_path, NULL, NULL, NULL, 0 ) )
 			result = OS_STATUS_SUCCESS;
+		if ( result == OS_STATUS_SUCCESS &&
+			( flags & OS_FILE_COPY_SYNC ) )
+		{
+			const HANDLE file = CreateFile( new_path, GENERIC_WRITE,
+				FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+			if ( file == INVALID_HANDLE_VALUE ||
+				!FlushFileBuffers( file ) )
+				result = OS_STATUS_FAILURE;
+			if ( file != INVALID_HANDLE_VALUE )
+				CloseHandle( file );
+		}
 	}
 	return result;
 }
@@ -891,7 +1512,7 @@ char *os_file_gets(
 	os_file_t stream )
 {
 	DWORD number_of_bytes_read = 0u;
-	char *read = (char *)os_malloc( size );
+	char *read = (char *)os_malloc_tagged( size, OS_MEMORY_TAG_FILE );
 	if ( read )
 	{
 		read[size - 1u] = '\0';
@@ -930,6 +1551,157 @@ char *os_file_gets(
 	return str;
 }
 
+os_status_t os_file_map(
+	const char *file_path,
+	int mode,
+	os_uint64_t offset,
+	size_t size,
+	os_file_map_t *map )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( file_path && map && mode >= OS_FILE_MAP_READ_ONLY &&
+		mode <= OS_FILE_MAP_PRIVATE )
+	{
+		DWORD access = GENERIC_READ;
+		HANDLE file;
+
+		if ( mode == OS_FILE_MAP_READ_WRITE )
+			access |= GENERIC_WRITE;
+		os_memzero( map, sizeof( os_file_map_t ) );
+		result = OS_STATUS_FAILURE;
+		file = CreateFile( file_path, access, FILE_SHARE_READ |
+			FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, NULL );
+		if ( file != INVALID_HANDLE_VALUE )
+		{
+			LARGE_INTEGER file_size;
+			if ( GetFileSizeEx( file, &file_size ) )
+			{
+				const os_uint64_t total =
+					(os_uint64_t)file_size.QuadPart;
+				/* 0 maps the rest of the file, if it can fit in
+				 * memory */
+				if ( size == 0u && offset <= total &&
+					total - offset <= (size_t)-1 )
+					size = (size_t)( total - offset );
+				if ( offset > total || size > total - offset ||
+					( size == 0u && offset < total ) )
+					result = OS_STATUS_BAD_PARAMETER;
+				else if ( size == 0u )
+					result = OS_STATUS_SUCCESS;
+				else
+				{
+					DWORD protect = PAGE_READONLY;
+					DWORD view_access = FILE_MAP_READ;
+					HANDLE mapping;
+					SYSTEM_INFO info;
+					size_t delta;
+
+					if ( mode == OS_FILE_MAP_READ_WRITE )
+					{
+						protect = PAGE_READWRITE;
+						view_access = FILE_MAP_WRITE;
+					}
+					else if ( mode == OS_FILE_MAP_PRIVATE )
+					{
+						protect = PAGE_WRITECOPY;
+						view_access = FILE_MAP_COPY;
+					}
+
+					/* views start on the allocation granularity */
+					GetSystemInfo( &info );
+					delta = (size_t)( offset %
+						info.dwAllocationGranularity );
+					offset -= delta;
+					mapping = CreateFileMapping( file, NULL, protect,
+						0u, 0u, NULL );
+					if ( mapping )
+					{
+						map->base = MapViewOfFile( mapping,
+							view_access,
+							(DWORD)( offset >> 32 ),
+							(DWORD)( offset & 0xFFFFFFFFu ),
+							size + delta );
+						/* the view keeps the mapping open */
+						CloseHandle( mapping );
+					}
+					if ( map->base )
+					{
+						map->address = (char *)map->base + delta;
+						map->size = size;
+						map->base_size = size + delta;
+						result = OS_STATUS_SUCCESS;
+					}
+				}
+			}
+			/* changes are only written by flushing the file */
+			if ( result == OS_STATUS_SUCCESS && map->base &&
+				mode == OS_FILE_MAP_READ_WRITE )
+				map->file = file;
+			else
+				CloseHandle( file );
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_map_advise(
+	os_file_map_t *map,
+	size_t offset,
+	size_t size,
+	int advice )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map && offset <= map->size &&
+		advice >= OS_FILE_MAP_ADVICE_SEQUENTIAL &&
+		advice <= OS_FILE_MAP_ADVICE_DONTNEED )
+	{
+		if ( size == 0u )
+			size = map->size - offset;
+		if ( size <= map->size - offset )
+		{
+			char *const start = (char *)map->address + offset;
+			result = OS_STATUS_SUCCESS;
+			/* sequential access can only be advised when opening
+			 * a file, so it is ignored */
+			if ( size > 0u && advice == OS_FILE_MAP_ADVICE_DONTNEED )
+			{
+				/* unlocking pages that are not locked removes
+				 * them from the working set */
+				VirtualUnlock( start, size );
+			}
+#if _WIN32_WINNT >= 0x0602
+			else if ( size > 0u &&
+				advice == OS_FILE_MAP_ADVICE_WILLNEED )
+			{
+				WIN32_MEMORY_RANGE_ENTRY range;
+				range.VirtualAddress = start;
+				range.NumberOfBytes = size;
+				PrefetchVirtualMemory( GetCurrentProcess(), 1u,
+					&range, 0u );
+			}
+#endif /* if _WIN32_WINNT >= 0x0602 */
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_map_sync(
+	os_file_map_t *map,
+	os_bool_t wait )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( map->base && !FlushViewOfFile( map->base, 0u ) )
+			result = OS_STATUS_FAILURE;
+		else if ( wait && map->file && !FlushFileBuffers( map->file ) )
+			result = OS_STATUS_FAILURE;
+	}
+	return result;
+}
+
 os_status_t os_file_move(
 	const char *old_path,
 	const char *new_path
@@ -1023,6 +1795,131 @@ size_t os_file_read(
 	return result;
 }
 
+os_status_t os_file_pread(
+	os_file_t stream,
+	void *buf,
+	size_t size,
+	os_uint64_t offset,
+	size_t *bytes_read )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && stream != OS_FILE_INVALID && ( buf || size == 0u ) )
+	{
+		size_t total = 0u;
+		DWORD got = 1u;
+
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && got > 0u && total < size )
+		{
+			OVERLAPPED overlapped;
+			DWORD chunk = OS_FILE_IO_CHUNK_SIZE;
+			if ( size - total < chunk )
+				chunk = (DWORD)( size - total );
+
+			/* the position is given with each read, so threads
+			 * may read from the same file at once; the handle is
+			 * synchronous, so the file position is still moved */
+			ZeroMemory( &overlapped, sizeof( overlapped ) );
+			overlapped.Offset = (DWORD)( offset + total );
+			overlapped.OffsetHigh = (DWORD)( ( offset + total ) >> 32 );
+			got = 0u;
+			if ( !ReadFile( stream, (char *)buf + total, chunk, &got,
+				&overlapped ) && GetLastError() != ERROR_HANDLE_EOF )
+				result = OS_STATUS_FAILURE;
+			total += got;
+		}
+		if ( bytes_read )
+			*bytes_read = total;
+	}
+	return result;
+}
+
+os_status_t os_file_preadv(
+	os_file_t stream,
+	const os_file_io_vector_t *vector,
+	size_t count,
+	os_uint64_t offset,
+	size_t *bytes_read )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && stream != OS_FILE_INVALID && ( vector || count == 0u ) )
+	{
+		size_t total = 0u;
+		size_t i;
+
+		/* stops at the end of the file */
+		result = OS_STATUS_SUCCESS;
+		for ( i = 0u; result == OS_STATUS_SUCCESS && i < count; ++i )
+		{
+			size_t got = 0u;
+			result = os_file_pread( stream, vector[i].iov_base,
+				vector[i].iov_len, offset + total, &got );
+			total += got;
+			if ( got < vector[i].iov_len )
+				count = i;
+		}
+		if ( bytes_read )
+			*bytes_read = total;
+	}
+	return result;
+}
+
+os_status_t os_file_pwrite(
+	os_file_t stream,
+	const void *buf,
+	size_t size,
+	os_uint64_t offset )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && stream != OS_FILE_INVALID && ( buf || size == 0u ) )
+	{
+		size_t total = 0u;
+
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && total < size )
+		{
+			OVERLAPPED overlapped;
+			DWORD put = 0u;
+			DWORD chunk = OS_FILE_IO_CHUNK_SIZE;
+			if ( size - total < chunk )
+				chunk = (DWORD)( size - total );
+
+			/* the position is given with each write, so threads
+			 * may write to the same file at once; the handle is
+			 * synchronous, so the file position is still moved */
+			ZeroMemory( &overlapped, sizeof( overlapped ) );
+			overlapped.Offset = (DWORD)( offset + total );
+			overlapped.OffsetHigh = (DWORD)( ( offset + total ) >> 32 );
+			if ( !WriteFile( stream, (const char *)buf + total, chunk,
+				&put, &overlapped ) || put == 0u )
+				result = OS_STATUS_FAILURE;
+			total += put;
+		}
+	}
+	return result;
+}
+
+os_status_t os_file_pwritev(
+	os_file_t stream,
+	const os_file_io_vector_t *vector,
+	size_t count,
+	os_uint64_t offset )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream && stream != OS_FILE_INVALID && ( vector || count == 0u ) )
+	{
+		size_t i;
+		result = OS_STATUS_SUCCESS;
+		for ( i = 0u; result == OS_STATUS_SUCCESS && i < count; ++i )
+		{
+			result = os_file_pwrite( stream, vector[i].iov_base,
+				vector[i].iov_len, offset );
+			offset += vector[i].iov_len;
+		}
+	}
+	return result;
+}
+
 os_status_t os_file_seek(
 	os_file_t stream,
 	long offset,
@@ -1040,6 +1937,23 @@ os_status_t os_file_seek(
 	return result;
 }
 
+os_status_t os_file_seek64(
+	os_file_t stream,
+	os_int64_t offset,
+	int whence )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( stream != OS_FILE_INVALID )
+	{
+		LARGE_INTEGER distance;
+		distance.QuadPart = offset;
+		result = OS_STATUS_FAILURE;
+		if ( SetFilePointerEx( stream, distance, NULL, whence ) )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
 os_uint64_t os_file_size(
 	const char *file_path )
 {
@@ -1060,10 +1974,11 @@ os_uint64_t os_file_size(
 os_uint64_t os_file_size_handle(
 	os_file_t file_handle )
 {
-	DWORD file_size = 0;
-	if ( file_handle )
-		file_size = GetFileSize( file_handle, NULL );
-	return (os_uint64_t)file_size;
+	os_uint64_t result = 0u;
+	LARGE_INTEGER file_size;
+	if ( file_handle && GetFileSizeEx( file_handle, &file_size ) )
+		result = (os_uint64_t)file_size.QuadPart;
+	return result;
 }
 
 os_status_t os_file_sync(
@@ -1092,6 +2007,22 @@ long int os_file_tell(
 	return result;
 }
 
+os_int64_t os_file_tell64(
+	os_file_t stream )
+{
+	os_int64_t result = -1;
+	if ( stream != OS_FILE_INVALID )
+	{
+		LARGE_INTEGER distance;
+		LARGE_INTEGER position;
+		distance.QuadPart = 0;
+		if ( SetFilePointerEx( stream, distance, &position,
+			FILE_CURRENT ) )
+			result = (os_int64_t)position.QuadPart;
+	}
+	return result;
+}
+
 os_status_t os_file_temp(
 	char *prototype,
 	size_t suffix_len )
@@ -1119,6 +2050,22 @@ os_status_t os_file_temp(
 	return result;
 }
 
+os_status_t os_file_unmap(
+	os_file_map_t *map )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( map )
+	{
+		result = OS_STATUS_SUCCESS;
+		if ( map->base && !UnmapViewOfFile( map->base ) )
+			result = OS_STATUS_FAILURE;
+		if ( map->file )
+			CloseHandle( map->file );
+		os_memzero( map, sizeof( os_file_map_t ) );
+	}
+	return result;
+}
+
 size_t os_file_write(
 	const void *ptr,
 	size_t size,
@@ -1567,14 +2514,13 @@ size_t os_env_expand(
 			/* according to documentation, this should be size of
 			 * the string + null-terminator + 1, so add +2 to result
 			 * to ensure enough space */
-			dest = (char*)HeapAlloc( GetProcessHeap(), 0,
-				result + 2u );
+			dest = (char*)os_malloc( result + 2u );
 			if ( dest )
 			{
 				ExpandEnvironmentStringsA( src, dest,
 					result + 2u );
 				os_memcpy( src, dest, result + 1u );
-				HeapFree( GetProcessHeap(), 0, dest );
+				os_free( dest );
 			}
 		}
 	}
@@ -1737,33 +2683,49 @@ os_bool_t os_flush( os_file_t stream )
 }
 
 /* memory functions */
-#if OSAL_WRAP
-void *os_calloc( size_t nmemb, size_t size )
+void *os_allocator_system_aligned_alloc(
+	size_t alignment,
+	size_t size,
+	void *UNUSED(user_data) )
 {
-	return HeapAlloc( GetProcessHeap(), 0, nmemb * size );
+	void *result = NULL;
+	/* memory from the heap is released by os_allocator_system_free, so
+	 * only the alignment of the heap can be provided */
+	if ( alignment <= MEMORY_ALLOCATION_ALIGNMENT )
+		result = HeapAlloc( GetProcessHeap(), 0, size );
+	return result;
 }
 
-void os_free( void *ptr )
+void *os_allocator_system_calloc(
+	size_t nmemb,
+	size_t size,
+	void *UNUSED(user_data) )
 {
-	HeapFree( GetProcessHeap(), 0, ptr );
+	void *result = NULL;
+	if ( size == 0u || nmemb <= (size_t)-1 / size )
+		result = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+			nmemb * size );
+	return result;
 }
 
-void os_free_null( void **ptr )
-{
-	if ( ptr && *ptr )
-	{
-		HeapFree( GetProcessHeap(), 0, *ptr );
-		*ptr = NULL;
-	}
+void os_allocator_system_free(
+	void *ptr,
+	void *UNUSED(user_data) )
+{
+	HeapFree( GetProcessHeap(), 0, ptr );
 }
 
-void *os_malloc( size_t size )
+void *os_allocator_system_malloc(
+	size_t size,
+	void *UNUSED(user_data) )
 {
 	return HeapAlloc( GetProcessHeap(), 0, size );
 }
-#endif /* OSAL_WRAP */
 
-void *os_realloc( void *ptr, size_t size )
+void *os_allocator_system_realloc(
+	void *ptr,
+	size_t size,
+	void *UNUSED(user_data) )
 {
 	void *result;
 	if ( ptr )
@@ -1773,6 +2735,65 @@ void *os_realloc( void *ptr, size_t size )
 	return result;
 }
 
+const os_allocator_t *os_allocator_system( void )
+{
+	return &OS_ALLOCATOR_SYSTEM;
+}
+
+void os_free_large(
+	void *ptr,
+	size_t UNUSED(size) )
+{
+	if ( ptr )
+		VirtualFree( ptr, 0u, MEM_RELEASE );
+}
+
+void *os_malloc_large(
+	size_t size,
+	unsigned int flags )
+{
+	void *result = NULL;
+	if ( size > 0u )
+	{
+		const SIZE_T large_page = GetLargePageMinimum();
+		/* large pages need the "lock pages in memory" privilege, and
+		 * are always locked */
+		if ( ( flags & OS_MEMORY_FLAG_HUGE_PAGES ) && large_page > 0u &&
+			size <= (size_t)-1 - large_page )
+		{
+			result = VirtualAlloc( NULL,
+				( size + large_page - 1u ) & ~( large_page - 1u ),
+				MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+				PAGE_READWRITE );
+			if ( result )
+				flags &= ~OS_MEMORY_FLAG_LOCK;
+		}
+		if ( result == NULL )
+			result = VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT,
+				PAGE_READWRITE );
+
+		if ( result && ( flags & OS_MEMORY_FLAG_LOCK ) )
+		{
+			/* locking also faults in every page */
+			if ( VirtualLock( result, size ) == FALSE )
+			{
+				VirtualFree( result, 0u, MEM_RELEASE );
+				result = NULL;
+			}
+		}
+		else if ( result && ( flags & OS_MEMORY_FLAG_PREFAULT ) )
+		{
+			SYSTEM_INFO info;
+			volatile char *const p = (volatile char *)result;
+			size_t i;
+			GetSystemInfo( &info );
+			for ( i = 0u; i < size; i += info.dwPageSize )
+				p[i] = 0;
+		}
+	}
+	return result;
+}
+
 BOOL WINAPI os_on_terminate( DWORD ctrl_type )
 {
 	BOOL result = FALSE;
@@ -1934,7 +2955,8 @@ os_status_t os_service_run(
 				os_strlen( id );
 
 			result = OS_STATUS_NO_MEMORY;
-			SERVICE_KEY = (char *)os_malloc( service_id_len );
+			SERVICE_KEY = (char *)os_malloc_tagged( service_id_len,
+				OS_MEMORY_TAG_PROCESS );
 			if ( SERVICE_KEY )
 			{
 				os_strncpy( SERVICE_KEY, id, service_id_len );
@@ -1942,8 +2964,9 @@ os_status_t os_service_run(
 
 				SERVICE_MAIN = main;
 				SERVICE_MAIN_ARGC = 0;
-				SERVICE_MAIN_ARGV = (char**)os_malloc(
-					sizeof(char*) * argc );
+				SERVICE_MAIN_ARGV = (char**)os_malloc_tagged(
+					sizeof(char*) * argc,
+					OS_MEMORY_TAG_PROCESS );
 				if ( SERVICE_MAIN_ARGV )
 				{
 					os_bool_t no_error = OS_TRUE;
@@ -2152,8 +3175,8 @@ os_status_t os_service_install(
 			/* +1 for space character between arguments */
 			cmd_line_len += os_strlen( args ) + 1u;
 		result = OS_STATUS_NO_MEMORY;
-		cmd_line = (char *)os_malloc( sizeof(char) *
-			( cmd_line_len + 1u ) );
+		cmd_line = (char *)os_malloc_tagged( sizeof(char) *
+			( cmd_line_len + 1u ), OS_MEMORY_TAG_PROCESS );
 		if ( cmd_line )
 		{
 			SC_HANDLE sc_manager;
@@ -2181,8 +3204,9 @@ os_status_t os_service_install(
 						os_strlen( dependencies ) + 1u;
 					/* extra +1 because must be double
 					 * null-terminated */
-					depends = (char*)os_malloc(
-						 dep_len + 1u );
+					depends = (char*)os_malloc_tagged(
+						dep_len + 1u,
+						OS_MEMORY_TAG_PROCESS );
 					if ( depends )
 					{
 						char *d = depends;
@@ -2228,7 +3252,8 @@ os_status_t os_service_install(
 						size_t desc_len =
 							os_strlen( description ) + 1u;
 #endif
-						desc_heap = (LPTSTR)os_malloc( desc_len );
+						desc_heap = (LPTSTR)os_malloc_tagged( desc_len,
+							OS_MEMORY_TAG_PROCESS );
 						if ( desc_heap )
 						{
 							SERVICE_DESCRIPTION sd;
@@ -2269,9 +3294,10 @@ os_status_t os_service_install(
 						sfa.lpCommand = NULL;
 
 						sfa.lpsaActions = (SC_ACTION*)
-							os_malloc(
+							os_malloc_tagged(
 								sizeof( SC_ACTION ) *
-								SERVICE_RETRY_COUNT_MAX );
+								SERVICE_RETRY_COUNT_MAX,
+								OS_MEMORY_TAG_PROCESS );
 						if ( sfa.lpsaActions )
 						{
 							unsigned int i;
@@ -2756,11 +3782,10 @@ void os_service_entry_close( void )
 		{
 			if ( SERV_DB.first[i].s_name )
 			{
-				HeapFree( GetProcessHeap(), 0,
-					SERV_DB.first[i].s_name );
+				os_free( SERV_DB.first[i].s_name );
 			}
 		}
-		HeapFree( GetProcessHeap(), 0, SERV_DB.first );
+		os_free( SERV_DB.first );
 
 		/* zeroize database */
 		ZeroMemory( &SERV_DB, sizeof( struct service_database ) );
@@ -2808,8 +3833,7 @@ void os_service_entry_open(
 	str_len = ExpandEnvironmentStrings( file_in, NULL, 0u );
 	if ( str_len > 0u )
 	{
-		LPSTR file_out = HeapAlloc( GetProcessHeap(), 0,
-			(str_len + 1u) * sizeof(TCHAR) );
+		LPSTR file_out = os_malloc( (str_len + 1u) * sizeof(TCHAR) );
 		if ( file_out )
 		{
 			ExpandEnvironmentStrings( file_in, file_out,
@@ -2817,7 +3841,7 @@ void os_service_entry_open(
 			serv_file = CreateFile( file_out, GENERIC_READ,
 				FILE_SHARE_READ, NULL, OPEN_EXISTING,
 				FILE_ATTRIBUTE_NORMAL, NULL );
-			HeapFree( GetProcessHeap(), 0, file_out );
+			os_free( file_out );
 		}
 	}
 
@@ -2910,20 +3934,19 @@ void os_service_entry_open(
 						if ( port > 0u && name_end > name_start )
 						{
 							if ( s )
-								s = (struct servent *)HeapReAlloc(
-									GetProcessHeap(), HEAP_ZERO_MEMORY, s,
+								s = (struct servent *)os_realloc( s,
 									sizeof( struct servent ) * (scnt + 1u));
 							else
-								s = (struct servent *)HeapAlloc(
-									GetProcessHeap(), HEAP_ZERO_MEMORY,
-									sizeof( struct servent ) * (scnt + 1u));
+								s = (struct servent *)os_malloc_tagged(
+									sizeof( struct servent ) * (scnt + 1u),
+									OS_MEMORY_TAG_SOCKET );
 							if ( s )
 							{
 								unsigned int i;
 								char *str;
-								s[scnt].s_name = HeapAlloc(
-									GetProcessHeap(), 0,
-									(sizeof(char) * ((name_end - name_start + 1u) + (proto_end - proto_start + 1u))) +
+								os_memzero( &s[scnt],
+									sizeof( struct servent ) );
+								s[scnt].s_name = os_malloc( (sizeof(char) * ((name_end - name_start + 1u) + (proto_end - proto_start + 1u))) +
 									(sizeof(char*) * (alias_count + 1u)) + (sizeof(char) * (buf_pos - alias_start)));
 								StringCchCopyA( s[scnt].s_name,
 									name_end - name_start,
@@ -3006,7 +4029,8 @@ os_status_t os_socket_accept(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( socket && out )
 	{
-		os_socket_t *s = os_malloc( sizeof( struct os_socket ) );
+		os_socket_t *s = os_malloc_tagged( sizeof( struct os_socket ),
+			OS_MEMORY_TAG_SOCKET );
 		result = OS_STATUS_NO_MEMORY;
 		if ( s )
 		{
@@ -3160,7 +4184,8 @@ os_status_t os_socket_open(
 
 	if ( out && address && port > 0u )
 	{
-		os_socket_t *s = os_malloc( sizeof( os_socket_t ) );
+		os_socket_t *s = os_malloc_tagged( sizeof( os_socket_t ),
+			OS_MEMORY_TAG_SOCKET );
 		result = OS_STATUS_NO_MEMORY;
 		*out = NULL;
 		if ( s )
@@ -3494,6 +4519,33 @@ int os_system_error_last( void )
 }
 #endif /* if OSAL_WRAP */
 
+unsigned int os_system_cpu_count( void )
+{
+	unsigned int result = 1u;
+	DWORD_PTR process_mask;
+	DWORD_PTR system_mask;
+
+	/* only count the CPUs the process is allowed to run on */
+	if ( GetProcessAffinityMask( GetCurrentProcess(), &process_mask,
+		&system_mask ) && process_mask != 0u )
+	{
+		result = 0u;
+		while ( process_mask != 0u )
+		{
+			process_mask &= process_mask - 1u;
+			++result;
+		}
+	}
+	else
+	{
+		SYSTEM_INFO sys_info;
+		GetSystemInfo( &sys_info );
+		if ( sys_info.dwNumberOfProcessors > 0u )
+			result = (unsigned int)sys_info.dwNumberOfProcessors;
+	}
+	return result;
+}
+
 const char *os_system_error_string(
 	int error_number )
 {
@@ -3550,8 +4602,7 @@ os_status_t os_system_info(
 		DWORD version_size = GetFileVersionInfoSize( "kernel32", NULL );
 		if ( version_size > 0u )
 		{
-			BYTE *version_info = (BYTE*)HeapAlloc( GetProcessHeap(),
-				0, sizeof( BYTE ) * version_size );
+			BYTE *version_info = (BYTE*)os_malloc( sizeof( BYTE ) * version_size );
 			if ( version_info && GetFileVersionInfo( "kernel32", 0,
 				version_size, version_info ) )
 			{
@@ -3566,7 +4617,7 @@ os_status_t os_system_info(
 				}
 			}
 			if ( version_info )
-				HeapFree( GetProcessHeap(), 0, version_info );
+				os_free( version_info );
 		}
 		is_server = IsWindowsServer();
 		*service_pack = '\0';
@@ -4352,6 +5403,18 @@ os_status_t os_time_format(
 	return result;
 }
 
+os_status_t os_time_monotonic(
+	os_timestamp_t *time_stamp )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( time_stamp )
+	{
+		*time_stamp = (os_timestamp_t)GetTickCount64();
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
 os_status_t os_time_sleep(
 	os_millisecond_t ms,
 	os_bool_t allow_interrupts )
@@ -4405,6 +5468,129 @@ os_status_t os_time_stamp_to_date_time( os_date_time_t* date_time,
 
 /* threads & lock support */
 #if OSAL_THREAD_SUPPORT
+os_status_t os_atomic_wait_u32(
+	os_atomic_uint32_t *ptr,
+	os_uint32_t expected,
+	const os_timestamp_t *deadline )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( ptr )
+	{
+		DWORD wait_time = INFINITE;
+		if ( deadline )
+		{
+			const os_timestamp_t now =
+				(os_timestamp_t)GetTickCount64();
+			wait_time = 0u;
+			if ( *deadline > now )
+			{
+				wait_time = INFINITE - 1u;
+				if ( *deadline - now < (os_timestamp_t)wait_time )
+					wait_time = (DWORD)( *deadline - now );
+			}
+		}
+
+		result = OS_STATUS_SUCCESS;
+		if ( !WaitOnAddress( (volatile VOID *)ptr, &expected,
+			sizeof( os_uint32_t ), wait_time ) )
+		{
+			result = OS_STATUS_FAILURE;
+			if ( GetLastError() == ERROR_TIMEOUT )
+				result = OS_STATUS_TIMED_OUT;
+		}
+	}
+	return result;
+}
+
+os_status_t os_atomic_wake_u32(
+	os_atomic_uint32_t *ptr,
+	os_bool_t wake_all )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( ptr )
+	{
+		if ( wake_all != OS_FALSE )
+			WakeByAddressAll( (PVOID)ptr );
+		else
+			WakeByAddressSingle( (PVOID)ptr );
+		result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_fiber_create(
+	os_fiber_scheduler_t *UNUSED(scheduler),
+	os_fiber_main_t UNUSED(main),
+	void *UNUSED(arg) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_create(
+	os_fiber_scheduler_t **UNUSED(scheduler),
+	size_t UNUSED(stack_size) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_destroy(
+	os_fiber_scheduler_t *UNUSED(scheduler) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_scheduler_run(
+	os_fiber_scheduler_t *UNUSED(scheduler) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_fiber_t *os_fiber_self( void )
+{
+	return NULL;
+}
+
+os_status_t os_fiber_sleep(
+	os_millisecond_t UNUSED(time_out) )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+os_status_t os_fiber_yield( void )
+{
+	return OS_STATUS_NOT_SUPPORTED;
+}
+
+#if OSAL_LOCK_STATS
+void os_lock_stats_list_lock( void )
+{
+	AcquireSRWLockExclusive( &OS_LOCK_STATS_LOCK );
+}
+
+void os_lock_stats_list_unlock( void )
+{
+	ReleaseSRWLockExclusive( &OS_LOCK_STATS_LOCK );
+}
+
+os_uint64_t os_lock_stats_now( void )
+{
+	static LARGE_INTEGER frequency = { 0 };
+	os_uint64_t result = 0u;
+	LARGE_INTEGER counter;
+	if ( frequency.QuadPart == 0 )
+		QueryPerformanceFrequency( &frequency );
+	if ( frequency.QuadPart > 0 && QueryPerformanceCounter( &counter ) )
+	{
+		/* split to avoid overflowing the multiplication */
+		const os_uint64_t ticks = (os_uint64_t)counter.QuadPart;
+		const os_uint64_t hz = (os_uint64_t)frequency.QuadPart;
+		result = ( ticks / hz ) * OS_NANOSECONDS_IN_SECOND +
+			( ticks % hz ) * OS_NANOSECONDS_IN_SECOND / hz;
+	}
+	return result;
+}
+#endif /* if OSAL_LOCK_STATS */
+
 os_status_t os_thread_condition_broadcast(
 	os_thread_condition_t *cond )
 {
@@ -4452,21 +5638,56 @@ os_status_t os_thread_condition_timed_wait(
 	os_thread_condition_t *cond,
 	os_thread_mutex_t *lock,
 	os_millisecond_t max_time_out )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( cond && lock )
+		result = os_thread_condition_wait_internal( cond, lock,
+			max_time_out > 0u ? max_time_out : INFINITE );
+	return result;
+}
+
+os_status_t os_thread_condition_wait_internal(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	DWORD time_out )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+#if OSAL_LOCK_STATS
+	/* the lock is not held while waiting */
+	os_lock_stats_released( lock->stats,
+		os_lock_stats_now() - lock->acquired );
+#endif /* if OSAL_LOCK_STATS */
+	if ( SleepConditionVariableCS( cond, OS_THREAD_LOCK_NATIVE( lock ),
+		time_out ) > 0 )
+		result = OS_STATUS_SUCCESS;
+	else if ( GetLastError() == ERROR_TIMEOUT )
+		result = OS_STATUS_TIMED_OUT;
+#if OSAL_LOCK_STATS
+	lock->acquired = os_lock_stats_now();
+#endif /* if OSAL_LOCK_STATS */
+	return result;
+}
+
+os_status_t os_thread_condition_wait_until(
+	os_thread_condition_t *cond,
+	os_thread_mutex_t *lock,
+	os_timestamp_t deadline )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( cond && lock )
 	{
-		result = OS_STATUS_FAILURE;
-		if ( max_time_out > 0u )
+		/* the wait is relative, measured from the monotonic clock */
+		os_timestamp_t now = 0u;
+		DWORD time_out = 0u;
+		os_time_monotonic( &now );
+		if ( deadline > now )
 		{
-			if ( SleepConditionVariableCS( cond, lock, max_time_out ) > 0 )
-				result = OS_STATUS_SUCCESS;
-			else if ( GetLastError() == ERROR_TIMEOUT )
-				result = OS_STATUS_TIMED_OUT;
+			time_out = INFINITE - 1u;
+			if ( deadline - now < (os_timestamp_t)time_out )
+				time_out = (DWORD)( deadline - now );
 		}
-		else
-			if ( SleepConditionVariableCS( cond, lock, INFINITE ) > 0 )
-				result = OS_STATUS_SUCCESS;
+		result = os_thread_condition_wait_internal( cond, lock,
+			time_out );
 	}
 	return result;
 }
@@ -4497,6 +5718,54 @@ os_status_t os_thread_create(
 	return result;
 }
 
+os_status_t os_thread_create_ex(
+	os_thread_t *thread,
+	os_thread_main_t main,
+	void *arg,
+	const os_thread_attr_t *attr )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( !attr )
+		result = os_thread_create( thread, main, arg, 0u );
+	else if ( thread && main &&
+		os_thread_priority_native( attr->policy, attr->priority ) !=
+			THREAD_PRIORITY_ERROR_RETURN )
+	{
+		/* start suspended, so the attributes apply before it runs */
+		result = OS_STATUS_FAILURE;
+		*thread = CreateThread( NULL, (SIZE_T)attr->stack_size,
+			main, arg, CREATE_SUSPENDED, NULL );
+		if ( *thread )
+		{
+			result = OS_STATUS_SUCCESS;
+			if ( attr->affinity != 0u )
+				result = os_thread_affinity_apply( *thread,
+					attr->affinity );
+			if ( result == OS_STATUS_SUCCESS &&
+				!SetThreadPriority( *thread,
+					os_thread_priority_native( attr->policy,
+						attr->priority ) ) )
+				result = OS_STATUS_FAILURE;
+			/* the name is informational, failing to set it is fine */
+			if ( result == OS_STATUS_SUCCESS && attr->name )
+				os_thread_name_apply( *thread, attr->name );
+			if ( result == OS_STATUS_SUCCESS &&
+				ResumeThread( *thread ) == (DWORD)-1 )
+				result = OS_STATUS_FAILURE;
+
+			if ( result != OS_STATUS_SUCCESS )
+				TerminateThread( *thread, 0 );
+			if ( result != OS_STATUS_SUCCESS ||
+				attr->detached != OS_FALSE )
+			{
+				CloseHandle( *thread );
+				*thread = NULL;
+			}
+		}
+	}
+	return result;
+}
+
 os_status_t os_thread_destroy(
 	os_thread_t *thread )
 {
@@ -4522,25 +5791,125 @@ os_status_t os_thread_wait(
 	return result;
 }
 
+os_status_t os_thread_local_key_create(
+	os_thread_local_key_t *key,
+	os_thread_local_destructor_t destructor )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		/* fiber-local storage, unlike TlsAlloc, calls a destructor */
+		*key = FlsAlloc( destructor );
+		result = OS_STATUS_SUCCESS;
+		if ( *key == FLS_OUT_OF_INDEXES )
+			result = OS_STATUS_NO_MEMORY;
+	}
+	return result;
+}
+
+os_status_t os_thread_local_key_destroy(
+	os_thread_local_key_t *key )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		result = OS_STATUS_FAILURE;
+		if ( FlsFree( *key ) )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+#if OSAL_WRAP
+void *os_thread_local_key_get(
+	const os_thread_local_key_t *key )
+{
+	void *result = NULL;
+	if ( key )
+		result = FlsGetValue( *key );
+	return result;
+}
+#endif /* if OSAL_WRAP */
+
+os_status_t os_thread_local_key_set(
+	const os_thread_local_key_t *key,
+	void *value )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( key )
+	{
+		result = OS_STATUS_FAILURE;
+		if ( FlsSetValue( *key, value ) )
+			result = OS_STATUS_SUCCESS;
+		else if ( GetLastError() == ERROR_NOT_ENOUGH_MEMORY )
+			result = OS_STATUS_NO_MEMORY;
+	}
+	return result;
+}
+
 os_status_t os_thread_mutex_create(
 	os_thread_mutex_t *lock )
+{
+	return os_thread_mutex_create_ex( lock, NULL );
+}
+
+os_status_t os_thread_mutex_create_ex(
+	os_thread_mutex_t *lock,
+	const os_thread_mutex_attr_t *attr )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
-	if ( lock )
+	if ( lock && ( !attr ||
+		attr->protocol == OS_THREAD_MUTEX_PROTOCOL_NONE ||
+		attr->protocol == OS_THREAD_MUTEX_PROTOCOL_INHERIT ||
+		( attr->protocol == OS_THREAD_MUTEX_PROTOCOL_PROTECT &&
+		  attr->priority >= 1 && attr->priority <= 99 ) ) )
 	{
-		InitializeCriticalSection( lock );
-		result = OS_STATUS_SUCCESS;
+		/* critical sections have no priority protocols, and are not
+		 * released when their owner ends */
+		result = OS_STATUS_NOT_SUPPORTED;
+		if ( !attr || ( attr->protocol == OS_THREAD_MUTEX_PROTOCOL_NONE &&
+			attr->robust == OS_FALSE ) )
+		{
+			InitializeCriticalSection( OS_THREAD_LOCK_NATIVE( lock ) );
+#if OSAL_LOCK_STATS
+			lock->stats = os_lock_stats_register( "mutex",
+				attr ? attr->name : NULL, lock );
+			lock->acquired = 0u;
+#endif /* if OSAL_LOCK_STATS */
+			result = OS_STATUS_SUCCESS;
+		}
 	}
 	return result;
 }
 
+os_status_t os_thread_mutex_create_named(
+	os_thread_mutex_t *lock,
+	const char *name )
+{
+	os_thread_mutex_attr_t attr;
+	ZeroMemory( &attr, sizeof( os_thread_mutex_attr_t ) );
+	attr.name = name;
+	return os_thread_mutex_create_ex( lock, &attr );
+}
+
 os_status_t os_thread_mutex_lock(
 	os_thread_mutex_t *lock )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		if ( !TryEnterCriticalSection( &lock->lock ) )
+		{
+			start = os_lock_stats_now();
+			EnterCriticalSection( &lock->lock );
+		}
+		lock->acquired = os_lock_stats_now();
+		os_lock_stats_acquired( lock->stats, start, lock->acquired );
+#else /* if OSAL_LOCK_STATS */
 		EnterCriticalSection( lock );
+#endif /* else if OSAL_LOCK_STATS */
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4552,7 +5921,12 @@ os_status_t os_thread_mutex_unlock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
-		LeaveCriticalSection( lock );
+#if OSAL_LOCK_STATS
+		/* measured before another thread can acquire the lock */
+		os_lock_stats_released( lock->stats,
+			os_lock_stats_now() - lock->acquired );
+#endif /* if OSAL_LOCK_STATS */
+		LeaveCriticalSection( OS_THREAD_LOCK_NATIVE( lock ) );
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4564,7 +5938,11 @@ os_status_t os_thread_mutex_destroy(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
-		DeleteCriticalSection( lock );
+		DeleteCriticalSection( OS_THREAD_LOCK_NATIVE( lock ) );
+#if OSAL_LOCK_STATS
+		os_lock_stats_unregister( lock->stats );
+		lock->stats = NULL;
+#endif /* if OSAL_LOCK_STATS */
 		result = OS_STATUS_SUCCESS;
 	}
 	return OS_STATUS_SUCCESS;
@@ -4572,11 +5950,24 @@ os_status_t os_thread_mutex_destroy(
 
 os_status_t os_thread_rwlock_create(
 	os_thread_rwlock_t *lock )
+{
+	return os_thread_rwlock_create_named( lock, NULL );
+}
+
+os_status_t os_thread_rwlock_create_named(
+	os_thread_rwlock_t *lock,
+	const char *name )
 {
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
-		InitializeSRWLock( lock );
+		InitializeSRWLock( OS_THREAD_LOCK_NATIVE( lock ) );
+#if OSAL_LOCK_STATS
+		lock->stats = os_lock_stats_register( "rwlock", name, lock );
+		lock->acquired = 0u;
+#else /* if OSAL_LOCK_STATS */
+		(void)name;
+#endif /* else if OSAL_LOCK_STATS */
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4588,7 +5979,19 @@ os_status_t os_thread_rwlock_read_lock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		if ( !TryAcquireSRWLockShared( &lock->lock ) )
+		{
+			start = os_lock_stats_now();
+			AcquireSRWLockShared( &lock->lock );
+		}
+		/* readers share the lock, so only waiting is timed */
+		os_lock_stats_acquired( lock->stats, start,
+			start != 0u ? os_lock_stats_now() : 0u );
+#else /* if OSAL_LOCK_STATS */
 		AcquireSRWLockShared( lock );
+#endif /* else if OSAL_LOCK_STATS */
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4600,7 +6003,7 @@ os_status_t os_thread_rwlock_read_unlock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
-		ReleaseSRWLockShared( lock );
+		ReleaseSRWLockShared( OS_THREAD_LOCK_NATIVE( lock ) );
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4612,7 +6015,18 @@ os_status_t os_thread_rwlock_write_lock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
+#if OSAL_LOCK_STATS
+		os_uint64_t start = 0u;
+		if ( !TryAcquireSRWLockExclusive( &lock->lock ) )
+		{
+			start = os_lock_stats_now();
+			AcquireSRWLockExclusive( &lock->lock );
+		}
+		lock->acquired = os_lock_stats_now();
+		os_lock_stats_acquired( lock->stats, start, lock->acquired );
+#else /* if OSAL_LOCK_STATS */
 		AcquireSRWLockExclusive( lock );
+#endif /* else if OSAL_LOCK_STATS */
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4624,7 +6038,12 @@ os_status_t os_thread_rwlock_write_unlock(
 	os_status_t result = OS_STATUS_BAD_PARAMETER;
 	if ( lock )
 	{
-		ReleaseSRWLockExclusive( lock );
+#if OSAL_LOCK_STATS
+		/* measured before another thread can acquire the lock */
+		os_lock_stats_released( lock->stats,
+			os_lock_stats_now() - lock->acquired );
+#endif /* if OSAL_LOCK_STATS */
+		ReleaseSRWLockExclusive( OS_THREAD_LOCK_NATIVE( lock ) );
 		result = OS_STATUS_SUCCESS;
 	}
 	return result;
@@ -4633,6 +6052,116 @@ os_status_t os_thread_rwlock_write_unlock(
 os_status_t os_thread_rwlock_destroy(
 	os_thread_rwlock_t *lock )
 {
+#if OSAL_LOCK_STATS
+	if ( lock )
+	{
+		os_lock_stats_unregister( lock->stats );
+		lock->stats = NULL;
+	}
+#endif /* if OSAL_LOCK_STATS */
+	return OS_STATUS_SUCCESS;
+}
+
+os_status_t os_thread_affinity_apply(
+	HANDLE thread,
+	os_uint64_t affinity )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	DWORD_PTR mask = (DWORD_PTR)affinity;
+	DWORD_PTR system_mask;
+
+	/* no CPUs specified, allow all CPUs of the process */
+	if ( affinity == 0u && !GetProcessAffinityMask( GetCurrentProcess(),
+		&mask, &system_mask ) )
+		mask = 0u;
+	if ( mask != 0u && SetThreadAffinityMask( thread, mask ) != 0u )
+		result = OS_STATUS_SUCCESS;
+	return result;
+}
+
+os_status_t os_thread_name_apply(
+	HANDLE thread,
+	const char *name )
+{
+	typedef HRESULT (WINAPI *set_thread_description_t)( HANDLE, PCWSTR );
+	os_status_t result = OS_STATUS_NOT_SUPPORTED;
+	const HMODULE kernel = GetModuleHandleA( "kernel32.dll" );
+	set_thread_description_t set_thread_description = NULL;
+
+	/* only available from Windows 10, version 1607 */
+	if ( kernel )
+		set_thread_description = (set_thread_description_t)
+			GetProcAddress( kernel, "SetThreadDescription" );
+	if ( set_thread_description )
+	{
+		char thread_name[OS_THREAD_NAME_MAX];
+		wchar_t thread_name_w[OS_THREAD_NAME_MAX];
+
+		strncpy( thread_name, name, OS_THREAD_NAME_MAX - 1u );
+		thread_name[OS_THREAD_NAME_MAX - 1u] = '\0';
+		result = OS_STATUS_FAILURE;
+		if ( MultiByteToWideChar( CP_UTF8, 0, thread_name, -1,
+			thread_name_w, OS_THREAD_NAME_MAX ) > 0 &&
+			SUCCEEDED( set_thread_description( thread,
+				thread_name_w ) ) )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+int os_thread_priority_native(
+	os_thread_policy_t policy,
+	int priority )
+{
+	int result = THREAD_PRIORITY_ERROR_RETURN;
+	if ( policy == OS_THREAD_POLICY_DEFAULT )
+		result = THREAD_PRIORITY_NORMAL;
+	else if ( policy == OS_THREAD_POLICY_FIFO ||
+		policy == OS_THREAD_POLICY_ROUND_ROBIN )
+	{
+		result = THREAD_PRIORITY_TIME_CRITICAL;
+		if ( priority <= 33 )
+			result = THREAD_PRIORITY_ABOVE_NORMAL;
+		else if ( priority <= 66 )
+			result = THREAD_PRIORITY_HIGHEST;
+	}
+	return result;
+}
+
+os_status_t os_thread_self_affinity_set(
+	os_uint64_t affinity )
+{
+	return os_thread_affinity_apply( GetCurrentThread(), affinity );
+}
+
+os_status_t os_thread_self_name_set(
+	const char *name )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	if ( name )
+		result = os_thread_name_apply( GetCurrentThread(), name );
+	return result;
+}
+
+os_status_t os_thread_self_scheduling_set(
+	os_thread_policy_t policy,
+	int priority )
+{
+	os_status_t result = OS_STATUS_BAD_PARAMETER;
+	const int native_priority = os_thread_priority_native( policy,
+		priority );
+	if ( native_priority != THREAD_PRIORITY_ERROR_RETURN )
+	{
+		result = OS_STATUS_FAILURE;
+		if ( SetThreadPriority( GetCurrentThread(), native_priority ) )
+			result = OS_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+os_status_t os_thread_yield( void )
+{
+	SwitchToThread();
 	return OS_STATUS_SUCCESS;
 }
 
@@ -75,5 +75,78 @@ typedef struct os_dir
 	const char *path;
 } os_dir_t;
 
+#if OSAL_THREAD_SUPPORT
+#if OSAL_LOCK_STATS
+/**
+ * @brief Records the acquisition of a lock
+ *
+ * @param[in,out]  stats               statistics of the lock (optional)
+ * @param[in]      start               time waiting started, 0 if the lock
+ *                                     was acquired without waiting
+ * @param[in]      acquired            time the lock was acquired
+ */
+void os_lock_stats_acquired(
+	os_lock_stats_t *stats,
+	os_uint64_t start,
+	os_uint64_t acquired
+);
+
+/**
+ * @brief Returns a monotonic time, used to measure lock statistics
+ *
+ * @return the time in nanoseconds
+ */
+os_uint64_t os_lock_stats_now( void );
+
+/**
+ * @brief Acquires the lock protecting the list of all lock statistics
+ */
+void os_lock_stats_list_lock( void );
+
+/**
+ * @brief Releases the lock protecting the list of all lock statistics
+ */
+void os_lock_stats_list_unlock( void );
+
+/**
+ * @brief Returns the statistics for a newly created lock
+ *
+ * @param[in]      kind                kind of lock ("mutex" or "rwlock")
+ * @param[in]      name                name of the lock (optional)
+ * @param[in]      lock                address of the lock
+ *
+ * @return the statistics, NULL if they could not be allocated
+ */
+os_lock_stats_t *os_lock_stats_register(
+	const char *kind,
+	const char *name,
+	const void *lock
+);
+
+/**
+ * @brief Records the release of a lock
+ *
+ * @param[in,out]  stats               statistics of the lock (optional)
+ * @param[in]      hold                time the lock was held
+ */
+void os_lock_stats_released(
+	os_lock_stats_t *stats,
+	os_uint64_t hold
+);
+
+/**
+ * @brief Releases the statistics of a destroyed lock
+ *
+ * Statistics of named locks are kept, to be reported and reused by the next
+ * lock created with the same name.
+ *
+ * @param[in,out]  stats               statistics of the lock (optional)
+ */
+void os_lock_stats_unregister(
+	os_lock_stats_t *stats
+);
+#endif /* if OSAL_LOCK_STATS */
+#endif /* if OSAL_THREAD_SUPPORT */
+
 #endif /* ifndef OS_WIN_PRIVATE_H */
 
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief source file containing integration tests for atomic operations
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Number of threads to use for contention tests */
+#define TEST_THREAD_COUNT 4u
+/** @brief Number of iterations each thread performs */
+#define TEST_ITERATIONS 100000u
+
+/** @brief Shared counter incremented by the worker threads */
+static os_atomic_uint32_t TEST_COUNTER_32;
+/** @brief Shared counter incremented by the worker threads */
+static os_atomic_uint64_t TEST_COUNTER_64;
+
+#if OSAL_THREAD_SUPPORT
+/* worker incrementing the shared counters */
+static OS_THREAD_DECL test_atomic_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITERATIONS; ++i )
+	{
+		os_atomic_fetch_add_u32( &TEST_COUNTER_32, 1u, OS_ATOMIC_RELAXED );
+		os_atomic_fetch_add_u64( &TEST_COUNTER_64, 1u, OS_ATOMIC_RELAXED );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+#endif /* if OSAL_THREAD_SUPPORT */
+
+/* test os_atomic_cas_* */
+static void test_os_atomic_cas( void **state )
+{
+	os_atomic_uint32_t v32 = 5u;
+	os_atomic_uint64_t v64 = 0x100000000ull;
+	os_atomic_ptr_t ptr = NULL;
+	os_uint32_t e32 = 4u;
+	os_uint64_t e64 = 0x100000000ull;
+	void *eptr = NULL;
+
+	assert_false( os_atomic_cas_u32( &v32, &e32, 7u, OS_ATOMIC_SEQ_CST ) );
+	assert_int_equal( e32, 5u );
+	assert_true( os_atomic_cas_u32( &v32, &e32, 7u, OS_ATOMIC_ACQ_REL ) );
+	assert_int_equal( os_atomic_load_u32( &v32, OS_ATOMIC_ACQUIRE ), 7u );
+
+	assert_true( os_atomic_cas_u64( &v64, &e64, 0x200000000ull,
+		OS_ATOMIC_RELEASE ) );
+	assert_false( os_atomic_cas_u64( &v64, &e64, 1u, OS_ATOMIC_RELAXED ) );
+	assert_true( e64 == 0x200000000ull );
+
+	assert_true( os_atomic_cas_ptr( &ptr, &eptr, &v32, OS_ATOMIC_SEQ_CST ) );
+	assert_false( os_atomic_cas_ptr( &ptr, &eptr, NULL, OS_ATOMIC_SEQ_CST ) );
+	assert_ptr_equal( eptr, &v32 );
+}
+
+/* test os_atomic_fetch_add_* */
+static void test_os_atomic_fetch_add( void **state )
+{
+	TEST_COUNTER_32 = 0u;
+	TEST_COUNTER_64 = 0u;
+#if OSAL_THREAD_SUPPORT
+	{
+		unsigned int i;
+		os_thread_t threads[TEST_THREAD_COUNT];
+		for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+			assert_int_equal( os_thread_create( &threads[i],
+				test_atomic_worker, NULL, 0u ),
+				OS_STATUS_SUCCESS );
+		for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+			os_thread_wait( &threads[i] );
+		assert_int_equal(
+			os_atomic_load_u32( &TEST_COUNTER_32, OS_ATOMIC_SEQ_CST ),
+			TEST_THREAD_COUNT * TEST_ITERATIONS );
+		assert_true(
+			os_atomic_load_u64( &TEST_COUNTER_64, OS_ATOMIC_SEQ_CST ) ==
+			TEST_THREAD_COUNT * TEST_ITERATIONS );
+	}
+#endif /* if OSAL_THREAD_SUPPORT */
+
+	/* wrap around */
+	os_atomic_store_u32( &TEST_COUNTER_32, 0xFFFFFFFFu, OS_ATOMIC_RELAXED );
+	assert_int_equal( os_atomic_fetch_add_u32( &TEST_COUNTER_32, 2u,
+		OS_ATOMIC_SEQ_CST ), 0xFFFFFFFFu );
+	assert_int_equal( os_atomic_load_u32( &TEST_COUNTER_32,
+		OS_ATOMIC_RELAXED ), 1u );
+}
+
+/* test os_atomic_load_*, os_atomic_store_* and os_atomic_exchange_* */
+static void test_os_atomic_load_store( void **state )
+{
+	os_atomic_uint32_t v32 = 0u;
+	os_atomic_uint64_t v64 = 0u;
+	os_atomic_ptr_t ptr = NULL;
+
+	os_atomic_store_u32( &v32, 0xDEADBEEFu, OS_ATOMIC_RELEASE );
+	assert_int_equal( os_atomic_load_u32( &v32, OS_ATOMIC_ACQUIRE ),
+		0xDEADBEEFu );
+	assert_int_equal( os_atomic_exchange_u32( &v32, 1u,
+		OS_ATOMIC_ACQ_REL ), 0xDEADBEEFu );
+
+	os_atomic_store_u64( &v64, 0x123456789ABCDEFull, OS_ATOMIC_SEQ_CST );
+	assert_true( os_atomic_load_u64( &v64, OS_ATOMIC_SEQ_CST ) ==
+		0x123456789ABCDEFull );
+	assert_true( os_atomic_exchange_u64( &v64, 2u, OS_ATOMIC_SEQ_CST ) ==
+		0x123456789ABCDEFull );
+
+	os_atomic_store_ptr( &ptr, &v64, OS_ATOMIC_RELEASE );
+	assert_ptr_equal( os_atomic_load_ptr( &ptr, OS_ATOMIC_ACQUIRE ), &v64 );
+	assert_ptr_equal( os_atomic_exchange_ptr( &ptr, NULL,
+		OS_ATOMIC_SEQ_CST ), &v64 );
+	os_atomic_thread_fence( OS_ATOMIC_SEQ_CST );
+	assert_null( os_atomic_load_ptr( &ptr, OS_ATOMIC_RELAXED ) );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_atomic_cas ),
+		cmocka_unit_test( test_os_atomic_fetch_add ),
+		cmocka_unit_test( test_os_atomic_load_store ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
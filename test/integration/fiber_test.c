@@ -0,0 +1,478 @@
+/**
+ * @file
+ * @brief source file containing integration tests for fibers
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Address the echo server listens on */
+#define TEST_ADDRESS "127.0.0.1"
+
+/** @brief Number of client sessions connecting to the echo server */
+#define TEST_CLIENTS 200u
+
+/** @brief Number of fibers created when testing with many fibers */
+#define TEST_MANY_FIBERS 10000u
+
+/** @brief Port the echo server listens on */
+#define TEST_PORT 47211u
+
+/** @brief Stack size of fibers created by the tests */
+#define TEST_STACK_SIZE 16384u
+
+/** @brief Number of times each fiber yields when testing yielding */
+#define TEST_YIELDS 3u
+
+/** @brief Bytes written while another fiber reads the same connection,
+ *         more than its buffers hold */
+#define TEST_DUPLEX_SIZE 0x800000u
+
+/** @brief Time out of each read and write on a shared connection */
+#define TEST_DUPLEX_TIME_OUT 2000u
+
+/** @brief State shared by the fibers of a test */
+struct test_fiber_data
+{
+	/** @brief Number of fibers that completed */
+	unsigned int count;
+	/** @brief Order fibers recorded themselves in */
+	unsigned int order[16u];
+	/** @brief Number of entries in the order array */
+	unsigned int order_count;
+	/** @brief Number of sessions echoed correctly */
+	unsigned int echoed;
+	/** @brief Scheduler running the fibers */
+	os_fiber_scheduler_t *scheduler;
+	/** @brief Socket the server listens on */
+	os_socket_t *server;
+	/** @brief Number of times the background fiber ran */
+	unsigned int ticks;
+	/** @brief Whether the background fiber should stop */
+	os_bool_t stop;
+	/** @brief Result of the last socket operation tested */
+	os_status_t status;
+	/** @brief Connection read from and written to by two fibers at once */
+	os_socket_t *duplex;
+	/** @brief Result of the write made alongside a read */
+	os_status_t write_status;
+};
+
+/** @brief Argument for a fiber recording its order */
+struct test_fiber_arg
+{
+	/** @brief Shared test state */
+	struct test_fiber_data *data;
+	/** @brief Identifier of the fiber */
+	unsigned int id;
+	/** @brief Time to sleep for, in milliseconds */
+	os_millisecond_t sleep;
+};
+
+/** @brief Shared state of the current test */
+static struct test_fiber_data TEST_DATA;
+
+/** @brief Data written to and read from a shared connection (larger than
+ *         the stack of a fiber) */
+static char TEST_DUPLEX_BUF[65536u];
+
+/* fiber counting and yielding */
+static void test_fiber_count( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	unsigned int i;
+	for ( i = 0u; i < TEST_YIELDS; ++i )
+		os_fiber_yield();
+	++data->count;
+}
+
+/* fiber recording its order after sleeping */
+static void test_fiber_sleep( void *arg )
+{
+	struct test_fiber_arg *const a = (struct test_fiber_arg *)arg;
+	os_fiber_sleep( a->sleep );
+	a->data->order[a->data->order_count++] = a->id;
+}
+
+/* fiber recording its order before and after yielding */
+static void test_fiber_yield( void *arg )
+{
+	struct test_fiber_arg *const a = (struct test_fiber_arg *)arg;
+	a->data->order[a->data->order_count++] = a->id;
+	os_fiber_yield();
+	a->data->order[a->data->order_count++] = a->id;
+}
+
+/* fiber counting scheduler passes until told to stop */
+static void test_fiber_background( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	while ( !data->stop )
+	{
+		++data->ticks;
+		os_fiber_sleep( 1u );
+	}
+}
+
+/* echoes a message back on a connection accepted by the server */
+static void test_fiber_echo_session( void *arg )
+{
+	os_socket_t *const s = (os_socket_t *)arg;
+	char buf[32u];
+	size_t len = 0u;
+	if ( os_socket_read( s, buf, sizeof( buf ), &len, 0u ) ==
+		OS_STATUS_SUCCESS )
+		os_socket_write( s, buf, len, NULL, 0u );
+	os_socket_close( s );
+}
+
+/* accepts connections, starting a session fiber for each */
+static void test_fiber_echo_server( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	unsigned int i;
+	for ( i = 0u; i < TEST_CLIENTS; ++i )
+	{
+		os_socket_t *s = NULL;
+		if ( os_socket_accept( data->server, &s, 0u ) ==
+			OS_STATUS_SUCCESS )
+			os_fiber_create( data->scheduler,
+				test_fiber_echo_session, s );
+	}
+}
+
+/* connects to the server, and checks the message is echoed */
+static void test_fiber_echo_client( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	os_socket_t *s = NULL;
+	if ( os_socket_open( &s, TEST_ADDRESS, TEST_PORT, SOCK_STREAM, 0,
+		0u ) == OS_STATUS_SUCCESS )
+	{
+		char buf[32u];
+		size_t len = 0u;
+		if ( os_socket_connect( s ) == OS_STATUS_SUCCESS &&
+			os_socket_write( s, "hello", 5u, NULL, 0u ) ==
+				OS_STATUS_SUCCESS &&
+			os_socket_read( s, buf, sizeof( buf ), &len, 0u ) ==
+				OS_STATUS_SUCCESS &&
+			len == 5u && os_memcmp( buf, "hello", 5u ) == 0 )
+			++data->echoed;
+		os_socket_close( s );
+	}
+}
+
+/* connects to the server, and reads without the server writing */
+static void test_fiber_time_out_client( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	os_socket_t *s = NULL;
+	os_socket_t *peer = NULL;
+	if ( os_socket_open( &s, TEST_ADDRESS, TEST_PORT, SOCK_STREAM, 0,
+		0u ) == OS_STATUS_SUCCESS )
+	{
+		char buf[32u];
+		size_t len = 0u;
+		if ( os_socket_connect( s ) == OS_STATUS_SUCCESS &&
+			os_socket_accept( data->server, &peer, 0u ) ==
+				OS_STATUS_SUCCESS )
+		{
+			data->status = os_socket_read( s, buf, sizeof( buf ),
+				&len, 100u );
+			os_socket_close( peer );
+		}
+		os_socket_close( s );
+	}
+	data->stop = OS_TRUE;
+}
+
+/* reads from the shared connection, while another fiber writes to it */
+static void test_fiber_duplex_reader( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	char buf[32u];
+	size_t len = 0u;
+	data->status = os_socket_read( data->duplex, buf, sizeof( buf ), &len,
+		TEST_DUPLEX_TIME_OUT );
+	++data->count;
+}
+
+/* writes to the shared connection, while another fiber reads from it */
+static void test_fiber_duplex_writer( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	size_t total = 0u;
+	data->write_status = OS_STATUS_SUCCESS;
+	while ( data->write_status == OS_STATUS_SUCCESS &&
+		total < TEST_DUPLEX_SIZE )
+	{
+		size_t len = 0u;
+		data->write_status = os_socket_write( data->duplex,
+			TEST_DUPLEX_BUF, sizeof( TEST_DUPLEX_BUF ), &len,
+			TEST_DUPLEX_TIME_OUT );
+		total += len;
+	}
+	++data->count;
+}
+
+/* connects to the server, then wakes up a fiber reading from the
+ * connection and another writing to it, both waiting at once */
+static void test_fiber_duplex_client( void *arg )
+{
+	struct test_fiber_data *const data = (struct test_fiber_data *)arg;
+	os_socket_t *s = NULL;
+	os_socket_t *peer = NULL;
+	if ( os_socket_open( &s, TEST_ADDRESS, TEST_PORT, SOCK_STREAM, 0,
+		0u ) == OS_STATUS_SUCCESS )
+	{
+		if ( os_socket_connect( s ) == OS_STATUS_SUCCESS &&
+			os_socket_accept( data->server, &peer, 0u ) ==
+				OS_STATUS_SUCCESS )
+		{
+			size_t len = 0u;
+			data->duplex = s;
+			os_fiber_create( data->scheduler,
+				test_fiber_duplex_reader, data );
+			os_fiber_create( data->scheduler,
+				test_fiber_duplex_writer, data );
+			os_fiber_sleep( 50u );
+			os_socket_write( peer, "x", 1u, NULL, 0u );
+			while ( data->count < 2u &&
+				os_socket_read( peer, TEST_DUPLEX_BUF,
+					sizeof( TEST_DUPLEX_BUF ), &len,
+					TEST_DUPLEX_TIME_OUT ) ==
+					OS_STATUS_SUCCESS && len > 0u ) {}
+			while ( data->count < 2u )
+				os_fiber_sleep( 1u );
+			os_socket_close( peer );
+		}
+		os_socket_close( s );
+	}
+}
+
+/* opens the socket the server listens on */
+static os_socket_t *test_server_open( void )
+{
+	os_socket_t *s = NULL;
+	const int reuse = 1;
+	assert_int_equal( os_socket_open( &s, TEST_ADDRESS, TEST_PORT,
+		SOCK_STREAM, 0, 0u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_socket_option( s, SOL_SOCKET, SO_REUSEADDR,
+		&reuse, sizeof( reuse ) ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_socket_bind( s, (int)TEST_CLIENTS ),
+		OS_STATUS_SUCCESS );
+	return s;
+}
+
+static void test_os_fiber_many( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+	unsigned int pass;
+	unsigned int i;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	assert_int_equal( os_fiber_scheduler_create( &scheduler,
+		TEST_STACK_SIZE ), OS_STATUS_SUCCESS );
+
+	/* second pass reuses the stacks of the first */
+	for ( pass = 1u; pass <= 2u; ++pass )
+	{
+		for ( i = 0u; i < TEST_MANY_FIBERS; ++i )
+			assert_int_equal( os_fiber_create( scheduler,
+				test_fiber_count, &TEST_DATA ),
+				OS_STATUS_SUCCESS );
+		assert_int_equal( os_fiber_scheduler_run( scheduler ),
+			OS_STATUS_SUCCESS );
+		assert_int_equal( TEST_DATA.count, pass * TEST_MANY_FIBERS );
+	}
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_fiber_self( void **state )
+{
+	assert_null( os_fiber_self() );
+	assert_int_equal( os_fiber_yield(), OS_STATUS_BAD_REQUEST );
+	assert_int_equal( os_fiber_sleep( 1u ), OS_STATUS_BAD_REQUEST );
+	assert_int_equal( os_fiber_create( NULL, test_fiber_count,
+		&TEST_DATA ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_fiber_scheduler_create( NULL, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_fiber_scheduler_run( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+}
+
+static void test_os_fiber_sleep( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+	struct test_fiber_arg args[3u];
+	os_timestamp_t start;
+	os_timestamp_t end;
+	unsigned int i;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	assert_int_equal( os_fiber_scheduler_create( &scheduler, 0u ),
+		OS_STATUS_SUCCESS );
+	for ( i = 0u; i < 3u; ++i )
+	{
+		args[i].data = &TEST_DATA;
+		args[i].id = i;
+		assert_int_equal( os_fiber_create( scheduler,
+			test_fiber_sleep, &args[i] ), OS_STATUS_SUCCESS );
+	}
+	args[0].sleep = 60u;
+	args[1].sleep = 20u;
+	args[2].sleep = 40u;
+
+	os_time_monotonic( &start );
+	assert_int_equal( os_fiber_scheduler_run( scheduler ),
+		OS_STATUS_SUCCESS );
+	os_time_monotonic( &end );
+
+	/* fibers sleep at the same time, and wake up in order */
+	assert_int_equal( TEST_DATA.order_count, 3u );
+	assert_int_equal( TEST_DATA.order[0], 1u );
+	assert_int_equal( TEST_DATA.order[1], 2u );
+	assert_int_equal( TEST_DATA.order[2], 0u );
+	assert_true( end - start >= 60u );
+	assert_true( end - start < 1000u );
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_fiber_socket( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+	unsigned int i;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	TEST_DATA.server = test_server_open();
+	assert_int_equal( os_fiber_scheduler_create( &scheduler,
+		TEST_STACK_SIZE ), OS_STATUS_SUCCESS );
+	TEST_DATA.scheduler = scheduler;
+
+	/* server and all clients share the calling thread */
+	assert_int_equal( os_fiber_create( scheduler,
+		test_fiber_echo_server, &TEST_DATA ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_CLIENTS; ++i )
+		assert_int_equal( os_fiber_create( scheduler,
+			test_fiber_echo_client, &TEST_DATA ),
+			OS_STATUS_SUCCESS );
+	assert_int_equal( os_fiber_scheduler_run( scheduler ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_DATA.echoed, TEST_CLIENTS );
+
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+	os_socket_close( TEST_DATA.server );
+}
+
+static void test_os_fiber_socket_duplex( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	TEST_DATA.server = test_server_open();
+	TEST_DATA.status = OS_STATUS_FAILURE;
+	TEST_DATA.write_status = OS_STATUS_FAILURE;
+	assert_int_equal( os_fiber_scheduler_create( &scheduler,
+		TEST_STACK_SIZE ), OS_STATUS_SUCCESS );
+	TEST_DATA.scheduler = scheduler;
+	assert_int_equal( os_fiber_create( scheduler,
+		test_fiber_duplex_client, &TEST_DATA ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_fiber_scheduler_run( scheduler ),
+		OS_STATUS_SUCCESS );
+
+	/* waiting to write did not take the wake up of the read */
+	assert_int_equal( TEST_DATA.count, 2u );
+	assert_int_equal( TEST_DATA.status, OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_DATA.write_status, OS_STATUS_SUCCESS );
+
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+	os_socket_close( TEST_DATA.server );
+}
+
+static void test_os_fiber_socket_time_out( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	TEST_DATA.server = test_server_open();
+	TEST_DATA.status = OS_STATUS_FAILURE;
+	assert_int_equal( os_fiber_scheduler_create( &scheduler,
+		TEST_STACK_SIZE ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_fiber_create( scheduler,
+		test_fiber_time_out_client, &TEST_DATA ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_fiber_create( scheduler,
+		test_fiber_background, &TEST_DATA ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_fiber_scheduler_run( scheduler ),
+		OS_STATUS_SUCCESS );
+
+	/* other fibers kept running while the read waited */
+	assert_int_equal( TEST_DATA.status, OS_STATUS_TIMED_OUT );
+	assert_true( TEST_DATA.ticks > 10u );
+
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+	os_socket_close( TEST_DATA.server );
+}
+
+static void test_os_fiber_yield( void **state )
+{
+	os_fiber_scheduler_t *scheduler = NULL;
+	struct test_fiber_arg args[3u];
+	const unsigned int expected[] = { 0u, 1u, 2u, 0u, 1u, 2u };
+	unsigned int i;
+
+	os_memzero( &TEST_DATA, sizeof( TEST_DATA ) );
+	assert_int_equal( os_fiber_scheduler_create( &scheduler, 0u ),
+		OS_STATUS_SUCCESS );
+	for ( i = 0u; i < 3u; ++i )
+	{
+		args[i].data = &TEST_DATA;
+		args[i].id = i;
+		args[i].sleep = 0u;
+		assert_int_equal( os_fiber_create( scheduler,
+			test_fiber_yield, &args[i] ), OS_STATUS_SUCCESS );
+	}
+	assert_int_equal( os_fiber_scheduler_run( scheduler ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_DATA.order_count, 6u );
+	for ( i = 0u; i < 6u; ++i )
+		assert_int_equal( TEST_DATA.order[i], expected[i] );
+	assert_int_equal( os_fiber_scheduler_destroy( scheduler ),
+		OS_STATUS_SUCCESS );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_fiber_many ),
+		cmocka_unit_test( test_os_fiber_self ),
+		cmocka_unit_test( test_os_fiber_sleep ),
+		cmocka_unit_test( test_os_fiber_socket ),
+		cmocka_unit_test( test_os_fiber_socket_duplex ),
+		cmocka_unit_test( test_os_fiber_socket_time_out ),
+		cmocka_unit_test( test_os_fiber_yield ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
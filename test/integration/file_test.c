@@ -0,0 +1,783 @@
+/**
+ * @file
+ * @brief source file containing integration tests for file support
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+#if !defined( _WIN32 )
+#include <fcntl.h>    /* for AT_FDCWD */
+#include <sys/stat.h> /* for chmod, lstat, utimensat */
+#include <unistd.h>   /* for readlink, symlink */
+#endif /* if !defined( _WIN32 ) */
+
+/** @brief Size of the files created by the tests (not a multiple of pages) */
+#define TEST_FILE_SIZE 200000u
+
+/** @brief Offset in the files created, not on a page boundary */
+#define TEST_FILE_OFFSET 70001u
+
+/** @brief Offset past 4 GB, beyond the reach of 32-bit offsets */
+#define TEST_FILE_LARGE_OFFSET 0x100000010
+
+/** @brief Size of the parts of a file read or written by each thread */
+#define TEST_FILE_CHUNK 4096u
+
+/** @brief File read or written by several threads at once */
+struct test_file_parallel
+{
+	/** @brief File shared by the threads */
+	os_file_t file;
+	/** @brief Number of parts that failed */
+	os_atomic_uint32_t errors;
+};
+
+/* returns the byte expected at a position of a test file */
+static unsigned char test_file_byte( size_t pos )
+{
+	return (unsigned char)( ( pos * 7u ) % 251u );
+}
+
+/* checks the parts of a test file, reading them from several threads */
+static void test_file_parallel_read( size_t begin, size_t end, void *arg )
+{
+	struct test_file_parallel *const parallel =
+		(struct test_file_parallel *)arg;
+	unsigned char buf[TEST_FILE_CHUNK];
+	size_t i;
+	for ( ; begin < end; ++begin )
+	{
+		const size_t offset = begin * TEST_FILE_CHUNK;
+		size_t size = TEST_FILE_SIZE - offset;
+		size_t bytes_read = 0u;
+		if ( size > TEST_FILE_CHUNK )
+			size = TEST_FILE_CHUNK;
+		if ( os_file_pread( parallel->file, buf, sizeof( buf ),
+			offset, &bytes_read ) != OS_STATUS_SUCCESS ||
+			bytes_read != size )
+			os_atomic_fetch_add_u32( &parallel->errors, 1u,
+				OS_ATOMIC_RELAXED );
+		for ( i = 0u; i < bytes_read; ++i )
+			if ( buf[i] != test_file_byte( offset + i ) )
+			{
+				os_atomic_fetch_add_u32( &parallel->errors, 1u,
+					OS_ATOMIC_RELAXED );
+				break;
+			}
+	}
+}
+
+/* writes the parts of a test file from several threads */
+static void test_file_parallel_write( size_t begin, size_t end, void *arg )
+{
+	struct test_file_parallel *const parallel =
+		(struct test_file_parallel *)arg;
+	unsigned char buf[TEST_FILE_CHUNK];
+	size_t i;
+	for ( ; begin < end; ++begin )
+	{
+		const size_t offset = begin * TEST_FILE_CHUNK;
+		size_t size = TEST_FILE_SIZE - offset;
+		if ( size > TEST_FILE_CHUNK )
+			size = TEST_FILE_CHUNK;
+		for ( i = 0u; i < size; ++i )
+			buf[i] = test_file_byte( offset + i );
+		if ( os_file_pwrite( parallel->file, buf, size, offset ) !=
+			OS_STATUS_SUCCESS )
+			os_atomic_fetch_add_u32( &parallel->errors, 1u,
+				OS_ATOMIC_RELAXED );
+	}
+}
+
+/* writes "size" bytes of a known pattern to a file */
+static void test_file_write( const char *path, size_t size )
+{
+	unsigned char *const data = (unsigned char *)test_malloc( size + 1u );
+	os_file_t file;
+	size_t i;
+
+	assert_non_null( data );
+	for ( i = 0u; i < size; ++i )
+		data[i] = test_file_byte( i );
+	file = os_file_open( path, OS_WRITE | OS_CREATE | OS_TRUNCATE );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	if ( size > 0u )
+		assert_int_equal( os_file_write( data, 1u, size, file ), size );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+	test_free( data );
+}
+
+/* creates a test file holding "size" bytes of a known pattern */
+static void test_file_create( char *path, size_t path_len, size_t size )
+{
+	os_strncpy( path, "osal_file_test_XXXXXX", path_len );
+	assert_int_equal( os_file_temp( path, 0u ), OS_STATUS_SUCCESS );
+	test_file_write( path, size );
+}
+
+/* checks that two files hold the same contents */
+static void test_file_compare( const char *path1, const char *path2 )
+{
+	os_file_map_t map1;
+	os_file_map_t map2;
+	assert_int_equal( os_file_map( path1, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map1 ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_map( path2, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map2 ), OS_STATUS_SUCCESS );
+	assert_int_equal( map1.size, map2.size );
+	if ( map1.size > 0u )
+		assert_memory_equal( map1.address, map2.address, map1.size );
+	os_file_unmap( &map1 );
+	os_file_unmap( &map2 );
+}
+
+#if defined( __linux__ )
+/* checks that a copy holds what reading a generated file (procfs, sysfs)
+ * returns */
+static void test_file_compare_read( const char *path1, const char *path2 )
+{
+	char buf1[4096];
+	char buf2[4096];
+	size_t len1;
+	size_t len2;
+	os_file_t file;
+
+	file = os_file_open( path1, OS_READ );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	len1 = os_file_read( buf1, 1u, sizeof( buf1 ), file );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+	file = os_file_open( path2, OS_READ );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	len2 = os_file_read( buf2, 1u, sizeof( buf2 ), file );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+	assert_true( len1 > 0u );
+	assert_int_equal( len1, len2 );
+	assert_int_equal( os_file_size( path2 ), len2 );
+	assert_memory_equal( buf1, buf2, len1 );
+}
+#endif /* if defined( __linux__ ) */
+
+/** @brief Progress reported by a directory copy */
+struct test_directory_progress
+{
+	/** @brief Number of times progress was reported */
+	os_uint64_t calls;
+	/** @brief Last number of files copied reported */
+	os_uint64_t files_done;
+	/** @brief Last number of files to copy reported */
+	os_uint64_t files_total;
+	/** @brief Last number of bytes copied reported */
+	os_uint64_t bytes_done;
+	/** @brief Last number of bytes to copy reported */
+	os_uint64_t bytes_total;
+	/** @brief Whether the counts reported ever went down */
+	os_bool_t out_of_order;
+};
+
+/* records the progress of a directory copy */
+static void test_directory_copy_progress( const char *path,
+	os_uint64_t files_done, os_uint64_t files_total,
+	os_uint64_t bytes_done, os_uint64_t bytes_total, void *user_data )
+{
+	struct test_directory_progress *const progress =
+		(struct test_directory_progress *)user_data;
+	if ( !path || files_done != progress->files_done + 1u ||
+		bytes_done < progress->bytes_done )
+		progress->out_of_order = OS_TRUE;
+	++progress->calls;
+	progress->files_done = files_done;
+	progress->files_total = files_total;
+	progress->bytes_done = bytes_done;
+	progress->bytes_total = bytes_total;
+}
+
+#if !defined( _WIN32 )
+/* checks that a copied entry kept the permissions and modification time */
+static void test_file_compare_stat( const char *path1, const char *path2 )
+{
+	struct stat s1;
+	struct stat s2;
+	assert_int_equal( lstat( path1, &s1 ), 0 );
+	assert_int_equal( lstat( path2, &s2 ), 0 );
+	assert_int_equal( s1.st_mode, s2.st_mode );
+	assert_true( s1.st_mtime == s2.st_mtime );
+}
+#endif /* if !defined( _WIN32 ) */
+
+static void test_os_directory_copy( void **state )
+{
+	const char *const names[] = { "file1", "sub", "deeper", "file2",
+		"file3" };
+	char src[PATH_MAX];
+	char dst[PATH_MAX];
+	char path[PATH_MAX];
+	char copy_path[PATH_MAX];
+	struct test_directory_progress progress;
+	os_directory_copy_options_t options;
+	unsigned int max_threads;
+#if !defined( _WIN32 )
+	struct timespec times[2];
+	char link[PATH_MAX];
+	ssize_t link_len;
+#endif /* if !defined( _WIN32 ) */
+
+	/* unique names for both directories */
+	test_file_create( src, sizeof( src ), 0u );
+	assert_int_equal( os_file_delete( src ), OS_STATUS_SUCCESS );
+	test_file_create( dst, sizeof( dst ), 0u );
+	assert_int_equal( os_file_delete( dst ), OS_STATUS_SUCCESS );
+
+	/* files at each level of nested directories */
+	assert_int_equal( os_directory_create_nowait( src ),
+		OS_STATUS_SUCCESS );
+	os_make_path( path, sizeof( path ), src, names[0], NULL );
+	test_file_write( path, TEST_FILE_SIZE );
+	os_make_path( path, sizeof( path ), src, names[1], NULL );
+	assert_int_equal( os_directory_create_nowait( path ),
+		OS_STATUS_SUCCESS );
+	os_make_path( path, sizeof( path ), src, names[1], names[2], NULL );
+	assert_int_equal( os_directory_create_nowait( path ),
+		OS_STATUS_SUCCESS );
+	os_make_path( path, sizeof( path ), src, names[1], names[3], NULL );
+	test_file_write( path, 0u );
+	os_make_path( path, sizeof( path ), src, names[1], names[2],
+		names[4], NULL );
+	test_file_write( path, TEST_FILE_OFFSET );
+
+#if !defined( _WIN32 )
+	/* links are copied, and permissions and times are kept */
+	os_make_path( path, sizeof( path ), src, "link", NULL );
+	assert_int_equal( symlink( names[0], path ), 0 );
+	times[0].tv_sec = times[1].tv_sec = 1000000000;
+	times[0].tv_nsec = times[1].tv_nsec = 0;
+	os_make_path( path, sizeof( path ), src, names[0], NULL );
+	assert_int_equal( chmod( path, 0640 ), 0 );
+	assert_int_equal( utimensat( AT_FDCWD, path, times, 0 ), 0 );
+	os_make_path( path, sizeof( path ), src, names[1], NULL );
+	assert_int_equal( chmod( path, 0750 ), 0 );
+	assert_int_equal( utimensat( AT_FDCWD, path, times, 0 ), 0 );
+#endif /* if !defined( _WIN32 ) */
+
+	/* copied once, then again over the copy by a single thread */
+	for ( max_threads = 0u; max_threads < 2u; ++max_threads )
+	{
+		os_memzero( &progress, sizeof( progress ) );
+		os_memzero( &options, sizeof( options ) );
+		options.max_threads = max_threads;
+		options.progress = test_directory_copy_progress;
+		options.user_data = &progress;
+		assert_int_equal( os_directory_copy( src, dst, &options ),
+			OS_STATUS_SUCCESS );
+		assert_false( progress.out_of_order );
+		assert_int_equal( progress.calls, 3u );
+		assert_int_equal( progress.files_total, 3u );
+		assert_int_equal( progress.bytes_total,
+			TEST_FILE_SIZE + TEST_FILE_OFFSET );
+		assert_int_equal( progress.bytes_done, progress.bytes_total );
+
+		os_make_path( path, sizeof( path ), src, names[0], NULL );
+		os_make_path( copy_path, sizeof( copy_path ), dst, names[0],
+			NULL );
+		test_file_compare( path, copy_path );
+		os_make_path( path, sizeof( path ), src, names[1], names[2],
+			names[4], NULL );
+		os_make_path( copy_path, sizeof( copy_path ), dst, names[1],
+			names[2], names[4], NULL );
+		test_file_compare( path, copy_path );
+		os_make_path( copy_path, sizeof( copy_path ), dst, names[1],
+			names[3], NULL );
+		assert_int_equal( os_file_size( copy_path ), 0u );
+#if !defined( _WIN32 )
+		os_make_path( path, sizeof( path ), src, names[0], NULL );
+		os_make_path( copy_path, sizeof( copy_path ), dst, names[0],
+			NULL );
+		test_file_compare_stat( path, copy_path );
+		os_make_path( path, sizeof( path ), src, names[1], NULL );
+		os_make_path( copy_path, sizeof( copy_path ), dst, names[1],
+			NULL );
+		test_file_compare_stat( path, copy_path );
+		test_file_compare_stat( src, dst );
+		os_make_path( copy_path, sizeof( copy_path ), dst, "link",
+			NULL );
+		link_len = readlink( copy_path, link, sizeof( link ) );
+		assert_int_equal( link_len, os_strlen( names[0] ) );
+		assert_memory_equal( link, names[0], (size_t)link_len );
+#endif /* if !defined( _WIN32 ) */
+	}
+
+	/* without options */
+	assert_int_equal( os_directory_copy( src, dst, NULL ),
+		OS_STATUS_SUCCESS );
+
+	/* into the directory copied, which leaves the destination out */
+	os_make_path( path, sizeof( path ), src, names[1], "nested", NULL );
+	assert_int_equal( os_directory_copy( src, path, NULL ),
+		OS_STATUS_SUCCESS );
+	os_make_path( copy_path, sizeof( copy_path ), path, names[1],
+		names[2], names[4], NULL );
+	assert_int_equal( os_file_size( copy_path ), TEST_FILE_OFFSET );
+	os_make_path( copy_path, sizeof( copy_path ), path, names[1],
+		"nested", NULL );
+	assert_false( os_file_exists( copy_path ) );
+#if !defined( _WIN32 )
+	os_make_path( copy_path, sizeof( copy_path ), path, "link", NULL );
+	assert_int_equal( os_file_delete( copy_path ), OS_STATUS_SUCCESS );
+#endif /* if !defined( _WIN32 ) */
+	assert_int_equal( os_directory_delete( path, NULL, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_directory_copy( src, src, NULL ),
+		OS_STATUS_FAILURE );
+
+	assert_int_equal( os_directory_copy( NULL, dst, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_directory_copy( src, NULL, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	os_make_path( path, sizeof( path ), src, names[0], NULL );
+	assert_int_equal( os_directory_copy( path, dst, NULL ),
+		OS_STATUS_FAILURE );
+
+#if !defined( _WIN32 )
+	os_make_path( path, sizeof( path ), src, "link", NULL );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+	os_make_path( path, sizeof( path ), dst, "link", NULL );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+#endif /* if !defined( _WIN32 ) */
+	assert_int_equal( os_directory_delete( src, NULL, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_directory_delete( dst, NULL, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_copy( void **state )
+{
+	char path[PATH_MAX];
+	char copy_path[PATH_MAX];
+	os_file_t file;
+
+	test_file_create( path, sizeof( path ), TEST_FILE_SIZE );
+	test_file_create( copy_path, sizeof( copy_path ), TEST_FILE_SIZE * 2u );
+
+	/* existing file is replaced */
+	assert_int_equal( os_file_copy( path, copy_path ), OS_STATUS_SUCCESS );
+	test_file_compare( path, copy_path );
+	assert_int_equal( os_file_copy_ex( path, copy_path,
+		OS_FILE_COPY_SYNC ), OS_STATUS_SUCCESS );
+	test_file_compare( path, copy_path );
+
+	/* copying a file onto itself keeps it */
+	assert_int_equal( os_file_copy( path, path ), OS_STATUS_FAILURE );
+	assert_int_equal( os_file_size( path ), TEST_FILE_SIZE );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+
+	/* sparse file, with holes at both ends */
+	test_file_create( path, sizeof( path ), 0u );
+	file = os_file_open( path, OS_WRITE );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	assert_int_equal( os_file_seek( file, (long)TEST_FILE_SIZE * 10,
+		OS_FILE_SEEK_START ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_write( "data", 1u, 4u, file ), 4u );
+	assert_int_equal( os_file_seek( file, (long)TEST_FILE_SIZE * 20,
+		OS_FILE_SEEK_START ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_write( "end", 1u, 3u, file ), 3u );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_copy( path, copy_path ), OS_STATUS_SUCCESS );
+	test_file_compare( path, copy_path );
+
+	/* empty file */
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+	test_file_create( path, sizeof( path ), 0u );
+	assert_int_equal( os_file_copy( path, copy_path ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_size( copy_path ), 0u );
+
+#if defined( __linux__ )
+	/* files whose reported size is not that of their contents */
+	assert_int_equal( os_file_copy( "/proc/version", copy_path ),
+		OS_STATUS_SUCCESS );
+	test_file_compare_read( "/proc/version", copy_path );
+	if ( os_file_exists( "/sys/kernel/mm/transparent_hugepage/enabled" ) )
+	{
+		assert_int_equal( os_file_copy(
+			"/sys/kernel/mm/transparent_hugepage/enabled",
+			copy_path ), OS_STATUS_SUCCESS );
+		test_file_compare_read(
+			"/sys/kernel/mm/transparent_hugepage/enabled",
+			copy_path );
+	}
+#endif /* if defined( __linux__ ) */
+
+	assert_int_equal( os_file_copy( NULL, copy_path ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_copy_ex( path, NULL, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_copy( path, copy_path ), OS_STATUS_FAILURE );
+	assert_int_equal( os_file_delete( copy_path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_map( void **state )
+{
+	char path[PATH_MAX];
+	os_file_map_t map;
+	size_t i;
+
+	test_file_create( path, sizeof( path ), TEST_FILE_SIZE );
+
+	/* whole file */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map ), OS_STATUS_SUCCESS );
+	assert_non_null( map.address );
+	assert_int_equal( map.size, TEST_FILE_SIZE );
+	for ( i = 0u; i < TEST_FILE_SIZE; ++i )
+		assert_int_equal( ((unsigned char *)map.address)[i],
+			test_file_byte( i ) );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	assert_null( map.address );
+
+	/* range starting within a page */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_OFFSET, 1000u, &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( map.size, 1000u );
+	for ( i = 0u; i < 1000u; ++i )
+		assert_int_equal( ((unsigned char *)map.address)[i],
+			test_file_byte( TEST_FILE_OFFSET + i ) );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+
+	/* rest of the file, and nothing at the end of it */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_OFFSET, 0u, &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( map.size, TEST_FILE_SIZE - TEST_FILE_OFFSET );
+	assert_int_equal( ((unsigned char *)map.address)[map.size - 1u],
+		test_file_byte( TEST_FILE_SIZE - 1u ) );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_SIZE, 0u, &map ), OS_STATUS_SUCCESS );
+	assert_null( map.address );
+	assert_int_equal( map.size, 0u );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+
+	/* ranges beyond the file */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_SIZE + 1u, 0u, &map ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_OFFSET, TEST_FILE_SIZE, &map ),
+		OS_STATUS_BAD_PARAMETER );
+
+	assert_int_equal( os_file_map( NULL, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map( path, 3, 0u, 0u, &map ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_unmap( NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map ), OS_STATUS_FAILURE );
+
+	/* empty file */
+	test_file_create( path, sizeof( path ), 0u );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map ), OS_STATUS_SUCCESS );
+	assert_null( map.address );
+	assert_int_equal( map.size, 0u );
+	assert_int_equal( os_file_map_sync( &map, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_map_advise( void **state )
+{
+	char path[PATH_MAX];
+	os_file_map_t map;
+	int advice;
+
+	test_file_create( path, sizeof( path ), TEST_FILE_SIZE );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY, 0u, 0u,
+		&map ), OS_STATUS_SUCCESS );
+	for ( advice = OS_FILE_MAP_ADVICE_SEQUENTIAL;
+		advice <= OS_FILE_MAP_ADVICE_DONTNEED; ++advice )
+	{
+		assert_int_equal( os_file_map_advise( &map, 0u, 0u, advice ),
+			OS_STATUS_SUCCESS );
+		assert_int_equal( os_file_map_advise( &map, TEST_FILE_OFFSET,
+			100u, advice ), OS_STATUS_SUCCESS );
+	}
+
+	/* pages released are read again from the file */
+	assert_int_equal( ((unsigned char *)map.address)[TEST_FILE_OFFSET],
+		test_file_byte( TEST_FILE_OFFSET ) );
+
+	assert_int_equal( os_file_map_advise( NULL, 0u, 0u,
+		OS_FILE_MAP_ADVICE_WILLNEED ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map_advise( &map, 0u, 0u, 0 ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map_advise( &map, TEST_FILE_SIZE + 1u, 0u,
+		OS_FILE_MAP_ADVICE_WILLNEED ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_map_advise( &map, TEST_FILE_OFFSET,
+		TEST_FILE_SIZE, OS_FILE_MAP_ADVICE_WILLNEED ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_map_write( void **state )
+{
+	char path[PATH_MAX];
+	os_file_map_t map;
+	os_file_t file;
+	unsigned char byte;
+
+	test_file_create( path, sizeof( path ), TEST_FILE_SIZE );
+
+	/* changes to a private mapping are not written */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_PRIVATE,
+		TEST_FILE_OFFSET, 0u, &map ), OS_STATUS_SUCCESS );
+	((unsigned char *)map.address)[0] = 0xFFu;
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_ONLY,
+		TEST_FILE_OFFSET, 1u, &map ), OS_STATUS_SUCCESS );
+	assert_int_equal( ((unsigned char *)map.address)[0],
+		test_file_byte( TEST_FILE_OFFSET ) );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+
+	/* changes to a read & write mapping are written */
+	assert_int_equal( os_file_map( path, OS_FILE_MAP_READ_WRITE,
+		TEST_FILE_OFFSET, 0u, &map ), OS_STATUS_SUCCESS );
+	((unsigned char *)map.address)[0] = 0xFFu;
+	assert_int_equal( os_file_map_sync( &map, OS_FALSE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_map_sync( &map, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_unmap( &map ), OS_STATUS_SUCCESS );
+	file = os_file_open( path, OS_READ );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	assert_int_equal( os_file_seek( file, (long)TEST_FILE_OFFSET,
+		OS_FILE_SEEK_START ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_read( &byte, 1u, 1u, file ), 1u );
+	assert_int_equal( byte, 0xFFu );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+
+	assert_int_equal( os_file_map_sync( NULL, OS_TRUE ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_pread( void **state )
+{
+	unsigned char buf[3000u];
+	os_file_io_vector_t vector[3];
+	os_file_io_vector_t bytes[3000u];
+	struct test_file_parallel parallel;
+	char path[PATH_MAX];
+	size_t bytes_read;
+	size_t i;
+
+	test_file_create( path, sizeof( path ), TEST_FILE_SIZE );
+	parallel.file = os_file_open( path, OS_READ );
+	parallel.errors = 0u;
+	assert_true( parallel.file != OS_FILE_INVALID && parallel.file != NULL );
+
+	/* the position of the file is not changed (except on Windows) */
+	assert_int_equal( os_file_pread( parallel.file, buf, 1000u,
+		TEST_FILE_OFFSET, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, 1000u );
+	for ( i = 0u; i < bytes_read; ++i )
+		assert_int_equal( buf[i], test_file_byte( TEST_FILE_OFFSET + i ) );
+#if !defined( _WIN32 )
+	assert_int_equal( os_file_tell( parallel.file ), 0 );
+#endif /* if !defined( _WIN32 ) */
+
+	/* reads stop at the end of the file */
+	assert_int_equal( os_file_pread( parallel.file, buf, sizeof( buf ),
+		TEST_FILE_SIZE - 10u, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, 10u );
+	assert_int_equal( os_file_pread( parallel.file, buf, sizeof( buf ),
+		(os_uint64_t)TEST_FILE_SIZE * 2u, &bytes_read ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, 0u );
+
+	/* buffers are filled in order, skipping empty ones */
+	vector[0].iov_base = buf;
+	vector[0].iov_len = 10u;
+	vector[1].iov_base = NULL;
+	vector[1].iov_len = 0u;
+	vector[2].iov_base = &buf[10];
+	vector[2].iov_len = sizeof( buf ) - 10u;
+	assert_int_equal( os_file_preadv( parallel.file, vector, 3u,
+		TEST_FILE_OFFSET, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, sizeof( buf ) );
+	for ( i = 0u; i < bytes_read; ++i )
+		assert_int_equal( buf[i], test_file_byte( TEST_FILE_OFFSET + i ) );
+	assert_int_equal( os_file_preadv( parallel.file, vector, 3u,
+		TEST_FILE_SIZE - 20u, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, 20u );
+
+	/* more buffers than the system takes at once */
+	os_memzero( buf, sizeof( buf ) );
+	for ( i = 0u; i < sizeof( buf ); ++i )
+	{
+		bytes[i].iov_base = &buf[i];
+		bytes[i].iov_len = 1u;
+	}
+	assert_int_equal( os_file_preadv( parallel.file, bytes, sizeof( buf ),
+		TEST_FILE_OFFSET, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, sizeof( buf ) );
+	for ( i = 0u; i < bytes_read; ++i )
+		assert_int_equal( buf[i], test_file_byte( TEST_FILE_OFFSET + i ) );
+
+	/* all of the file, from several threads at once (when supported) */
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	assert_int_equal( os_parallel_for( 0u,
+		( TEST_FILE_SIZE + TEST_FILE_CHUNK - 1u ) / TEST_FILE_CHUNK, 1u,
+		test_file_parallel_read, &parallel ), OS_STATUS_SUCCESS );
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	test_file_parallel_read( 0u,
+		( TEST_FILE_SIZE + TEST_FILE_CHUNK - 1u ) / TEST_FILE_CHUNK,
+		&parallel );
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	assert_int_equal( parallel.errors, 0u );
+
+	assert_int_equal( os_file_pread( NULL, buf, sizeof( buf ), 0u, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_pread( parallel.file, NULL, sizeof( buf ),
+		0u, NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_preadv( parallel.file, NULL, 1u, 0u, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_close( parallel.file ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_pwrite( void **state )
+{
+	char data[3][4] = { "one", "", "two" };
+	os_file_io_vector_t vector[3];
+	struct test_file_parallel parallel;
+	char path[PATH_MAX];
+	char expected_path[PATH_MAX];
+	char buf[6];
+	size_t bytes_read;
+	size_t i;
+
+	test_file_create( expected_path, sizeof( expected_path ),
+		TEST_FILE_SIZE );
+	test_file_create( path, sizeof( path ), 0u );
+	parallel.file = os_file_open( path, OS_READ | OS_WRITE );
+	parallel.errors = 0u;
+	assert_true( parallel.file != OS_FILE_INVALID && parallel.file != NULL );
+
+	/* all of the file, from several threads at once (when supported) */
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	assert_int_equal( os_parallel_for( 0u,
+		( TEST_FILE_SIZE + TEST_FILE_CHUNK - 1u ) / TEST_FILE_CHUNK, 1u,
+		test_file_parallel_write, &parallel ), OS_STATUS_SUCCESS );
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	test_file_parallel_write( 0u,
+		( TEST_FILE_SIZE + TEST_FILE_CHUNK - 1u ) / TEST_FILE_CHUNK,
+		&parallel );
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	assert_int_equal( parallel.errors, 0u );
+#if !defined( _WIN32 )
+	assert_int_equal( os_file_tell( parallel.file ), 0 );
+#endif /* if !defined( _WIN32 ) */
+	test_file_compare( path, expected_path );
+
+	/* buffers are written in order, extending the file */
+	for ( i = 0u; i < 3u; ++i )
+	{
+		vector[i].iov_base = data[i];
+		vector[i].iov_len = os_strlen( data[i] );
+	}
+	assert_int_equal( os_file_pwritev( parallel.file, vector, 3u,
+		TEST_FILE_SIZE + 10u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_size( path ), TEST_FILE_SIZE + 16u );
+	assert_int_equal( os_file_pread( parallel.file, buf, sizeof( buf ),
+		TEST_FILE_SIZE + 10u, &bytes_read ), OS_STATUS_SUCCESS );
+	assert_int_equal( bytes_read, sizeof( buf ) );
+	assert_memory_equal( buf, "onetwo", sizeof( buf ) );
+
+	assert_int_equal( os_file_pwrite( NULL, buf, sizeof( buf ), 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_pwrite( parallel.file, NULL, sizeof( buf ),
+		0u ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_pwritev( parallel.file, NULL, 1u, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_file_close( parallel.file ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( expected_path ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_file_seek64( void **state )
+{
+	char path[PATH_MAX];
+	char buf[3];
+	os_file_t file;
+
+	/* sparse file, larger than 4 GB */
+	test_file_create( path, sizeof( path ), 0u );
+	file = os_file_open( path, OS_READ | OS_WRITE );
+	assert_true( file != OS_FILE_INVALID && file != NULL );
+	assert_int_equal( os_file_seek64( file, TEST_FILE_LARGE_OFFSET,
+		OS_FILE_SEEK_START ), OS_STATUS_SUCCESS );
+	assert_true( os_file_tell64( file ) == TEST_FILE_LARGE_OFFSET );
+	assert_int_equal( os_file_write( "end", 1u, 3u, file ), 3u );
+	assert_true( os_file_tell64( file ) == TEST_FILE_LARGE_OFFSET + 3 );
+
+	/* moving flushes what was written, so the size includes it */
+	assert_int_equal( os_file_seek64( file, -3, OS_FILE_SEEK_END ),
+		OS_STATUS_SUCCESS );
+	assert_true( os_file_size_handle( file ) ==
+		TEST_FILE_LARGE_OFFSET + 3u );
+	assert_true( os_file_size( path ) == TEST_FILE_LARGE_OFFSET + 3u );
+	assert_true( os_file_tell64( file ) == TEST_FILE_LARGE_OFFSET );
+	assert_int_equal( os_file_read( buf, 1u, 3u, file ), 3u );
+	assert_memory_equal( buf, "end", 3u );
+	assert_int_equal( os_file_seek64( file,
+		-(os_int64_t)TEST_FILE_LARGE_OFFSET, OS_FILE_SEEK_CURRENT ),
+		OS_STATUS_SUCCESS );
+	assert_true( os_file_tell64( file ) == 3 );
+
+	/* before the start of the file */
+	assert_int_equal( os_file_seek64( file, -1, OS_FILE_SEEK_START ),
+		OS_STATUS_FAILURE );
+	assert_true( os_file_tell64( file ) == 3 );
+
+	assert_int_equal( os_file_seek64( OS_FILE_INVALID, 0,
+		OS_FILE_SEEK_START ), OS_STATUS_BAD_PARAMETER );
+	assert_true( os_file_tell64( OS_FILE_INVALID ) == -1 );
+	assert_int_equal( os_file_close( file ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_file_delete( path ), OS_STATUS_SUCCESS );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_directory_copy ),
+		cmocka_unit_test( test_os_file_copy ),
+		cmocka_unit_test( test_os_file_map ),
+		cmocka_unit_test( test_os_file_map_advise ),
+		cmocka_unit_test( test_os_file_map_write ),
+		cmocka_unit_test( test_os_file_pread ),
+		cmocka_unit_test( test_os_file_pwrite ),
+		cmocka_unit_test( test_os_file_seek64 ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,765 @@
+/**
+ * @file
+ * @brief source file containing integration tests for memory allocation
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Number of allocations made by each thread */
+#define TEST_ALLOC_COUNT 10000u
+
+/** @brief Tag used for the memory allocated by the tests */
+#define TEST_MEMORY_TAG ( OS_MEMORY_TAG_APP + 1u )
+
+/** @brief Number of pool objects freed by the main thread */
+#define TEST_POOL_FREES 200u
+
+/** @brief Number of threads allocating at the same time */
+#define TEST_THREAD_COUNT 4u
+
+/** @brief Number of calls made to the counting allocator */
+static os_atomic_uint32_t TEST_CALLS;
+/** @brief Copy of the system allocator, used by the counting allocator */
+static os_allocator_t TEST_SYSTEM;
+/** @brief Number of blocks corrupted while in use by another thread */
+static os_atomic_uint32_t TEST_ERRORS;
+
+/* counts an allocation, passed on to the system allocator */
+static void *test_count_malloc( size_t size, void *user_data )
+{
+	const os_allocator_t *const system = (const os_allocator_t *)user_data;
+	os_atomic_fetch_add_u32( &TEST_CALLS, 1u, OS_ATOMIC_RELAXED );
+	return system->malloc_fn( size, system->user_data );
+}
+
+/* counts an allocation, passed on to the system allocator */
+static void *test_count_calloc( size_t nmemb, size_t size, void *user_data )
+{
+	const os_allocator_t *const system = (const os_allocator_t *)user_data;
+	os_atomic_fetch_add_u32( &TEST_CALLS, 1u, OS_ATOMIC_RELAXED );
+	return system->calloc_fn( nmemb, size, system->user_data );
+}
+
+/* counts a reallocation, passed on to the system allocator */
+static void *test_count_realloc( void *ptr, size_t size, void *user_data )
+{
+	const os_allocator_t *const system = (const os_allocator_t *)user_data;
+	os_atomic_fetch_add_u32( &TEST_CALLS, 1u, OS_ATOMIC_RELAXED );
+	return system->realloc_fn( ptr, size, system->user_data );
+}
+
+/* counts a free, passed on to the system allocator */
+static void test_count_free( void *ptr, void *user_data )
+{
+	const os_allocator_t *const system = (const os_allocator_t *)user_data;
+	os_atomic_fetch_add_u32( &TEST_CALLS, 1u, OS_ATOMIC_RELAXED );
+	system->free_fn( ptr, system->user_data );
+}
+
+/* counts an aligned allocation, passed on to the system allocator */
+static void *test_count_aligned_alloc( size_t alignment, size_t size,
+	void *user_data )
+{
+	const os_allocator_t *const system = (const os_allocator_t *)user_data;
+	os_atomic_fetch_add_u32( &TEST_CALLS, 1u, OS_ATOMIC_RELAXED );
+	return system->aligned_alloc_fn( alignment, size, system->user_data );
+}
+
+/* supports no alignment */
+static void *test_no_aligned_alloc( size_t alignment, size_t size,
+	void *user_data )
+{
+	(void)alignment;
+	(void)size;
+	(void)user_data;
+	return NULL;
+}
+
+/* sets up the counting allocator */
+static void test_count_init( os_allocator_t *counter )
+{
+	counter->malloc_fn = test_count_malloc;
+	counter->calloc_fn = test_count_calloc;
+	counter->realloc_fn = test_count_realloc;
+	counter->free_fn = test_count_free;
+	counter->aligned_alloc_fn = test_count_aligned_alloc;
+	os_memcpy( &TEST_SYSTEM, os_allocator_system(),
+		sizeof( TEST_SYSTEM ) );
+	counter->user_data = &TEST_SYSTEM;
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/* thread allocating, filling, checking and freeing blocks */
+static OS_THREAD_DECL test_cache_worker( void *arg )
+{
+	unsigned char *blocks[16];
+	unsigned int i;
+	const unsigned char fill = (unsigned char)(size_t)arg;
+
+	os_memzero( blocks, sizeof( blocks ) );
+	for ( i = 0u; i < TEST_ALLOC_COUNT; ++i )
+	{
+		const unsigned int slot = i % 16u;
+		const size_t size = 1u + ( i * 7u ) % 700u;
+		if ( blocks[slot] )
+		{
+			if ( blocks[slot][0] != fill )
+				os_atomic_fetch_add_u32( &TEST_ERRORS, 1u,
+					OS_ATOMIC_RELAXED );
+			os_free( blocks[slot] );
+		}
+		blocks[slot] = (unsigned char *)os_malloc( size );
+		if ( blocks[slot] )
+			os_memset( blocks[slot], fill, size );
+		else
+			os_atomic_fetch_add_u32( &TEST_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+	}
+	for ( i = 0u; i < 16u; ++i )
+		os_free( blocks[i] );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread recording the allocator it uses */
+static OS_THREAD_DECL test_allocator_worker( void *arg )
+{
+	*(const os_allocator_t **)arg = os_allocator_get();
+	return (OS_THREAD_RETURN)0;
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+static void test_os_allocator_set( void **state )
+{
+	os_allocator_t counter;
+	void *ptr;
+
+	test_count_init( &counter );
+	counter.aligned_alloc_fn = NULL;
+
+	/* all functions are required */
+	assert_int_equal( os_allocator_set( &counter ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_ptr_equal( os_allocator_get(), os_allocator_system() );
+	counter.aligned_alloc_fn = test_count_aligned_alloc;
+
+	/* memory functions go through the allocator set */
+	TEST_CALLS = 0u;
+	assert_int_equal( os_allocator_set( &counter ), OS_STATUS_SUCCESS );
+	assert_ptr_equal( os_allocator_get(), &counter );
+	ptr = os_malloc( 10u );
+	assert_non_null( ptr );
+	ptr = os_realloc( ptr, 100u );
+	assert_non_null( ptr );
+	os_free( ptr );
+	os_free( NULL );
+	ptr = os_calloc( 4u, 4u );
+	assert_non_null( ptr );
+	os_free_null( &ptr );
+	assert_null( ptr );
+	assert_int_equal( TEST_CALLS, 5u );
+
+	/* NULL restores the system allocator */
+	assert_int_equal( os_allocator_set( NULL ), OS_STATUS_SUCCESS );
+	assert_ptr_equal( os_allocator_get(), os_allocator_system() );
+	os_free( os_malloc( 10u ) );
+	assert_int_equal( TEST_CALLS, 5u );
+}
+
+static void test_os_allocator_thread_cache( void **state )
+{
+	const os_allocator_t *const cache = os_allocator_thread_cache();
+	const size_t alignments[] = { 1u, 16u, 64u, 4096u };
+	unsigned char *ptr;
+	void *first;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	os_thread_t threads[TEST_THREAD_COUNT];
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	size_t i;
+
+	/* a freed block is reused by the next allocation of its size */
+	first = cache->malloc_fn( 24u, cache->user_data );
+	assert_non_null( first );
+	cache->free_fn( first, cache->user_data );
+	ptr = (unsigned char *)cache->malloc_fn( 32u, cache->user_data );
+	assert_ptr_equal( ptr, first );
+
+	/* growing keeps the contents */
+	for ( i = 0u; i < 32u; ++i )
+		ptr[i] = (unsigned char)i;
+	ptr = (unsigned char *)cache->realloc_fn( ptr, 5000u,
+		cache->user_data );
+	assert_non_null( ptr );
+	for ( i = 0u; i < 32u; ++i )
+		assert_int_equal( ptr[i], i );
+	cache->free_fn( ptr, cache->user_data );
+
+	ptr = (unsigned char *)cache->calloc_fn( 100u, 3u, cache->user_data );
+	assert_non_null( ptr );
+	for ( i = 0u; i < 300u; ++i )
+		assert_int_equal( ptr[i], 0u );
+	cache->free_fn( ptr, cache->user_data );
+	assert_null( cache->calloc_fn( (size_t)-1, 2u, cache->user_data ) );
+
+	for ( i = 0u; i < sizeof( alignments ) / sizeof( alignments[0] ); ++i )
+	{
+		ptr = (unsigned char *)cache->aligned_alloc_fn( alignments[i],
+			100u, cache->user_data );
+		assert_non_null( ptr );
+		assert_int_equal( (size_t)ptr % alignments[i], 0u );
+		os_memset( ptr, 0xA5, 100u );
+		cache->free_fn( ptr, cache->user_data );
+	}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	/* threads allocating and freeing through the library */
+	assert_int_equal( os_allocator_set( cache ), OS_STATUS_SUCCESS );
+	TEST_ERRORS = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_cache_worker, (void *)( i + 1u ), 0u ),
+			OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( TEST_ERRORS, 0u );
+	assert_int_equal( os_allocator_set( NULL ), OS_STATUS_SUCCESS );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+}
+
+static void test_os_allocator_thread_set( void **state )
+{
+	os_allocator_t counter;
+	os_allocator_t incomplete;
+	const os_allocator_t *previous = &counter;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	const os_allocator_t *other = NULL;
+	os_thread_t thread;
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	void *ptr;
+
+	test_count_init( &counter );
+	os_memcpy( &incomplete, &counter, sizeof( incomplete ) );
+	incomplete.free_fn = NULL;
+
+	/* an incomplete allocator is not set */
+	assert_int_equal( os_allocator_thread_set( &incomplete, &previous ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_ptr_equal( previous, &counter );
+	assert_ptr_equal( os_allocator_get(), os_allocator_system() );
+
+	/* memory functions of the thread go through the allocator */
+	TEST_CALLS = 0u;
+	assert_int_equal( os_allocator_thread_set( &counter, &previous ),
+		OS_STATUS_SUCCESS );
+	assert_null( previous );
+	assert_ptr_equal( os_allocator_get(), &counter );
+	ptr = os_malloc( 10u );
+	assert_non_null( ptr );
+	os_free( ptr );
+	assert_int_equal( TEST_CALLS, 2u );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	/* other threads keep the allocator set for the process */
+	assert_int_equal( os_thread_create( &thread, test_allocator_worker,
+		&other, 0u ), OS_STATUS_SUCCESS );
+	os_thread_wait( &thread );
+	assert_ptr_equal( other, os_allocator_system() );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+	/* calls nest, restoring the previous allocator */
+	assert_int_equal( os_allocator_thread_set(
+		os_allocator_thread_cache(), &previous ), OS_STATUS_SUCCESS );
+	assert_ptr_equal( previous, &counter );
+	assert_ptr_equal( os_allocator_get(), os_allocator_thread_cache() );
+	assert_int_equal( os_allocator_thread_set( previous, &previous ),
+		OS_STATUS_SUCCESS );
+	assert_ptr_equal( previous, os_allocator_thread_cache() );
+	assert_ptr_equal( os_allocator_get(), &counter );
+
+	/* NULL falls back to the allocator set for the process */
+	assert_int_equal( os_allocator_thread_set( NULL, NULL ),
+		OS_STATUS_SUCCESS );
+	assert_ptr_equal( os_allocator_get(), os_allocator_system() );
+	os_free( os_malloc( 10u ) );
+	assert_int_equal( TEST_CALLS, 2u );
+}
+
+static void test_os_arena( void **state )
+{
+	const size_t alignments[] = { 1u, 8u, 64u, 4096u };
+	os_allocator_t counter;
+	os_arena_t arena;
+	os_arena_checkpoint_t checkpoint;
+	os_arena_checkpoint_t empty;
+	unsigned char *first;
+	unsigned char *ptr;
+	size_t i;
+
+	assert_int_equal( os_arena_create( NULL, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_null( os_arena_alloc( NULL, 10u ) );
+
+	/* chunks come from the allocator set when the arena is created */
+	test_count_init( &counter );
+	assert_int_equal( os_allocator_set( &counter ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_arena_create( &arena, 256u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_allocator_set( NULL ), OS_STATUS_SUCCESS );
+	TEST_CALLS = 0u;
+	assert_int_equal( os_arena_checkpoint( &arena, &empty ),
+		OS_STATUS_SUCCESS );
+
+	/* small allocations share a chunk */
+	first = (unsigned char *)os_arena_alloc( &arena, 10u );
+	assert_non_null( first );
+	os_memset( first, 0x5A, 10u );
+	ptr = (unsigned char *)os_arena_alloc( &arena, 10u );
+	assert_non_null( ptr );
+	assert_int_equal( (size_t)ptr % 16u, 0u );
+	assert_true( ptr > first && ptr < first + 256u );
+	assert_int_equal( TEST_CALLS, 1u );
+	assert_null( os_arena_alloc_aligned( &arena, 3u, 10u ) );
+	for ( i = 0u; i < sizeof( alignments ) / sizeof( alignments[0] ); ++i )
+	{
+		ptr = (unsigned char *)os_arena_alloc_aligned( &arena,
+			alignments[i], 100u );
+		assert_non_null( ptr );
+		assert_int_equal( (size_t)ptr % alignments[i], 0u );
+		os_memset( ptr, 0xA5, 100u );
+	}
+	for ( i = 0u; i < 10u; ++i )
+		assert_int_equal( first[i], 0x5A );
+
+	/* allocations larger than a chunk get their own */
+	assert_int_equal( os_arena_checkpoint( &arena, &checkpoint ),
+		OS_STATUS_SUCCESS );
+	ptr = (unsigned char *)os_arena_alloc( &arena, 10000u );
+	assert_non_null( ptr );
+	os_memset( ptr, 0xA5, 10000u );
+	assert_null( os_arena_alloc( &arena, (size_t)-1 ) );
+
+	/* rewinding releases the chunks allocated since the checkpoint */
+	TEST_CALLS = 0u;
+	assert_int_equal( os_arena_rewind( &arena, &checkpoint ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_CALLS, 1u );
+	ptr = (unsigned char *)os_arena_alloc_aligned( &arena, 1u, 1u );
+	assert_ptr_equal( ptr, checkpoint.position );
+	assert_int_equal( os_arena_rewind( &arena, &checkpoint ),
+		OS_STATUS_SUCCESS );
+
+	/* reset keeps the memory in a single chunk */
+	assert_non_null( os_arena_alloc( &arena, 1000u ) );
+	TEST_CALLS = 0u;
+	assert_int_equal( os_arena_reset( &arena ), OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_CALLS, 4u );
+	first = (unsigned char *)os_arena_alloc( &arena, 10u );
+	assert_non_null( first );
+	assert_non_null( os_arena_alloc( &arena, 1000u ) );
+	assert_int_equal( os_arena_reset( &arena ), OS_STATUS_SUCCESS );
+	assert_ptr_equal( os_arena_alloc( &arena, 10u ), first );
+	assert_int_equal( TEST_CALLS, 4u );
+
+	/* rewinding to an empty arena releases everything */
+	assert_int_equal( os_arena_rewind( &arena, &empty ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_CALLS, 5u );
+	assert_non_null( os_arena_alloc( &arena, 10u ) );
+	assert_int_equal( os_arena_destroy( &arena ), OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_CALLS, 7u );
+	assert_int_equal( os_arena_destroy( NULL ), OS_STATUS_BAD_PARAMETER );
+}
+
+static void test_os_arena_allocator( void **state )
+{
+	os_allocator_t allocator;
+	os_arena_t arena;
+	const os_allocator_t *previous;
+	unsigned char *ptr;
+	unsigned char *moved;
+	void *other;
+	size_t i;
+
+	assert_int_equal( os_arena_create( &arena, 0u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_arena_allocator( NULL, &allocator ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_arena_allocator( &arena, &allocator ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_allocator_thread_set( &allocator, NULL ),
+		OS_STATUS_SUCCESS );
+
+	/* the most recent allocation grows and shrinks in place */
+	ptr = (unsigned char *)os_malloc( 32u );
+	assert_non_null( ptr );
+	for ( i = 0u; i < 32u; ++i )
+		ptr[i] = (unsigned char)i;
+	assert_ptr_equal( os_realloc( ptr, 64u ), ptr );
+	assert_ptr_equal( os_realloc( ptr, 16u ), ptr );
+
+	/* otherwise the contents are moved */
+	other = os_calloc( 4u, 4u );
+	assert_non_null( other );
+	moved = (unsigned char *)os_realloc( ptr, 64u );
+	assert_non_null( moved );
+	assert_ptr_not_equal( moved, ptr );
+	for ( i = 0u; i < 16u; ++i )
+		assert_int_equal( moved[i], i );
+
+	/* freeing the most recent allocation gives its memory back */
+	os_free( moved );
+	assert_ptr_equal( os_malloc( 64u ), moved );
+	os_free( other );
+	ptr = (unsigned char *)allocator.aligned_alloc_fn( 256u, 10u,
+		allocator.user_data );
+	assert_non_null( ptr );
+	assert_int_equal( (size_t)ptr % 256u, 0u );
+	assert_null( os_calloc( (size_t)-1, 2u ) );
+
+	/* all memory is released with the arena */
+	assert_int_equal( os_allocator_thread_set( NULL, &previous ),
+		OS_STATUS_SUCCESS );
+	assert_ptr_equal( previous, &allocator );
+	assert_int_equal( os_arena_destroy( &arena ), OS_STATUS_SUCCESS );
+}
+
+static void test_os_malloc_aligned( void **state )
+{
+	os_allocator_t counter;
+	size_t alignment;
+	char *ptr;
+	assert_null( os_malloc_aligned( 0u, 16u ) );
+	assert_null( os_malloc_aligned( 24u, 16u ) );
+	assert_null( os_malloc_aligned( 64u, (size_t)-1 ) );
+	os_free_aligned( NULL );
+
+	for ( alignment = 1u; alignment <= 8192u; alignment *= 2u )
+	{
+		ptr = (char *)os_malloc_aligned( alignment, 100u );
+		assert_non_null( ptr );
+		assert_int_equal( (size_t)ptr & ( alignment - 1u ), 0u );
+		os_memset( ptr, 0xAB, 100u );
+		os_free_aligned( ptr );
+	}
+
+	/* memory comes from the aligned allocation of the allocator */
+	test_count_init( &counter );
+	TEST_CALLS = 0u;
+	assert_int_equal( os_allocator_thread_set( &counter, NULL ),
+		OS_STATUS_SUCCESS );
+	ptr = (char *)os_malloc_aligned( 256u, 100u );
+	assert_non_null( ptr );
+	assert_int_equal( (size_t)ptr & 255u, 0u );
+	os_free_aligned( ptr );
+	assert_int_equal( TEST_CALLS, 2u );
+	counter.aligned_alloc_fn = test_no_aligned_alloc;
+	assert_null( os_malloc_aligned( 256u, 100u ) );
+	assert_int_equal( os_allocator_thread_set( NULL, NULL ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_malloc_large( void **state )
+{
+	const unsigned int flags[] = {
+		0u,
+		OS_MEMORY_FLAG_PREFAULT,
+		OS_MEMORY_FLAG_HUGE_PAGES,
+		OS_MEMORY_FLAG_HUGE_PAGES | OS_MEMORY_FLAG_PREFAULT
+	};
+	const size_t sizes[] = { 1u, 100000u, 4u * 1024u * 1024u + 1u };
+	char *ptr;
+	size_t f;
+	size_t s;
+
+	assert_null( os_malloc_large( 0u, 0u ) );
+	assert_null( os_malloc_large( (size_t)-1, 0u ) );
+	os_free_large( NULL, 0u );
+
+	for ( f = 0u; f < sizeof( flags ) / sizeof( flags[0] ); ++f )
+	{
+		for ( s = 0u; s < sizeof( sizes ) / sizeof( sizes[0] ); ++s )
+		{
+			ptr = (char *)os_malloc_large( sizes[s], flags[f] );
+			assert_non_null( ptr );
+			assert_int_equal( (size_t)ptr & 4095u, 0u );
+			assert_int_equal( ptr[0], 0 );
+			assert_int_equal( ptr[sizes[s] - 1u], 0 );
+			os_memset( ptr, 0xAB, sizes[s] );
+			os_free_large( ptr, sizes[s] );
+		}
+	}
+
+	/* locking may not be permitted, but memory returned is usable */
+	ptr = (char *)os_malloc_large( 65536u, OS_MEMORY_FLAG_LOCK );
+	if ( ptr )
+	{
+		os_memset( ptr, 0xAB, 65536u );
+		os_free_large( ptr, 65536u );
+	}
+}
+
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS && \
+	defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/* allocates memory under the test tag and exits without freeing it */
+static OS_THREAD_DECL test_memory_worker( void *arg )
+{
+	os_memory_tag_set( TEST_MEMORY_TAG );
+	*(void **)arg = os_malloc( 100u );
+	return 0;
+}
+#endif /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS &&
+	defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+static void test_os_memory_stats( void **state )
+{
+	os_memory_stats_t stats;
+#if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS
+	os_memory_tag_stats_t before;
+	os_memory_tag_t previous;
+	void *ptr;
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	os_thread_t thread;
+	void *thread_ptr = NULL;
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+	assert_int_equal( os_memory_stats( NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	before = stats.tags[TEST_MEMORY_TAG];
+
+	/* explicit tag */
+	ptr = os_malloc_tagged( 100u, TEST_MEMORY_TAG );
+	assert_non_null( ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes + 100u );
+	assert_true( stats.tags[TEST_MEMORY_TAG].count == before.count + 1u );
+	assert_true( stats.tags[TEST_MEMORY_TAG].allocations ==
+		before.allocations + 1u );
+	assert_true( stats.total.bytes >= stats.tags[TEST_MEMORY_TAG].bytes );
+
+	/* resizing keeps the tag of the memory */
+	ptr = os_realloc( ptr, 300u );
+	assert_non_null( ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes + 300u );
+	assert_true( stats.tags[TEST_MEMORY_TAG].count == before.count + 1u );
+	os_free( ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes );
+	assert_true( stats.tags[TEST_MEMORY_TAG].count == before.count );
+
+	/* tag of the calling thread, restored by the caller */
+	previous = os_memory_tag_set( TEST_MEMORY_TAG );
+	assert_int_equal( os_memory_tag_set( OS_MEMORY_TAG_MAX ),
+		TEST_MEMORY_TAG );
+	ptr = os_calloc( 4u, 16u );
+	assert_int_equal( os_memory_tag_set( previous ), TEST_MEMORY_TAG );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes + 64u );
+	os_free( ptr );
+
+	/* large allocations reach the shared totals and the watermark */
+	ptr = os_malloc_tagged( 65536u, TEST_MEMORY_TAG );
+	assert_non_null( ptr );
+	os_free( ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes_max >=
+		before.bytes + 65536u );
+	assert_true( stats.total.bytes_max >= 65536u );
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+	/* counts of an exiting thread are kept */
+	assert_int_equal( os_thread_create( &thread, test_memory_worker,
+		&thread_ptr, 0u ), OS_STATUS_SUCCESS );
+	os_thread_wait( &thread );
+	assert_non_null( thread_ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes + 100u );
+	os_free( thread_ptr );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_SUCCESS );
+	assert_true( stats.tags[TEST_MEMORY_TAG].bytes == before.bytes );
+	assert_true( stats.tags[TEST_MEMORY_TAG].count == before.count );
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+#else /* if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+	void *ptr = os_malloc_tagged( 100u, TEST_MEMORY_TAG );
+	assert_non_null( ptr );
+	os_free( ptr );
+	assert_int_equal( os_memory_tag_set( TEST_MEMORY_TAG ),
+		OS_MEMORY_TAG_DEFAULT );
+	assert_int_equal( os_memory_stats( &stats ), OS_STATUS_NOT_SUPPORTED );
+#endif /* else if defined(OSAL_MEMORY_STATS) && OSAL_MEMORY_STATS */
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/* allocates and frees objects of a pool, some freed by another thread */
+static OS_THREAD_DECL test_pool_worker( void *arg )
+{
+	os_pool_t *const pool = (os_pool_t *)arg;
+	os_uint32_t *objects[64];
+	unsigned int i;
+	for ( i = 0u; i < TEST_ALLOC_COUNT; ++i )
+	{
+		const unsigned int j = i % 64u;
+		if ( i >= 64u )
+		{
+			if ( *objects[j] != i - 64u )
+				os_atomic_fetch_add_u32( &TEST_ERRORS, 1u,
+					OS_ATOMIC_RELAXED );
+			os_pool_free( pool, objects[j] );
+		}
+		objects[j] = (os_uint32_t *)os_pool_alloc( pool );
+		if ( objects[j] == NULL )
+			os_atomic_fetch_add_u32( &TEST_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+		else
+			*objects[j] = i;
+	}
+	for ( i = 0u; i < 64u; ++i )
+		os_pool_free( pool, objects[i] );
+	return (OS_THREAD_RETURN)0;
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+static void test_os_pool( void **state )
+{
+	os_pool_t pool;
+	os_pool_stats_t stats;
+	unsigned char *objects[100];
+	unsigned char *ptr;
+	size_t i;
+
+	assert_int_equal( os_pool_create( NULL, 24u, 0u, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_pool_create( &pool, (size_t)-1, 0u, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_null( os_pool_alloc( NULL ) );
+	assert_int_equal( os_pool_create( &pool, 24u, 16u, 0u ),
+		OS_STATUS_SUCCESS );
+
+	/* objects are distinct and aligned */
+	for ( i = 0u; i < 100u; ++i )
+	{
+		objects[i] = (unsigned char *)os_pool_alloc( &pool );
+		assert_non_null( objects[i] );
+		assert_int_equal( (size_t)objects[i] % 16u, 0u );
+		os_memset( objects[i], (int)i, 24u );
+	}
+	for ( i = 0u; i < 100u; ++i )
+		assert_int_equal( objects[i][23], i );
+	assert_int_equal( os_pool_stats( &pool, &stats ), OS_STATUS_SUCCESS );
+	assert_int_equal( stats.in_use, 100u );
+	assert_int_equal( stats.capacity, 112u );
+	assert_true( stats.high_watermark >= 100u );
+
+	/* the last object freed is reused first */
+	os_pool_free( &pool, objects[99] );
+	assert_ptr_equal( os_pool_alloc( &pool ), objects[99] );
+	for ( i = 0u; i < 100u; ++i )
+		os_pool_free( &pool, objects[i] );
+	os_pool_free( &pool, NULL );
+	assert_int_equal( os_pool_stats( &pool, &stats ), OS_STATUS_SUCCESS );
+	assert_int_equal( stats.in_use, 0u );
+	assert_int_equal( stats.capacity, 112u );
+	assert_int_equal( os_pool_stats( NULL, &stats ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_pool_destroy( &pool ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_pool_destroy( NULL ), OS_STATUS_BAD_PARAMETER );
+
+	/* objects on their own cache lines */
+	assert_int_equal( os_pool_create( &pool, 8u, 0u,
+		OS_POOL_FLAG_CACHE_ALIGN ), OS_STATUS_SUCCESS );
+	objects[0] = (unsigned char *)os_pool_alloc( &pool );
+	objects[1] = (unsigned char *)os_pool_alloc( &pool );
+	assert_non_null( objects[0] );
+	assert_non_null( objects[1] );
+	assert_int_equal( (size_t)objects[0] % 64u, 0u );
+	assert_int_equal( (size_t)objects[1] % 64u, 0u );
+	os_pool_free( &pool, objects[0] );
+	os_pool_free( &pool, objects[1] );
+	assert_int_equal( os_pool_destroy( &pool ), OS_STATUS_SUCCESS );
+
+	/* writes after an object is freed are detected */
+	assert_int_equal( os_pool_create( &pool, 32u, 0u,
+		OS_POOL_FLAG_POISON ), OS_STATUS_SUCCESS );
+	ptr = (unsigned char *)os_pool_alloc( &pool );
+	assert_non_null( ptr );
+	assert_int_equal( ptr[31], 0xCD );
+	os_pool_free( &pool, ptr );
+	assert_int_equal( ptr[31], 0xDD );
+	assert_ptr_equal( os_pool_alloc( &pool ), ptr );
+	os_pool_free( &pool, ptr );
+	ptr[20] = 0u;
+	assert_ptr_equal( os_pool_alloc( &pool ), ptr );
+	assert_int_equal( os_pool_stats( &pool, &stats ), OS_STATUS_SUCCESS );
+	assert_int_equal( stats.poison_errors, 1u );
+	os_pool_free( &pool, ptr );
+	assert_int_equal( os_pool_destroy( &pool ), OS_STATUS_SUCCESS );
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+static void test_os_pool_threads( void **state )
+{
+	os_pool_t pool;
+	os_pool_stats_t stats;
+	os_thread_t threads[TEST_THREAD_COUNT];
+	void *objects[TEST_POOL_FREES];
+	size_t i;
+
+	assert_int_equal( os_pool_create( &pool, sizeof( os_uint32_t ), 0u,
+		0u ), OS_STATUS_SUCCESS );
+
+	/* objects freed by another thread are shared with the others */
+	for ( i = 0u; i < TEST_POOL_FREES; ++i )
+		objects[i] = os_pool_alloc( &pool );
+	TEST_ERRORS = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_pool_worker, &pool, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_POOL_FREES; ++i )
+		os_pool_free( &pool, objects[i] );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( TEST_ERRORS, 0u );
+
+	assert_int_equal( os_pool_stats( &pool, &stats ), OS_STATUS_SUCCESS );
+	assert_int_equal( stats.in_use, 0u );
+	assert_true( stats.refills > 0u );
+	assert_true( stats.high_watermark <= stats.capacity );
+	assert_int_equal( os_pool_destroy( &pool ), OS_STATUS_SUCCESS );
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_allocator_set ),
+		cmocka_unit_test( test_os_allocator_thread_cache ),
+		cmocka_unit_test( test_os_allocator_thread_set ),
+		cmocka_unit_test( test_os_arena ),
+		cmocka_unit_test( test_os_arena_allocator ),
+		cmocka_unit_test( test_os_malloc_aligned ),
+		cmocka_unit_test( test_os_malloc_large ),
+		cmocka_unit_test( test_os_memory_stats ),
+		cmocka_unit_test( test_os_pool ),
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+		cmocka_unit_test( test_os_pool_threads ),
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @brief source file containing integration tests for parallel loops
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Number of indexes in the ranges tested */
+#define TEST_RANGE 100000u
+
+/** @brief State shared by the chunks of a parallel loop */
+struct test_parallel_data
+{
+	/** @brief Number of chunks processed */
+	os_atomic_uint32_t chunks;
+	/** @brief Largest number of indexes in a chunk */
+	os_atomic_uint32_t largest;
+	/** @brief Number of times each index was processed */
+	os_uint32_t *visits;
+};
+
+/* counts the visits to each index of a chunk */
+static void test_parallel_visit( size_t begin, size_t end, void *arg )
+{
+	struct test_parallel_data *const data =
+		(struct test_parallel_data *)arg;
+	const os_uint32_t size = (os_uint32_t)( end - begin );
+	os_uint32_t largest = os_atomic_load_u32( &data->largest,
+		OS_ATOMIC_RELAXED );
+	size_t i;
+	for ( i = begin; i < end; ++i )
+		os_atomic_fetch_add_u32( &data->visits[i], 1u,
+			OS_ATOMIC_RELAXED );
+	while ( size > largest && !os_atomic_cas_u32(
+		&data->largest, &largest, size, OS_ATOMIC_RELAXED ) ) {}
+}
+
+/* adds up the indexes of a chunk */
+static void test_parallel_sum( size_t begin, size_t end, void *partial,
+	void *arg )
+{
+	os_uint64_t *const sum = (os_uint64_t *)partial;
+	size_t i;
+	for ( i = begin; i < end; ++i )
+		*sum += i;
+	os_atomic_fetch_add_u32( &((struct test_parallel_data *)arg)->chunks,
+		1u, OS_ATOMIC_RELAXED );
+}
+
+/* adds a partial sum to the total */
+static void test_parallel_sum_combine( void *total, const void *partial,
+	void *arg )
+{
+	*(os_uint64_t *)total += *(const os_uint64_t *)partial;
+	(void)arg;
+}
+
+static void test_os_parallel_for( void **state )
+{
+	const size_t grains[] = { 0u, 1u, 7u, 1000u, TEST_RANGE * 2u };
+	struct test_parallel_data data;
+	size_t g;
+
+	data.visits = (os_uint32_t *)test_malloc(
+		sizeof( os_uint32_t ) * TEST_RANGE );
+	assert_non_null( data.visits );
+	for ( g = 0u; g < sizeof( grains ) / sizeof( grains[0] ); ++g )
+	{
+		size_t i;
+		os_memzero( data.visits, sizeof( os_uint32_t ) * TEST_RANGE );
+		data.largest = 0u;
+
+		/* indexes before "begin" are not visited */
+		assert_int_equal( os_parallel_for( 10u, TEST_RANGE, grains[g],
+			test_parallel_visit, &data ), OS_STATUS_SUCCESS );
+		for ( i = 0u; i < TEST_RANGE; ++i )
+			assert_int_equal( data.visits[i], i < 10u ? 0u : 1u );
+		if ( grains[g] > 0u )
+			assert_true( data.largest <= grains[g] );
+	}
+	test_free( data.visits );
+}
+
+static void test_os_parallel_for_bad_parameter( void **state )
+{
+	struct test_parallel_data data;
+	os_memzero( &data, sizeof( data ) );
+	assert_int_equal( os_parallel_for( 0u, 10u, 0u, NULL, &data ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_parallel_for( 10u, 0u, 0u, test_parallel_visit,
+		&data ), OS_STATUS_BAD_PARAMETER );
+
+	/* empty range never calls the function */
+	assert_int_equal( os_parallel_for( 5u, 5u, 0u, test_parallel_visit,
+		&data ), OS_STATUS_SUCCESS );
+	assert_int_equal( data.largest, 0u );
+}
+
+static void test_os_parallel_reduce( void **state )
+{
+	const size_t grains[] = { 0u, 3u, TEST_RANGE };
+	size_t g;
+	for ( g = 0u; g < sizeof( grains ) / sizeof( grains[0] ); ++g )
+	{
+		struct test_parallel_data data;
+		os_uint64_t sum = 0u;
+		os_memzero( &data, sizeof( data ) );
+		assert_int_equal( os_parallel_reduce( 0u, TEST_RANGE, grains[g],
+			test_parallel_sum, test_parallel_sum_combine, &sum,
+			sizeof( sum ), &data ), OS_STATUS_SUCCESS );
+		assert_true( sum == (os_uint64_t)TEST_RANGE *
+			( TEST_RANGE - 1u ) / 2u );
+		if ( grains[g] == TEST_RANGE )
+			assert_int_equal( data.chunks, 1u );
+	}
+}
+
+static void test_os_parallel_reduce_bad_parameter( void **state )
+{
+	struct test_parallel_data data;
+	os_uint64_t sum = 0u;
+	os_memzero( &data, sizeof( data ) );
+	assert_int_equal( os_parallel_reduce( 0u, 10u, 0u, NULL,
+		test_parallel_sum_combine, &sum, sizeof( sum ), &data ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_parallel_reduce( 0u, 10u, 0u, test_parallel_sum,
+		NULL, &sum, sizeof( sum ), &data ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_parallel_reduce( 0u, 10u, 0u, test_parallel_sum,
+		test_parallel_sum_combine, NULL, sizeof( sum ), &data ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_parallel_reduce( 0u, 10u, 0u, test_parallel_sum,
+		test_parallel_sum_combine, &sum, 0u, &data ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( data.chunks, 0u );
+}
+
+static void test_os_system_cpu_count( void **state )
+{
+	assert_true( os_system_cpu_count() >= 1u );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_parallel_for ),
+		cmocka_unit_test( test_os_parallel_for_bad_parameter ),
+		cmocka_unit_test( test_os_parallel_reduce ),
+		cmocka_unit_test( test_os_parallel_reduce_bad_parameter ),
+		cmocka_unit_test( test_os_system_cpu_count ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,1179 @@
+/**
+ * @file
+ * @brief source file containing integration tests for thread primitives
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Number of items passed between threads */
+#define TEST_ITEM_COUNT 10000u
+
+/** @brief Number of threads contending for a lock */
+#define TEST_THREAD_COUNT 4u
+
+/** @brief Number of phases threads synchronize at a barrier */
+#define TEST_PHASE_COUNT 100u
+
+/** @brief Time the low priority thread holds the lock, in milliseconds */
+#define TEST_INVERSION_HOLD 50u
+/** @brief Time the medium priority thread runs, in milliseconds */
+#define TEST_INVERSION_BUSY 300u
+
+/** @brief Counter protected by the lock under test */
+static unsigned int TEST_COUNTER;
+/** @brief Copy of the counter, always equal to it while the lock is held */
+static volatile unsigned int TEST_COUNTER_COPY;
+/** @brief Number of times readers saw a partially written value */
+static os_atomic_uint32_t TEST_READ_ERRORS;
+/** @brief Adaptive lock under test */
+static os_thread_adaptive_mutex_t TEST_ADAPTIVE_MUTEX;
+/** @brief Time the high priority thread waited for the lock, in ms */
+static os_timestamp_t TEST_INVERSION_WAIT;
+/** @brief Record protected by a sequence lock, both values are always equal */
+struct test_record
+{
+	/** @brief First value */
+	unsigned int a;
+	/** @brief Second value */
+	unsigned int b;
+};
+
+/** @brief Snapshot published through a read-copy-update pointer */
+struct test_snapshot
+{
+	/** @brief Version of the snapshot */
+	unsigned int version;
+	/** @brief Set once the snapshot is freed */
+	os_atomic_uint32_t freed;
+	/** @brief Next freed snapshot */
+	struct test_snapshot *next;
+};
+
+/** @brief Record protected by the sequence lock */
+static struct test_record TEST_RECORD;
+/** @brief Sequence lock under test */
+static os_seqlock_t TEST_SEQLOCK;
+/** @brief Read-copy-update pointer under test */
+static os_rcu_ptr_t TEST_RCU;
+/** @brief Snapshots freed by the read-copy-update pointer */
+static struct test_snapshot *TEST_FREED;
+/** @brief Big-reader lock under test */
+static os_thread_brlock_t TEST_BRLOCK;
+/** @brief Spin lock under test */
+static os_thread_spinlock_t TEST_SPINLOCK;
+
+/** @brief Condition variable under test */
+static os_thread_condition_t TEST_CONDITION;
+/** @brief Events used to pass control back and forth between threads */
+static os_thread_event_t TEST_EVENT[2];
+/** @brief Semaphore counting items produced */
+static os_thread_semaphore_t TEST_SEM;
+/** @brief Barrier under test */
+static os_thread_barrier_t TEST_BARRIER;
+/** @brief Number of threads that arrived in each phase at the barrier */
+static os_atomic_uint32_t TEST_PHASE_ARRIVALS[TEST_PHASE_COUNT];
+/** @brief Number of threads told they were last, in each phase */
+static os_atomic_uint32_t TEST_PHASE_LAST[TEST_PHASE_COUNT];
+/** @brief Latch under test */
+static os_thread_latch_t TEST_LATCH;
+/** @brief Thread-local key under test */
+static os_thread_local_key_t TEST_LOCAL_KEY;
+/** @brief Number of thread-local values passed to the destructor */
+static os_atomic_uint32_t TEST_LOCAL_FREED;
+/** @brief Counter with a separate instance for each thread */
+static OS_THREAD_LOCAL unsigned int TEST_LOCAL_COUNTER;
+/** @brief Mutex under test */
+static os_thread_mutex_t TEST_MUTEX;
+/** @brief One-time initialization under test */
+static os_thread_once_t TEST_ONCE = OS_THREAD_ONCE_INIT;
+/** @brief Read/write lock under test */
+static os_thread_rwlock_t TEST_RWLOCK;
+
+/* thread stepping through phases, synchronized by the barrier */
+static OS_THREAD_DECL test_barrier_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_PHASE_COUNT; ++i )
+	{
+		os_bool_t last = OS_FALSE;
+		os_atomic_fetch_add_u32( &TEST_PHASE_ARRIVALS[i], 1u,
+			OS_ATOMIC_RELAXED );
+		os_thread_barrier_wait( &TEST_BARRIER, &last );
+		/* all threads arrived before any leaves */
+		if ( os_atomic_load_u32( &TEST_PHASE_ARRIVALS[i],
+			OS_ATOMIC_RELAXED ) != TEST_THREAD_COUNT )
+			os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+		if ( last != OS_FALSE )
+			os_atomic_fetch_add_u32( &TEST_PHASE_LAST[i], 1u,
+				OS_ATOMIC_RELAXED );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread incrementing the counter protected by the adaptive lock */
+static OS_THREAD_DECL test_adaptive_mutex_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_adaptive_mutex_lock( &TEST_ADAPTIVE_MUTEX );
+		++TEST_COUNTER;
+		os_thread_adaptive_mutex_unlock( &TEST_ADAPTIVE_MUTEX );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread mostly reading, and sometimes writing, the counter protected by
+ * the big-reader lock */
+static OS_THREAD_DECL test_brlock_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		if ( i % 8u == 0u )
+		{
+			os_thread_brlock_write_lock( &TEST_BRLOCK );
+			++TEST_COUNTER;
+			os_thread_yield();
+			TEST_COUNTER_COPY = TEST_COUNTER;
+			os_thread_brlock_write_unlock( &TEST_BRLOCK );
+		}
+		else
+		{
+			os_thread_brlock_read_lock( &TEST_BRLOCK );
+			if ( TEST_COUNTER != TEST_COUNTER_COPY )
+				os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+					OS_ATOMIC_RELAXED );
+			os_thread_brlock_read_unlock( &TEST_BRLOCK );
+		}
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread reading the snapshots published by the read-copy-update pointer */
+static OS_THREAD_DECL test_rcu_reader( void *arg )
+{
+	unsigned int i;
+	unsigned int last_version = 0u;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_rcu_reader_t reader;
+		void *ptr = NULL;
+		struct test_snapshot *snapshot;
+
+		os_rcu_ptr_read_lock( &TEST_RCU, &reader, &ptr );
+		snapshot = (struct test_snapshot *)ptr;
+		if ( !snapshot || snapshot->version < last_version )
+			os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+		else
+		{
+			last_version = snapshot->version;
+			os_thread_yield();
+			if ( os_atomic_load_u32( &snapshot->freed,
+				OS_ATOMIC_ACQUIRE ) != 0u )
+				os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+					OS_ATOMIC_RELAXED );
+		}
+		os_rcu_ptr_read_unlock( &TEST_RCU, &reader );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* marks a snapshot as freed, actually freed at the end of the test */
+static void test_rcu_free( void *ptr )
+{
+	struct test_snapshot *const snapshot = (struct test_snapshot *)ptr;
+	os_atomic_store_u32( &snapshot->freed, 1u, OS_ATOMIC_RELEASE );
+	snapshot->next = TEST_FREED;
+	TEST_FREED = snapshot;
+}
+
+/* thread reading the record protected by the sequence lock */
+static OS_THREAD_DECL test_seqlock_reader( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		struct test_record record;
+		os_seqlock_read( &TEST_SEQLOCK, &record, &TEST_RECORD,
+			sizeof( struct test_record ) );
+		if ( record.a != record.b )
+			os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread incrementing the counter protected by the spin lock */
+static OS_THREAD_DECL test_spinlock_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_spinlock_lock( &TEST_SPINLOCK );
+		++TEST_COUNTER;
+		os_thread_spinlock_unlock( &TEST_SPINLOCK );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* runs a worker on multiple threads, and checks the counter */
+static void test_run_counter_workers( os_thread_main_t worker )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+	TEST_COUNTER = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i], worker,
+			NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( TEST_COUNTER, TEST_THREAD_COUNT * TEST_ITEM_COUNT );
+}
+
+/* thread created with attributes, signals when it has run */
+static OS_THREAD_DECL test_attr_worker( void *arg )
+{
+	(void)arg;
+	++TEST_COUNTER;
+	os_thread_event_set( &TEST_EVENT[0] );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread signalling the condition after a short delay */
+static OS_THREAD_DECL test_condition_worker( void *arg )
+{
+	(void)arg;
+	os_time_sleep( 20u, OS_FALSE );
+	os_thread_mutex_lock( &TEST_MUTEX );
+	TEST_COUNTER = 1u;
+	os_thread_condition_broadcast( &TEST_CONDITION );
+	os_thread_mutex_unlock( &TEST_MUTEX );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread incrementing the counter protected by the mutex */
+static OS_THREAD_DECL test_mutex_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_mutex_lock( &TEST_MUTEX );
+		++TEST_COUNTER;
+		os_thread_mutex_unlock( &TEST_MUTEX );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* runs without blocking for a time, from a starting time */
+static void test_busy_until( os_timestamp_t start, os_millisecond_t ms )
+{
+	os_timestamp_t now;
+	do {
+		os_time_monotonic( &now );
+	} while ( now - start < ms );
+}
+
+/* high priority thread, measuring how long it waits for the lock */
+static OS_THREAD_DECL test_inversion_high( void *arg )
+{
+	os_timestamp_t start;
+	os_timestamp_t end;
+	(void)arg;
+	os_time_monotonic( &start );
+	os_thread_mutex_lock( &TEST_MUTEX );
+	os_time_monotonic( &end );
+	os_thread_mutex_unlock( &TEST_MUTEX );
+	TEST_INVERSION_WAIT = end - start;
+	return (OS_THREAD_RETURN)0;
+}
+
+/* low priority thread, holding the lock for a while */
+static OS_THREAD_DECL test_inversion_low( void *arg )
+{
+	os_timestamp_t start;
+	(void)arg;
+	os_thread_mutex_lock( &TEST_MUTEX );
+	os_time_monotonic( &start );
+	os_thread_event_set( &TEST_EVENT[0] );
+	test_busy_until( start, TEST_INVERSION_HOLD );
+	os_thread_mutex_unlock( &TEST_MUTEX );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* medium priority thread, keeping the processor busy */
+static OS_THREAD_DECL test_inversion_medium( void *arg )
+{
+	os_timestamp_t start;
+	(void)arg;
+	os_time_monotonic( &start );
+	test_busy_until( start, TEST_INVERSION_BUSY );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread counting down the latch */
+static OS_THREAD_DECL test_latch_worker( void *arg )
+{
+	(void)arg;
+	os_thread_latch_count_down( &TEST_LATCH );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* destructor of the thread-local values */
+static void OS_THREAD_LINK test_local_free( void *value )
+{
+	if ( value == &TEST_LOCAL_COUNTER )
+		os_atomic_fetch_add_u32( &TEST_LOCAL_FREED, 1u,
+			OS_ATOMIC_RELAXED );
+}
+
+/* thread checking it sees only its own thread-local values */
+static OS_THREAD_DECL test_local_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	if ( os_thread_local_key_get( &TEST_LOCAL_KEY ) != NULL )
+		os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+			OS_ATOMIC_RELAXED );
+	os_thread_local_key_set( &TEST_LOCAL_KEY, &TEST_LOCAL_COUNTER );
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		++TEST_LOCAL_COUNTER;
+		if ( os_thread_local_key_get( &TEST_LOCAL_KEY ) !=
+			&TEST_LOCAL_COUNTER )
+			os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+				OS_ATOMIC_RELAXED );
+		os_thread_yield();
+	}
+	if ( TEST_LOCAL_COUNTER != TEST_ITEM_COUNT )
+		os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+			OS_ATOMIC_RELAXED );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread ending while holding the lock */
+static OS_THREAD_DECL test_robust_worker( void *arg )
+{
+	(void)arg;
+	os_thread_mutex_lock( &TEST_MUTEX );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread incrementing the counter protected by the write lock */
+static OS_THREAD_DECL test_rwlock_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_rwlock_write_lock( &TEST_RWLOCK );
+		++TEST_COUNTER;
+		os_thread_rwlock_write_unlock( &TEST_RWLOCK );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* slow initialization, counting the number of times it runs */
+static void test_once_init( void *arg )
+{
+	(void)arg;
+	os_time_sleep( 20u, OS_FALSE );
+	os_atomic_fetch_add_u32( (os_atomic_uint32_t *)&TEST_COUNTER, 1u,
+		OS_ATOMIC_RELAXED );
+}
+
+/* thread calling the one-time initialization */
+static OS_THREAD_DECL test_once_worker( void *arg )
+{
+	(void)arg;
+	os_thread_once( &TEST_ONCE, test_once_init, NULL );
+	/* initialization completed before returning */
+	if ( os_atomic_load_u32( (os_atomic_uint32_t *)&TEST_COUNTER,
+		OS_ATOMIC_RELAXED ) != 1u )
+		os_atomic_fetch_add_u32( &TEST_READ_ERRORS, 1u,
+			OS_ATOMIC_RELAXED );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread replying to each event received */
+static OS_THREAD_DECL test_event_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_event_wait( &TEST_EVENT[0] );
+		os_thread_event_set( &TEST_EVENT[1] );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/* thread producing items for the semaphore */
+static OS_THREAD_DECL test_semaphore_worker( void *arg )
+{
+	unsigned int i;
+	(void)arg;
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+		os_thread_semaphore_post( &TEST_SEM );
+	return (OS_THREAD_RETURN)0;
+}
+
+/* runs high, medium and low priority real-time threads on one processor,
+ * while the low priority thread holds a lock the high one waits for, and
+ * returns the time the high priority thread waited */
+static os_timestamp_t test_run_inversion(
+	const os_thread_mutex_attr_t *mutex_attr )
+{
+	os_thread_attr_t attr;
+	os_thread_t threads[3u];
+	unsigned int i;
+
+	assert_int_equal( os_thread_mutex_create_ex( &TEST_MUTEX, mutex_attr ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_create( &TEST_EVENT[0],
+		OS_FALSE ), OS_STATUS_SUCCESS );
+	os_memzero( &attr, sizeof( os_thread_attr_t ) );
+	attr.affinity = 1u;
+	attr.policy = OS_THREAD_POLICY_FIFO;
+
+	/* this thread has the highest priority, so it runs whenever ready */
+	attr.priority = 10;
+	assert_int_equal( os_thread_create_ex( &threads[0],
+		test_inversion_low, NULL, &attr ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_wait( &TEST_EVENT[0] ),
+		OS_STATUS_SUCCESS );
+	attr.priority = 30;
+	assert_int_equal( os_thread_create_ex( &threads[1],
+		test_inversion_high, NULL, &attr ), OS_STATUS_SUCCESS );
+	os_time_sleep( 10u, OS_FALSE );
+	attr.priority = 20;
+	assert_int_equal( os_thread_create_ex( &threads[2],
+		test_inversion_medium, NULL, &attr ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < 3u; ++i )
+		os_thread_wait( &threads[i] );
+
+	assert_int_equal( os_thread_event_destroy( &TEST_EVENT[0] ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_destroy( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+	return TEST_INVERSION_WAIT;
+}
+
+/* test os_lock_stats_dump */
+static void test_os_lock_stats_dump( void **state )
+{
+	FILE *out = tmpfile();
+	assert_non_null( out );
+	assert_int_equal( os_lock_stats_dump( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+
+	assert_int_equal( os_thread_mutex_create_named( &TEST_MUTEX,
+		"test mutex" ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_rwlock_create_named( &TEST_RWLOCK,
+		"test rwlock" ), OS_STATUS_SUCCESS );
+	test_run_counter_workers( test_mutex_worker );
+	test_run_counter_workers( test_rwlock_worker );
+	assert_int_equal( os_thread_rwlock_read_lock( &TEST_RWLOCK ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_rwlock_read_unlock( &TEST_RWLOCK ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_rwlock_destroy( &TEST_RWLOCK ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_destroy( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+
+#if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS
+	{
+		char buf[4096u];
+		size_t len;
+		assert_int_equal( os_lock_stats_dump( out ), OS_STATUS_SUCCESS );
+		rewind( out );
+		len = fread( buf, 1u, sizeof( buf ) - 1u, out );
+		buf[len] = '\0';
+
+		/* statistics of named locks outlive the locks */
+		assert_non_null( strstr( buf,
+			"mutex \"test mutex\": acquired 40000," ) );
+		assert_non_null( strstr( buf,
+			"rwlock \"test rwlock\": acquired 40001," ) );
+	}
+#else /* if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+	assert_int_equal( os_lock_stats_dump( out ),
+		OS_STATUS_NOT_SUPPORTED );
+#endif /* else if defined(OSAL_LOCK_STATS) && OSAL_LOCK_STATS */
+	fclose( out );
+}
+
+/* test os_rcu_ptr_* */
+static void test_os_rcu_ptr( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+	struct test_snapshot *snapshot;
+	os_rcu_reader_t reader;
+	void *ptr = NULL;
+
+	assert_int_equal( os_rcu_ptr_create( NULL, NULL, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	snapshot = (struct test_snapshot *)test_calloc( 1u,
+		sizeof( struct test_snapshot ) );
+	assert_non_null( snapshot );
+	TEST_FREED = NULL;
+	assert_int_equal( os_rcu_ptr_create( &TEST_RCU, snapshot,
+		test_rcu_free ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_rcu_ptr_read_lock( &TEST_RCU, &reader, &ptr ),
+		OS_STATUS_SUCCESS );
+	assert_ptr_equal( ptr, snapshot );
+	assert_int_equal( os_rcu_ptr_read_unlock( &TEST_RCU, &reader ),
+		OS_STATUS_SUCCESS );
+
+	/* readers must never see a freed snapshot */
+	os_atomic_store_u32( &TEST_READ_ERRORS, 0u, OS_ATOMIC_SEQ_CST );
+	for ( i = 0u; i < TEST_THREAD_COUNT - 1u; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_rcu_reader, NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 1u; i <= TEST_ITEM_COUNT / 100u; ++i )
+	{
+		snapshot = (struct test_snapshot *)test_calloc( 1u,
+			sizeof( struct test_snapshot ) );
+		assert_non_null( snapshot );
+		snapshot->version = i;
+		assert_int_equal( os_rcu_ptr_publish( &TEST_RCU, snapshot ),
+			OS_STATUS_SUCCESS );
+	}
+	for ( i = 0u; i < TEST_THREAD_COUNT - 1u; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( os_atomic_load_u32( &TEST_READ_ERRORS,
+		OS_ATOMIC_SEQ_CST ), 0u );
+	assert_int_equal( os_rcu_ptr_synchronize( &TEST_RCU ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_rcu_ptr_destroy( &TEST_RCU ), OS_STATUS_SUCCESS );
+
+	/* every snapshot published is freed */
+	for ( i = 0u; TEST_FREED; ++i )
+	{
+		snapshot = TEST_FREED;
+		TEST_FREED = snapshot->next;
+		test_free( snapshot );
+	}
+	assert_int_equal( i, TEST_ITEM_COUNT / 100u + 1u );
+}
+
+/* test os_seqlock_* */
+static void test_os_seqlock( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+	struct test_record record;
+
+	assert_int_equal( os_seqlock_create( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_seqlock_create( &TEST_SEQLOCK ),
+		OS_STATUS_SUCCESS );
+	TEST_RECORD.a = TEST_RECORD.b = 0u;
+
+	/* readers must never see a partially written record */
+	os_atomic_store_u32( &TEST_READ_ERRORS, 0u, OS_ATOMIC_SEQ_CST );
+	for ( i = 0u; i < TEST_THREAD_COUNT - 1u; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_seqlock_reader, NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 1u; i <= TEST_ITEM_COUNT; ++i )
+	{
+		assert_int_equal( os_seqlock_write_lock( &TEST_SEQLOCK ),
+			OS_STATUS_SUCCESS );
+		TEST_RECORD.a = i;
+		if ( i % 100u == 0u )
+			os_thread_yield();
+		TEST_RECORD.b = i;
+		assert_int_equal( os_seqlock_write_unlock( &TEST_SEQLOCK ),
+			OS_STATUS_SUCCESS );
+	}
+	for ( i = 0u; i < TEST_THREAD_COUNT - 1u; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( os_atomic_load_u32( &TEST_READ_ERRORS,
+		OS_ATOMIC_SEQ_CST ), 0u );
+
+	/* copy helpers */
+	record.a = record.b = 42u;
+	assert_int_equal( os_seqlock_write( &TEST_SEQLOCK, &TEST_RECORD,
+		&record, sizeof( struct test_record ) ), OS_STATUS_SUCCESS );
+	record.a = record.b = 0u;
+	assert_int_equal( os_seqlock_read( &TEST_SEQLOCK, &record,
+		&TEST_RECORD, sizeof( struct test_record ) ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( record.a, 42u );
+	assert_int_equal( record.b, 42u );
+	assert_int_equal( os_seqlock_destroy( &TEST_SEQLOCK ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_adaptive_mutex_* */
+static void test_os_thread_adaptive_mutex( void **state )
+{
+	assert_int_equal( os_thread_adaptive_mutex_create( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_adaptive_mutex_create(
+		&TEST_ADAPTIVE_MUTEX ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_adaptive_mutex_try_lock(
+		&TEST_ADAPTIVE_MUTEX ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_adaptive_mutex_try_lock(
+		&TEST_ADAPTIVE_MUTEX ), OS_STATUS_TRY_AGAIN );
+	assert_int_equal( os_thread_adaptive_mutex_unlock(
+		&TEST_ADAPTIVE_MUTEX ), OS_STATUS_SUCCESS );
+	test_run_counter_workers( test_adaptive_mutex_worker );
+	assert_int_equal( os_thread_adaptive_mutex_destroy(
+		&TEST_ADAPTIVE_MUTEX ), OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_barrier_* */
+static void test_os_thread_barrier( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+	os_bool_t last = OS_FALSE;
+
+	assert_int_equal( os_thread_barrier_create( NULL, 1u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_barrier_create( &TEST_BARRIER, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+
+	/* a barrier for one thread never waits */
+	assert_int_equal( os_thread_barrier_create( &TEST_BARRIER, 1u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_barrier_wait( &TEST_BARRIER, &last ),
+		OS_STATUS_SUCCESS );
+	assert_true( last != OS_FALSE );
+
+	assert_int_equal( os_thread_barrier_create( &TEST_BARRIER,
+		TEST_THREAD_COUNT ), OS_STATUS_SUCCESS );
+	TEST_READ_ERRORS = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_barrier_worker, NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( TEST_READ_ERRORS, 0u );
+	for ( i = 0u; i < TEST_PHASE_COUNT; ++i )
+		assert_int_equal( TEST_PHASE_LAST[i], 1u );
+	assert_int_equal( os_thread_barrier_destroy( &TEST_BARRIER ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_brlock_* */
+static void test_os_thread_brlock( void **state )
+{
+	unsigned int i, j;
+	os_thread_t threads[TEST_THREAD_COUNT];
+
+	assert_int_equal( os_thread_brlock_create( NULL, OS_FALSE ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_brlock_read_lock( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+
+	/* reader preference, then writer preference */
+	for ( i = 0u; i < 2u; ++i )
+	{
+		assert_int_equal( os_thread_brlock_create( &TEST_BRLOCK,
+			i > 0u ? OS_TRUE : OS_FALSE ), OS_STATUS_SUCCESS );
+
+		/* readers share the lock */
+		assert_int_equal( os_thread_brlock_read_lock( &TEST_BRLOCK ),
+			OS_STATUS_SUCCESS );
+		assert_int_equal( os_thread_brlock_read_lock( &TEST_BRLOCK ),
+			OS_STATUS_SUCCESS );
+		assert_int_equal( os_thread_brlock_read_unlock( &TEST_BRLOCK ),
+			OS_STATUS_SUCCESS );
+		assert_int_equal( os_thread_brlock_read_unlock( &TEST_BRLOCK ),
+			OS_STATUS_SUCCESS );
+
+		TEST_COUNTER = 0u;
+		TEST_COUNTER_COPY = 0u;
+		os_atomic_store_u32( &TEST_READ_ERRORS, 0u, OS_ATOMIC_SEQ_CST );
+		for ( j = 0u; j < TEST_THREAD_COUNT; ++j )
+			assert_int_equal( os_thread_create( &threads[j],
+				test_brlock_worker, NULL, 0u ),
+				OS_STATUS_SUCCESS );
+		for ( j = 0u; j < TEST_THREAD_COUNT; ++j )
+			os_thread_wait( &threads[j] );
+		assert_int_equal( TEST_COUNTER,
+			TEST_THREAD_COUNT * TEST_ITEM_COUNT / 8u );
+		assert_int_equal( os_atomic_load_u32( &TEST_READ_ERRORS,
+			OS_ATOMIC_SEQ_CST ), 0u );
+
+		assert_int_equal( os_thread_brlock_destroy( &TEST_BRLOCK ),
+			OS_STATUS_SUCCESS );
+	}
+}
+
+/* test os_thread_condition_wait_until */
+static void test_os_thread_condition_wait_until( void **state )
+{
+	os_status_t result = OS_STATUS_SUCCESS;
+	os_thread_t thread;
+	os_timestamp_t deadline, now;
+
+	assert_int_equal( os_thread_condition_create( &TEST_CONDITION ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_create( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_condition_wait_until( NULL, &TEST_MUTEX,
+		0u ), OS_STATUS_BAD_PARAMETER );
+
+	os_thread_mutex_lock( &TEST_MUTEX );
+
+	/* deadline already passed */
+	os_time_monotonic( &now );
+	assert_int_equal( os_thread_condition_wait_until( &TEST_CONDITION,
+		&TEST_MUTEX, now > 0u ? now - 1u : 0u ), OS_STATUS_TIMED_OUT );
+
+	/* deadline in the future, measured on the monotonic clock */
+	deadline = now + 50u;
+	assert_int_equal( os_thread_condition_wait_until( &TEST_CONDITION,
+		&TEST_MUTEX, deadline ), OS_STATUS_TIMED_OUT );
+	os_time_monotonic( &now );
+	assert_true( now >= deadline );
+	assert_int_equal( os_thread_condition_timed_wait( &TEST_CONDITION,
+		&TEST_MUTEX, 20u ), OS_STATUS_TIMED_OUT );
+
+	/* one deadline shared by every wakeup of a predicate loop */
+	TEST_COUNTER = 0u;
+	assert_int_equal( os_thread_create( &thread, test_condition_worker,
+		NULL, 0u ), OS_STATUS_SUCCESS );
+	deadline = now + 5000u;
+	while ( TEST_COUNTER == 0u && result == OS_STATUS_SUCCESS )
+		result = os_thread_condition_wait_until( &TEST_CONDITION,
+			&TEST_MUTEX, deadline );
+	assert_int_equal( result, OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_COUNTER, 1u );
+	os_thread_mutex_unlock( &TEST_MUTEX );
+
+	os_thread_wait( &thread );
+	assert_int_equal( os_thread_condition_destroy( &TEST_CONDITION ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_destroy( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_create_ex */
+static void test_os_thread_create_ex( void **state )
+{
+	os_thread_attr_t attr;
+	os_thread_t thread;
+
+	TEST_COUNTER = 0u;
+	assert_int_equal( os_thread_event_create( &TEST_EVENT[0], OS_FALSE ),
+		OS_STATUS_SUCCESS );
+
+	/* default attributes */
+	assert_int_equal( os_thread_create_ex( &thread, test_attr_worker,
+		NULL, NULL ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_wait( &thread ), OS_STATUS_SUCCESS );
+
+	/* invalid parameters */
+	memset( &attr, 0, sizeof( os_thread_attr_t ) );
+	assert_int_equal( os_thread_create_ex( &thread, NULL, NULL, &attr ),
+		OS_STATUS_BAD_PARAMETER );
+	attr.policy = (os_thread_policy_t)99;
+	assert_int_equal( os_thread_create_ex( &thread, test_attr_worker,
+		NULL, &attr ), OS_STATUS_BAD_PARAMETER );
+
+	/* named thread, with a long name that gets truncated */
+	memset( &attr, 0, sizeof( os_thread_attr_t ) );
+	attr.name = "test-thread-with-a-long-name";
+	attr.stack_size = 256u * 1024u;
+	assert_int_equal( os_thread_create_ex( &thread, test_attr_worker,
+		NULL, &attr ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_wait( &thread ), OS_STATUS_SUCCESS );
+
+	/* detached thread, can't be waited on */
+	attr.detached = OS_TRUE;
+	assert_int_equal( os_thread_event_reset( &TEST_EVENT[0] ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_create_ex( &thread, test_attr_worker,
+		NULL, &attr ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_timed_wait( &TEST_EVENT[0], 5000u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_COUNTER, 3u );
+
+	assert_int_equal( os_thread_event_destroy( &TEST_EVENT[0] ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_event_* with an auto-reset event */
+static void test_os_thread_event_auto_reset( void **state )
+{
+	os_thread_event_t event;
+	os_timestamp_t start = 0u;
+	os_timestamp_t end = 0u;
+
+	assert_int_equal( os_thread_event_create( NULL, OS_FALSE ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_event_create( &event, OS_FALSE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_set( &event ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_wait( &event ), OS_STATUS_SUCCESS );
+
+	/* event was reset by the previous wait */
+	os_time_monotonic( &start );
+	assert_int_equal( os_thread_event_timed_wait( &event, 50u ),
+		OS_STATUS_TIMED_OUT );
+	os_time_monotonic( &end );
+	assert_true( end - start >= 49u );
+
+	/* deadline in the past */
+	assert_int_equal( os_thread_event_wait_until( &event, end ),
+		OS_STATUS_TIMED_OUT );
+	assert_int_equal( os_thread_event_destroy( &event ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_event_* with a manual-reset event */
+static void test_os_thread_event_manual_reset( void **state )
+{
+	os_thread_event_t event;
+	assert_int_equal( os_thread_event_create( &event, OS_TRUE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_timed_wait( &event, 1u ),
+		OS_STATUS_TIMED_OUT );
+	assert_int_equal( os_thread_event_set( &event ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_wait( &event ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_timed_wait( &event, 1u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_reset( &event ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_event_timed_wait( &event, 1u ),
+		OS_STATUS_TIMED_OUT );
+	os_thread_event_destroy( &event );
+}
+
+/* test os_thread_event_* passing control between threads */
+static void test_os_thread_event_ping_pong( void **state )
+{
+	unsigned int i;
+	os_thread_t thread;
+	os_thread_event_create( &TEST_EVENT[0], OS_FALSE );
+	os_thread_event_create( &TEST_EVENT[1], OS_FALSE );
+	assert_int_equal( os_thread_create( &thread, test_event_worker,
+		NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+	{
+		os_thread_event_set( &TEST_EVENT[0] );
+		assert_int_equal( os_thread_event_timed_wait( &TEST_EVENT[1],
+			5000u ), OS_STATUS_SUCCESS );
+	}
+	os_thread_wait( &thread );
+	os_thread_event_destroy( &TEST_EVENT[0] );
+	os_thread_event_destroy( &TEST_EVENT[1] );
+}
+
+/* test os_thread_self_* */
+static void test_os_thread_self( void **state )
+{
+	os_status_t result;
+
+	/* naming & affinity are not available on all platforms */
+	assert_int_equal( os_thread_self_name_set( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	result = os_thread_self_name_set( "test-self" );
+	assert_true( result == OS_STATUS_SUCCESS ||
+		result == OS_STATUS_NOT_SUPPORTED );
+	result = os_thread_self_affinity_set( 0u );
+	assert_true( result == OS_STATUS_SUCCESS ||
+		result == OS_STATUS_NOT_SUPPORTED );
+
+	/* real-time scheduling may require privileges */
+	assert_int_equal( os_thread_self_scheduling_set(
+		(os_thread_policy_t)99, 0 ), OS_STATUS_BAD_PARAMETER );
+	result = os_thread_self_scheduling_set( OS_THREAD_POLICY_FIFO, 1 );
+	assert_true( result == OS_STATUS_SUCCESS ||
+		result == OS_STATUS_NO_PERMISSION );
+	assert_int_equal( os_thread_self_scheduling_set(
+		OS_THREAD_POLICY_DEFAULT, 0 ), OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_latch_* */
+static void test_os_thread_latch( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+
+	assert_int_equal( os_thread_latch_create( NULL, 1u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_latch_create( &TEST_LATCH, 1u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_latch_try_wait( &TEST_LATCH ),
+		OS_STATUS_TRY_AGAIN );
+	assert_int_equal( os_thread_latch_timed_wait( &TEST_LATCH, 10u ),
+		OS_STATUS_TIMED_OUT );
+	assert_int_equal( os_thread_latch_count_down( &TEST_LATCH ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_latch_count_down( &TEST_LATCH ),
+		OS_STATUS_OUT_OF_RANGE );
+	assert_int_equal( os_thread_latch_try_wait( &TEST_LATCH ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_latch_wait( &TEST_LATCH ),
+		OS_STATUS_SUCCESS );
+
+	/* released once every thread has counted down */
+	assert_int_equal( os_thread_latch_create( &TEST_LATCH,
+		TEST_THREAD_COUNT ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_latch_worker, NULL, 0u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_latch_timed_wait( &TEST_LATCH, 5000u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_latch_try_wait( &TEST_LATCH ),
+		OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( os_thread_latch_destroy( &TEST_LATCH ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_local_key_* and OS_THREAD_LOCAL */
+static void test_os_thread_local_key( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+
+	assert_int_equal( os_thread_local_key_create( NULL, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_local_key_set( NULL, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_local_key_create( &TEST_LOCAL_KEY,
+		test_local_free ), OS_STATUS_SUCCESS );
+	assert_null( os_thread_local_key_get( &TEST_LOCAL_KEY ) );
+
+	/* each thread sees its own values, freed when it exits */
+	TEST_LOCAL_COUNTER = 0u;
+	TEST_LOCAL_FREED = 0u;
+	TEST_READ_ERRORS = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_local_worker, NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( TEST_READ_ERRORS, 0u );
+	assert_int_equal( TEST_LOCAL_FREED, TEST_THREAD_COUNT );
+	assert_int_equal( TEST_LOCAL_COUNTER, 0u );
+	assert_null( os_thread_local_key_get( &TEST_LOCAL_KEY ) );
+
+	/* a value cleared before exiting is not passed to the destructor */
+	assert_int_equal( os_thread_local_key_set( &TEST_LOCAL_KEY,
+		&TEST_LOCAL_COUNTER ), OS_STATUS_SUCCESS );
+	assert_ptr_equal( os_thread_local_key_get( &TEST_LOCAL_KEY ),
+		&TEST_LOCAL_COUNTER );
+	assert_int_equal( os_thread_local_key_set( &TEST_LOCAL_KEY, NULL ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_local_key_destroy( &TEST_LOCAL_KEY ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_LOCAL_FREED, TEST_THREAD_COUNT );
+}
+
+/* test os_thread_mutex_create_ex with priority inheritance */
+static void test_os_thread_mutex_priority_inherit( void **state )
+{
+	os_thread_mutex_attr_t attr;
+	os_timestamp_t inverted;
+	os_timestamp_t inherited;
+
+	os_memzero( &attr, sizeof( os_thread_mutex_attr_t ) );
+	attr.protocol = (os_thread_mutex_protocol_t)99;
+	assert_int_equal( os_thread_mutex_create_ex( &TEST_MUTEX, &attr ),
+		OS_STATUS_BAD_PARAMETER );
+	attr.protocol = OS_THREAD_MUTEX_PROTOCOL_PROTECT;
+	assert_int_equal( os_thread_mutex_create_ex( &TEST_MUTEX, &attr ),
+		OS_STATUS_BAD_PARAMETER );
+	attr.protocol = OS_THREAD_MUTEX_PROTOCOL_INHERIT;
+	if ( os_thread_mutex_create_ex( &TEST_MUTEX, &attr ) !=
+		OS_STATUS_SUCCESS )
+		skip();
+	assert_int_equal( os_thread_mutex_destroy( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+
+	/* real-time scheduling may require privileges */
+	if ( os_thread_self_affinity_set( 1u ) != OS_STATUS_SUCCESS ||
+		os_thread_self_scheduling_set( OS_THREAD_POLICY_FIFO, 40 ) !=
+			OS_STATUS_SUCCESS )
+	{
+		os_thread_self_affinity_set( 0u );
+		skip();
+	}
+
+	/* the medium priority thread delays the lock owner, and so the high
+	 * priority thread, unless the owner inherits the waiter's priority */
+	inverted = test_run_inversion( NULL );
+	inherited = test_run_inversion( &attr );
+	os_thread_self_scheduling_set( OS_THREAD_POLICY_DEFAULT, 0 );
+	os_thread_self_affinity_set( 0u );
+	print_message( "waited %u ms with inversion, %u ms with inheritance\n",
+		(unsigned int)inverted, (unsigned int)inherited );
+	assert_true( inverted >= TEST_INVERSION_BUSY );
+	assert_true( inherited <= TEST_INVERSION_HOLD +
+		TEST_INVERSION_BUSY / 4u );
+}
+
+/* test os_thread_mutex_create_ex with a robust lock */
+static void test_os_thread_mutex_robust( void **state )
+{
+	os_thread_mutex_attr_t attr;
+	os_thread_t thread;
+
+	os_memzero( &attr, sizeof( os_thread_mutex_attr_t ) );
+	attr.robust = OS_TRUE;
+	if ( os_thread_mutex_create_ex( &TEST_MUTEX, &attr ) !=
+		OS_STATUS_SUCCESS )
+		skip();
+	assert_int_equal( os_thread_create( &thread, test_robust_worker,
+		NULL, 0u ), OS_STATUS_SUCCESS );
+	os_thread_wait( &thread );
+
+	/* recovered once, then usable as normal */
+	assert_int_equal( os_thread_mutex_lock( &TEST_MUTEX ),
+		OS_STATUS_OWNER_DIED );
+	assert_int_equal( os_thread_mutex_unlock( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_lock( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_unlock( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_mutex_destroy( &TEST_MUTEX ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_once */
+static void test_os_thread_once( void **state )
+{
+	unsigned int i;
+	os_thread_t threads[TEST_THREAD_COUNT];
+
+	assert_int_equal( os_thread_once( NULL, test_once_init, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_once( &TEST_ONCE, NULL, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+
+	TEST_COUNTER = 0u;
+	TEST_READ_ERRORS = 0u;
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		assert_int_equal( os_thread_create( &threads[i],
+			test_once_worker, NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_THREAD_COUNT; ++i )
+		os_thread_wait( &threads[i] );
+	assert_int_equal( os_thread_once( &TEST_ONCE, test_once_init, NULL ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( TEST_COUNTER, 1u );
+	assert_int_equal( TEST_READ_ERRORS, 0u );
+}
+
+/* test os_thread_semaphore_* */
+static void test_os_thread_semaphore( void **state )
+{
+	os_thread_semaphore_t sem;
+	assert_int_equal( os_thread_semaphore_create( NULL, 0u ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_semaphore_create( &sem, 2u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_semaphore_try_wait( &sem ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_semaphore_wait( &sem ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_semaphore_try_wait( &sem ),
+		OS_STATUS_TRY_AGAIN );
+	assert_int_equal( os_thread_semaphore_timed_wait( &sem, 10u ),
+		OS_STATUS_TIMED_OUT );
+	assert_int_equal( os_thread_semaphore_post( &sem ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_semaphore_timed_wait( &sem, 10u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_semaphore_destroy( &sem ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test os_thread_semaphore_* between threads */
+static void test_os_thread_semaphore_producer( void **state )
+{
+	unsigned int i;
+	os_thread_t thread;
+	os_thread_semaphore_create( &TEST_SEM, 0u );
+	assert_int_equal( os_thread_create( &thread, test_semaphore_worker,
+		NULL, 0u ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_ITEM_COUNT; ++i )
+		assert_int_equal( os_thread_semaphore_timed_wait( &TEST_SEM,
+			5000u ), OS_STATUS_SUCCESS );
+	os_thread_wait( &thread );
+	assert_int_equal( os_thread_semaphore_try_wait( &TEST_SEM ),
+		OS_STATUS_TRY_AGAIN );
+	os_thread_semaphore_destroy( &TEST_SEM );
+}
+
+/* test os_thread_spinlock_* */
+static void test_os_thread_spinlock( void **state )
+{
+	assert_int_equal( os_thread_spinlock_create( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_thread_spinlock_create( &TEST_SPINLOCK ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_spinlock_try_lock( &TEST_SPINLOCK ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_spinlock_try_lock( &TEST_SPINLOCK ),
+		OS_STATUS_TRY_AGAIN );
+	assert_int_equal( os_thread_spinlock_unlock( &TEST_SPINLOCK ),
+		OS_STATUS_SUCCESS );
+	test_run_counter_workers( test_spinlock_worker );
+	assert_int_equal( os_thread_spinlock_destroy( &TEST_SPINLOCK ),
+		OS_STATUS_SUCCESS );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_lock_stats_dump ),
+		cmocka_unit_test( test_os_rcu_ptr ),
+		cmocka_unit_test( test_os_seqlock ),
+		cmocka_unit_test( test_os_thread_adaptive_mutex ),
+		cmocka_unit_test( test_os_thread_barrier ),
+		cmocka_unit_test( test_os_thread_brlock ),
+		cmocka_unit_test( test_os_thread_condition_wait_until ),
+		cmocka_unit_test( test_os_thread_create_ex ),
+		cmocka_unit_test( test_os_thread_event_auto_reset ),
+		cmocka_unit_test( test_os_thread_event_manual_reset ),
+		cmocka_unit_test( test_os_thread_event_ping_pong ),
+		cmocka_unit_test( test_os_thread_latch ),
+		cmocka_unit_test( test_os_thread_local_key ),
+		cmocka_unit_test( test_os_thread_mutex_priority_inherit ),
+		cmocka_unit_test( test_os_thread_mutex_robust ),
+		cmocka_unit_test( test_os_thread_once ),
+		cmocka_unit_test( test_os_thread_self ),
+		cmocka_unit_test( test_os_thread_semaphore ),
+		cmocka_unit_test( test_os_thread_semaphore_producer ),
+		cmocka_unit_test( test_os_thread_spinlock ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
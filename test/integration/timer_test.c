@@ -0,0 +1,305 @@
+/**
+ * @file
+ * @brief source file containing integration tests for the timer service
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Number of timers started when testing with many timers */
+#define TEST_MANY_TIMERS 100000u
+
+/** @brief Number of timers started when testing the service thread */
+#define TEST_THREAD_TIMERS 1000u
+
+/** @brief Longest time to wait for timers to expire, in milliseconds */
+#define TEST_WAIT_MAX 5000u
+
+/** @brief Information recorded by the timer callbacks */
+struct test_timer_data
+{
+	/** @brief Number of times the callback was called */
+	unsigned int count;
+	/** @brief Time the callback was last called */
+	os_timestamp_t fired;
+	/** @brief Stop the timer once it has fired this many times (0 = never) */
+	unsigned int stop_after;
+	/** @brief Semaphore posted each time the callback is called (optional) */
+	os_thread_semaphore_t *sem;
+};
+
+/** @brief Timer service under test */
+static os_timer_service_t TEST_SERVICE;
+
+/* records that a timer expired */
+static void test_timer_callback( os_timer_t *timer, void *user_data )
+{
+	struct test_timer_data *const data =
+		(struct test_timer_data *)user_data;
+	++data->count;
+	os_time_monotonic( &data->fired );
+	if ( data->stop_after > 0u && data->count >= data->stop_after )
+		os_timer_stop( timer );
+	if ( data->sem )
+		os_thread_semaphore_post( data->sem );
+}
+
+/* polls the service until all counters reach a value, or a time out */
+static void test_poll_until( const struct test_timer_data *data,
+	unsigned int data_count, unsigned int count )
+{
+	os_timestamp_t start = 0u;
+	os_timestamp_t now = 0u;
+	unsigned int done;
+
+	os_time_monotonic( &start );
+	do
+	{
+		unsigned int i;
+		os_time_sleep( 1u, OS_FALSE );
+		assert_int_equal( os_timer_service_poll( &TEST_SERVICE ),
+			OS_STATUS_SUCCESS );
+		done = 1u;
+		for ( i = 0u; i < data_count; ++i )
+			if ( data[i].count < count )
+				done = 0u;
+		os_time_monotonic( &now );
+	} while ( done == 0u && now - start < TEST_WAIT_MAX );
+	assert_int_equal( done, 1u );
+}
+
+/* test timers beyond the range of the lowest level of the wheel */
+static void test_os_timer_levels( void **state )
+{
+	os_timer_t timers[3];
+	struct test_timer_data data[3];
+	const os_millisecond_t delays[3] = { 100000u, 20000000u, 4000000000u };
+	os_timestamp_t expiry = 0u;
+	os_timestamp_t now = 0u;
+	unsigned int i;
+
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( data, sizeof( data ) );
+	os_time_monotonic( &now );
+	for ( i = 0u; i < 3u; ++i )
+	{
+		assert_int_equal( os_timer_create( &timers[i],
+			test_timer_callback, &data[i] ), OS_STATUS_SUCCESS );
+		assert_int_equal( os_timer_start( &TEST_SERVICE, &timers[i],
+			delays[i], 0u ), OS_STATUS_SUCCESS );
+	}
+
+	/* the next expiry is never later than the first timer */
+	assert_int_equal( os_timer_service_next_expiry( &TEST_SERVICE,
+		&expiry ), OS_STATUS_SUCCESS );
+	assert_true( expiry <= now + delays[0] + 1u );
+	assert_int_equal( os_timer_service_poll( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	for ( i = 0u; i < 3u; ++i )
+	{
+		assert_int_equal( data[i].count, 0u );
+		assert_int_equal( os_timer_destroy( &timers[i] ),
+			OS_STATUS_SUCCESS );
+	}
+	assert_int_equal( os_timer_service_next_expiry( &TEST_SERVICE,
+		&expiry ), OS_STATUS_NOT_FOUND );
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test starting and stopping a large number of timers */
+static void test_os_timer_many( void **state )
+{
+	os_timer_t *timers;
+	struct test_timer_data data;
+	os_timestamp_t expiry = 0u;
+	unsigned int i;
+
+	timers = (os_timer_t *)test_malloc(
+		sizeof( os_timer_t ) * TEST_MANY_TIMERS );
+	assert_non_null( timers );
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( &data, sizeof( data ) );
+	for ( i = 0u; i < TEST_MANY_TIMERS; ++i )
+	{
+		os_timer_create( &timers[i], test_timer_callback, &data );
+		assert_int_equal( os_timer_start( &TEST_SERVICE, &timers[i],
+			1000u + i * 10u, 0u ), OS_STATUS_SUCCESS );
+	}
+	assert_int_equal( os_timer_service_next_expiry( &TEST_SERVICE,
+		&expiry ), OS_STATUS_SUCCESS );
+	for ( i = 0u; i < TEST_MANY_TIMERS; ++i )
+		assert_int_equal( os_timer_stop( &timers[i] ),
+			OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_service_next_expiry( &TEST_SERVICE,
+		&expiry ), OS_STATUS_NOT_FOUND );
+	assert_int_equal( data.count, 0u );
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	test_free( timers );
+}
+
+/* test one-shot timers, run by polling */
+static void test_os_timer_one_shot( void **state )
+{
+	os_timer_t timers[4];
+	struct test_timer_data data[4];
+	const os_millisecond_t delays[4] = { 0u, 5u, 20u, 300u };
+	os_timestamp_t start = 0u;
+	unsigned int i;
+
+	assert_int_equal( os_timer_create( NULL, test_timer_callback, NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( data, sizeof( data ) );
+	os_time_monotonic( &start );
+	for ( i = 0u; i < 4u; ++i )
+	{
+		assert_int_equal( os_timer_create( &timers[i],
+			test_timer_callback, &data[i] ), OS_STATUS_SUCCESS );
+		assert_int_equal( os_timer_start( &TEST_SERVICE, &timers[i],
+			delays[i], 0u ), OS_STATUS_SUCCESS );
+	}
+
+	test_poll_until( data, 4u, 1u );
+	for ( i = 0u; i < 4u; ++i )
+	{
+		/* each timer fired once, not before its delay */
+		assert_int_equal( data[i].count, 1u );
+		assert_true( data[i].fired >= start + delays[i] );
+		assert_int_equal( os_timer_stop( &timers[i] ),
+			OS_STATUS_NOT_FOUND );
+	}
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test periodic timers, stopped from their callback */
+static void test_os_timer_periodic( void **state )
+{
+	os_timer_t timer;
+	struct test_timer_data data;
+
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( &data, sizeof( data ) );
+	data.stop_after = 5u;
+	assert_int_equal( os_timer_create( &timer, test_timer_callback,
+		&data ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_start( &TEST_SERVICE, &timer, 2u, 2u ),
+		OS_STATUS_SUCCESS );
+	test_poll_until( &data, 1u, 5u );
+	os_time_sleep( 20u, OS_FALSE );
+	assert_int_equal( os_timer_service_poll( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 5u );
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test stopping a timer before it expires */
+static void test_os_timer_stop( void **state )
+{
+	os_timer_t timer;
+	struct test_timer_data data;
+
+	assert_int_equal( os_timer_stop( NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( &data, sizeof( data ) );
+	assert_int_equal( os_timer_create( &timer, test_timer_callback,
+		&data ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_stop( &timer ), OS_STATUS_NOT_FOUND );
+	assert_int_equal( os_timer_start( &TEST_SERVICE, &timer, 10u, 0u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_stop( &timer ), OS_STATUS_SUCCESS );
+	os_time_sleep( 20u, OS_FALSE );
+	assert_int_equal( os_timer_service_poll( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 0u );
+
+	/* restarting a scheduled timer reschedules it */
+	assert_int_equal( os_timer_start( &TEST_SERVICE, &timer, 10000u, 0u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_start( &TEST_SERVICE, &timer, 1u, 0u ),
+		OS_STATUS_SUCCESS );
+	test_poll_until( &data, 1u, 1u );
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+}
+
+/* test timers run by the service thread */
+static void test_os_timer_thread( void **state )
+{
+	os_timer_t *timers;
+	struct test_timer_data data;
+	os_thread_semaphore_t sem;
+	unsigned int i;
+
+	timers = (os_timer_t *)test_malloc(
+		sizeof( os_timer_t ) * TEST_THREAD_TIMERS );
+	assert_non_null( timers );
+	assert_int_equal( os_thread_semaphore_create( &sem, 0u ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_service_create( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_service_start( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_memzero( &data, sizeof( data ) );
+	data.sem = &sem;
+
+	/* the thread is sleeping, timers started must wake it up */
+	os_time_sleep( 10u, OS_FALSE );
+	for ( i = 0u; i < TEST_THREAD_TIMERS; ++i )
+	{
+		os_timer_create( &timers[i], test_timer_callback, &data );
+		assert_int_equal( os_timer_start( &TEST_SERVICE, &timers[i],
+			( TEST_THREAD_TIMERS - i ) % 50u, 0u ),
+			OS_STATUS_SUCCESS );
+	}
+	for ( i = 0u; i < TEST_THREAD_TIMERS; ++i )
+		assert_int_equal( os_thread_semaphore_timed_wait( &sem,
+			TEST_WAIT_MAX ), OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, TEST_THREAD_TIMERS );
+
+	assert_int_equal( os_timer_service_stop( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_timer_service_destroy( &TEST_SERVICE ),
+		OS_STATUS_SUCCESS );
+	os_thread_semaphore_destroy( &sem );
+	test_free( timers );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_timer_levels ),
+		cmocka_unit_test( test_os_timer_many ),
+		cmocka_unit_test( test_os_timer_one_shot ),
+		cmocka_unit_test( test_os_timer_periodic ),
+		cmocka_unit_test( test_os_timer_stop ),
+		cmocka_unit_test( test_os_timer_thread ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief source file containing integration tests for the thread watchdog
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include "test_support.h"
+
+/** @brief Longest time allowed between heartbeats, in milliseconds */
+#define TEST_THRESHOLD 30u
+
+/** @brief Time the worker thread stalls for, in milliseconds */
+#define TEST_STALL 100u
+
+/** @brief Information recorded by the watchdog callback */
+struct test_watchdog_data
+{
+	/** @brief Number of times the callback was called */
+	os_atomic_uint32_t count;
+	/** @brief Entry of the last stalled thread reported */
+	os_watchdog_entry_t *entry;
+	/** @brief Longest stall reported, in milliseconds */
+	os_millisecond_t stalled;
+};
+
+/** @brief Watchdog under test */
+static os_watchdog_t TEST_WATCHDOG;
+
+/* records that a thread stalled */
+static void test_watchdog_callback( os_watchdog_entry_t *entry,
+	os_millisecond_t stalled, void *user_data )
+{
+	struct test_watchdog_data *const data =
+		(struct test_watchdog_data *)user_data;
+	data->entry = entry;
+	if ( stalled > data->stalled )
+		data->stalled = stalled;
+	os_atomic_fetch_add_u32( &data->count, 1u, OS_ATOMIC_RELEASE );
+}
+
+/* thread sending heartbeats, then stalling once */
+static OS_THREAD_DECL test_watchdog_worker( void *arg )
+{
+	os_watchdog_entry_t *const entry = (os_watchdog_entry_t *)arg;
+	unsigned int i;
+
+	os_watchdog_register( &TEST_WATCHDOG, entry, "worker",
+		TEST_THRESHOLD );
+	for ( i = 0u; i < 20u; ++i )
+	{
+		os_time_sleep( 1u, OS_FALSE );
+		os_watchdog_heartbeat( entry );
+	}
+	os_time_sleep( TEST_STALL, OS_FALSE );
+	os_watchdog_heartbeat( entry );
+	os_watchdog_unregister( entry );
+	return (OS_THREAD_RETURN)0;
+}
+
+static void test_os_watchdog_bad_parameter( void **state )
+{
+	struct test_watchdog_data data;
+	os_watchdog_entry_t entry;
+
+	os_memzero( &data, sizeof( data ) );
+	os_memzero( &entry, sizeof( entry ) );
+	assert_int_equal( os_watchdog_create( NULL, test_watchdog_callback,
+		&data, 10u ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_create( &TEST_WATCHDOG, NULL, &data,
+		10u ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_create( &TEST_WATCHDOG,
+		test_watchdog_callback, &data, 0u ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_check( NULL ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_heartbeat( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_unregister( NULL ),
+		OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_unregister( &entry ),
+		OS_STATUS_NOT_FOUND );
+
+	assert_int_equal( os_watchdog_create( &TEST_WATCHDOG,
+		test_watchdog_callback, &data, 10u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_register( &TEST_WATCHDOG, &entry, NULL,
+		0u ), OS_STATUS_BAD_PARAMETER );
+	assert_int_equal( os_watchdog_destroy( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_watchdog_check( void **state )
+{
+	struct test_watchdog_data data;
+	os_watchdog_entry_t entry;
+
+	os_memzero( &data, sizeof( data ) );
+	assert_int_equal( os_watchdog_create( &TEST_WATCHDOG,
+		test_watchdog_callback, &data, 10u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_register( &TEST_WATCHDOG, &entry,
+		"checked", TEST_THRESHOLD ), OS_STATUS_SUCCESS );
+
+	/* registering counts as a heartbeat */
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 0u );
+
+	/* reported once each time the threshold passes */
+	os_time_sleep( TEST_THRESHOLD + 10u, OS_FALSE );
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 1u );
+	assert_ptr_equal( data.entry, &entry );
+	assert_string_equal( data.entry->name, "checked" );
+	assert_true( data.stalled > TEST_THRESHOLD );
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 1u );
+	os_time_sleep( TEST_THRESHOLD + 10u, OS_FALSE );
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 2u );
+	assert_true( data.stalled > TEST_THRESHOLD * 2u );
+
+	/* a heartbeat ends the stall */
+	assert_int_equal( os_watchdog_heartbeat( &entry ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 2u );
+
+	/* unregistered threads are not checked */
+	assert_int_equal( os_watchdog_unregister( &entry ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_unregister( &entry ),
+		OS_STATUS_NOT_FOUND );
+	os_time_sleep( TEST_THRESHOLD + 10u, OS_FALSE );
+	assert_int_equal( os_watchdog_check( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( data.count, 2u );
+	assert_int_equal( os_watchdog_destroy( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+}
+
+static void test_os_watchdog_thread( void **state )
+{
+	struct test_watchdog_data data;
+	os_watchdog_entry_t entry;
+	os_thread_t thread;
+
+	os_memzero( &data, sizeof( data ) );
+	assert_int_equal( os_watchdog_create( &TEST_WATCHDOG,
+		test_watchdog_callback, &data, 5u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_start( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_create( &thread, test_watchdog_worker,
+		&entry, 0u ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_thread_wait( &thread ), OS_STATUS_SUCCESS );
+	assert_int_equal( os_watchdog_stop( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+
+	/* the stall is reported by the monitor thread, while it lasts */
+	assert_true( os_atomic_load_u32( &data.count,
+		OS_ATOMIC_ACQUIRE ) >= 1u );
+	assert_ptr_equal( data.entry, &entry );
+	assert_string_equal( data.entry->name, "worker" );
+	assert_true( data.stalled > TEST_THRESHOLD );
+	assert_true( data.stalled <= TEST_STALL + TEST_THRESHOLD );
+	assert_int_equal( os_watchdog_destroy( &TEST_WATCHDOG ),
+		OS_STATUS_SUCCESS );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_os_watchdog_bad_parameter ),
+		cmocka_unit_test( test_os_watchdog_check ),
+		cmocka_unit_test( test_os_watchdog_thread ),
+	};
+
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @brief source file measuring the cost of request-scoped allocations
+ *
+ * Handling a request is simulated by making a number of small allocations of
+ * varying sizes that are all released together.  The number of allocations
+ * per request is swept, and the average time per request is reported when
+ * allocating each object with os_malloc and freeing it with os_free, when
+ * allocating from an arena that is reset after each request, and when
+ * os_malloc is directed to the arena by its allocator.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, EXIT_SUCCESS */
+
+/** @brief Maximum number of allocations per request */
+#define OBJECTS_MAX 256u
+/** @brief Default number of requests per test */
+#define REQUESTS_DEFAULT 20000u
+
+/** @brief Numbers of allocations per request to test with */
+static const unsigned int OBJECT_COUNTS[] = { 8u, 32u, 128u, OBJECTS_MAX };
+
+/** @brief Sizes of the allocations made, in turn (bytes) */
+static const size_t OBJECT_SIZES[] = { 24u, 8u, 96u, 16u, 40u, 200u, 12u, 64u };
+
+/** @brief Allocation strategy under test */
+struct arena_type
+{
+	/** @brief Name of the strategy */
+	const char *name;
+	/** @brief Handles a request making a number of allocations */
+	void (*request)( os_arena_t *arena, unsigned int objects );
+};
+
+/** @brief Allocations of the request being handled */
+static void *OBJECTS[OBJECTS_MAX];
+
+/** @brief Allocates the objects of a request from an arena, then resets it */
+static void arena_request( os_arena_t *arena, unsigned int objects )
+{
+	unsigned int i;
+	for ( i = 0u; i < objects; ++i )
+	{
+		const size_t size = OBJECT_SIZES[i % ( sizeof( OBJECT_SIZES ) /
+			sizeof( OBJECT_SIZES[0] ) )];
+		OBJECTS[i] = os_arena_alloc( arena, size );
+		os_memset( OBJECTS[i], 0, size );
+	}
+	os_arena_reset( arena );
+}
+
+/** @brief Allocates the objects of a request with os_malloc, then frees
+ *         each of them */
+static void malloc_request( os_arena_t *UNUSED(arena), unsigned int objects )
+{
+	unsigned int i;
+	for ( i = 0u; i < objects; ++i )
+	{
+		const size_t size = OBJECT_SIZES[i % ( sizeof( OBJECT_SIZES ) /
+			sizeof( OBJECT_SIZES[0] ) )];
+		OBJECTS[i] = os_malloc( size );
+		os_memset( OBJECTS[i], 0, size );
+	}
+	for ( i = 0u; i < objects; ++i )
+		os_free( OBJECTS[i] );
+}
+
+/** @brief Allocates the objects of a request with os_malloc directed to an
+ *         arena, then resets it */
+static void arena_malloc_request( os_arena_t *arena, unsigned int objects )
+{
+	os_allocator_t allocator;
+	const os_allocator_t *previous;
+	unsigned int i;
+	os_arena_allocator( arena, &allocator );
+	os_allocator_thread_set( &allocator, &previous );
+	for ( i = 0u; i < objects; ++i )
+	{
+		const size_t size = OBJECT_SIZES[i % ( sizeof( OBJECT_SIZES ) /
+			sizeof( OBJECT_SIZES[0] ) )];
+		OBJECTS[i] = os_malloc( size );
+		os_memset( OBJECTS[i], 0, size );
+	}
+	os_allocator_thread_set( previous, NULL );
+	os_arena_reset( arena );
+}
+
+/** @brief Allocation strategies to test */
+static const struct arena_type ARENA_TYPES[] = {
+	{ "malloc", malloc_request },
+	{ "arena", arena_request },
+	{ "allocator", arena_malloc_request }
+};
+
+int main( int argc, char *argv[] )
+{
+	unsigned int requests = REQUESTS_DEFAULT;
+	unsigned int t;
+
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		requests = (unsigned int)atoi( argv[1] );
+
+	os_printf( "%-10s %8s %12s %12s\n", "strategy", "objects",
+		"ns/request", "ns/object" );
+	for ( t = 0u; t < sizeof( ARENA_TYPES ) / sizeof( ARENA_TYPES[0] ); ++t )
+	{
+		unsigned int c;
+		for ( c = 0u; c < sizeof( OBJECT_COUNTS ) /
+			sizeof( OBJECT_COUNTS[0] ); ++c )
+		{
+			os_arena_t arena;
+			os_timestamp_t start = 0u;
+			os_timestamp_t end = 0u;
+			double elapsed;
+			unsigned int i;
+
+			os_arena_create( &arena, 0u );
+			os_time_monotonic( &start );
+			for ( i = 0u; i < requests; ++i )
+				ARENA_TYPES[t].request( &arena,
+					OBJECT_COUNTS[c] );
+			os_time_monotonic( &end );
+			os_arena_destroy( &arena );
+
+			elapsed = (double)( end - start ) * 1000000.0 /
+				(double)requests;
+			os_printf( "%-10s %8u %12.1f %12.1f\n",
+				ARENA_TYPES[t].name, OBJECT_COUNTS[c],
+				elapsed, elapsed / (double)OBJECT_COUNTS[c] );
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief source file measuring the wake up latency of thread primitives
+ *
+ * Two threads pass control back and forth ("ping-pong"), each one waking the
+ * other and then waiting to be woken up again.  The average time of a round
+ * trip is reported for each type of primitive.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, EXIT_SUCCESS */
+
+/** @brief Default number of round trips to measure */
+#define ROUND_TRIPS_DEFAULT 100000u
+
+/** @brief State shared between the two threads */
+struct ping_pong
+{
+	/** @brief Number of round trips to perform */
+	unsigned int round_trips;
+	/** @brief Condition variable signalled when @p turn changes */
+	os_thread_condition_t cond;
+	/** @brief Lock protecting @p turn */
+	os_thread_mutex_t lock;
+	/** @brief Thread whose turn it is (condition variable test) */
+	unsigned int turn;
+	/** @brief Events, one per thread */
+	os_thread_event_t event[2];
+	/** @brief Semaphores, one per thread */
+	os_thread_semaphore_t sem[2];
+};
+
+/**
+ * @brief Waits for this thread's turn, then hands the turn to the other one
+ *
+ * @param[in,out]  pp                  shared state
+ * @param[in]      self                index of the calling thread
+ */
+static void condition_pass( struct ping_pong *pp, unsigned int self )
+{
+	os_thread_mutex_lock( &pp->lock );
+	while ( pp->turn != self )
+		os_thread_condition_wait( &pp->cond, &pp->lock );
+	pp->turn = 1u - self;
+	os_thread_mutex_unlock( &pp->lock );
+	os_thread_condition_signal( &pp->cond, &pp->lock );
+}
+
+/** @brief Second thread in the condition variable test */
+static OS_THREAD_DECL condition_worker( void *arg )
+{
+	struct ping_pong *const pp = (struct ping_pong *)arg;
+	unsigned int i;
+	for ( i = 0u; i < pp->round_trips; ++i )
+		condition_pass( pp, 1u );
+	return (OS_THREAD_RETURN)0;
+}
+
+/** @brief Second thread in the event test */
+static OS_THREAD_DECL event_worker( void *arg )
+{
+	struct ping_pong *const pp = (struct ping_pong *)arg;
+	unsigned int i;
+	for ( i = 0u; i < pp->round_trips; ++i )
+	{
+		os_thread_event_wait( &pp->event[1] );
+		os_thread_event_set( &pp->event[0] );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/** @brief Second thread in the semaphore test */
+static OS_THREAD_DECL semaphore_worker( void *arg )
+{
+	struct ping_pong *const pp = (struct ping_pong *)arg;
+	unsigned int i;
+	for ( i = 0u; i < pp->round_trips; ++i )
+	{
+		os_thread_semaphore_wait( &pp->sem[1] );
+		os_thread_semaphore_post( &pp->sem[0] );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+/**
+ * @brief Runs one ping-pong test and prints the average round trip
+ *
+ * @param[in]      name                name of the primitive tested
+ * @param[in,out]  pp                  shared state
+ * @param[in]      worker              second thread of the test
+ * @param[in]      type                0 = condition, 1 = event, 2 = semaphore
+ */
+static void run_test( const char *name, struct ping_pong *pp,
+	os_thread_main_t worker, unsigned int type )
+{
+	os_thread_t thread;
+	os_timestamp_t start = 0u;
+	os_timestamp_t end = 0u;
+	unsigned int i;
+
+	pp->turn = 0u;
+	os_time_monotonic( &start );
+	os_thread_create( &thread, worker, pp, 0u );
+	for ( i = 0u; i < pp->round_trips; ++i )
+	{
+		if ( type == 0u )
+			condition_pass( pp, 0u );
+		else if ( type == 1u )
+		{
+			os_thread_event_set( &pp->event[1] );
+			os_thread_event_wait( &pp->event[0] );
+		}
+		else
+		{
+			os_thread_semaphore_post( &pp->sem[1] );
+			os_thread_semaphore_wait( &pp->sem[0] );
+		}
+	}
+	os_thread_wait( &thread );
+	os_time_monotonic( &end );
+
+	os_printf( "%-20s %10u %12.3f\n", name, pp->round_trips,
+		(double)( end - start ) * 1000.0 / (double)pp->round_trips );
+}
+
+int main( int argc, char *argv[] )
+{
+	struct ping_pong pp;
+
+	pp.round_trips = ROUND_TRIPS_DEFAULT;
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		pp.round_trips = (unsigned int)atoi( argv[1] );
+
+	os_thread_condition_create( &pp.cond );
+	os_thread_mutex_create( &pp.lock );
+	os_thread_event_create( &pp.event[0], OS_FALSE );
+	os_thread_event_create( &pp.event[1], OS_FALSE );
+	os_thread_semaphore_create( &pp.sem[0], 0u );
+	os_thread_semaphore_create( &pp.sem[1], 0u );
+
+	os_printf( "%-20s %10s %12s\n", "primitive", "trips", "us/trip" );
+	run_test( "condition", &pp, condition_worker, 0u );
+	run_test( "event", &pp, event_worker, 1u );
+	run_test( "semaphore", &pp, semaphore_worker, 2u );
+
+	os_thread_semaphore_destroy( &pp.sem[1] );
+	os_thread_semaphore_destroy( &pp.sem[0] );
+	os_thread_event_destroy( &pp.event[1] );
+	os_thread_event_destroy( &pp.event[0] );
+	os_thread_mutex_destroy( &pp.lock );
+	os_thread_condition_destroy( &pp.cond );
+	return EXIT_SUCCESS;
+}
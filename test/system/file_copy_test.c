@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief source file measuring the throughput of file copies
+ *
+ * A file of each size is created, then copied a number of times (more for
+ * small files, so at least 64 MB are copied).  The
+ * average time per copy and the throughput are reported for os_file_copy,
+ * for os_file_copy_ex waiting for the copy to reach the storage device, and
+ * for a copy through a 4 KB buffer using os_file_read and os_file_write.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, EXIT_FAILURE, EXIT_SUCCESS */
+
+/** @brief Size of the buffer used by the buffered copy */
+#define BUFFER_SIZE 4096u
+/** @brief Default number of copies per test */
+#define COPIES_DEFAULT 5u
+/** @brief Smallest amount of data copied per test (bytes) */
+#define COPY_BYTES_MIN ( 64u * 1024u * 1024u )
+/** @brief Name of the file copied */
+#define FILE_FROM "file_copy_from.tmp"
+/** @brief Name of the copy made */
+#define FILE_TO "file_copy_to.tmp"
+
+/** @brief File sizes to test with (bytes) */
+static const size_t FILE_SIZES[] = {
+	64u * 1024u, 1024u * 1024u, 16u * 1024u * 1024u, 256u * 1024u * 1024u };
+
+/** @brief Copy method under test */
+struct copy_type
+{
+	/** @brief Name of the method */
+	const char *name;
+	/** @brief Copies a file */
+	os_status_t (*copy)( const char *old_path, const char *new_path );
+};
+
+/** @brief Copies a file through a buffer, a block at a time */
+static os_status_t buffer_copy( const char *old_path, const char *new_path )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	const os_file_t in = os_file_open( old_path, OS_READ );
+	const os_file_t out = os_file_open( new_path,
+		OS_WRITE | OS_CREATE | OS_TRUNCATE );
+	if ( in != NULL && out != NULL )
+	{
+		char buf[BUFFER_SIZE];
+		size_t len;
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS &&
+			( len = os_file_read( buf, 1u, sizeof( buf ), in ) ) > 0u )
+		{
+			if ( os_file_write( buf, 1u, len, out ) != len )
+				result = OS_STATUS_FAILURE;
+		}
+	}
+	if ( in != NULL )
+		os_file_close( in );
+	if ( out != NULL )
+		os_file_close( out );
+	return result;
+}
+
+/** @brief Copies a file, waiting for it to reach the storage device */
+static os_status_t sync_copy( const char *old_path, const char *new_path )
+{
+	return os_file_copy_ex( old_path, new_path, OS_FILE_COPY_SYNC );
+}
+
+/** @brief Copy methods to test */
+static const struct copy_type COPY_TYPES[] = {
+	{ "buffer", buffer_copy },
+	{ "copy", os_file_copy },
+	{ "copy+sync", sync_copy }
+};
+
+/** @brief Creates the file to copy */
+static os_status_t file_create( size_t size )
+{
+	os_status_t result = OS_STATUS_FAILURE;
+	const os_file_t out = os_file_open( FILE_FROM,
+		OS_WRITE | OS_CREATE | OS_TRUNCATE );
+	if ( out != NULL )
+	{
+		char buf[BUFFER_SIZE];
+		size_t written = 0u;
+		size_t i;
+		for ( i = 0u; i < sizeof( buf ); ++i )
+			buf[i] = (char)i;
+		result = OS_STATUS_SUCCESS;
+		while ( result == OS_STATUS_SUCCESS && written < size )
+		{
+			if ( os_file_write( buf, 1u, sizeof( buf ), out ) !=
+				sizeof( buf ) )
+				result = OS_STATUS_FAILURE;
+			written += sizeof( buf );
+		}
+		os_file_close( out );
+	}
+	return result;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int copies = COPIES_DEFAULT;
+	int result = EXIT_SUCCESS;
+	unsigned int s;
+
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		copies = (unsigned int)atoi( argv[1] );
+
+	os_printf( "%-10s %10s %12s %10s\n", "method", "size (KB)",
+		"ms/copy", "MB/s" );
+	for ( s = 0u; result == EXIT_SUCCESS &&
+		s < sizeof( FILE_SIZES ) / sizeof( FILE_SIZES[0] ); ++s )
+	{
+		unsigned int t;
+		if ( file_create( FILE_SIZES[s] ) != OS_STATUS_SUCCESS )
+			result = EXIT_FAILURE;
+		for ( t = 0u; result == EXIT_SUCCESS &&
+			t < sizeof( COPY_TYPES ) / sizeof( COPY_TYPES[0] ); ++t )
+		{
+			unsigned int count = copies;
+			os_timestamp_t start = 0u;
+			os_timestamp_t end = 0u;
+			double elapsed;
+			unsigned int i;
+
+			if ( FILE_SIZES[s] * count < COPY_BYTES_MIN )
+				count = (unsigned int)( COPY_BYTES_MIN /
+					FILE_SIZES[s] );
+			os_time_monotonic( &start );
+			for ( i = 0u; result == EXIT_SUCCESS && i < count; ++i )
+				if ( COPY_TYPES[t].copy( FILE_FROM, FILE_TO ) !=
+					OS_STATUS_SUCCESS )
+					result = EXIT_FAILURE;
+			os_time_monotonic( &end );
+
+			elapsed = (double)( end - start ) / (double)count;
+			os_printf( "%-10s %10lu %12.2f %10.1f\n",
+				COPY_TYPES[t].name,
+				(unsigned long)( FILE_SIZES[s] / 1024u ), elapsed,
+				elapsed > 0.0 ? (double)FILE_SIZES[s] /
+				( elapsed * 1000.0 ) : 0.0 );
+		}
+	}
+	os_file_delete( FILE_FROM );
+	os_file_delete( FILE_TO );
+	if ( result != EXIT_SUCCESS )
+		os_fprintf( OS_STDERR, "failed to copy the file\n" );
+	return result;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief source file measuring the throughput of the mutual exclusion locks
+ *
+ * A fixed amount of lock/unlock operations is split between a number of
+ * threads, each holding the lock for a critical section of a given length.
+ * The number of threads and the length of the critical section are swept,
+ * and the average time per operation is reported for each type of lock.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, EXIT_SUCCESS */
+
+/** @brief Default number of lock operations per test */
+#define OPERATIONS_DEFAULT 400000u
+/** @brief Maximum number of threads */
+#define THREADS_MAX 8u
+
+/** @brief Numbers of threads to test with */
+static const unsigned int THREAD_COUNTS[] = { 1u, 2u, 4u, THREADS_MAX };
+/** @brief Critical section lengths to test with (loop iterations) */
+static const unsigned int SECTION_LENGTHS[] = { 0u, 16u, 128u, 1024u };
+
+/** @brief Lock type under test */
+struct lock_type
+{
+	/** @brief Name of the lock type */
+	const char *name;
+	/** @brief Obtains the lock */
+	void (*lock)( void );
+	/** @brief Releases the lock */
+	void (*unlock)( void );
+};
+
+/** @brief Parameters shared by the threads of a test */
+struct lock_test
+{
+	/** @brief Lock type under test */
+	const struct lock_type *type;
+	/** @brief Number of operations for each thread */
+	unsigned int operations;
+	/** @brief Length of the critical section */
+	unsigned int section_length;
+};
+
+/** @brief Adaptive lock */
+static os_thread_adaptive_mutex_t ADAPTIVE_MUTEX;
+/** @brief Operating system mutex */
+static os_thread_mutex_t MUTEX;
+/** @brief Spin lock */
+static os_thread_spinlock_t SPINLOCK;
+/** @brief Data modified within the critical section */
+static volatile unsigned int SHARED_DATA;
+
+/** @brief Obtains the adaptive lock */
+static void adaptive_mutex_lock( void )
+{
+	os_thread_adaptive_mutex_lock( &ADAPTIVE_MUTEX );
+}
+
+/** @brief Releases the adaptive lock */
+static void adaptive_mutex_unlock( void )
+{
+	os_thread_adaptive_mutex_unlock( &ADAPTIVE_MUTEX );
+}
+
+/** @brief Obtains the operating system mutex */
+static void mutex_lock( void )
+{
+	os_thread_mutex_lock( &MUTEX );
+}
+
+/** @brief Releases the operating system mutex */
+static void mutex_unlock( void )
+{
+	os_thread_mutex_unlock( &MUTEX );
+}
+
+/** @brief Obtains the spin lock */
+static void spinlock_lock( void )
+{
+	os_thread_spinlock_lock( &SPINLOCK );
+}
+
+/** @brief Releases the spin lock */
+static void spinlock_unlock( void )
+{
+	os_thread_spinlock_unlock( &SPINLOCK );
+}
+
+/** @brief Lock types to test */
+static const struct lock_type LOCK_TYPES[] = {
+	{ "mutex", mutex_lock, mutex_unlock },
+	{ "adaptive", adaptive_mutex_lock, adaptive_mutex_unlock },
+	{ "spinlock", spinlock_lock, spinlock_unlock }
+};
+
+/** @brief Thread repeatedly entering the critical section */
+static OS_THREAD_DECL lock_worker( void *arg )
+{
+	const struct lock_test *const test = (const struct lock_test *)arg;
+	unsigned int i;
+	for ( i = 0u; i < test->operations; ++i )
+	{
+		unsigned int j;
+		test->type->lock();
+		for ( j = 0u; j < test->section_length; ++j )
+			++SHARED_DATA;
+		test->type->unlock();
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int operations = OPERATIONS_DEFAULT;
+	unsigned int t;
+
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		operations = (unsigned int)atoi( argv[1] );
+
+	os_thread_adaptive_mutex_create( &ADAPTIVE_MUTEX );
+	os_thread_mutex_create( &MUTEX );
+	os_thread_spinlock_create( &SPINLOCK );
+
+	os_printf( "%-10s %8s %8s %12s\n", "lock", "threads", "section",
+		"ns/op" );
+	for ( t = 0u; t < sizeof( LOCK_TYPES ) / sizeof( LOCK_TYPES[0] ); ++t )
+	{
+		unsigned int c;
+		for ( c = 0u; c < sizeof( THREAD_COUNTS ) /
+			sizeof( THREAD_COUNTS[0] ); ++c )
+		{
+			unsigned int s;
+			for ( s = 0u; s < sizeof( SECTION_LENGTHS ) /
+				sizeof( SECTION_LENGTHS[0] ); ++s )
+			{
+				os_thread_t threads[THREADS_MAX];
+				struct lock_test test;
+				os_timestamp_t start = 0u;
+				os_timestamp_t end = 0u;
+				unsigned int i;
+
+				test.type = &LOCK_TYPES[t];
+				test.operations = operations / THREAD_COUNTS[c];
+				test.section_length = SECTION_LENGTHS[s];
+
+				os_time_monotonic( &start );
+				for ( i = 0u; i < THREAD_COUNTS[c]; ++i )
+					os_thread_create( &threads[i],
+						lock_worker, &test, 0u );
+				for ( i = 0u; i < THREAD_COUNTS[c]; ++i )
+					os_thread_wait( &threads[i] );
+				os_time_monotonic( &end );
+
+				os_printf( "%-10s %8u %8u %12.1f\n",
+					LOCK_TYPES[t].name, THREAD_COUNTS[c],
+					SECTION_LENGTHS[s],
+					(double)( end - start ) * 1000000.0 /
+					(double)( test.operations *
+						THREAD_COUNTS[c] ) );
+			}
+		}
+	}
+
+	os_thread_spinlock_destroy( &SPINLOCK );
+	os_thread_mutex_destroy( &MUTEX );
+	os_thread_adaptive_mutex_destroy( &ADAPTIVE_MUTEX );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief source file measuring the throughput of the memory allocators
+ *
+ * A fixed amount of allocations is split between a number of threads, each
+ * allocating a batch of blocks of a given size then freeing them again.
+ * The number of threads and the size of the blocks are swept, and the
+ * average time per allocation and free is reported for each allocator, and
+ * for a pool of blocks of the size allocated.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, free, malloc, EXIT_SUCCESS */
+
+/** @brief Number of blocks allocated before they are freed */
+#define BATCH_SIZE 32u
+/** @brief Default number of allocations per test */
+#define OPERATIONS_DEFAULT 2000000u
+/** @brief Maximum number of threads */
+#define THREADS_MAX 8u
+
+/** @brief Numbers of threads to test with */
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+static const unsigned int THREAD_COUNTS[] = { 1u, 2u, 4u, THREADS_MAX };
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+static const unsigned int THREAD_COUNTS[] = { 1u };
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+/** @brief Block sizes to test with (bytes) */
+static const size_t BLOCK_SIZES[] = { 16u, 64u, 256u, 512u };
+
+/** @brief Allocator under test */
+struct malloc_type
+{
+	/** @brief Name of the allocator */
+	const char *name;
+	/** @brief Allocator to install, NULL to call the C library */
+	const os_allocator_t *(*allocator)( void );
+	/** @brief Whether blocks are allocated from a pool instead */
+	os_bool_t pool;
+};
+
+/** @brief Parameters shared by the threads of a test */
+struct malloc_test
+{
+	/** @brief Allocator under test */
+	const struct malloc_type *type;
+	/** @brief Number of allocations for each thread */
+	unsigned int operations;
+	/** @brief Size of each block allocated */
+	size_t block_size;
+	/** @brief Pool of blocks of the size allocated */
+	os_pool_t pool;
+};
+
+/** @brief Allocators to test */
+static const struct malloc_type MALLOC_TYPES[] = {
+	{ "libc", NULL, OS_FALSE },
+	{ "system", os_allocator_system, OS_FALSE },
+	{ "cache", os_allocator_thread_cache, OS_FALSE },
+	{ "pool", NULL, OS_TRUE }
+};
+
+/** @brief Repeatedly allocates and frees batches of blocks */
+static void malloc_run( struct malloc_test *test )
+{
+	void *blocks[BATCH_SIZE];
+	unsigned int i;
+	for ( i = 0u; i < test->operations; i += BATCH_SIZE )
+	{
+		unsigned int j;
+		if ( test->type->pool )
+		{
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				blocks[j] = os_pool_alloc( &test->pool );
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				os_pool_free( &test->pool, blocks[j] );
+		}
+		else if ( test->type->allocator )
+		{
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				blocks[j] = os_malloc( test->block_size );
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				os_free( blocks[j] );
+		}
+		else
+		{
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				blocks[j] = malloc( test->block_size );
+			for ( j = 0u; j < BATCH_SIZE; ++j )
+				free( blocks[j] );
+		}
+	}
+}
+
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+/** @brief Thread repeatedly allocating and freeing batches of blocks */
+static OS_THREAD_DECL malloc_worker( void *arg )
+{
+	malloc_run( (struct malloc_test *)arg );
+	return (OS_THREAD_RETURN)0;
+}
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+
+int main( int argc, char *argv[] )
+{
+	unsigned int operations = OPERATIONS_DEFAULT;
+	unsigned int t;
+
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		operations = (unsigned int)atoi( argv[1] );
+
+	os_printf( "%-10s %8s %8s %12s\n", "allocator", "threads", "size",
+		"ns/op" );
+	for ( t = 0u; t < sizeof( MALLOC_TYPES ) / sizeof( MALLOC_TYPES[0] );
+		++t )
+	{
+		unsigned int c;
+		if ( MALLOC_TYPES[t].allocator )
+			os_allocator_set( MALLOC_TYPES[t].allocator() );
+		for ( c = 0u; c < sizeof( THREAD_COUNTS ) /
+			sizeof( THREAD_COUNTS[0] ); ++c )
+		{
+			unsigned int s;
+			for ( s = 0u; s < sizeof( BLOCK_SIZES ) /
+				sizeof( BLOCK_SIZES[0] ); ++s )
+			{
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+				os_thread_t threads[THREADS_MAX];
+				unsigned int i;
+#endif /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+				struct malloc_test test;
+				os_timestamp_t start = 0u;
+				os_timestamp_t end = 0u;
+
+				test.type = &MALLOC_TYPES[t];
+				test.operations = operations / THREAD_COUNTS[c];
+				test.block_size = BLOCK_SIZES[s];
+				os_pool_create( &test.pool, test.block_size, 0u,
+					0u );
+
+				os_time_monotonic( &start );
+#if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT
+				for ( i = 0u; i < THREAD_COUNTS[c]; ++i )
+					os_thread_create( &threads[i],
+						malloc_worker, &test, 0u );
+				for ( i = 0u; i < THREAD_COUNTS[c]; ++i )
+					os_thread_wait( &threads[i] );
+#else /* if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+				malloc_run( &test );
+#endif /* else if defined(OSAL_THREAD_SUPPORT) && OSAL_THREAD_SUPPORT */
+				os_time_monotonic( &end );
+				os_pool_destroy( &test.pool );
+
+				os_printf( "%-10s %8u %8u %12.1f\n",
+					MALLOC_TYPES[t].name, THREAD_COUNTS[c],
+					(unsigned int)BLOCK_SIZES[s],
+					(double)( end - start ) * 1000000.0 /
+					(double)( test.operations *
+						THREAD_COUNTS[c] ) );
+			}
+		}
+	}
+
+	os_allocator_set( NULL );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief source file measuring how read locks scale with the number of threads
+ *
+ * Each thread repeatedly takes and releases a read lock, reading a shared
+ * value while holding it.  The number of threads is doubled up to
+ * THREADS_MAX and the total read throughput is reported for the
+ * reader-writer lock and the big-reader lock.  With a lock that scales, the
+ * throughput grows with the number of threads up to the number of CPUs.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include <os.h>
+
+#include <stdlib.h> /* for atoi, EXIT_SUCCESS */
+
+/** @brief Default number of read locks taken by each thread */
+#define OPERATIONS_DEFAULT 200000u
+/** @brief Maximum number of threads */
+#define THREADS_MAX 16u
+
+/** @brief Lock type under test */
+struct lock_type
+{
+	/** @brief Name of the lock type */
+	const char *name;
+	/** @brief Obtains a read lock */
+	void (*read_lock)( void );
+	/** @brief Releases a read lock */
+	void (*read_unlock)( void );
+};
+
+/** @brief Big-reader lock, preferring readers */
+static os_thread_brlock_t BRLOCK;
+/** @brief Big-reader lock, preferring writers */
+static os_thread_brlock_t BRLOCK_WRITER;
+/** @brief Operating system reader-writer lock */
+static os_thread_rwlock_t RWLOCK;
+/** @brief Released to start all threads at the same time */
+static os_thread_event_t START;
+/** @brief Number of read locks taken by each thread */
+static unsigned int OPERATIONS = OPERATIONS_DEFAULT;
+/** @brief Data read within the critical section */
+static volatile unsigned int SHARED_DATA;
+
+/** @brief Obtains a read lock on the reader-preferring big-reader lock */
+static void brlock_read_lock( void )
+{
+	os_thread_brlock_read_lock( &BRLOCK );
+}
+
+/** @brief Releases a read lock on the reader-preferring big-reader lock */
+static void brlock_read_unlock( void )
+{
+	os_thread_brlock_read_unlock( &BRLOCK );
+}
+
+/** @brief Obtains a read lock on the writer-preferring big-reader lock */
+static void brlock_writer_read_lock( void )
+{
+	os_thread_brlock_read_lock( &BRLOCK_WRITER );
+}
+
+/** @brief Releases a read lock on the writer-preferring big-reader lock */
+static void brlock_writer_read_unlock( void )
+{
+	os_thread_brlock_read_unlock( &BRLOCK_WRITER );
+}
+
+/** @brief Obtains a read lock on the operating system lock */
+static void rwlock_read_lock( void )
+{
+	os_thread_rwlock_read_lock( &RWLOCK );
+}
+
+/** @brief Releases a read lock on the operating system lock */
+static void rwlock_read_unlock( void )
+{
+	os_thread_rwlock_read_unlock( &RWLOCK );
+}
+
+/** @brief Lock types to test */
+static struct lock_type LOCK_TYPES[] = {
+	{ "rwlock", rwlock_read_lock, rwlock_read_unlock },
+	{ "brlock", brlock_read_lock, brlock_read_unlock },
+	{ "brlock-wp", brlock_writer_read_lock, brlock_writer_read_unlock }
+};
+
+/** @brief Thread repeatedly taking a read lock */
+static OS_THREAD_DECL read_worker( void *arg )
+{
+	const struct lock_type *const type = (const struct lock_type *)arg;
+	unsigned int i;
+	unsigned int sum = 0u;
+
+	os_thread_event_wait( &START );
+	for ( i = 0u; i < OPERATIONS; ++i )
+	{
+		type->read_lock();
+		sum += SHARED_DATA;
+		type->read_unlock();
+	}
+	return (OS_THREAD_RETURN)(size_t)sum;
+}
+
+int main( int argc, char *argv[] )
+{
+	unsigned int t;
+
+	if ( argc > 1 && atoi( argv[1] ) > 0 )
+		OPERATIONS = (unsigned int)atoi( argv[1] );
+
+	os_thread_brlock_create( &BRLOCK, OS_FALSE );
+	os_thread_brlock_create( &BRLOCK_WRITER, OS_TRUE );
+	os_thread_rwlock_create( &RWLOCK );
+
+	os_printf( "CPUs available: %u\n", os_system_cpu_count() );
+	os_printf( "%-10s %8s %12s %12s\n", "lock", "threads", "ns/op",
+		"Mops/s" );
+	for ( t = 0u; t < sizeof( LOCK_TYPES ) / sizeof( LOCK_TYPES[0] ); ++t )
+	{
+		unsigned int thread_count;
+		for ( thread_count = 1u; thread_count <= THREADS_MAX;
+			thread_count *= 2u )
+		{
+			os_thread_t threads[THREADS_MAX];
+			os_timestamp_t start = 0u;
+			os_timestamp_t end = 0u;
+			double elapsed_ns;
+			unsigned int i;
+
+			os_thread_event_create( &START, OS_TRUE );
+			for ( i = 0u; i < thread_count; ++i )
+				os_thread_create( &threads[i], read_worker,
+					&LOCK_TYPES[t], 0u );
+
+			os_time_monotonic( &start );
+			os_thread_event_set( &START );
+			for ( i = 0u; i < thread_count; ++i )
+				os_thread_wait( &threads[i] );
+			os_time_monotonic( &end );
+			os_thread_event_destroy( &START );
+
+			elapsed_ns = (double)( end - start ) * 1000000.0;
+			if ( elapsed_ns < 1.0 )
+				elapsed_ns = 1.0;
+			os_printf( "%-10s %8u %12.1f %12.2f\n",
+				LOCK_TYPES[t].name, thread_count,
+				elapsed_ns / (double)OPERATIONS,
+				(double)OPERATIONS * (double)thread_count *
+				1000.0 / elapsed_ns );
+		}
+	}
+
+	os_thread_rwlock_destroy( &RWLOCK );
+	os_thread_brlock_destroy( &BRLOCK_WRITER );
+	os_thread_brlock_destroy( &BRLOCK );
+	return EXIT_SUCCESS;
+}